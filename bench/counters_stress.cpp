@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// Two-thread stress test for the receiver-task / loop() counter exchange
+// (seqlock_counters.h), run on the host with std::thread standing in for the
+// radio_recv task and loop().
+//
+// "receiver" counts into its SeqlockCounters block in the same pattern as
+// receive_frame() (a few fields per frame, one publish() per frame), and reads
+// the loop's block the way rx_task_view_() does. "loop" folds snapshot deltas
+// into its interval counters the way diag_sync_rx_task_() does, closes an
+// interval every few hundred passes (fold into a total, reset) and publishes
+// its own block back. At the end every counter summed over all intervals has
+// to equal what the receiver counted, and every snapshot either side ever saw
+// has to be internally consistent (fields the writer only changes together
+// never disagree).
+//
+// For comparison the previous scheme, where loop() reads and then zeroes the
+// very counters the receiver increments, runs on the same schedule and
+// reports how many increments it lost.
+
+#include "seqlock_counters.h"
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace wr = esphome::wmbus_radio;
+
+namespace {
+
+// Shaped like RxPathCounters: scalars plus RSSI bucket arrays. frames and
+// bytes_x3 always change together (bytes_x3 == 3 * frames), as do the bucket
+// sum and frames.
+struct RxCounters {
+  uint32_t frames{0};
+  uint32_t bytes_x3{0};
+  uint32_t odd_frames{0};
+  uint32_t rssi_bucket[5]{};
+  uint32_t filler[16]{};
+};
+
+// Shaped like LoopRxStats: ok never exceeds total, interval counts closes.
+struct LoopCounters {
+  uint32_t total{0};
+  uint32_t ok{0};
+  uint32_t interval{0};
+};
+
+bool consistent(const RxCounters &c) {
+  uint32_t buckets = 0;
+  for (uint32_t b : c.rssi_bucket) buckets += b;
+  return c.bytes_x3 == 3U * c.frames && buckets == c.frames && c.filler[15] == c.frames;
+}
+
+bool consistent(const LoopCounters &c) { return c.ok <= c.total && c.total == 2U * c.interval + c.ok; }
+
+struct Result {
+  uint64_t receiver_frames{0};
+  uint64_t loop_frames{0};
+  uint64_t loop_odd{0};
+  uint64_t loop_buckets[5]{};
+  uint64_t torn_rx{0};
+  uint64_t torn_loop{0};
+  uint64_t rx_read_gave_up{0};
+  uint64_t loop_read_gave_up{0};
+  uint64_t loop_passes{0};
+  uint64_t intervals{0};
+};
+
+Result run_seqlock(uint32_t frames) {
+  static wr::SeqlockCounters<RxCounters> rx_block;
+  static wr::SeqlockCounters<LoopCounters> loop_block;
+  rx_block.local() = {};
+  rx_block.publish();
+  loop_block.local() = {};
+  loop_block.publish();
+
+  Result r;
+  std::atomic<bool> done{false};
+
+  std::thread receiver([&] {
+    RxCounters &rx = rx_block.local();
+    LoopCounters seen;
+    for (uint32_t i = 0; i < frames; i++) {
+      rx.frames++;
+      rx.bytes_x3 += 3;
+      if (i & 1U) rx.odd_frames++;
+      rx.rssi_bucket[i % 5]++;
+      rx.filler[15]++;
+      rx_block.publish();
+      if ((i & 7U) == 0) {
+        if (!loop_block.read(seen))
+          r.rx_read_gave_up++;
+        else if (!consistent(seen))
+          r.torn_loop++;
+      }
+    }
+    done.store(true, std::memory_order_release);
+  });
+
+  std::thread loop([&] {
+    RxCounters interval{};
+    RxCounters seen{};
+    uint64_t closed_frames = 0, closed_odd = 0, closed_buckets[5] = {};
+    auto sync = [&] {
+      RxCounters now;
+      if (!rx_block.read(now)) {
+        r.loop_read_gave_up++;
+        return;
+      }
+      if (!consistent(now)) r.torn_rx++;
+      RxCounters delta = now;
+      wr::counters_fold(delta, seen, true);
+      wr::counters_fold(interval, delta, false);
+      seen = now;
+    };
+    LoopCounters &lc = loop_block.local();
+    bool last = false;
+    while (!last) {
+      last = done.load(std::memory_order_acquire);
+      sync();
+      r.loop_passes++;
+      // Loop-owned counters the receiver reads back.
+      lc.total += 1;
+      lc.ok += 1;
+      loop_block.publish();
+      if ((r.loop_passes % 300) == 0 || last) {
+        closed_frames += interval.frames;
+        closed_odd += interval.odd_frames;
+        for (int b = 0; b < 5; b++) closed_buckets[b] += interval.rssi_bucket[b];
+        interval = {};
+        lc.interval++;
+        lc.total = 2U * lc.interval;
+        lc.ok = 0;
+        loop_block.publish();
+        r.intervals++;
+      }
+    }
+    r.loop_frames = closed_frames;
+    r.loop_odd = closed_odd;
+    for (int b = 0; b < 5; b++) r.loop_buckets[b] = closed_buckets[b];
+  });
+
+  receiver.join();
+  loop.join();
+  r.receiver_frames = frames;
+  return r;
+}
+
+// The previous scheme: both sides on the same counters, loop() resets them.
+// Relaxed atomics keep the race well-defined on the host; on the ESP32 these
+// were plain uint32_t with the same load / add / store and read / zero steps.
+uint64_t run_shared_reset(uint32_t frames) {
+  std::atomic<uint32_t> shared{0};
+  std::atomic<bool> done{false};
+  uint64_t counted = 0;
+
+  std::thread receiver([&] {
+    for (uint32_t i = 0; i < frames; i++) {
+      shared.store(shared.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    done.store(true, std::memory_order_release);
+  });
+  std::thread loop([&] {
+    bool last = false;
+    while (!last) {
+      last = done.load(std::memory_order_acquire);
+      counted += shared.load(std::memory_order_relaxed);
+      shared.store(0, std::memory_order_relaxed);
+    }
+  });
+  receiver.join();
+  loop.join();
+  return (uint64_t) frames - counted;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  uint32_t frames = 5000000;
+  int rounds = 5;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) frames = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+    if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) rounds = std::atoi(argv[++i]);
+  }
+  std::printf("hardware threads: %u, %u frames x %d rounds\n", std::thread::hardware_concurrency(), frames, rounds);
+
+  int failures = 0;
+  for (int round = 0; round < rounds; round++) {
+    const auto t0 = std::chrono::steady_clock::now();
+    const Result r = run_seqlock(frames);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    uint64_t buckets = 0;
+    for (uint64_t b : r.loop_buckets) buckets += b;
+    const bool lost = r.loop_frames != r.receiver_frames || r.loop_odd != r.receiver_frames / 2 ||
+                      buckets != r.receiver_frames;
+    const bool torn = r.torn_rx != 0 || r.torn_loop != 0;
+    if (lost || torn) failures++;
+    std::printf("seqlock  round %d: counted %" PRIu64 "/%" PRIu64 " frames over %" PRIu64 " intervals, %" PRIu64
+                " loop passes, torn snapshots %" PRIu64 "/%" PRIu64 ", reads given up %" PRIu64 "/%" PRIu64
+                " (%.0f ms) %s\n",
+                round, r.loop_frames, r.receiver_frames, r.intervals, r.loop_passes, r.torn_rx, r.torn_loop,
+                r.loop_read_gave_up, r.rx_read_gave_up, ms, (lost || torn) ? "FAILED" : "OK");
+  }
+
+  for (int round = 0; round < 2; round++) {
+    const uint64_t lost = run_shared_reset(frames);
+    std::printf("previous read-and-zero scheme round %d: lost %" PRIu64 "/%u increments\n", round, lost, frames);
+  }
+
+  std::printf("%s\n", failures == 0 ? "no increments lost, no torn snapshots" : "FAILED");
+  return failures == 0 ? 0 : 1;
+}
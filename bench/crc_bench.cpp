@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// Microbenchmark for the DLL CRC strip in dll_crc.h.
+//
+// Compares trim_dll_crc_format_a/b against a copy of the previous bit-by-bit,
+// copy-into-new-vector implementation on 143-byte telegrams (the
+// largest T1 meters in docs/BENCHMARKS.md), counts heap allocations on the
+// success path through a global operator new hook, and cross-checks both
+// implementations on random good and corrupted frames before timing anything.
+
+#include "dll_crc.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace wc = esphome::wmbus_common;
+
+static size_t g_allocs = 0;
+
+void *operator new(size_t n) {
+  g_allocs++;
+  if (void *p = std::malloc(n == 0 ? 1 : n)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace legacy {
+
+static uint16_t crc16_per_byte(uint16_t crc, uint8_t b) {
+  for (int i = 0; i < 8; i++) {
+    if ((((crc & 0x8000) >> 8) ^ (b & 0x80)) != 0) {
+      crc = (uint16_t) ((crc << 1) ^ wc::CRC16_EN_13757_POLY);
+    } else {
+      crc = (uint16_t) (crc << 1);
+    }
+    b <<= 1;
+  }
+  return crc;
+}
+
+static uint16_t crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0x0000;
+  for (size_t i = 0; i < len; i++) crc = crc16_per_byte(crc, data[i]);
+  return (uint16_t) (~crc);
+}
+
+static bool trim_a(std::vector<uint8_t> &payload) {
+  if (payload.size() < 12) return false;
+  const size_t len = payload.size();
+  std::vector<uint8_t> out;
+  if (crc16(payload.data(), 10) != (uint16_t) (payload[10] << 8 | payload[11])) return false;
+  out.insert(out.end(), payload.begin(), payload.begin() + 10);
+  size_t pos = 12;
+  for (; pos + 18 <= len; pos += 18) {
+    if (crc16(payload.data() + pos, 16) != (uint16_t) (payload[pos + 16] << 8 | payload[pos + 17])) return false;
+    out.insert(out.end(), payload.begin() + pos, payload.begin() + pos + 16);
+  }
+  if (pos < len - 2) {
+    if (crc16(payload.data() + pos, len - 2 - pos) != (uint16_t) (payload[len - 2] << 8 | payload[len - 1]))
+      return false;
+    out.insert(out.end(), payload.begin() + pos, payload.begin() + (len - 2));
+  }
+  out[0] = (uint8_t) (out.size() - 1);
+  payload = std::move(out);
+  return true;
+}
+
+static bool trim_b(std::vector<uint8_t> &payload) {
+  if (payload.size() < 12) return false;
+  const size_t len = payload.size();
+  if (len == 129) return false;  // over-read in the original; rejected by the current code
+  std::vector<uint8_t> out;
+  const size_t crc1_pos = len <= 128 ? len - 2 : 126;
+  const size_t crc2_pos = len <= 128 ? 0 : len - 2;
+  if (crc16(payload.data(), crc1_pos) != (uint16_t) (payload[crc1_pos] << 8 | payload[crc1_pos + 1])) return false;
+  out.insert(out.end(), payload.begin(), payload.begin() + crc1_pos);
+  if (crc2_pos > 0) {
+    const size_t start = crc1_pos + 2;
+    if (crc16(payload.data() + start, crc2_pos - start) != (uint16_t) (payload[crc2_pos] << 8 | payload[crc2_pos + 1]))
+      return false;
+    out.insert(out.end(), payload.begin() + start, payload.begin() + crc2_pos);
+  }
+  out[0] = (uint8_t) (out.size() - 1);
+  payload = std::move(out);
+  return true;
+}
+
+}  // namespace legacy
+
+namespace {
+
+struct Lcg {
+  uint32_t state;
+  uint32_t next() {
+    this->state = this->state * 1664525U + 1013904223U;
+    return this->state >> 8;
+  }
+};
+
+void append_crc(std::vector<uint8_t> &v, size_t from) {
+  const uint16_t crc = legacy::crc16(v.data() + from, v.size() - from);
+  v.push_back((uint8_t) (crc >> 8));
+  v.push_back((uint8_t) (crc & 0xFF));
+}
+
+// Telegram of `total` bytes (L-field included) framed as format A.
+std::vector<uint8_t> make_format_a(Lcg &rng, size_t total) {
+  std::vector<uint8_t> t(total);
+  for (auto &b : t) b = (uint8_t) rng.next();
+  t[0] = (uint8_t) (total - 1);
+  std::vector<uint8_t> out(t.begin(), t.begin() + 10);
+  append_crc(out, 0);
+  for (size_t pos = 10; pos < total; pos += 16) {
+    const size_t n = std::min<size_t>(16, total - pos);
+    const size_t from = out.size();
+    out.insert(out.end(), t.begin() + pos, t.begin() + pos + n);
+    append_crc(out, from);
+  }
+  return out;
+}
+
+std::vector<uint8_t> make_format_b(Lcg &rng, size_t total) {
+  std::vector<uint8_t> t(total);
+  for (auto &b : t) b = (uint8_t) rng.next();
+  if (total + 2 <= 128) {
+    t[0] = (uint8_t) (total + 1);
+    append_crc(t, 0);
+    return t;
+  }
+  t[0] = (uint8_t) (total + 3);
+  std::vector<uint8_t> out(t.begin(), t.begin() + 126);
+  append_crc(out, 0);
+  const size_t from = out.size();
+  out.insert(out.end(), t.begin() + 126, t.end());
+  append_crc(out, from);
+  return out;
+}
+
+int cross_check() {
+  Lcg rng{7};
+  int mismatches = 0;
+  for (int i = 0; i < 20000; i++) {
+    const bool b = (i & 1) != 0;
+    const size_t total = 11 + rng.next() % 240;
+    auto frame = b ? make_format_b(rng, total) : make_format_a(rng, total);
+    if (rng.next() % 3 == 0) frame[rng.next() % frame.size()] ^= (uint8_t) (1U << (rng.next() % 8));
+    if (rng.next() % 5 == 0) frame.resize(frame.size() - rng.next() % 4);
+    auto ref = frame, now = frame;
+    const bool ok_ref = b ? legacy::trim_b(ref) : legacy::trim_a(ref);
+    const bool ok_now = b ? wc::trim_dll_crc_format_b(now) : wc::trim_dll_crc_format_a(now);
+    // On failure the new code must leave the buffer untouched (the caller
+    // may retry the other format on it); the old code did so by construction.
+    if (ok_ref != ok_now || ref != now) mismatches++;
+  }
+  return mismatches;
+}
+
+using Clock = std::chrono::steady_clock;
+
+struct Timing {
+  double ns_per_frame{0};
+  double allocs_per_frame{0};
+};
+
+template<typename Fn> Timing time_trim(const std::vector<std::vector<uint8_t>> &frames, Fn trim) {
+  std::vector<std::vector<uint8_t>> work(frames.size());
+  uint64_t ns = 0, ops = 0, sink = 0;
+  size_t allocs = 0;
+  while (ns < 300000000ULL) {
+    // Untimed: refill every slot. The previous implementation swaps in a
+    // right-sized vector, so restore capacity first to give both variants
+    // the same starting state (a Packet buffer that already holds the frame).
+    for (size_t i = 0; i < frames.size(); i++) {
+      work[i].reserve(256);
+      work[i].assign(frames[i].begin(), frames[i].end());
+    }
+    const size_t a0 = g_allocs;
+    const auto t0 = Clock::now();
+    for (auto &w : work) sink += trim(w) ? w.size() : 0;
+    ns += (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    allocs += g_allocs - a0;
+    ops += work.size();
+  }
+  if (sink == 0) std::puts("no frame passed the CRC check");
+  return {(double) ns / (double) ops, (double) allocs / (double) ops};
+}
+
+}  // namespace
+
+int main() {
+  const int mismatches = cross_check();
+  std::printf("cross-check vs previous implementation: %s (%d mismatches / 20000 frames)\n",
+              mismatches == 0 ? "OK" : "FAILED", mismatches);
+  if (mismatches != 0) return 1;
+
+  Lcg rng{1};
+  std::vector<std::vector<uint8_t>> a143, b143;
+  for (int i = 0; i < 512; i++) a143.push_back(make_format_a(rng, 143));
+  for (int i = 0; i < 512; i++) b143.push_back(make_format_b(rng, 143));
+
+  const Timing legacy_a = time_trim(a143, legacy::trim_a);
+  const Timing now_a = time_trim(a143, [](std::vector<uint8_t> &v) { return wc::trim_dll_crc_format_a(v); });
+  const Timing legacy_b = time_trim(b143, legacy::trim_b);
+  const Timing now_b = time_trim(b143, [](std::vector<uint8_t> &v) { return wc::trim_dll_crc_format_b(v); });
+
+  std::printf("\n%-36s %12s %14s\n", "143 B telegram", "ns/frame", "allocs/frame");
+  auto row = [](const char *name, const Timing &t) {
+    std::printf("%-36s %12.1f %14.2f\n", name, t.ns_per_frame, t.allocs_per_frame);
+  };
+  row("format A, previous", legacy_a);
+  row("format A, table + in-place", now_a);
+  row("format B, previous", legacy_b);
+  row("format B, table + in-place", now_b);
+  std::printf("\nspeedup: format A %.1fx, format B %.1fx\n", legacy_a.ns_per_frame / now_a.ns_per_frame,
+              legacy_b.ns_per_frame / now_b.ns_per_frame);
+
+  // The success path must not touch the heap.
+  return (now_a.allocs_per_frame == 0 && now_b.allocs_per_frame == 0) ? 0 : 1;
+}
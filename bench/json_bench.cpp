@@ -0,0 +1,632 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// JsonWriter (json_writer.h) against the payload builders it replaced.
+//
+// Three payloads, each built by a copy of the previous code and by the
+// JsonWriter version now in the component:
+//
+//   summary        one snprintf() with ~90 arguments into char[2560], plus the
+//                  char[48] busy_ether_state and char[384] telegram_batch
+//                  side buffers (diagnostics.cpp)
+//   dropped        the drop event with diag_publish_raw: the packet hex-encoded
+//                  into a std::string, then snprintf() into char[1280]
+//                  (component.cpp); JsonWriter::hex() writes it in place
+//   meter_snapshot std::string grown with += and std::to_string(), one
+//                  snprintf() into char[256] per meter (meter_stats.cpp)
+//
+// Both versions must produce byte-identical JSON before anything is timed.
+// The bench prints ns and MB/s of JSON per payload, heap allocations per
+// payload (global operator new hook) and, when given the -fstack-usage file
+// the Makefile produces (--su FILE), the stack frame of every builder.
+
+#include "json_writer.h"
+
+#include "esphome/core/helpers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace wr = esphome::wmbus_radio;
+
+static size_t g_allocs = 0;
+
+void *operator new(size_t n) {
+  g_allocs++;
+  if (void *p = std::malloc(n == 0 ? 1 : n)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Stand-in for mqtt->publish(): keeps the last payload for the cross-check.
+std::string g_last;
+bool g_keep = false;
+size_t g_bytes = 0;
+
+__attribute__((noinline)) void publish(const char *payload, size_t len) {
+  g_bytes += len;
+  if (g_keep) g_last.assign(payload, len);
+}
+
+struct Strings {
+  const char *listen_mode;
+  const char *hint_code;
+  const char *hint_en;
+  const char *hint_pl;
+  const char *busy_ether_state;
+};
+
+struct Meter {
+  char id[12];
+  const char *mode;
+  uint32_t count_window, count_total, avg_interval_s, win_avg_interval_s, win_interval_n;
+  int32_t last_rssi, win_avg_rssi;
+};
+
+struct Drop {
+  uint32_t uptime_ms;
+  const char *listen_mode, *reason, *stage, *detail, *mode;
+  int32_t rssi;
+  uint32_t want, got, raw_got, decoded_len, final_len, dll_crc_removed, suffix_ignored;
+  std::vector<uint8_t> raw;
+};
+
+// The component builds every payload in one buffer allocated in setup().
+std::vector<char> g_json_buf(3072);
+
+}  // namespace
+
+namespace legacy {
+
+__attribute__((noinline)) void summary(const uint32_t *v, const Strings &s) {
+  char payload[2560];
+  char busy_ether_field[48] = "";
+  snprintf(busy_ether_field, sizeof(busy_ether_field), ",\"busy_ether_state\":\"%s\"", s.busy_ether_state);
+  char telegram_batch_field[384] = "";
+  snprintf(payload, sizeof(payload),
+           "{"
+           "\"event\":\"summary\","
+           "\"interval_s\":%u,"
+           "\"uptime_ms\":%lu,"
+           "\"listen_mode\":\"%s\","
+           "\"total\":%u,"
+           "\"ok\":%u,"
+           "\"truncated\":%u,"
+           "\"dropped\":%u,"
+           "\"crc_failed\":%u,"
+           "\"crc_fail_pct\":%u,"
+           "\"drop_pct\":%u,"
+           "\"trunc_pct\":%u,"
+           "\"avg_ok_rssi\":%d,"
+           "\"avg_drop_rssi\":%d,"
+           "\"t1\":{"
+           "\"total\":%u,"
+           "\"ok\":%u,"
+           "\"dropped\":%u,"
+           "\"per_pct\":%u,"
+           "\"crc_failed\":%u,"
+           "\"crc_pct\":%u,"
+           "\"avg_ok_rssi\":%d,"
+           "\"avg_drop_rssi\":%d,"
+           "\"sym_total\":%u,"
+           "\"sym_invalid\":%u,"
+           "\"sym_invalid_pct\":%u"
+           "},"
+           "\"c1\":{"
+           "\"total\":%u,"
+           "\"ok\":%u,"
+           "\"dropped\":%u,"
+           "\"per_pct\":%u,"
+           "\"crc_failed\":%u,"
+           "\"crc_pct\":%u,"
+           "\"avg_ok_rssi\":%d,"
+           "\"avg_drop_rssi\":%d"
+           "},"
+           "\"dropped_by_reason\":{"
+           "\"too_short\":%u,"
+           "\"decode_failed\":%u,"
+           "\"dll_crc_failed\":%u,"
+           "\"unknown_preamble\":%u,"
+           "\"l_field_invalid\":%u,"
+           "\"unknown_link_mode\":%u,"
+           "\"other\":%u"
+           "},"
+           "\"dropped_by_stage\":{"
+           "\"precheck\":%u,"
+           "\"t1_decode3of6\":%u,"
+           "\"t1_l_field\":%u,"
+           "\"t1_length_check\":%u,"
+           "\"c1_precheck\":%u,"
+           "\"c1_preamble\":%u,"
+           "\"c1_suffix\":%u,"
+           "\"c1_l_field\":%u,"
+           "\"c1_length_check\":%u,"
+           "\"dll_crc_first\":%u,"
+           "\"dll_crc_mid\":%u,"
+           "\"dll_crc_final\":%u,"
+           "\"dll_crc_b1\":%u,"
+           "\"dll_crc_b2\":%u,"
+           "\"link_mode\":%u,"
+           "\"other\":%u"
+           "},"
+           "\"rx_path\":{"
+           "\"irq_timeout\":%u,"
+           "\"preamble_read_failed\":%u,"
+           "\"preamble_retry_recovered\":%u,"
+           "\"t1_header_read_failed\":%u,"
+           "\"payload_size_unknown\":%u,"
+           "\"raw_drain_attempted\":%u,"
+           "\"raw_drain_recovered\":%u,"
+           "\"raw_drain_recovery_pct\":%u,"
+           "\"raw_drain_bytes\":%u,"
+           "\"payload_read_failed\":%u,"
+           "\"t1_symbol_abort\":%u,"
+           "\"queue_send_failed\":%u,"
+           "\"pool_exhausted\":%u,"
+           "\"fifo_overrun\":%u,"
+           "\"weak_start_aborted\":%u,"
+           "\"probe_start_aborted\":%u,"
+           "\"raw_drain_skipped_weak\":%u,"
+           "\"false_start_like\":%u,"
+           "\"probe_abort_rssi\":{\"gt70\":%u,\"70_79\":%u,\"80_89\":%u,\"90_99\":%u,\"lt100\":%u},"
+           "\"weak_abort_rssi\":{\"gt70\":%u,\"70_79\":%u,\"80_89\":%u,\"90_99\":%u,\"lt100\":%u},"
+           "\"events_lost\":%u"
+           "},"
+           "\"reasons_sum\":%u,"
+           "\"reasons_sum_mismatch\":%u,"
+           "\"hint_code\":\"%s\","
+           "\"hint_en\":\"%s\","
+           "\"hint_pl\":\"%s\""
+           "%s%s"
+           "}"
+           , (unsigned) v[0],
+           (unsigned long) v[1],
+           s.listen_mode,
+           (unsigned) v[2],
+           (unsigned) v[3],
+           (unsigned) v[4],
+           (unsigned) v[5],
+           (unsigned) v[6],
+           (unsigned) v[7],
+           (unsigned) v[8],
+           (unsigned) v[9],
+           (int) ((int32_t) -(int32_t) (v[10] % 120U)),
+           (int) ((int32_t) -(int32_t) (v[11] % 120U)),
+           (unsigned) v[12],
+           (unsigned) v[13],
+           (unsigned) v[14],
+           (unsigned) v[15],
+           (unsigned) v[16],
+           (unsigned) v[17],
+           (int) ((int32_t) -(int32_t) (v[18] % 120U)),
+           (int) ((int32_t) -(int32_t) (v[19] % 120U)),
+           (unsigned) v[20],
+           (unsigned) v[21],
+           (unsigned) v[22],
+           (unsigned) v[23],
+           (unsigned) v[24],
+           (unsigned) v[25],
+           (unsigned) v[26],
+           (unsigned) v[27],
+           (unsigned) v[28],
+           (int) ((int32_t) -(int32_t) (v[29] % 120U)),
+           (int) ((int32_t) -(int32_t) (v[30] % 120U)),
+           (unsigned) v[31],
+           (unsigned) v[32],
+           (unsigned) v[33],
+           (unsigned) v[34],
+           (unsigned) v[35],
+           (unsigned) v[36],
+           (unsigned) v[37],
+           (unsigned) v[38],
+           (unsigned) v[39],
+           (unsigned) v[40],
+           (unsigned) v[41],
+           (unsigned) v[42],
+           (unsigned) v[43],
+           (unsigned) v[44],
+           (unsigned) v[45],
+           (unsigned) v[46],
+           (unsigned) v[47],
+           (unsigned) v[48],
+           (unsigned) v[49],
+           (unsigned) v[50],
+           (unsigned) v[51],
+           (unsigned) v[52],
+           (unsigned) v[53],
+           (unsigned) v[54],
+           (unsigned) v[55],
+           (unsigned) v[56],
+           (unsigned) v[57],
+           (unsigned) v[58],
+           (unsigned) v[59],
+           (unsigned) v[60],
+           (unsigned) v[61],
+           (unsigned) v[62],
+           (unsigned) v[63],
+           (unsigned) v[64],
+           (unsigned) v[65],
+           (unsigned) v[66],
+           (unsigned) v[67],
+           (unsigned) v[68],
+           (unsigned) v[69],
+           (unsigned) v[70],
+           (unsigned) v[71],
+           (unsigned) v[72],
+           (unsigned) v[73],
+           (unsigned) v[74],
+           (unsigned) v[75],
+           (unsigned) v[76],
+           (unsigned) v[77],
+           (unsigned) v[78],
+           (unsigned) v[79],
+           (unsigned) v[80],
+           (unsigned) v[81],
+           (unsigned) v[82],
+           (unsigned) v[83],
+           (unsigned) v[84],
+           s.hint_code,
+           s.hint_en,
+           s.hint_pl,
+           busy_ether_field,
+           telegram_batch_field);
+  publish(payload, strlen(payload));
+}
+
+__attribute__((noinline)) void dropped(const Drop &d) {
+  char payload[1280];
+  snprintf(payload, sizeof(payload),
+           "{\"event\":\"dropped\",\"uptime_ms\":%lu,\"listen_mode\":\"%s\",\"reason\":\"%s\",\"stage\":\"%s\",\"detail\":\"%s\",\"mode\":\"%s\",\"rssi\":%d,\"want\":%u,\"got\":%u,\"raw_got\":%u,\"decoded_len\":%u,\"final_len\":%u,\"dll_crc_removed\":%u,\"suffix_ignored\":%u,\"raw\":\"%s\"}",
+           (unsigned long) d.uptime_ms, d.listen_mode, d.reason, d.stage, d.detail, d.mode, (int) d.rssi,
+           (unsigned) d.want, (unsigned) d.got, (unsigned) d.raw_got, (unsigned) d.decoded_len,
+           (unsigned) d.final_len, (unsigned) d.dll_crc_removed, (unsigned) d.suffix_ignored,
+           esphome::format_hex(d.raw).c_str());
+  publish(payload, strlen(payload));
+}
+
+__attribute__((noinline)) void meter_snapshot(const std::vector<Meter> &meters, uint32_t now_ms, uint32_t elapsed_s) {
+  std::string batch = "{";
+  batch += "\"event\":\"meter_snapshot\",";
+  batch += "\"trigger\":\"";
+  batch += "summary_15min";
+  batch += "\",";
+  batch += "\"uptime_ms\":";
+  batch += std::to_string(now_ms);
+  batch += ",\"listen_mode\":\"";
+  batch += "t1_c1";
+  batch += "\",\"elapsed_s\":";
+  batch += std::to_string(elapsed_s);
+  batch += ",\"meters\":[";
+  bool first = true;
+  for (const auto &m : meters) {
+    char entry[256];
+    snprintf(entry, sizeof(entry),
+             "%s{"
+             "\"id\":\"%s\","
+             "\"mode\":\"%s\","
+             "\"count_window\":%u,"
+             "\"count_total\":%u,"
+             "\"avg_interval_s\":%u,"
+             "\"win_avg_interval_s\":%u,"
+             "\"win_interval_n\":%u,"
+             "\"last_rssi\":%d,"
+             "\"win_avg_rssi\":%d"
+             "}",
+             first ? "" : ",", m.id, m.mode, (unsigned) m.count_window, (unsigned) m.count_total,
+             (unsigned) m.avg_interval_s, (unsigned) m.win_avg_interval_s, (unsigned) m.win_interval_n,
+             (int) m.last_rssi, (int) m.win_avg_rssi);
+    batch += entry;
+    first = false;
+  }
+  batch += "]}";
+  publish(batch.data(), batch.size());
+}
+
+}  // namespace legacy
+
+namespace writer {
+
+__attribute__((noinline)) void summary(const uint32_t *v, const Strings &s) {
+  wr::JsonWriter w(g_json_buf.data(), g_json_buf.size());
+  w.begin_object()
+      .str("event", "summary")
+      .u32("interval_s", v[0])
+      .u32("uptime_ms", v[1])
+      .str("listen_mode", s.listen_mode)
+      .u32("total", v[2])
+      .u32("ok", v[3])
+      .u32("truncated", v[4])
+      .u32("dropped", v[5])
+      .u32("crc_failed", v[6])
+      .u32("crc_fail_pct", v[7])
+      .u32("drop_pct", v[8])
+      .u32("trunc_pct", v[9])
+      .i32("avg_ok_rssi", (int32_t) -(int32_t) (v[10] % 120U))
+      .i32("avg_drop_rssi", (int32_t) -(int32_t) (v[11] % 120U));
+  w.begin_object("t1")
+      .u32("total", v[12])
+      .u32("ok", v[13])
+      .u32("dropped", v[14])
+      .u32("per_pct", v[15])
+      .u32("crc_failed", v[16])
+      .u32("crc_pct", v[17])
+      .i32("avg_ok_rssi", (int32_t) -(int32_t) (v[18] % 120U))
+      .i32("avg_drop_rssi", (int32_t) -(int32_t) (v[19] % 120U))
+      .u32("sym_total", v[20])
+      .u32("sym_invalid", v[21])
+      .u32("sym_invalid_pct", v[22])
+      .end_object();
+  w.begin_object("c1")
+      .u32("total", v[23])
+      .u32("ok", v[24])
+      .u32("dropped", v[25])
+      .u32("per_pct", v[26])
+      .u32("crc_failed", v[27])
+      .u32("crc_pct", v[28])
+      .i32("avg_ok_rssi", (int32_t) -(int32_t) (v[29] % 120U))
+      .i32("avg_drop_rssi", (int32_t) -(int32_t) (v[30] % 120U))
+      .end_object();
+  w.begin_object("dropped_by_reason")
+      .u32("too_short", v[31])
+      .u32("decode_failed", v[32])
+      .u32("dll_crc_failed", v[33])
+      .u32("unknown_preamble", v[34])
+      .u32("l_field_invalid", v[35])
+      .u32("unknown_link_mode", v[36])
+      .u32("other", v[37])
+      .end_object();
+  w.begin_object("dropped_by_stage")
+      .u32("precheck", v[38])
+      .u32("t1_decode3of6", v[39])
+      .u32("t1_l_field", v[40])
+      .u32("t1_length_check", v[41])
+      .u32("c1_precheck", v[42])
+      .u32("c1_preamble", v[43])
+      .u32("c1_suffix", v[44])
+      .u32("c1_l_field", v[45])
+      .u32("c1_length_check", v[46])
+      .u32("dll_crc_first", v[47])
+      .u32("dll_crc_mid", v[48])
+      .u32("dll_crc_final", v[49])
+      .u32("dll_crc_b1", v[50])
+      .u32("dll_crc_b2", v[51])
+      .u32("link_mode", v[52])
+      .u32("other", v[53])
+      .end_object();
+  w.begin_object("rx_path")
+      .u32("irq_timeout", v[54])
+      .u32("preamble_read_failed", v[55])
+      .u32("preamble_retry_recovered", v[56])
+      .u32("t1_header_read_failed", v[57])
+      .u32("payload_size_unknown", v[58])
+      .u32("raw_drain_attempted", v[59])
+      .u32("raw_drain_recovered", v[60])
+      .u32("raw_drain_recovery_pct", v[61])
+      .u32("raw_drain_bytes", v[62])
+      .u32("payload_read_failed", v[63])
+      .u32("t1_symbol_abort", v[64])
+      .u32("queue_send_failed", v[65])
+      .u32("pool_exhausted", v[66])
+      .u32("fifo_overrun", v[67])
+      .u32("weak_start_aborted", v[68])
+      .u32("probe_start_aborted", v[69])
+      .u32("raw_drain_skipped_weak", v[70])
+      .u32("false_start_like", v[71])
+      .begin_object("probe_abort_rssi")
+      .u32("gt70", v[72])
+      .u32("70_79", v[73])
+      .u32("80_89", v[74])
+      .u32("90_99", v[75])
+      .u32("lt100", v[76])
+      .end_object()
+      .begin_object("weak_abort_rssi")
+      .u32("gt70", v[77])
+      .u32("70_79", v[78])
+      .u32("80_89", v[79])
+      .u32("90_99", v[80])
+      .u32("lt100", v[81])
+      .end_object()
+      .u32("events_lost", v[82])
+      .end_object();
+  w
+      .u32("reasons_sum", v[83])
+      .u32("reasons_sum_mismatch", v[84])
+      .str("hint_code", s.hint_code)
+      .str("hint_en", s.hint_en)
+      .str("hint_pl", s.hint_pl);
+  w.str("busy_ether_state", s.busy_ether_state);
+  w.end_object();
+  if (!w.truncated()) publish(w.c_str(), w.size());
+}
+
+__attribute__((noinline)) void dropped(const Drop &d) {
+  wr::JsonWriter w(g_json_buf.data(), g_json_buf.size());
+  w.begin_object()
+      .str("event", "dropped")
+      .u32("uptime_ms", d.uptime_ms)
+      .str("listen_mode", d.listen_mode)
+      .str("reason", d.reason)
+      .str("stage", d.stage)
+      .str("detail", d.detail)
+      .str("mode", d.mode)
+      .i32("rssi", d.rssi)
+      .u32("want", d.want)
+      .u32("got", d.got)
+      .u32("raw_got", d.raw_got)
+      .u32("decoded_len", d.decoded_len)
+      .u32("final_len", d.final_len)
+      .u32("dll_crc_removed", d.dll_crc_removed)
+      .u32("suffix_ignored", d.suffix_ignored)
+      .hex("raw", d.raw.data(), d.raw.size())
+      .end_object();
+  if (!w.truncated()) publish(w.c_str(), w.size());
+}
+
+__attribute__((noinline)) void meter_snapshot(const std::vector<Meter> &meters, uint32_t now_ms, uint32_t elapsed_s) {
+  wr::JsonWriter w(g_json_buf.data(), g_json_buf.size());
+  w.begin_object()
+      .str("event", "meter_snapshot")
+      .str("trigger", "summary_15min")
+      .u32("uptime_ms", now_ms)
+      .str("listen_mode", "t1_c1")
+      .u32("elapsed_s", elapsed_s)
+      .begin_array("meters");
+  for (const auto &m : meters) {
+    w.begin_object()
+        .str("id", m.id)
+        .str("mode", m.mode)
+        .u32("count_window", m.count_window)
+        .u32("count_total", m.count_total)
+        .u32("avg_interval_s", m.avg_interval_s)
+        .u32("win_avg_interval_s", m.win_avg_interval_s)
+        .u32("win_interval_n", m.win_interval_n)
+        .i32("last_rssi", m.last_rssi)
+        .i32("win_avg_rssi", m.win_avg_rssi)
+        .end_object();
+  }
+  w.end_array().end_object();
+  if (!w.truncated()) publish(w.c_str(), w.size());
+}
+
+}  // namespace writer
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Timing {
+  double ns{0};
+  double mb_s{0};
+  double allocs{0};
+};
+
+template<typename F> Timing time_it(int min_ms, F &&f) {
+  uint64_t ns = 0, calls = 0;
+  size_t allocs = 0;
+  g_bytes = 0;
+  while (ns < (uint64_t) min_ms * 1000000ULL) {
+    const size_t a0 = g_allocs;
+    const auto t0 = Clock::now();
+    for (int i = 0; i < 256; i++) f(i);
+    ns += (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    allocs += g_allocs - a0;
+    calls += 256;
+  }
+  return {(double) ns / (double) calls, (double) g_bytes / ((double) ns / 1e9) / 1e6, (double) allocs / (double) calls};
+}
+
+// "json_bench.cpp:86:32:void legacy::summary(...)\t3744\tdynamic,bounded" -> 3744
+long stack_of(const std::string &su_file, const char *fn) {
+  std::ifstream in(su_file);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.find(fn) == std::string::npos) continue;
+    const size_t tab = line.find('\t');
+    if (tab != std::string::npos) return std::strtol(line.c_str() + tab + 1, nullptr, 10);
+  }
+  return -1;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int min_ms = 300;
+  std::string su_file;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) min_ms = std::atoi(argv[++i]);
+    if (std::strcmp(argv[i], "--su") == 0 && i + 1 < argc) su_file = argv[++i];
+  }
+
+  uint32_t v[85];
+  for (size_t i = 0; i < sizeof(v) / sizeof(v[0]); i++) v[i] = (uint32_t) ((i * 2654435761U) % 100000U);
+  const Strings s{"t1_c1", "BUSY_ETHER_WEAK_TRASH",
+                  "many dropped packets are far weaker than valid ones; the receiver likely hears lots of distant "
+                  "or overlapping neighbor meters.",
+                  "wiele odrzuconych ramek jest dużo słabszych niż poprawne; odbiornik prawdopodobnie słyszy dużo "
+                  "dalekich lub nakładających się liczników sąsiadów.",
+                  "adaptive_passive"};
+
+  Drop d{123456789, "t1_c1", "dll_crc_failed", "dll_crc_mid", "l_field=126 decoded_len=129 block=3", "T1", -97,
+         195, 195, 293, 129, 0, 0, 0, std::vector<uint8_t>(293)};
+  for (size_t i = 0; i < d.raw.size(); i++) d.raw[i] = (uint8_t) (i * 151 + 7);
+
+  std::vector<Meter> meters;
+  for (uint32_t i = 0; i < 8; i++) {
+    Meter m{};
+    snprintf(m.id, sizeof(m.id), "%08u", 12345678U + i * 1111U);
+    m.mode = (i & 1) ? "C1" : "T1";
+    m.count_window = 40 + i;
+    m.count_total = 100000 + i * 313;
+    m.avg_interval_s = 16;
+    m.win_avg_interval_s = 17;
+    m.win_interval_n = 39 + i;
+    m.last_rssi = -60 - (int32_t) i * 4;
+    m.win_avg_rssi = -62 - (int32_t) i * 4;
+    meters.push_back(m);
+  }
+
+  struct Case {
+    const char *name;
+    void (*legacy_fn)();
+    void (*writer_fn)();
+    const char *legacy_sym;
+    const char *writer_sym;
+  };
+  static const uint32_t *pv;
+  static const Strings *ps;
+  static const Drop *pd;
+  static const std::vector<Meter> *pm;
+  pv = v;
+  ps = &s;
+  pd = &d;
+  pm = &meters;
+  const Case cases[] = {
+      {"summary", [] { legacy::summary(pv, *ps); }, [] { writer::summary(pv, *ps); }, "legacy::summary",
+       "writer::summary"},
+      {"dropped + raw", [] { legacy::dropped(*pd); }, [] { writer::dropped(*pd); }, "legacy::dropped",
+       "writer::dropped"},
+      {"meter_snapshot x8", [] { legacy::meter_snapshot(*pm, 123456789U, 900U); },
+       [] { writer::meter_snapshot(*pm, 123456789U, 900U); }, "legacy::meter_snapshot", "writer::meter_snapshot"},
+  };
+
+  int mismatches = 0;
+  g_keep = true;
+  for (const auto &c : cases) {
+    c.legacy_fn();
+    const std::string a = g_last;
+    g_last.clear();
+    c.writer_fn();
+    if (a != g_last || a.empty()) {
+      mismatches++;
+      std::printf("%s differs:\n  legacy: %s\n  writer: %s\n", c.name, a.c_str(), g_last.c_str());
+    }
+  }
+  g_keep = false;
+  std::printf("cross-check vs previous builders: %s (%d mismatches / %zu payloads)\n",
+              mismatches == 0 ? "OK" : "FAILED", mismatches, sizeof(cases) / sizeof(cases[0]));
+  if (mismatches != 0) return 1;
+
+  std::printf("\n%-18s %10s %8s %7s %7s   %10s %8s %7s %7s\n", "payload", "prev ns", "MB/s", "allocs", "stack",
+              "writer ns", "MB/s", "allocs", "stack");
+  for (const auto &c : cases) {
+    const Timing a = time_it(min_ms, [&](int) { c.legacy_fn(); });
+    const Timing b = time_it(min_ms, [&](int) { c.writer_fn(); });
+    const long sa = su_file.empty() ? -1 : stack_of(su_file, c.legacy_sym);
+    const long sb = su_file.empty() ? -1 : stack_of(su_file, c.writer_sym);
+    std::printf("%-18s %10.1f %8.1f %7.1f %7ld   %10.1f %8.1f %7.1f %7ld\n", c.name, a.ns, a.mb_s, a.allocs, sa, b.ns,
+                b.mb_s, b.allocs, sb);
+  }
+  if (su_file.empty())
+    std::printf("(stack: pass --su <-fstack-usage file>, see Makefile)\n");
+  else
+    std::printf("(stack: own frame in bytes, snprintf()/JsonWriter callees not included)\n");
+  return 0;
+}
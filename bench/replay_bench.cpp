@@ -0,0 +1,631 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// Host-side replay benchmark for the Packet::convert_to_frame() pipeline.
+//
+// Links the real parser translation units (packet.cpp, decode3of6.cpp)
+// against the thin stubs in bench/stubs and replays a corpus of raw captures
+// through them, so a parser change can be judged in seconds on a workstation
+// instead of a day of field logging.
+//
+// Input: one capture per line, in the `wmbus_bridge/raw` JSON format that
+// Radio::maybe_publish_radio_raw_() publishes (publish_radio_raw: true). A
+// leading topic as written by `mosquitto_sub -v` is skipped, and bare hex
+// lines are accepted as T1/C1 captures. Without a corpus file a deterministic
+// synthetic corpus (T1 + C1 format A/B, with CRC errors, symbol errors,
+// truncation and noise mixed in) is generated so runs are comparable anywhere.
+//
+// Reported: frames/s through convert_to_frame(), ns per stage (3-of-6 decode,
+// L-field probe via expected_size(), DLL CRC strip, convert_to_frame() split
+// by primary / fallback / both-failed outcome, and S1 raw-drain parsing) and
+// yield per link mode.
+
+#include "packet.h"
+#include "decode3of6.h"
+#include "dll_crc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace esphome::wmbus_radio;
+namespace wc = esphome::wmbus_common;
+
+namespace {
+
+struct Capture {
+  LinkMode mode{LinkMode::UNKNOWN};  // as tagged by the bridge (preliminary mode)
+  int8_t rssi{0};
+  std::vector<uint8_t> raw;
+};
+
+// ---------------------------------------------------------------------------
+// Corpus loading
+// ---------------------------------------------------------------------------
+
+static int hex_nibble_(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static bool parse_hex_(const char *s, size_t n, std::vector<uint8_t> &out) {
+  out.clear();
+  if (n % 2 != 0) return false;
+  out.reserve(n / 2);
+  for (size_t i = 0; i < n; i += 2) {
+    const int hi = hex_nibble_(s[i]);
+    const int lo = hex_nibble_(s[i + 1]);
+    if (hi < 0 || lo < 0) return false;
+    out.push_back((uint8_t) ((hi << 4) | lo));
+  }
+  return true;
+}
+
+// Value of a "key":"value" string field, or empty when absent.
+static std::string json_string_field_(const std::string &line, const char *key) {
+  const std::string needle = std::string("\"") + key + "\":\"";
+  const size_t pos = line.find(needle);
+  if (pos == std::string::npos) return {};
+  const size_t start = pos + needle.size();
+  const size_t end = line.find('"', start);
+  if (end == std::string::npos) return {};
+  return line.substr(start, end - start);
+}
+
+static bool json_int_field_(const std::string &line, const char *key, long &out) {
+  const std::string needle = std::string("\"") + key + "\":";
+  const size_t pos = line.find(needle);
+  if (pos == std::string::npos) return false;
+  char *endp = nullptr;
+  const char *s = line.c_str() + pos + needle.size();
+  out = std::strtol(s, &endp, 10);
+  return endp != s;
+}
+
+static LinkMode link_mode_from_name_(const std::string &name) {
+  if (name == "T1") return LinkMode::T1;
+  if (name == "C1") return LinkMode::C1;
+  if (name == "S1") return LinkMode::S1;
+  return LinkMode::UNKNOWN;
+}
+
+static size_t load_corpus_(const char *path, std::vector<Capture> &out) {
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "cannot open corpus file: %s\n", path);
+    std::exit(2);
+  }
+  size_t loaded = 0, skipped = 0;
+  std::string line;
+  while (std::getline(in, line)) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+
+    Capture cap;
+    const size_t brace = line.find('{');
+    if (brace != std::string::npos) {
+      const std::string json = line.substr(brace);
+      const std::string raw = json_string_field_(json, "raw");
+      if (raw.empty() || !parse_hex_(raw.data(), raw.size(), cap.raw)) {
+        skipped++;
+        continue;
+      }
+      cap.mode = link_mode_from_name_(json_string_field_(json, "mode"));
+      long rssi = 0;
+      if (json_int_field_(json, "rssi", rssi)) cap.rssi = (int8_t) rssi;
+    } else if (!parse_hex_(line.data(), line.size(), cap.raw)) {
+      skipped++;
+      continue;
+    }
+    if (cap.raw.empty()) {
+      skipped++;
+      continue;
+    }
+    // Same preliminary tagging as the receive path: C1 preamble or T1.
+    if (cap.mode == LinkMode::UNKNOWN) cap.mode = (cap.raw[0] == 0x54) ? LinkMode::C1 : LinkMode::T1;
+    out.push_back(std::move(cap));
+    loaded++;
+  }
+  if (skipped > 0) std::fprintf(stderr, "%s: skipped %zu unparsable line(s)\n", path, skipped);
+  return loaded;
+}
+
+// ---------------------------------------------------------------------------
+// Synthetic corpus
+// ---------------------------------------------------------------------------
+
+struct Lcg {
+  uint32_t state;
+  uint32_t next() {
+    this->state = this->state * 1664525U + 1013904223U;
+    return this->state >> 8;
+  }
+  uint32_t below(uint32_t n) { return this->next() % n; }
+};
+
+// nibble -> 6-bit 3-of-6 code (EN 13757-4), inverse of LOOKUP_3OF6.
+static const uint8_t ENCODE_3OF6[16] = {0x16, 0x0D, 0x0E, 0x0B, 0x1C, 0x19, 0x1A, 0x13,
+                                        0x2C, 0x25, 0x26, 0x23, 0x34, 0x31, 0x32, 0x29};
+
+static std::vector<uint8_t> encode3of6_(const std::vector<uint8_t> &in) {
+  std::vector<uint8_t> out;
+  out.reserve(encoded_size(in.size()));
+  uint32_t acc = 0;
+  int bits = 0;
+  for (uint8_t b : in) {
+    for (int shift = 4; shift >= 0; shift -= 4) {
+      acc = (acc << 6) | ENCODE_3OF6[(b >> shift) & 0x0F];
+      bits += 6;
+      while (bits >= 8) {
+        out.push_back((uint8_t) (acc >> (bits - 8)));
+        bits -= 8;
+      }
+    }
+  }
+  if (bits > 0) out.push_back((uint8_t) (acc << (8 - bits)));
+  return out;
+}
+
+static void append_crc_(std::vector<uint8_t> &out, size_t from) {
+  const uint16_t crc = wc::crc16_en13757(out.data() + from, out.size() - from);
+  out.push_back((uint8_t) (crc >> 8));
+  out.push_back((uint8_t) (crc & 0xFF));
+}
+
+// telegram = L C M M A A A A V T CI ..., L = telegram.size() - 1.
+static std::vector<uint8_t> make_telegram_(Lcg &rng, size_t total_len) {
+  std::vector<uint8_t> t(total_len);
+  t[0] = (uint8_t) (total_len - 1);
+  t[1] = 0x44;
+  const uint16_t mfr = (uint16_t) ((((rng.below(26) + 1) << 10) | ((rng.below(26) + 1) << 5) | (rng.below(26) + 1)));
+  t[2] = (uint8_t) (mfr & 0xFF);
+  t[3] = (uint8_t) (mfr >> 8);
+  for (int i = 4; i < 8; i++) t[i] = (uint8_t) ((rng.below(10) << 4) | rng.below(10));
+  if (t[7] == 0) t[7] = 0x12;  // keep the id non-zero
+  t[8] = (uint8_t) rng.below(256);
+  t[9] = (uint8_t) (rng.below(2) ? 0x07 : 0x16);
+  t[10] = 0x7A;
+  for (size_t i = 11; i < total_len; i++) t[i] = (uint8_t) rng.below(256);
+  return t;
+}
+
+static std::vector<uint8_t> frame_format_a_(const std::vector<uint8_t> &t) {
+  std::vector<uint8_t> out;
+  out.reserve(t.size() + 2 * (t.size() / 16 + 2));
+  out.insert(out.end(), t.begin(), t.begin() + 10);
+  append_crc_(out, 0);
+  for (size_t pos = 10; pos < t.size(); pos += 16) {
+    const size_t n = std::min<size_t>(16, t.size() - pos);
+    const size_t from = out.size();
+    out.insert(out.end(), t.begin() + pos, t.begin() + pos + n);
+    append_crc_(out, from);
+  }
+  return out;
+}
+
+static std::vector<uint8_t> frame_format_b_(std::vector<uint8_t> t) {
+  // Format B: L counts every byte after itself, CRC bytes included.
+  const size_t content = t.size() - 1;
+  if (content + 3 <= 128) {
+    t[0] = (uint8_t) (content + 2);
+    append_crc_(t, 0);
+    return t;
+  }
+  t[0] = (uint8_t) (content + 4);
+  std::vector<uint8_t> out(t.begin(), t.begin() + 126);
+  append_crc_(out, 0);
+  const size_t from = out.size();
+  out.insert(out.end(), t.begin() + 126, t.end());
+  append_crc_(out, from);
+  return out;
+}
+
+static void synth_corpus_(uint32_t seed, size_t count, std::vector<Capture> &out) {
+  Lcg rng{seed};
+  // Decoded telegram sizes seen in the field notes (docs/BENCHMARKS.md).
+  static const size_t SIZES[] = {56, 77, 77, 77, 143, 31};
+  for (size_t i = 0; i < count; i++) {
+    Capture cap;
+    cap.rssi = (int8_t) (-60 - (int) rng.below(45));
+    const size_t size = SIZES[rng.below(sizeof(SIZES) / sizeof(SIZES[0]))];
+    const uint32_t kind = rng.below(100);
+    if (kind < 55) {  // T1, clean
+      cap.mode = LinkMode::T1;
+      cap.raw = encode3of6_(frame_format_a_(make_telegram_(rng, size)));
+    } else if (kind < 63) {  // T1, data bit error -> DLL CRC failure
+      cap.mode = LinkMode::T1;
+      auto framed = frame_format_a_(make_telegram_(rng, size));
+      framed[12 + rng.below((uint32_t) (framed.size() - 12))] ^= (uint8_t) (1U << rng.below(8));
+      cap.raw = encode3of6_(framed);
+    } else if (kind < 73) {  // T1, channel bit error -> invalid 3-of-6 symbol, C1 fallback fails too
+      cap.mode = LinkMode::T1;
+      cap.raw = encode3of6_(frame_format_a_(make_telegram_(rng, size)));
+      cap.raw[rng.below((uint32_t) cap.raw.size())] ^= (uint8_t) (1U << rng.below(8));
+    } else if (kind < 77) {  // T1, truncated tail
+      cap.mode = LinkMode::T1;
+      cap.raw = encode3of6_(frame_format_a_(make_telegram_(rng, size)));
+      cap.raw.resize(cap.raw.size() * 3 / 4);
+    } else if (kind < 83) {  // C1 format A
+      cap.mode = LinkMode::C1;
+      cap.raw = {0x54, 0xCD};
+      auto framed = frame_format_a_(make_telegram_(rng, size));
+      cap.raw.insert(cap.raw.end(), framed.begin(), framed.end());
+    } else if (kind < 85) {  // C1 format A, bit error in the C preamble -> T1 first, only the C1 fallback accepts it
+      cap.mode = LinkMode::C1;
+      cap.raw = {(uint8_t) (0x54 ^ (1U << rng.below(8))), 0xCD};
+      auto framed = frame_format_a_(make_telegram_(rng, size));
+      cap.raw.insert(cap.raw.end(), framed.begin(), framed.end());
+    } else if (kind < 93) {  // C1 format B
+      cap.mode = LinkMode::C1;
+      cap.raw = {0x54, 0x3D};
+      auto framed = frame_format_b_(make_telegram_(rng, size));
+      cap.raw.insert(cap.raw.end(), framed.begin(), framed.end());
+    } else if (kind < 97) {  // C1 format A, CRC failure
+      cap.mode = LinkMode::C1;
+      cap.raw = {0x54, 0xCD};
+      auto framed = frame_format_a_(make_telegram_(rng, size));
+      framed[3] ^= 0x10;
+      cap.raw.insert(cap.raw.end(), framed.begin(), framed.end());
+    } else {  // noise / false start
+      cap.mode = LinkMode::T1;
+      cap.raw.resize(20 + rng.below(40));
+      for (auto &b : cap.raw) b = (uint8_t) rng.below(256);
+      if (cap.raw[0] == 0x54) cap.raw[0] = 0x55;
+    }
+    out.push_back(std::move(cap));
+  }
+}
+
+// S1 Manchester, MSB first. polarity=false: 0 -> 01, 1 -> 10; true inverts.
+static std::vector<uint8_t> encode_manchester_(const std::vector<uint8_t> &in, bool polarity) {
+  std::vector<uint8_t> out;
+  out.reserve(in.size() * 2);
+  for (uint8_t b : in) {
+    uint16_t w = 0;
+    for (int bit = 7; bit >= 0; bit--) {
+      const bool one = ((b >> bit) & 1) != (polarity ? 1 : 0);
+      w = (uint16_t) ((w << 2) | (one ? 0x2 : 0x1));
+    }
+    out.push_back((uint8_t) (w >> 8));
+    out.push_back((uint8_t) (w & 0xFF));
+  }
+  return out;
+}
+
+// S1 arrives through the raw-drain path: a fixed 416-byte read that holds the
+// Manchester-coded frame followed by whatever the radio heard afterwards.
+static constexpr size_t S1_RAW_DRAIN_BYTES = 416;
+
+static void synth_s1_corpus_(uint32_t seed, size_t count, std::vector<Capture> &out) {
+  Lcg rng{seed ^ 0x5151U};
+  static const size_t SIZES[] = {31, 56, 77, 77};
+  for (size_t i = 0; i < count; i++) {
+    Capture cap;
+    cap.mode = LinkMode::S1;
+    cap.rssi = (int8_t) (-60 - (int) rng.below(45));
+    auto framed = frame_format_a_(make_telegram_(rng, SIZES[rng.below(sizeof(SIZES) / sizeof(SIZES[0]))]));
+    const uint32_t kind = rng.below(100);
+    if (kind >= 70 && kind < 85) framed[3 + rng.below((uint32_t) (framed.size() - 3))] ^= 0x04;  // CRC failure
+    cap.raw = encode_manchester_(framed, rng.below(2) != 0);
+    if (kind >= 85) cap.raw[rng.below(4)] ^= 0x80;  // broken symbol in the L-field
+    while (cap.raw.size() < S1_RAW_DRAIN_BYTES) cap.raw.push_back((uint8_t) rng.below(256));
+    cap.raw.resize(S1_RAW_DRAIN_BYTES);
+    out.push_back(std::move(cap));
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Timing
+// ---------------------------------------------------------------------------
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t elapsed_ns_(Clock::time_point since) {
+  return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+}
+
+// Keeps results observable so the optimizer cannot drop the measured work.
+static volatile uint64_t g_sink = 0;
+
+struct StageResult {
+  uint64_t ops{0};
+  uint64_t ns{0};
+  double ns_per_op() const { return this->ops == 0 ? 0.0 : (double) this->ns / (double) this->ops; }
+};
+
+// Runs `batch(begin, end)` over `inputs` in rounds until at least min_ms of
+// measured time is accumulated. `prepare(begin, end)` runs untimed before each
+// batch so per-op setup (fresh Packet objects, buffer copies) is excluded.
+template<typename T, typename Prepare, typename Batch>
+static StageResult run_stage_(const std::vector<T> &inputs, uint32_t min_ms, Prepare prepare, Batch batch) {
+  StageResult r;
+  if (inputs.empty()) return r;
+  static constexpr size_t CHUNK = 256;
+  const uint64_t min_ns = (uint64_t) min_ms * 1000000ULL;
+  while (r.ns < min_ns) {
+    for (size_t begin = 0; begin < inputs.size(); begin += CHUNK) {
+      const size_t end = std::min(inputs.size(), begin + CHUNK);
+      prepare(begin, end);
+      const auto t0 = Clock::now();
+      batch(begin, end);
+      r.ns += elapsed_ns_(t0);
+      r.ops += end - begin;
+    }
+  }
+  return r;
+}
+
+static void fill_packet_(Packet &p, const Capture &cap, size_t max_bytes) {
+  const size_t n = (max_bytes == 0) ? cap.raw.size() : std::min(max_bytes, cap.raw.size());
+  std::memcpy(p.append_space(n), cap.raw.data(), n);
+  p.set_rssi(cap.rssi);
+  if (cap.mode == LinkMode::S1) p.set_forced_link_mode(LinkMode::S1);
+}
+
+enum Outcome : uint8_t { OK_PRIMARY = 0, OK_FALLBACK, DROPPED, OUTCOME_COUNT };
+static const char *const OUTCOME_NAMES[OUTCOME_COUNT] = {
+    "ok, primary parser", "ok, fallback parser", "dropped (all parsers ran)"};
+
+struct ModeYield {
+  uint32_t total{0};
+  uint32_t ok{0};
+  uint32_t fallback{0};
+  uint32_t truncated{0};
+};
+
+// DLL CRC stage input: the decoded/suffix-stripped frame cut to its L-field
+// length, exactly what the parsers hand to trim_dll_crc_format_a/b.
+struct CrcInput {
+  bool format_b{false};
+  std::vector<uint8_t> data;
+};
+
+static bool crc_stage_input_(const Capture &cap, CrcInput &out) {
+  if (cap.mode == LinkMode::S1 || cap.raw.empty()) return false;
+  if (cap.raw[0] == 0x54) {
+    if (cap.raw.size() < 3 || (cap.raw[1] != 0xCD && cap.raw[1] != 0x3D)) return false;
+    out.format_b = cap.raw[1] == 0x3D;
+    out.data.assign(cap.raw.begin() + 2, cap.raw.end());
+  } else {
+    auto decoded = decode3of6(cap.raw);
+    if (!decoded || decoded->size() < 2) return false;
+    out.format_b = false;
+    out.data = std::move(*decoded);
+  }
+  const uint8_t l = out.data[0];
+  const size_t blocks = (l < 26) ? 2 : (size_t) ((l - 26) / 16 + 3);
+  const size_t need = out.format_b ? (size_t) l + 1 : (size_t) l + 1 + 2 * blocks;
+  if (l + 1 < 12 || out.data.size() < need) return false;
+  out.data.resize(need);
+  return true;
+}
+
+static void usage_(const char *argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--min-ms N] [--synth N] [--seed N] [--raw-hex] [corpus.jsonl ...]\n"
+               "  corpus lines: wmbus_bridge/raw JSON (mosquitto_sub -v prefix ok) or bare hex\n"
+               "  --min-ms N   measured time per stage, default 300\n"
+               "  --synth N    synthetic captures when no corpus is given, default 2000\n"
+               "  --seed N     synthetic corpus seed, default 1\n"
+               "  --raw-hex    keep Packet raw-hex capture on (diagnostic_publish_raw: true)\n",
+               argv0);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  uint32_t min_ms = 300;
+  size_t synth_count = 2000;
+  uint32_t seed = 1;
+  bool raw_hex = false;
+  std::vector<const char *> files;
+
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    if (std::strcmp(a, "--min-ms") == 0 && i + 1 < argc) {
+      min_ms = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(a, "--synth") == 0 && i + 1 < argc) {
+      synth_count = (size_t) std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(a, "--seed") == 0 && i + 1 < argc) {
+      seed = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(a, "--raw-hex") == 0) {
+      raw_hex = true;
+    } else if (a[0] == '-') {
+      usage_(argv[0]);
+      return 2;
+    } else {
+      files.push_back(a);
+    }
+  }
+
+  std::vector<Capture> corpus;
+  std::string source;
+  if (files.empty()) {
+    synth_corpus_(seed, synth_count, corpus);
+    source = "synthetic seed=" + std::to_string(seed);
+  } else {
+    for (const char *f : files) load_corpus_(f, corpus);
+    source = std::to_string(files.size()) + " file(s)";
+  }
+  if (corpus.empty()) {
+    std::fprintf(stderr, "corpus is empty\n");
+    return 2;
+  }
+
+  size_t raw_bytes = 0;
+  uint32_t by_mode[4] = {};
+  for (const auto &c : corpus) {
+    raw_bytes += c.raw.size();
+    by_mode[(uint8_t) c.mode & 0x03]++;
+  }
+
+  // One untimed classification pass: outcome class, yield and drop stages.
+  std::vector<Capture> by_outcome[OUTCOME_COUNT];
+  std::map<uint8_t, ModeYield> yield;
+  std::map<std::string, uint32_t> drop_stages;
+  for (const auto &cap : corpus) {
+    Packet p;
+    fill_packet_(p, cap, 0);
+    p.set_capture_raw_hex(raw_hex);
+    auto frame = p.convert_to_frame();
+    const bool fallback = p.fallback_used();
+    auto &y = yield[(uint8_t) p.get_link_mode()];
+    y.total++;
+    if (frame) {
+      y.ok++;
+      if (fallback) y.fallback++;
+      by_outcome[fallback ? OK_FALLBACK : OK_PRIMARY].push_back(cap);
+    } else {
+      if (p.is_truncated()) y.truncated++;
+      const char *stage = drop_stage_name(p.drop_stage());
+      drop_stages[stage[0] != '\0' ? stage : "(none)"]++;
+      by_outcome[DROPPED].push_back(cap);
+    }
+  }
+
+  std::vector<Capture> t1_raw;
+  std::vector<CrcInput> crc_inputs;
+  for (const auto &cap : corpus) {
+    if (cap.mode != LinkMode::S1 && cap.raw[0] != 0x54) t1_raw.push_back(cap);
+    CrcInput in;
+    if (crc_stage_input_(cap, in)) crc_inputs.push_back(std::move(in));
+  }
+
+  std::vector<Packet> packets;
+  packets.reserve(256);
+  auto prepare_packets = [&](const std::vector<Capture> &src, size_t max_bytes) {
+    return [&, max_bytes](size_t begin, size_t end) {
+      packets.clear();
+      for (size_t i = begin; i < end; i++) {
+        packets.emplace_back();
+        fill_packet_(packets.back(), src[i], max_bytes);
+        packets.back().set_capture_raw_hex(raw_hex);
+      }
+    };
+  };
+  auto convert_batch = [&](size_t begin, size_t end) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < end - begin; i++) {
+      auto frame = packets[i].convert_to_frame();
+      s += frame ? frame->data().size() : 1;
+    }
+    g_sink = g_sink + s;
+  };
+
+  const StageResult r_3of6 = run_stage_(
+      t1_raw, min_ms, [](size_t, size_t) {},
+      [&](size_t begin, size_t end) {
+        uint64_t s = 0;
+        for (size_t i = begin; i < end; i++) {
+          Decode3of6Stats st;
+          auto d = decode3of6(t1_raw[i].raw, &st);
+          s += d ? d->size() : st.symbols_invalid;
+        }
+        g_sink = g_sink + s;
+      });
+
+  // Mirrors receive_frame(): both modes compute the length from the first
+  // 3 raw bytes (T1 through the packet's streaming 3-of-6 decoder).
+  std::vector<Capture> probe_src;
+  for (const auto &cap : corpus)
+    if (cap.mode != LinkMode::S1) probe_src.push_back(cap);
+  std::vector<Capture> t1_probe, c1_probe;
+  for (const auto &cap : probe_src) (cap.raw[0] == 0x54 ? c1_probe : t1_probe).push_back(cap);
+  auto expected_size_batch = [&](size_t begin, size_t end) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < end - begin; i++) s += packets[i].expected_size();
+    g_sink = g_sink + s;
+  };
+  const StageResult r_lfield_t1 = run_stage_(t1_probe, min_ms, prepare_packets(t1_probe, 3), expected_size_batch);
+  const StageResult r_lfield_c1 = run_stage_(c1_probe, min_ms, prepare_packets(c1_probe, 3), expected_size_batch);
+
+  std::vector<std::vector<uint8_t>> crc_work;
+  const StageResult r_crc = run_stage_(
+      crc_inputs, min_ms,
+      [&](size_t begin, size_t end) {
+        crc_work.resize(end - begin);
+        for (size_t i = begin; i < end; i++) crc_work[i - begin] = crc_inputs[i].data;
+      },
+      [&](size_t begin, size_t end) {
+        uint64_t s = 0;
+        for (size_t i = begin; i < end; i++) {
+          auto &buf = crc_work[i - begin];
+          const bool ok = crc_inputs[i].format_b ? wc::trim_dll_crc_format_b(buf) : wc::trim_dll_crc_format_a(buf);
+          s += ok ? buf.size() : 1;
+        }
+        g_sink = g_sink + s;
+      });
+
+  // S1 is rare in captures but the most expensive parse (Manchester over the
+  // whole raw-drain buffer, both polarities), so it gets its own row; without
+  // S1 captures in the corpus a small synthetic set stands in.
+  std::vector<Capture> s1_src;
+  for (const auto &cap : corpus)
+    if (cap.mode == LinkMode::S1) s1_src.push_back(cap);
+  const bool s1_synthetic = s1_src.empty();
+  if (s1_synthetic) synth_s1_corpus_(seed, 256, s1_src);
+  const StageResult r_s1 = run_stage_(s1_src, min_ms, prepare_packets(s1_src, 0), convert_batch);
+
+  const StageResult r_all = run_stage_(corpus, min_ms, prepare_packets(corpus, 0), convert_batch);
+  StageResult r_outcome[OUTCOME_COUNT];
+  for (int o = 0; o < OUTCOME_COUNT; o++)
+    r_outcome[o] = run_stage_(by_outcome[o], min_ms, prepare_packets(by_outcome[o], 0), convert_batch);
+
+  std::printf("corpus: %zu captures from %s (T1 %u, C1 %u, S1 %u, other %u), %zu raw bytes, avg %.1f B\n",
+              corpus.size(), source.c_str(), by_mode[(uint8_t) LinkMode::T1], by_mode[(uint8_t) LinkMode::C1],
+              by_mode[(uint8_t) LinkMode::S1], by_mode[(uint8_t) LinkMode::UNKNOWN], raw_bytes,
+              (double) raw_bytes / (double) corpus.size());
+  std::printf("raw-hex capture: %s, min measured time per stage: %u ms\n\n", raw_hex ? "on" : "off",
+              (unsigned) min_ms);
+
+  std::printf("%-44s %10s %12s\n", "stage", "inputs", "ns/op");
+  auto row = [](const char *name, size_t inputs, const StageResult &r) {
+    std::printf("%-44s %10zu %12.1f\n", name, inputs, r.ns_per_op());
+  };
+  row("3-of-6 decode (T1 raw)", t1_raw.size(), r_3of6);
+  row("L-field probe, expected_size() T1 (3 B)", t1_probe.size(), r_lfield_t1);
+  row("L-field probe, expected_size() C1 (3 B)", c1_probe.size(), r_lfield_c1);
+  row("DLL CRC strip (format A/B)", crc_inputs.size(), r_crc);
+  for (int o = 0; o < OUTCOME_COUNT; o++) {
+    const std::string name = std::string("convert_to_frame, ") + OUTCOME_NAMES[o];
+    row(name.c_str(), by_outcome[o].size(), r_outcome[o]);
+  }
+  row(s1_synthetic ? "convert_to_frame, S1 raw drain (synthetic)" : "convert_to_frame, S1 captures", s1_src.size(),
+      r_s1);
+  row("convert_to_frame, whole corpus", corpus.size(), r_all);
+  const double fps = r_all.ns == 0 ? 0.0 : (double) r_all.ops * 1e9 / (double) r_all.ns;
+  std::printf("\nthroughput: %.0f frames/s (%.2f MB/s raw)\n\n", fps,
+              fps * ((double) raw_bytes / (double) corpus.size()) / 1e6);
+
+  std::printf("%-6s %8s %8s %9s %10s %8s\n", "mode", "total", "ok", "fallback", "truncated", "yield");
+  for (const auto &kv : yield) {
+    const auto &y = kv.second;
+    std::printf("%-6s %8u %8u %9u %10u %7.1f%%\n", link_mode_name((LinkMode) kv.first), y.total, y.ok, y.fallback,
+                y.truncated, y.total == 0 ? 0.0 : 100.0 * y.ok / y.total);
+  }
+
+  if (!drop_stages.empty()) {
+    std::printf("\ndropped by stage:\n");
+    for (const auto &kv : drop_stages) std::printf("  %-20s %8u\n", kv.first.c_str(), kv.second);
+  }
+
+  // The synthetic corpus is built to reach every outcome; an empty one means
+  // a parser path stopped being exercised (or stopped working).
+  if (files.empty()) {
+    bool missing = false;
+    for (int o = 0; o < OUTCOME_COUNT; o++) {
+      if (!by_outcome[o].empty()) continue;
+      std::fprintf(stderr, "synthetic corpus: no capture ended as \"%s\"\n", OUTCOME_NAMES[o]);
+      missing = true;
+    }
+    if (missing) return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+// Host-side stand-in for the ESPHome SPI device base. The bench radios never
+// touch the bus; this only has to make transceiver.h/.cpp compile.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esphome/core/component.h"
+#include "esphome/core/gpio.h"
+
+namespace esphome {
+namespace spi {
+
+enum SPIBitOrder { BIT_ORDER_LSB_FIRST, BIT_ORDER_MSB_FIRST };
+enum SPIClockPolarity { CLOCK_POLARITY_LOW, CLOCK_POLARITY_HIGH };
+enum SPIClockPhase { CLOCK_PHASE_LEADING, CLOCK_PHASE_TRAILING };
+enum SPIDataRate : uint32_t { DATA_RATE_2MHZ = 2000000 };
+
+class SPIDelegate {
+ public:
+  void begin_transaction() {}
+  void end_transaction() {}
+  uint8_t transfer(uint8_t data) { return data; }
+};
+
+template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, SPIDataRate DATA_RATE>
+class SPIDevice {
+ public:
+  void spi_setup() {}
+
+ protected:
+  SPIDelegate *delegate_{nullptr};
+};
+
+}  // namespace spi
+}  // namespace esphome
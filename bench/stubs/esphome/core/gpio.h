@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace gpio {
+enum InterruptType : uint8_t { INTERRUPT_RISING_EDGE = 1, INTERRUPT_FALLING_EDGE = 2, INTERRUPT_ANY_EDGE = 3 };
+}  // namespace gpio
+
+class InternalGPIOPin {
+ public:
+  void setup() {}
+  bool digital_read() { return false; }
+  void digital_write(bool) {}
+  template<typename T> void attach_interrupt(void (*)(T *), T *, gpio::InterruptType) const {}
+};
+
+}  // namespace esphome
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+// Host-side stand-in for the few esphome/core/helpers.h functions the parser
+// translation units use. Behaviour matches ESPHome (lowercase hex, no
+// separators) so Frame::as_hex() output is byte-identical to the firmware.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+inline std::string format_hex(const uint8_t *data, size_t length) {
+  static const char *hex = "0123456789abcdef";
+  std::string out;
+  out.resize(length * 2);
+  for (size_t i = 0; i < length; i++) {
+    out[2 * i] = hex[data[i] >> 4];
+    out[2 * i + 1] = hex[data[i] & 0x0F];
+  }
+  return out;
+}
+
+inline std::string format_hex(const std::vector<uint8_t> &data) { return format_hex(data.data(), data.size()); }
+
+}  // namespace esphome
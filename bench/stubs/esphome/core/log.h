@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+// Host-side stand-in for ESPHome's logger, used only by the bench/ targets.
+// Log calls compile to nothing, the same as a firmware build whose log level
+// is below the call site, so timings measure the parser and not stdout.
+// The arguments sit in an unevaluated sizeof(), so a variable that only
+// feeds a log line still counts as used.
+
+namespace esphome {
+template<typename... Args> inline int esp_log_discard(const char *, Args &&...) { return 0; }
+}  // namespace esphome
+
+#define ESP_LOG_DISCARD_(tag, ...) ((void) sizeof(::esphome::esp_log_discard(tag, ##__VA_ARGS__)))
+#define ESP_LOGE(tag, ...) ESP_LOG_DISCARD_(tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, ...) ESP_LOG_DISCARD_(tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, ...) ESP_LOG_DISCARD_(tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, ...) ESP_LOG_DISCARD_(tag, ##__VA_ARGS__)
+#define ESP_LOGV(tag, ...) ESP_LOG_DISCARD_(tag, ##__VA_ARGS__)
+#define ESP_LOGVV(tag, ...) ESP_LOG_DISCARD_(tag, ##__VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ESP_LOG_DISCARD_(tag, ##__VA_ARGS__)
+#define LOG_PIN(prefix, pin) ((void) (pin))
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+// Host-side stand-in for the FreeRTOS types transceiver.h needs. Only the
+// bench/ targets that build transceiver.cpp include it.
+
+#include <cstdint>
+
+typedef void *TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(ms) ((TickType_t) (ms))
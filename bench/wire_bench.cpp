@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+//
+// Binary telegram records (telegram_wire.h) against the hex text they replace.
+//
+// For T1/C1/S1-sized frames it prints the MQTT payload bytes per frame on the
+// telegram topic (hex vs binary record) and on the raw tap (radio_raw JSON vs
+// binary record), and the CPU cost of building each payload: Frame::as_hex()
+// style format_hex() into a fresh std::string, and telegram_wire_encode()
+// into a buffer reserved once, as the firmware does. Every record is decoded
+// back with telegram_wire_decode() and compared before anything is timed,
+// including a batch of all cases back to back.
+
+#include "telegram_wire.h"
+
+#include "esphome/core/helpers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace wr = esphome::wmbus_radio;
+
+namespace {
+
+struct Case {
+  const char *name;
+  size_t len;
+  wr::LinkMode mode;
+  wr::TelegramWireFormat format;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// The JSON maybe_publish_radio_raw_() builds around the hex.
+std::string raw_json(const std::vector<uint8_t> &frame, const Case &c) {
+  const std::string raw = esphome::format_hex(frame);
+  char head[256];
+  snprintf(head, sizeof(head),
+           "{\"event\":\"radio_raw\",\"uptime_ms\":%lu,\"chip\":\"%s\",\"listen_mode\":\"%s\",\"mode\":\"%s\","
+           "\"rssi\":%d,\"raw_len\":%u,\"hex_len\":%u,\"raw\":\"",
+           123456789UL, "SX1262", "t1_c1", wr::link_mode_name(c.mode), -87, (unsigned) frame.size(),
+           (unsigned) raw.size());
+  return std::string(head) + raw + "\"}";
+}
+
+wr::TelegramWireHeader header_for(const Case &c, uint32_t rx_ms) {
+  wr::TelegramWireHeader h;
+  h.link_mode = c.mode;
+  h.format = c.format;
+  h.rssi = -87;
+  h.rx_ms = rx_ms;
+  return h;
+}
+
+bool same_header(const wr::TelegramWireHeader &a, const wr::TelegramWireHeader &b) {
+  return a.link_mode == b.link_mode && a.format == b.format && a.rssi == b.rssi && a.rx_ms == b.rx_ms &&
+         a.flags == b.flags;
+}
+
+template<typename F> double ns_per_call(int min_ms, F &&f) {
+  uint64_t ns = 0, calls = 0;
+  while (ns < (uint64_t) min_ms * 1000000ULL) {
+    const auto t0 = Clock::now();
+    for (int i = 0; i < 1024; i++) f(i);
+    ns += (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    calls += 1024;
+  }
+  return (double) ns / (double) calls;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int min_ms = 300;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) min_ms = std::atoi(argv[++i]);
+  }
+
+  const Case cases[] = {
+      {"T1  48 B telegram", 48, wr::LinkMode::T1, wr::TelegramWireFormat::A},
+      {"T1 130 B telegram", 130, wr::LinkMode::T1, wr::TelegramWireFormat::A},
+      {"C1 180 B telegram", 180, wr::LinkMode::C1, wr::TelegramWireFormat::B},
+      {"S1 255 B telegram", 255, wr::LinkMode::S1, wr::TelegramWireFormat::A},
+  };
+  constexpr size_t NCASES = sizeof(cases) / sizeof(cases[0]);
+
+  std::vector<std::vector<uint8_t>> frames;
+  for (const auto &c : cases) {
+    std::vector<uint8_t> f(c.len);
+    for (size_t i = 0; i < f.size(); i++) f[i] = (uint8_t) (i * 151 + c.len);
+    frames.push_back(f);
+  }
+
+  // Round trip, single records and one batch of all of them.
+  int mismatches = 0;
+  std::vector<uint8_t> batch;
+  for (size_t k = 0; k < NCASES; k++) {
+    const auto h = header_for(cases[k], 1000U * (uint32_t) k + 0x01020304U);
+    std::vector<uint8_t> rec(wr::TELEGRAM_WIRE_HEADER_LEN + frames[k].size());
+    const size_t n = wr::telegram_wire_encode(rec.data(), rec.size(), h, frames[k].data(), frames[k].size());
+    wr::TelegramWireHeader got;
+    const uint8_t *payload = nullptr;
+    if (n != rec.size() || wr::telegram_wire_decode(rec.data(), rec.size(), got, payload) != n ||
+        !same_header(h, got) || got.payload_len != frames[k].size() ||
+        std::memcmp(payload, frames[k].data(), frames[k].size()) != 0)
+      mismatches++;
+    if (wr::telegram_wire_decode(rec.data(), rec.size() - 1, got, payload) != 0) mismatches++;
+    batch.insert(batch.end(), rec.begin(), rec.end());
+  }
+  size_t off = 0, k = 0;
+  while (off < batch.size()) {
+    wr::TelegramWireHeader got;
+    const uint8_t *payload = nullptr;
+    const size_t n = wr::telegram_wire_decode(batch.data() + off, batch.size() - off, got, payload);
+    if (n == 0 || k >= NCASES || got.payload_len != frames[k].size() ||
+        std::memcmp(payload, frames[k].data(), frames[k].size()) != 0) {
+      mismatches++;
+      break;
+    }
+    off += n;
+    k++;
+  }
+  if (k != NCASES) mismatches++;
+  std::printf("round trip through telegram_wire_decode(): %s (%d mismatches, %zu records + 1 batch)\n",
+              mismatches == 0 ? "OK" : "FAILED", mismatches, NCASES);
+  if (mismatches != 0) return 1;
+
+  std::printf("\n%-20s %10s %10s %10s %10s %12s %12s\n", "frame", "hex B", "binary B", "raw JSON B", "raw bin B",
+              "hex ns", "binary ns");
+  std::vector<uint8_t> wire;
+  wire.reserve(wr::TELEGRAM_WIRE_HEADER_LEN + 436);
+  for (size_t i = 0; i < NCASES; i++) {
+    const auto &c = cases[i];
+    const auto &f = frames[i];
+    const size_t hex_bytes = esphome::format_hex(f).size();
+    const size_t json_bytes = raw_json(f, c).size();
+    const size_t bin_bytes = wr::TELEGRAM_WIRE_HEADER_LEN + f.size();
+
+    size_t sink = 0;
+    const double hex_ns = ns_per_call(min_ms, [&](int) { sink += esphome::format_hex(f).size(); });
+    const double bin_ns = ns_per_call(min_ms, [&](int j) {
+      wire.resize(wr::TELEGRAM_WIRE_HEADER_LEN + f.size());
+      sink += wr::telegram_wire_encode(wire.data(), wire.size(), header_for(c, (uint32_t) j), f.data(), f.size());
+    });
+    if (sink == 0) std::puts("nothing encoded");
+    std::printf("%-20s %10zu %10zu %10zu %10zu %12.1f %12.1f\n", c.name, hex_bytes, bin_bytes, json_bytes, bin_bytes,
+                hex_ns, bin_ns);
+  }
+  return 0;
+}
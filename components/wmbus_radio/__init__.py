@@ -15,6 +15,7 @@ from esphome.const import (
     CONF_TRIGGER_ID,
     CONF_FORMAT,
     CONF_DATA,
+    CONF_TOPIC,
 )
 from pathlib import Path
 
@@ -38,6 +39,7 @@ CONF_MARK_AS_HANDLED = "mark_as_handled"
 CONF_BUSY_PIN = "busy_pin"
 CONF_LISTEN_MODE = "listen_mode"
 CONF_LISTEN_MODE_FILTER_AFTER_PARSE = "listen_mode_filter_after_parse"
+CONF_SYNC_SCHEDULE = "sync_schedule"
 CONF_RECEIVER_TASK_STACK_SIZE = "receiver_task_stack_size"
 
 # Optional built-in RAW forwarding (avoids YAML on_frame boilerplate)
@@ -45,8 +47,26 @@ CONF_TOPIC_NAME = "topic_name"
 CONF_TELEGRAM_TOPIC = "telegram_topic"
 CONF_TARGET_METER_ID = "target_meter_id"
 CONF_TARGET_TOPIC = "target_topic"
+CONF_TARGETS = "targets"
+CONF_METER_ID = "meter_id"
+CONF_TARGET_TOPIC_TEMPLATE = "target_topic_template"
 CONF_TARGET_LOG = "target_log"
 CONF_PUBLISH_RADIO_RAW = "publish_radio_raw"
+CONF_TELEGRAM_BATCH_SIZE = "telegram_batch_size"
+CONF_TELEGRAM_BATCH_MAX_DELAY = "telegram_batch_max_delay"
+CONF_TELEGRAM_BATCH_FORMAT = "telegram_batch_format"
+CONF_DUPLICATE_SUPPRESSION_TTL = "duplicate_suppression_ttl"
+CONF_OFFLINE_BUFFER_SIZE = "offline_buffer_size"
+CONF_OFFLINE_BUFFER_PSRAM = "offline_buffer_psram"
+CONF_OFFLINE_REPLAY_RATE = "offline_replay_rate"
+CONF_TELEGRAM_FORMAT = "telegram_format"
+CONF_LOOP_BUDGET = "loop_budget"
+CONF_METER_FILTER = "meter_filter"
+CONF_METER_FILTER_DEFAULT = "meter_filter_default"
+CONF_ACTION = "action"
+CONF_MANUFACTURER = "manufacturer"
+CONF_DEVICE_TYPE = "device_type"
+CONF_CI = "ci"
 
 # SX1262 board helpers
 CONF_DIO2_RF_SWITCH = "dio2_rf_switch"
@@ -55,6 +75,8 @@ CONF_HAS_TCXO = "has_tcxo"
 
 # SX1276 board helper: optional external TCXO enable/power pin.
 CONF_TCXO_PIN = "tcxo_pin"
+# SX1276: how the receiver task waits for FIFO bytes while reading a frame.
+CONF_SX1276_FIFO_WAKEUP = "sx1276_fifo_wakeup"
 
 # RX gain option (datasheet: boosted / power_saving)
 CONF_RX_GAIN = "rx_gain"
@@ -97,6 +119,7 @@ CONF_FEM_PA_PIN = "fem_pa_pin"
 CONF_GDO0_PIN = "gdo0_pin"
 CONF_GDO2_PIN = "gdo2_pin"
 CONF_CC1101_ALLOW_EXPERIMENTAL = "cc1101_allow_experimental"
+CONF_CC1101_FIFO_WAKEUP = "cc1101_fifo_wakeup"
 CONF_ALLOW_UNTESTED_FRAMEWORK = "allow_untested_framework"
 CONF_FREQUENCY = "frequency"
 
@@ -128,6 +151,34 @@ def _validate_topic_name(value):
     return value
 
 
+def _validate_filter_manufacturer(value):
+    # Three-letter code (KAM, DME, ...) or the raw M-field value.
+    if isinstance(value, int):
+        return cv.int_range(min=0, max=0xFFFF)(value)
+    code = str(value).strip().upper()
+    if not re.fullmatch(r"[A-Z]{3}", code):
+        raise cv.Invalid("manufacturer must be a 3-letter code or a number / manufacturer musi byc 3-literowym kodem albo liczba")
+    return ((ord(code[0]) - 64) << 10) | ((ord(code[1]) - 64) << 5) | (ord(code[2]) - 64)
+
+
+def _validate_filter_meter_id(value):
+    # Same forms as highlight_meters: decimal (the printed BCD id) or hex
+    # with 0x / containing a-f for non-BCD ids.
+    tok = str(value).strip()
+    try:
+        if tok[:2].lower() == "0x":
+            v = int(tok[2:], 16)
+        elif re.search(r"[a-fA-F]", tok):
+            v = int(tok, 16)
+        else:
+            v = int(tok, 10)
+    except ValueError as err:
+        raise cv.Invalid(f"could not parse meter_id '{tok}' / nie mozna odczytac meter_id '{tok}'") from err
+    if not 0 <= v <= 0xFFFFFFFF:
+        raise cv.Invalid(f"meter_id '{tok}' out of range / meter_id '{tok}' poza zakresem")
+    return v
+
+
 def _normalize_diagnostic_mode(mode):
     mode = str(mode).lower().strip()
     if mode == "medium":
@@ -150,6 +201,12 @@ BASE_CONFIG_SCHEMA = (
             cv.Optional(CONF_GDO0_PIN): pins.internal_gpio_input_pin_schema,
             cv.Optional(CONF_GDO2_PIN): pins.internal_gpio_input_pin_schema,
             cv.Optional(CONF_CC1101_ALLOW_EXPERIMENTAL, default=False): cv.boolean,
+            # CC1101: how the receiver task waits for FIFO bytes while reading a
+            # frame. threshold sleeps until GDO0 reports the RX FIFO threshold,
+            # poll is the legacy RXBYTES busy-wait.
+            cv.Optional(CONF_CC1101_FIFO_WAKEUP, default="threshold"): cv.one_of(
+                "threshold", "poll", lower=True
+            ),
             cv.Optional(CONF_ALLOW_UNTESTED_FRAMEWORK, default=False): cv.boolean,
             cv.Optional(CONF_FREQUENCY): cv.float_range(min=300.0, max=928.0),
             cv.Optional(CONF_LISTEN_MODE, default="both"): cv.one_of(
@@ -159,6 +216,12 @@ BASE_CONFIG_SCHEMA = (
             # filter listen_mode by preliminary raw packet mode before parsing.
             # True tries parser/CRC-selected mode first, then filters afterwards.
             cv.Optional(CONF_LISTEN_MODE_FILTER_AFTER_PARSE, default=False): cv.boolean,
+            # How restart_rx() splits listening between the 0x3D and 0xCD second
+            # sync bytes in listen modes both/c1: adaptive follows the valid-frame
+            # rate of each, fixed is the legacy 3:1.
+            cv.Optional(CONF_SYNC_SCHEDULE, default="adaptive"): cv.one_of(
+                "adaptive", "fixed", lower=True
+            ),
             # Stack size for the dedicated radio_recv FreeRTOS task created by this
             # component. This is intentionally separate from ESPHome's
             # loop_task_stack_size because that YAML option only affects the main
@@ -181,6 +244,11 @@ BASE_CONFIG_SCHEMA = (
 
             # SX1276-specific board helper (for boards such as LilyGO T3 V3.0 TCXO).
             cv.Optional(CONF_TCXO_PIN): pins.internal_gpio_output_pin_schema,
+            # SX1276: event sleeps until DIO1 (FifoLevel) reports the next chunk or
+            # the rest of a frame of known length, poll is the legacy tail-gap spin.
+            cv.Optional(CONF_SX1276_FIFO_WAKEUP, default="event"): cv.one_of(
+                "event", "poll", lower=True
+            ),
 
             # Heltec V4 FEM pins (optional, only makes sense for SX1262)
             cv.Optional(CONF_FEM_CTRL_PIN): pins.internal_gpio_output_pin_schema,
@@ -201,9 +269,72 @@ BASE_CONFIG_SCHEMA = (
             cv.Optional(CONF_TELEGRAM_TOPIC): cv.string,
             cv.Optional(CONF_TARGET_METER_ID, default=""): cv.string,
             cv.Optional(CONF_TARGET_TOPIC, default=""): cv.string,
+            # More meters forwarded like target_meter_id, each to its own topic.
+            # topic may use {id}; without one, target_topic_template (also with
+            # {id}) or the derived wmbus/<topic_name>/target_<id> applies.
+            cv.Optional(CONF_TARGETS, default=[]): cv.ensure_list(
+                cv.Schema(
+                    {
+                        cv.Required(CONF_METER_ID): cv.string,
+                        cv.Optional(CONF_TOPIC, default=""): cv.string,
+                    }
+                )
+            ),
+            cv.Optional(CONF_TARGET_TOPIC_TEMPLATE, default=""): cv.string,
             cv.Optional(CONF_TARGET_LOG, default=True): cv.boolean,
             # Internal/dev-only raw packet tap. Fixed MQTT topic: wmbus_bridge/raw.
             cv.Optional(CONF_PUBLISH_RADIO_RAW, default=False): cv.boolean,
+            # Opt-in batching of the telegram stream: up to telegram_batch_size
+            # frames per message on <telegram topic>/batch, sent at the latest
+            # telegram_batch_max_delay after the first frame. 0/1 = off (one
+            # publish per frame on the telegram topic, as before).
+            cv.Optional(CONF_TELEGRAM_BATCH_SIZE, default=0): cv.int_range(min=0, max=64),
+            cv.Optional(CONF_TELEGRAM_BATCH_MAX_DELAY, default="1s"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(milliseconds=50), max=cv.TimePeriod(seconds=60)),
+            ),
+            cv.Optional(CONF_TELEGRAM_BATCH_FORMAT, default="json"): cv.one_of("json", "hex", lower=True),
+            # binary = 12-byte header + frame bytes (telegram_wire.h) on the
+            # telegram topic, its batches and the raw tap, instead of hex/JSON.
+            cv.Optional(CONF_TELEGRAM_FORMAT, default="hex"): cv.one_of("hex", "binary", lower=True),
+            # Forward a telegram repeated by the same meter within this time
+            # (repeats, or the T1 and C1 copies of a dual-mode meter) only once,
+            # to the topics and to on_frame handlers alike. 0s = off.
+            cv.Optional(CONF_DUPLICATE_SUPPRESSION_TTL, default="0s"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(max=cv.TimePeriod(minutes=60)),
+            ),
+            # Store-and-forward across MQTT outages: bytes of RAM for frames
+            # received while MQTT is down (0 = off, lost as before), replayed
+            # oldest first at offline_replay_rate frames/s after reconnect.
+            cv.Optional(CONF_OFFLINE_BUFFER_SIZE, default=0): cv.int_range(min=0, max=1048576),
+            cv.Optional(CONF_OFFLINE_BUFFER_PSRAM, default=False): cv.boolean,
+            cv.Optional(CONF_OFFLINE_REPLAY_RATE, default=10): cv.int_range(min=1, max=50),
+            # Time loop() may spend taking queued packets per call (at least
+            # one is always taken). 0us = one packet per call, as before.
+            cv.Optional(CONF_LOOP_BUDGET, default="5ms"): cv.All(
+                cv.positive_time_period_microseconds,
+                cv.Range(max=cv.TimePeriod(milliseconds=50)),
+            ),
+            # Allow/deny rules checked in order on the telegram header, before
+            # the full parse where possible; the first matching rule decides,
+            # an omitted field matches anything. Without a match:
+            # meter_filter_default (auto = deny if any allow rule exists).
+            cv.Optional(CONF_METER_FILTER, default=[]): cv.All(
+                cv.ensure_list(
+                    cv.Schema(
+                        {
+                            cv.Required(CONF_ACTION): cv.one_of("allow", "deny", lower=True),
+                            cv.Optional(CONF_MANUFACTURER): _validate_filter_manufacturer,
+                            cv.Optional(CONF_METER_ID): _validate_filter_meter_id,
+                            cv.Optional(CONF_DEVICE_TYPE): cv.hex_int_range(min=0, max=255),
+                            cv.Optional(CONF_CI): cv.hex_int_range(min=0, max=255),
+                        }
+                    )
+                ),
+                cv.Length(max=16),
+            ),
+            cv.Optional(CONF_METER_FILTER_DEFAULT, default="auto"): cv.one_of("auto", "allow", "deny", lower=True),
 
             # Diagnostics are opt-in by default. `diagnostic_mode` applies a preset
             # for MQTT publishing only; explicit detailed flags still override it.
@@ -354,6 +485,8 @@ async def to_code(config):
     if config[CONF_RADIO_TYPE] == "SX1276" and CONF_TCXO_PIN in config:
         tcxo_pin = await cg.gpio_pin_expression(config[CONF_TCXO_PIN])
         cg.add(radio_var.set_tcxo_pin(tcxo_pin))
+    if config[CONF_RADIO_TYPE] == "SX1276":
+        cg.add(radio_var.set_fifo_event_wakeup(config[CONF_SX1276_FIFO_WAKEUP] == "event"))
 
     if config[CONF_RADIO_TYPE] != "CC1101":
         reset_pin = await cg.gpio_pin_expression(config[CONF_RESET_PIN])
@@ -381,12 +514,14 @@ async def to_code(config):
         cg.add(radio_var.set_gdo0_pin(gdo0_pin))
         cg.add(radio_var.set_gdo2_pin(gdo2_pin))
         cg.add(radio_var.set_frequency_mhz(frequency_mhz))
+        cg.add(radio_var.set_fifo_threshold_wakeup(config[CONF_CC1101_FIFO_WAKEUP] == "threshold"))
         # Receiver task wake-up interrupt is the sync-detect line.
         cg.add(radio_var.set_irq_pin(gdo2_pin))
     else:
         cg.add(radio_var.set_frequency_mhz(frequency_mhz))
 
     cg.add(radio_var.set_listen_mode(listen_mode_map[effective_listen_mode]))
+    cg.add(radio_var.set_adaptive_sync_schedule(config[CONF_SYNC_SCHEDULE] == "adaptive"))
 
     if config[CONF_RADIO_TYPE] != "CC1101":
         irq_pin = await cg.gpio_pin_expression(config[CONF_IRQ_PIN])
@@ -495,8 +630,44 @@ async def to_code(config):
     cg.add(var.set_telegram_topic(telegram_topic))
     cg.add(var.set_target_meter_id_str(config.get(CONF_TARGET_METER_ID, "")))
     cg.add(var.set_target_topic(config.get(CONF_TARGET_TOPIC, "")))
+    cg.add(var.set_target_topic_template(config[CONF_TARGET_TOPIC_TEMPLATE]))
+    for target in config[CONF_TARGETS]:
+        cg.add(var.add_target(target[CONF_METER_ID], target[CONF_TOPIC]))
     cg.add(var.set_target_log(config.get(CONF_TARGET_LOG, True)))
     cg.add(var.set_publish_radio_raw(config.get(CONF_PUBLISH_RADIO_RAW, False)))
+    cg.add(var.set_telegram_batch(
+        config[CONF_TELEGRAM_BATCH_SIZE],
+        config[CONF_TELEGRAM_BATCH_MAX_DELAY].total_milliseconds,
+        config[CONF_TELEGRAM_BATCH_FORMAT] == "json",
+    ))
+    cg.add(var.set_telegram_binary(config[CONF_TELEGRAM_FORMAT] == "binary"))
+    cg.add(var.set_duplicate_suppression_ttl(config[CONF_DUPLICATE_SUPPRESSION_TTL].total_milliseconds))
+    cg.add(var.set_offline_buffer(
+        config[CONF_OFFLINE_BUFFER_SIZE],
+        config[CONF_OFFLINE_BUFFER_PSRAM],
+        config[CONF_OFFLINE_REPLAY_RATE],
+    ))
+    cg.add(var.set_loop_budget_us(config[CONF_LOOP_BUDGET].total_microseconds))
+    # Bits match MeterFilter::Field (meter_filter.h).
+    for rule in config[CONF_METER_FILTER]:
+        fields = 0
+        for bit, key in enumerate((CONF_MANUFACTURER, CONF_METER_ID, CONF_DEVICE_TYPE, CONF_CI)):
+            if key in rule:
+                fields |= 1 << bit
+        cg.add(var.add_meter_filter_rule(
+            rule[CONF_ACTION] == "allow",
+            fields,
+            rule.get(CONF_MANUFACTURER, 0),
+            rule.get(CONF_METER_ID, 0),
+            rule.get(CONF_DEVICE_TYPE, 0),
+            rule.get(CONF_CI, 0),
+        ))
+    meter_filter_default = config[CONF_METER_FILTER_DEFAULT]
+    if meter_filter_default == "auto":
+        meter_filter_default = (
+            "deny" if any(r[CONF_ACTION] == "allow" for r in config[CONF_METER_FILTER]) else "allow"
+        )
+    cg.add(var.set_meter_filter_default(meter_filter_default == "allow"))
 
     diag_events_highlight_only = (
         config[CONF_DIAG_EVENTS_HIGHLIGHT_ONLY]
@@ -18,6 +18,7 @@
 
 // Protocol constants shared with the split-out translation units (rf_runtime, ...).
 #include "wmbus_radio_internal.h"
+#include "telegram_wire.h"
 
 // xQueueCreate returns a handle (a pointer), xTaskCreate returns BaseType_t.
 // Funnel both through one overload set so a single format specifier stays
@@ -115,35 +116,111 @@ static inline uint8_t rssi_abort_bucket_(int rssi_dbm) {
   return 4;
 }
 
+void Radio::setup_targets_() {
+  // target_meter_id/target_topic first, so it wins over a targets: entry for
+  // the same meter.
+  std::vector<TargetSpec> specs;
+  if (!this->target_meter_id_str_.empty()) specs.push_back({this->target_meter_id_str_, this->target_topic_});
+  specs.insert(specs.end(), this->target_specs_.begin(), this->target_specs_.end());
+
+  std::vector<uint32_t> ids;
+  for (const auto &spec : specs) {
+    parse_meter_id_csv_(spec.meter_id, ids);
+    if (ids.empty()) continue;
+    const uint32_t id = ids.front();
+    char id_buf[9];
+    snprintf(id_buf, sizeof(id_buf), "%08u", (unsigned) id);
+    if (std::any_of(this->targets_.begin(), this->targets_.end(),
+                    [id](const ForwardTarget &t) { return t.meter_id == id; })) {
+      ESP_LOGW(TAG, "Target meter id=%s listed twice, keeping the first / licznik podany dwa razy", id_buf);
+      continue;
+    }
+    std::string topic = this->target_topic_for_(id, spec.topic);
+    if (topic.empty()) {
+      ESP_LOGW(TAG, "Target meter id=%s has no topic (no topic_name/target_topic), skipped / brak topicu, pominieto",
+               id_buf);
+      continue;
+    }
+    ESP_LOGI(TAG, "Target meter forwarding enabled / wlaczono przekazywanie docelowego licznika id=%s topic=%s",
+             id_buf, topic.c_str());
+    std::string replay_topic = this->offline_buffer_bytes_ != 0 ? topic + "/replay" : std::string();
+    this->targets_.push_back({id, std::move(topic), std::move(replay_topic)});
+  }
+  std::sort(this->targets_.begin(), this->targets_.end(),
+            [](const ForwardTarget &a, const ForwardTarget &b) { return a.meter_id < b.meter_id; });
+  this->targets_.shrink_to_fit();
+  this->target_specs_.clear();
+  this->target_specs_.shrink_to_fit();
+}
+
 void Radio::setup() {
   for (const auto &warning : this->config_warnings_) {
     ESP_LOGW(TAG, "Config warning / ostrzezenie konfiguracji: %s", warning.c_str());
   }
   // Parse optional highlight meter list (CSV provided by python/YAML).
   parse_meter_id_csv_(this->highlight_meters_csv_, this->highlight_meter_ids_);
-  if (!this->target_meter_id_str_.empty()) {
-    std::vector<uint32_t> tmp;
-    parse_meter_id_csv_(this->target_meter_id_str_, tmp);
-    if (!tmp.empty()) {
-      this->target_meter_id_ = tmp.front();
-      this->target_meter_enabled_ = true;
-      if (this->target_topic_.empty()) {
-        this->target_topic_ = this->derived_target_topic_();
-      }
-      char id_buf[9];
-      snprintf(id_buf, sizeof(id_buf), "%08u", (unsigned) this->target_meter_id_);
-      ESP_LOGI(TAG, "Target meter forwarding enabled / wlaczono przekazywanie docelowego licznika id=%s topic=%s",
-               id_buf, this->target_topic_.empty() ? "<derived at runtime>" : this->target_topic_.c_str());
-    }
-  }
+  this->setup_targets_();
 
   if (!this->telegram_topic_.empty()) {
     ESP_LOGI(TAG, "Frame RAW forwarding topic / topic publikacji RAW: %s", this->telegram_topic_.c_str());
   }
+  if (this->telegram_batch_enabled_()) {
+    this->telegram_batch_topic_ = this->telegram_topic_ + "/batch";
+    this->telegram_batch_buf_.reserve(TELEGRAM_BATCH_MAX_BYTES);
+    ESP_LOGI(TAG, "Telegram batching / grupowanie telegramow: topic=%s max_frames=%u max_delay=%ums format=%s",
+             this->telegram_batch_topic_.c_str(), (unsigned) this->telegram_batch_max_frames_,
+             (unsigned) this->telegram_batch_max_delay_ms_,
+             this->telegram_binary_ ? "binary" : (this->telegram_batch_json_ ? "json" : "hex"));
+  }
+
+  if (this->offline_buffer_bytes_ != 0) {
+    // PSRAM when asked for and present, internal RAM otherwise.
+    uint8_t *buf = nullptr;
+    if (this->offline_buffer_psram_) {
+      RAMAllocator<uint8_t> psram(RAMAllocator<uint8_t>::ALLOC_EXTERNAL);
+      buf = psram.allocate(this->offline_buffer_bytes_);
+    }
+    const bool in_psram = buf != nullptr;
+    if (buf == nullptr) {
+      RAMAllocator<uint8_t> internal(RAMAllocator<uint8_t>::ALLOC_INTERNAL);
+      buf = internal.allocate(this->offline_buffer_bytes_);
+    }
+    this->offline_store_.attach(buf, this->offline_buffer_bytes_);
+    this->offline_rec_.reserve(TELEGRAM_WIRE_HEADER_LEN + PacketPool::SLOT_BYTES);
+    if (!this->telegram_topic_.empty()) this->telegram_replay_topic_ = this->telegram_topic_ + "/replay";
+    if (buf != nullptr && this->telegram_batch_enabled_() && !this->telegram_binary_) {
+      this->telegram_batch_records_.reserve(TELEGRAM_BATCH_MAX_BYTES +
+                                            this->telegram_batch_max_frames_ * TELEGRAM_WIRE_HEADER_LEN);
+    }
+    if (buf == nullptr) {
+      ESP_LOGW(TAG, "Offline buffer: allocation of %u B failed, disabled / bufor offline: brak pamieci, wylaczony",
+               (unsigned) this->offline_buffer_bytes_);
+    } else {
+      ESP_LOGI(TAG, "Offline buffer / bufor offline: %u B in %s, replay every %ums",
+               (unsigned) this->offline_buffer_bytes_, in_psram ? "PSRAM" : "internal RAM",
+               (unsigned) this->offline_replay_interval_ms_);
+    }
+  }
+
+  if (this->meter_filter_.enabled()) {
+    ESP_LOGI(TAG, "Meter filter / filtr licznikow: %u rules / regul, default / domyslnie: %s",
+             (unsigned) this->meter_filter_.size(), this->meter_filter_.default_allow() ? "allow" : "deny");
+  }
+
+  if (this->dedup_ttl_ms_ != 0) {
+    ESP_LOGI(TAG, "Duplicate suppression / tlumienie duplikatow: ttl=%ums cache=%u entries",
+             (unsigned) this->dedup_ttl_ms_, (unsigned) DEDUP_CACHE_SIZE);
+  }
 
   if (this->publish_radio_raw_) {
     ESP_LOGI(TAG, "Internal radio RAW tap enabled / wlaczono wewnetrzny RAW tap: wmbus_bridge/raw");
   }
+  if (this->telegram_binary_) {
+    this->wire_buf_.reserve(TELEGRAM_WIRE_HEADER_LEN + PacketPool::SLOT_BYTES);
+    if (this->publish_radio_raw_) this->raw_wire_buf_.reserve(TELEGRAM_WIRE_HEADER_LEN + PacketPool::SLOT_BYTES);
+    ESP_LOGI(TAG, "Binary telegram records / binarne rekordy telegramow: version=%u header=%u B",
+             (unsigned) TELEGRAM_WIRE_VERSION, (unsigned) TELEGRAM_WIRE_HEADER_LEN);
+  }
 
   if (!this->highlight_meter_ids_.empty()) {
     // meter_window_interval_ms_ defaults to 15 min; cap it at diag_summary_interval_ms_ minimum
@@ -156,6 +233,10 @@ void Radio::setup() {
              (unsigned) (this->meter_window_interval_ms_ / 1000));
   }
 
+  // Before the tx-test early return: the boot event needs it too.
+  this->json_buf_.resize(std::max<size_t>(
+      JSON_BUF_BYTES, 192 + this->highlight_meter_ids_.size() * 2 * METER_SNAPSHOT_ENTRY_BYTES));
+
   if (this->tx_test_enabled_) {
     ESP_LOGI(TAG, "TX test mode enabled / wlaczono tryb nadajnika testowego: radio=%s mode=%s frame_length=%u interval=%ums tx_data_gpio=%u",
              this->radio != nullptr ? this->radio->get_name() : "<null>",
@@ -171,7 +252,7 @@ void Radio::setup() {
     return;
   }
 
-  ASSERT_SETUP(this->packet_queue_ = xQueueCreate(3, sizeof(Packet *)));
+  this->packet_pool_.init();
 
   // This component uses its own FreeRTOS receiver task instead of ESPHome's
   // main loop task. Because of that, ESPHome's loop_task_stack_size YAML option
@@ -230,6 +311,7 @@ void Radio::dump_config() {
   ESP_LOGCONFIG(TAG, "  Listen mode filter: %s",
                 this->listen_mode_filter_after_parse_ ? "after parse (experimental)" : "before parse (legacy)");
   ESP_LOGCONFIG(TAG, "  Receiver task stack: %u bytes", (unsigned) this->receiver_task_stack_size_);
+  ESP_LOGCONFIG(TAG, "  Loop packet budget: %uus", (unsigned) this->loop_budget_us_);
   if (this->tx_test_enabled_) {
     ESP_LOGCONFIG(TAG, "  Operation: tx_test");
     ESP_LOGCONFIG(TAG, "  TX test: mode=%s frame_length=%u interval=%ums tx_data_gpio=%u",
@@ -248,6 +330,36 @@ void Radio::dump_config() {
   } else {
     ESP_LOGCONFIG(TAG, "  Busy ether mode: n/a (SX1276 only)");
   }
+  if (this->telegram_batch_enabled_()) {
+    ESP_LOGCONFIG(TAG, "  Telegram batching: max_frames=%u max_delay=%ums format=%s",
+                  (unsigned) this->telegram_batch_max_frames_, (unsigned) this->telegram_batch_max_delay_ms_,
+                  this->telegram_binary_ ? "binary" : (this->telegram_batch_json_ ? "json" : "hex"));
+  }
+  for (const auto &t : this->targets_) {
+    ESP_LOGCONFIG(TAG, "  Target meter %08u -> %s", (unsigned) t.meter_id, t.topic.c_str());
+  }
+  if (this->offline_store_.enabled()) {
+    ESP_LOGCONFIG(TAG, "  Offline buffer: %u B, replay every %ums", (unsigned) this->offline_store_.capacity(),
+                  (unsigned) this->offline_replay_interval_ms_);
+  }
+  if (this->meter_filter_.enabled()) {
+    ESP_LOGCONFIG(TAG, "  Meter filter: %u rules, default %s", (unsigned) this->meter_filter_.size(),
+                  this->meter_filter_.default_allow() ? "allow" : "deny");
+    for (size_t i = 0; i < this->meter_filter_.size(); i++) {
+      const MeterFilter::Rule &r = this->meter_filter_.rule(i);
+      char mfr[8] = "*", id[12] = "*", type[8] = "*", ci[8] = "*";
+      if (r.fields & MeterFilter::FIELD_MFR) std::snprintf(mfr, sizeof(mfr), "0x%04X", (unsigned) r.mfr);
+      if (r.fields & MeterFilter::FIELD_ID) std::snprintf(id, sizeof(id), "%08u", (unsigned) r.id);
+      if (r.fields & MeterFilter::FIELD_TYPE) std::snprintf(type, sizeof(type), "0x%02X", (unsigned) r.type);
+      if (r.fields & MeterFilter::FIELD_CI) std::snprintf(ci, sizeof(ci), "0x%02X", (unsigned) r.ci);
+      ESP_LOGCONFIG(TAG, "    [%u] %s manufacturer=%s meter_id=%s device_type=%s ci=%s", (unsigned) i,
+                    r.allow ? "allow" : "deny", mfr, id, type, ci);
+    }
+  }
+  if (this->dedup_ttl_ms_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Duplicate suppression: ttl=%ums cache=%u entries", (unsigned) this->dedup_ttl_ms_,
+                  (unsigned) DEDUP_CACHE_SIZE);
+  }
   if (!this->diag_topic_.empty()) {
     ESP_LOGCONFIG(TAG, "  Diagnostics MQTT topic: %s", this->diag_topic_.c_str());
     ESP_LOGCONFIG(TAG, "  MQTT boot topic: %s/boot", this->diag_topic_.c_str());
@@ -368,19 +480,20 @@ if (!this->boot_log_done_ && this->radio != nullptr) {
 
   auto *mqtt = mqtt::global_mqtt_client;
   if (this->radio != nullptr && mqtt != nullptr && mqtt->is_connected() && !this->diag_topic_.empty()) {
-    std::string boot_payload = str_sprintf(
-        "{\"event\":\"boot\",\"radio\":\"%s\",\"listen_mode\":\"%s\",\"uptime_ms\":%lu}",
-        this->radio->get_name(),
-        listen_mode_to_string_(this->radio->get_listen_mode()),
-        (unsigned long) loop_now_ms);
+    JsonWriter w = this->json_writer_();
+    w.begin_object()
+        .str("event", "boot")
+        .str("radio", this->radio->get_name())
+        .str("listen_mode", listen_mode_to_string_(this->radio->get_listen_mode()))
+        .u32("uptime_ms", loop_now_ms)
+        .end_object();
 
     if (this->boot_info_mqtt_pending_) {
-      std::string boot_topic = this->diag_topic_ + "/boot";
-      mqtt->publish(boot_topic, boot_payload, static_cast<uint8_t>(0), true);
+      this->publish_json_(this->diag_topic_ + "/boot", w, true);
       this->boot_info_mqtt_pending_ = false;
     }
     if (this->boot_info_event_pending_) {
-      mqtt->publish(this->diag_topic_, std::string(boot_payload), static_cast<uint8_t>(0), false);
+      this->publish_json_(this->diag_topic_, w);
       this->boot_info_event_pending_ = false;
     }
   }
@@ -389,13 +502,21 @@ if (!this->boot_log_done_ && this->radio != nullptr) {
     const char *listen_mode = (this->radio != nullptr)
                                   ? listen_mode_to_string_(this->radio->get_listen_mode())
                                   : "unknown";
-    char payload[256];
-    snprintf(payload, sizeof(payload),
-             "{\"event\":\"dev_err_cleared\",\"uptime_ms\":%lu,\"listen_mode\":\"%s\",\"before\":%u,\"before_hex\":\"%04X\",\"after\":%u,\"after_hex\":\"%04X\"}",
-             (unsigned long) loop_now_ms, listen_mode,
-             (unsigned) this->dev_err_before_, (unsigned) this->dev_err_before_,
-             (unsigned) this->dev_err_after_, (unsigned) this->dev_err_after_);
-    mqtt->publish(this->diag_topic_, payload);
+    char before_hex[5];
+    char after_hex[5];
+    snprintf(before_hex, sizeof(before_hex), "%04X", (unsigned) this->dev_err_before_);
+    snprintf(after_hex, sizeof(after_hex), "%04X", (unsigned) this->dev_err_after_);
+    JsonWriter w = this->json_writer_();
+    w.begin_object()
+        .str("event", "dev_err_cleared")
+        .u32("uptime_ms", loop_now_ms)
+        .str("listen_mode", listen_mode)
+        .u32("before", this->dev_err_before_)
+        .str("before_hex", before_hex)
+        .u32("after", this->dev_err_after_)
+        .str("after_hex", after_hex)
+        .end_object();
+    this->publish_json_(this->diag_topic_, w);
     this->dev_err_cleared_pending_ = false;
   }
 
@@ -411,15 +532,53 @@ if (!this->boot_log_done_ && this->radio != nullptr) {
     return;
   }
 
+  this->diag_sync_rx_task_();
+  this->publish_pending_(loop_now_ms);
+  this->publish_rx_path_events_();
   this->maybe_publish_health_(loop_now_ms);
   this->maybe_publish_diag_summary_(loop_now_ms);
   this->maybe_publish_diag_15min_summary_(loop_now_ms);
   this->maybe_publish_diag_60min_summary_(loop_now_ms);
   this->maybe_publish_meter_windows_(loop_now_ms);
+  this->drain_packets_(loop_now_ms);
+}
+
+// Takes packets until none is left or loop_budget_us_ is spent, so a burst
+// (several meters answering on the same hour boundary) is cleared in one
+// call rather than one packet per loop() pass. At least one packet is always
+// processed. While packets are still waiting, loop() asks ESPHome to run it
+// again at once instead of after the usual loop interval.
+void Radio::drain_packets_(uint32_t loop_now_ms) {
+  const uint32_t start_us = (uint32_t) esphome::micros();
+  uint32_t n = 0;
+  bool exhausted = false;
   Packet *p;
-  if (xQueueReceive(this->packet_queue_, &p, 0) != pdPASS)
-    return;
+  while ((p = this->packet_pool_.take()) != nullptr) {
+    this->note_queue_depth_((uint32_t) this->packet_pool_.queued() + 1);
+    this->process_packet_(p, loop_now_ms);
+    n++;
+    if ((uint32_t) esphome::micros() - start_us >= this->loop_budget_us_) {
+      exhausted = this->packet_pool_.queued() != 0;
+      break;
+    }
+  }
+
+  if (n != 0) {
+    auto &ld = this->diag_.loop_drain;
+    ld.loops++;
+    ld.packets += n;
+    ld.per_loop_hist[n < 4 ? n - 1 : 3]++;
+    if (exhausted) ld.budget_exhausted++;
+  }
+
+  if (this->packet_pool_.queued() != 0) {
+    this->high_freq_.start();
+  } else {
+    this->high_freq_.stop();
+  }
+}
 
+void Radio::process_packet_(Packet *p, uint32_t loop_now_ms) {
   this->maybe_publish_radio_raw_(p, loop_now_ms);
 
   // listen_mode filtering has two modes:
@@ -439,11 +598,25 @@ if (!this->boot_log_done_ && this->radio != nullptr) {
                (want == LISTEN_MODE_C1) ? "C1" : ((want == LISTEN_MODE_S1) ? "S1" : "T1"),
                link_mode_name(got),
                (int) p->get_rssi());
-      delete p;
+      this->packet_pool_.release(p);
       return;
     }
   }
 
+  // meter_filter: decide on the raw header when it can be read, so a
+  // foreign meter costs no parse, CRC strip, log line or publish.
+  bool meter_filter_decided = false;
+  if (this->meter_filter_.enabled()) {
+    MeterHeader hdr;
+    if (p->peek_meter_header(hdr)) {
+      meter_filter_decided = true;
+      if (!this->meter_filter_pass_(hdr, true, loop_now_ms)) {
+        this->packet_pool_.release(p);
+        return;
+      }
+    }
+  }
+
   // The raw-hex capture inside convert_to_frame() is only ever read behind
   // diag_publish_raw_, so let the packet skip it when that's off.
   p->set_capture_raw_hex(this->diag_publish_raw_);
@@ -463,33 +636,35 @@ if (!this->boot_log_done_ && this->radio != nullptr) {
                  (want == LISTEN_MODE_C1) ? "C1" : ((want == LISTEN_MODE_S1) ? "S1" : "T1"),
                  link_mode_name(got),
                  (int) p->get_rssi());
-        delete p;
+        this->packet_pool_.release(p);
         return;
       }
     }
   }
 
-  // Count only packets that pass the listen_mode filter.
-  this->diag_total_++;
-  this->diag_15m_total_++;
-  this->diag_60min_total_++;
+  // Headers the early check could not read (S1, format A block 1 CRC
+  // error) are judged on the parsed frame.
+  if (frame && this->meter_filter_.enabled() && !meter_filter_decided) {
+    MeterHeader hdr;
+    if (frame->meter_header(hdr) && !this->meter_filter_pass_(hdr, false, loop_now_ms)) {
+      this->packet_pool_.release(p);
+      return;
+    }
+  }
+
+  // Count only packets that pass the listen_mode filter (and meter_filter).
+  this->diag_.total++;
   // Always-on liveness: proof the RX path delivered a frame (not just that the
   // main loop ticks). Drives the health pulse's sec_since_last_rx, independent
   // of diagnostic_mode.
   this->rx_total_lifetime_++;
   this->last_rx_ms_ = loop_now_ms;
   this->any_rx_ = true;
-  if (mode_idx < this->diag_mode_total_.size()) this->diag_mode_total_[mode_idx]++;
-  if (mode_idx < this->diag_15m_mode_total_.size()) this->diag_15m_mode_total_[mode_idx]++;
-  if (mode_idx < this->diag_60min_mode_total_.size()) this->diag_60min_mode_total_[mode_idx]++;
+  if (mode_idx < this->diag_.mode_total.size()) this->diag_.mode_total[mode_idx]++;
 
   if (mode_idx == (uint8_t) LinkMode::T1) {
-    this->diag_t1_symbols_total_ += (uint32_t) p->t1_symbols_total();
-    this->diag_t1_symbols_invalid_ += (uint32_t) p->t1_symbols_invalid();
-    this->diag_15m_t1_symbols_total_ += (uint32_t) p->t1_symbols_total();
-    this->diag_15m_t1_symbols_invalid_ += (uint32_t) p->t1_symbols_invalid();
-    this->diag_60min_t1_symbols_total_ += (uint32_t) p->t1_symbols_total();
-    this->diag_60min_t1_symbols_invalid_ += (uint32_t) p->t1_symbols_invalid();
+    this->diag_.t1_symbols_total += (uint32_t) p->t1_symbols_total();
+    this->diag_.t1_symbols_invalid += (uint32_t) p->t1_symbols_invalid();
   }
 
   if (!frame) {
@@ -497,165 +672,90 @@ if (!this->boot_log_done_ && this->radio != nullptr) {
     const char *listen_mode = (this->radio != nullptr)
                                   ? listen_mode_to_string_(this->radio->get_listen_mode())
                                   : "unknown";
-    this->diag_dropped_by_stage_[bucket_for_stage_(p->drop_stage())]++;
-    this->diag_15m_dropped_by_stage_[bucket_for_stage_(p->drop_stage())]++;
-    this->diag_60min_dropped_by_stage_[bucket_for_stage_(p->drop_stage())]++;
+    const auto stage_bucket = bucket_for_stage_(p->drop_stage());
+    this->diag_.dropped_by_stage[stage_bucket]++;
+    const char *drop_stage = drop_stage_name(p->drop_stage());
+    const char *drop_reason = drop_reason_name(p->drop_reason());
+    // Filled in only when an event is published or logged below.
+    char drop_detail[Packet::DROP_DETAIL_MAX];
+    drop_detail[0] = '\0';
 
     if (p->is_truncated()) {
-      this->diag_truncated_++;
-      this->diag_15m_truncated_++;
-      this->diag_60min_truncated_++;
+      this->diag_.truncated++;
       if (this->should_publish_packet_event_(p) && mqtt::global_mqtt_client != nullptr && !this->diag_topic_.empty()) {
-        char payload[1280];
-        if (this->diag_publish_raw_) {
-          snprintf(payload, sizeof(payload),
-                   "{\"event\":\"truncated\",\"uptime_ms\":%lu,\"listen_mode\":\"%s\",\"reason\":\"%s\",\"stage\":\"%s\",\"detail\":\"%s\",\"mode\":\"%s\",\"rssi\":%d,\"want\":%u,\"got\":%u,\"raw_got\":%u,\"decoded_len\":%u,\"final_len\":%u,\"dll_crc_removed\":%u,\"suffix_ignored\":%u,\"raw\":\"%s\"}",
-                   (unsigned long) loop_now_ms, listen_mode,
-                   p->drop_reason().c_str(), p->drop_stage().c_str(), p->drop_detail().c_str(),
-                   mode, (int) p->get_rssi(), (unsigned) p->want_len(),
-                   (unsigned) p->got_len(), (unsigned) p->raw_got_len(),
-                   (unsigned) p->decoded_len(), (unsigned) p->final_len(),
-                   (unsigned) p->dll_crc_removed(), (unsigned) p->suffix_ignored(),
-                   p->raw_hex().c_str());
-        } else {
-          snprintf(payload, sizeof(payload),
-                   "{\"event\":\"truncated\",\"uptime_ms\":%lu,\"listen_mode\":\"%s\",\"reason\":\"%s\",\"stage\":\"%s\",\"detail\":\"%s\",\"mode\":\"%s\",\"rssi\":%d,\"want\":%u,\"got\":%u,\"raw_got\":%u,\"decoded_len\":%u,\"final_len\":%u,\"dll_crc_removed\":%u,\"suffix_ignored\":%u}",
-                   (unsigned long) loop_now_ms, listen_mode,
-                   p->drop_reason().c_str(), p->drop_stage().c_str(), p->drop_detail().c_str(),
-                   mode, (int) p->get_rssi(), (unsigned) p->want_len(),
-                   (unsigned) p->got_len(), (unsigned) p->raw_got_len(),
-                   (unsigned) p->decoded_len(), (unsigned) p->final_len(),
-                   (unsigned) p->dll_crc_removed(), (unsigned) p->suffix_ignored());
-        }
-        mqtt::global_mqtt_client->publish(this->diag_topic_, payload);
+        p->format_drop_detail(drop_detail, sizeof(drop_detail));
+        this->publish_packet_event_("truncated", p, loop_now_ms, listen_mode, drop_reason, drop_stage, drop_detail, mode);
       }
 
       if (this->diag_verbose_) {
+        if (drop_detail[0] == '\0') p->format_drop_detail(drop_detail, sizeof(drop_detail));
         ESP_LOGW(TAG,
                  "TRUNCATED frame / ucieta ramka: uptime_ms=%lu listen_mode=%s stage=%s reason=%s mode=%s want=%u got=%u raw_got=%u decoded_len=%u final_len=%u RSSI=%ddBm detail=%s",
-                 (unsigned long) loop_now_ms, listen_mode, p->drop_stage().c_str(), p->drop_reason().c_str(), mode,
+                 (unsigned long) loop_now_ms, listen_mode, drop_stage, drop_reason, mode,
                  (unsigned) p->want_len(), (unsigned) p->got_len(),
                  (unsigned) p->raw_got_len(), (unsigned) p->decoded_len(),
-                 (unsigned) p->final_len(), (int) p->get_rssi(), p->drop_detail().c_str());
+                 (unsigned) p->final_len(), (int) p->get_rssi(), drop_detail);
         if (this->diag_publish_raw_) {
           ESP_LOGW(TAG, "TRUNCATED raw(hex) / ucieta ramka raw(hex)=%s", p->raw_hex().c_str());
         }
       }
-    } else if (!p->drop_reason().empty()) {
-      this->diag_dropped_++;
-      this->diag_15m_dropped_++;
-      this->diag_60min_dropped_++;
-      this->diag_rssi_drop_sum_ += (int32_t) p->get_rssi();
-      this->diag_rssi_drop_n_++;
-      this->diag_15m_rssi_drop_sum_ += (int32_t) p->get_rssi();
-      this->diag_15m_rssi_drop_n_++;
-      this->diag_60min_rssi_drop_sum_ += (int32_t) p->get_rssi();
-      this->diag_60min_rssi_drop_n_++;
-      if (mode_idx < this->diag_mode_dropped_.size()) {
-        this->diag_mode_dropped_[mode_idx]++;
-        this->diag_mode_rssi_drop_sum_[mode_idx] += (int32_t) p->get_rssi();
-        this->diag_mode_rssi_drop_n_[mode_idx]++;
-      }
-      if (mode_idx < this->diag_15m_mode_dropped_.size()) {
-        this->diag_15m_mode_dropped_[mode_idx]++;
-        this->diag_15m_mode_rssi_drop_sum_[mode_idx] += (int32_t) p->get_rssi();
-        this->diag_15m_mode_rssi_drop_n_[mode_idx]++;
-      }
-      if (mode_idx < this->diag_60min_mode_dropped_.size()) {
-        this->diag_60min_mode_dropped_[mode_idx]++;
-        this->diag_60min_mode_rssi_drop_sum_[mode_idx] += (int32_t) p->get_rssi();
-        this->diag_60min_mode_rssi_drop_n_[mode_idx]++;
+    } else if (p->drop_reason() != DropReason::NONE) {
+      this->diag_.dropped++;
+      this->diag_.rssi_drop_sum += (int32_t) p->get_rssi();
+      this->diag_.rssi_drop_n++;
+      if (mode_idx < this->diag_.mode_dropped.size()) {
+        this->diag_.mode_dropped[mode_idx]++;
+        this->diag_.mode_rssi_drop_sum[mode_idx] += (int32_t) p->get_rssi();
+        this->diag_.mode_rssi_drop_n[mode_idx]++;
       }
       auto bucket = bucket_for_reason_(p->drop_reason());
-      this->diag_dropped_by_bucket_[bucket]++;
-      this->diag_15m_dropped_by_bucket_[bucket]++;
-      this->diag_60min_dropped_by_bucket_[bucket]++;
-      if (bucket == DB_DLL_CRC_FAILED && mode_idx < this->diag_mode_crc_failed_.size()) {
-        this->diag_mode_crc_failed_[mode_idx]++;
-      }
-      if (bucket == DB_DLL_CRC_FAILED && mode_idx < this->diag_15m_mode_crc_failed_.size()) {
-        this->diag_15m_mode_crc_failed_[mode_idx]++;
-      }
-      if (bucket == DB_DLL_CRC_FAILED && mode_idx < this->diag_60min_mode_crc_failed_.size()) {
-        this->diag_60min_mode_crc_failed_[mode_idx]++;
+      this->diag_.dropped_by_bucket[bucket]++;
+      if (bucket == DB_DLL_CRC_FAILED && mode_idx < this->diag_.mode_crc_failed.size()) {
+        this->diag_.mode_crc_failed[mode_idx]++;
       }
 
       if (this->should_publish_packet_event_(p) && mqtt::global_mqtt_client != nullptr && !this->diag_topic_.empty()) {
-        char payload[1280];
-        if (this->diag_publish_raw_) {
-          snprintf(payload, sizeof(payload),
-                   "{\"event\":\"dropped\",\"uptime_ms\":%lu,\"listen_mode\":\"%s\",\"reason\":\"%s\",\"stage\":\"%s\",\"detail\":\"%s\",\"mode\":\"%s\",\"rssi\":%d,\"want\":%u,\"got\":%u,\"raw_got\":%u,\"decoded_len\":%u,\"final_len\":%u,\"dll_crc_removed\":%u,\"suffix_ignored\":%u,\"raw\":\"%s\"}",
-                   (unsigned long) loop_now_ms, listen_mode,
-                   p->drop_reason().c_str(), p->drop_stage().c_str(), p->drop_detail().c_str(),
-                   mode, (int) p->get_rssi(), (unsigned) p->want_len(),
-                   (unsigned) p->got_len(), (unsigned) p->raw_got_len(),
-                   (unsigned) p->decoded_len(), (unsigned) p->final_len(),
-                   (unsigned) p->dll_crc_removed(), (unsigned) p->suffix_ignored(),
-                   p->raw_hex().c_str());
-        } else {
-          snprintf(payload, sizeof(payload),
-                   "{\"event\":\"dropped\",\"uptime_ms\":%lu,\"listen_mode\":\"%s\",\"reason\":\"%s\",\"stage\":\"%s\",\"detail\":\"%s\",\"mode\":\"%s\",\"rssi\":%d,\"want\":%u,\"got\":%u,\"raw_got\":%u,\"decoded_len\":%u,\"final_len\":%u,\"dll_crc_removed\":%u,\"suffix_ignored\":%u}",
-                   (unsigned long) loop_now_ms, listen_mode,
-                   p->drop_reason().c_str(), p->drop_stage().c_str(), p->drop_detail().c_str(),
-                   mode, (int) p->get_rssi(), (unsigned) p->want_len(),
-                   (unsigned) p->got_len(), (unsigned) p->raw_got_len(),
-                   (unsigned) p->decoded_len(), (unsigned) p->final_len(),
-                   (unsigned) p->dll_crc_removed(), (unsigned) p->suffix_ignored());
-        }
-        mqtt::global_mqtt_client->publish(this->diag_topic_, payload);
+        p->format_drop_detail(drop_detail, sizeof(drop_detail));
+        this->publish_packet_event_("dropped", p, loop_now_ms, listen_mode, drop_reason, drop_stage, drop_detail, mode);
       }
 
       if (this->diag_verbose_) {
+        if (drop_detail[0] == '\0') p->format_drop_detail(drop_detail, sizeof(drop_detail));
         ESP_LOGW(TAG,
                  "DROPPED packet / odrzucony pakiet: uptime_ms=%lu listen_mode=%s stage=%s reason=%s mode=%s want=%u got=%u raw_got=%u decoded_len=%u final_len=%u RSSI=%ddBm detail=%s",
-                 (unsigned long) loop_now_ms, listen_mode, p->drop_stage().c_str(), p->drop_reason().c_str(), mode,
+                 (unsigned long) loop_now_ms, listen_mode, drop_stage, drop_reason, mode,
                  (unsigned) p->want_len(), (unsigned) p->got_len(),
                  (unsigned) p->raw_got_len(), (unsigned) p->decoded_len(),
-                 (unsigned) p->final_len(), (int) p->get_rssi(), p->drop_detail().c_str());
+                 (unsigned) p->final_len(), (int) p->get_rssi(), drop_detail);
         if (this->diag_publish_raw_) {
           ESP_LOGW(TAG, "DROPPED raw(hex) / odrzucony pakiet raw(hex)=%s", p->raw_hex().c_str());
         }
       }
     }
 
-    this->collect_radio_rx_diag_();
-    delete p;
+    this->packet_pool_.release(p);
     return;
   }
 
-  this->diag_ok_++;
-  this->diag_15m_ok_++;
-  this->diag_60min_ok_++;
-  this->diag_rssi_ok_sum_ += (int32_t) frame->rssi();
-  this->diag_rssi_ok_n_++;
-  this->diag_15m_rssi_ok_sum_ += (int32_t) frame->rssi();
-  this->diag_15m_rssi_ok_n_++;
-  this->diag_60min_rssi_ok_sum_ += (int32_t) frame->rssi();
-  this->diag_60min_rssi_ok_n_++;
+  this->diag_.ok++;
+  this->diag_.rssi_ok_sum += (int32_t) frame->rssi();
+  this->diag_.rssi_ok_n++;
   if (!this->recent_ok_rssi_valid_) {
     this->recent_ok_rssi_avg_ = (int32_t) frame->rssi();
     this->recent_ok_rssi_valid_ = true;
   } else {
     this->recent_ok_rssi_avg_ = ((this->recent_ok_rssi_avg_ * 7) + (int32_t) frame->rssi()) / 8;
   }
-  if (mode_idx < this->diag_mode_ok_.size()) {
-    this->diag_mode_ok_[mode_idx]++;
-    this->diag_mode_rssi_ok_sum_[mode_idx] += (int32_t) frame->rssi();
-    this->diag_mode_rssi_ok_n_[mode_idx]++;
-  }
-  if (mode_idx < this->diag_15m_mode_ok_.size()) {
-    this->diag_15m_mode_ok_[mode_idx]++;
-    this->diag_15m_mode_rssi_ok_sum_[mode_idx] += (int32_t) frame->rssi();
-    this->diag_15m_mode_rssi_ok_n_[mode_idx]++;
+  if (mode_idx < this->diag_.mode_ok.size()) {
+    this->diag_.mode_ok[mode_idx]++;
+    this->diag_.mode_rssi_ok_sum[mode_idx] += (int32_t) frame->rssi();
+    this->diag_.mode_rssi_ok_n[mode_idx]++;
   }
-  if (mode_idx < this->diag_60min_mode_ok_.size()) {
-    this->diag_60min_mode_ok_[mode_idx]++;
-    this->diag_60min_mode_rssi_ok_sum_[mode_idx] += (int32_t) frame->rssi();
-    this->diag_60min_mode_rssi_ok_n_[mode_idx]++;
+  if (this->radio->uses_sync_schedule()) {
+    this->radio->sync_scheduler().note_hit(p->sync2());
+    this->diag_.sync_hits[SyncScheduler::variant_of(p->sync2())]++;
   }
 
-  this->collect_radio_rx_diag_();
-
   auto &d = frame->data();
 
   const char *mfr = "???";
@@ -811,21 +911,38 @@ if (!this->boot_log_done_ && this->radio != nullptr) {
              mfr, id_str, (unsigned) ver, (unsigned) dev, (unsigned) ci);
   }
 
-  this->maybe_forward_frame_(frame.value(), id_val, id_str, log_tag);
+  // A repeat is still counted and logged above, but neither forwarded nor
+  // handed to the frame handlers.
+  if (id_val != 0 && this->dedup_ttl_ms_ != 0 &&
+      this->is_duplicate_telegram_(frame.value(), id_val, (uint32_t) esphome::millis())) {
+    ESP_LOGD(TAG, "Duplicate telegram suppressed / pominieto powtorzony telegram id=%s mode=%s", id_str,
+             link_mode_name(frame->link_mode()));
+    this->packet_pool_.release(p);
+    return;
+  }
 
-  for (auto &handler : this->handlers_)
-    handler(&frame.value());
+  this->dispatch_frame_(frame.value(), id_val, id_str, log_tag);
 
-  if (frame->handlers_count()) {
-    ESP_LOGI(TAG, "Telegram handled / obsluzono przez %d handlers", frame->handlers_count());
-  } else {
-    // Braces are required: at log level INFO the ESP_LOGD below compiles to an
-    // empty statement, and an unbraced 'else' with an empty body warns
-    // -Wempty-body (seen on the SX1276 arduino build, 2026.7.0).
-    ESP_LOGD(TAG, "Telegram not handled by any handler");
-  }
+  this->packet_pool_.release(p);
+}
 
-  delete p;
+bool Radio::meter_filter_pass_(const MeterHeader &h, bool early, uint32_t now_ms) {
+  bool allow = false;
+  const size_t rule = this->meter_filter_.match(h, allow);
+  auto &c = this->diag_.meter_filter;
+  c.rule_hits[rule]++;
+  if (allow) {
+    c.passed++;
+    return true;
+  }
+  (early ? c.rejected_early : c.rejected_late)++;
+  // A foreign meter still proves the receiver is alive.
+  this->last_rx_ms_ = now_ms;
+  this->any_rx_ = true;
+  ESP_LOGV(TAG, "Rejected by meter_filter (%s, rule %d): mfr=0x%04X id=%08u type=0x%02X ci=0x%02X",
+           early ? "header" : "frame", rule == MeterFilter::DEFAULT_RULE ? -1 : (int) rule, (unsigned) h.mfr,
+           (unsigned) h.id, (unsigned) h.type, (unsigned) h.ci);
+  return false;
 }
 
 void Radio::wakeup_receiver_task_from_isr(TaskHandle_t *arg) {
@@ -835,6 +952,8 @@ void Radio::wakeup_receiver_task_from_isr(TaskHandle_t *arg) {
 }
 
 void Radio::receive_frame() {
+  // This task's counters; receiver_task() publishes them after each frame.
+  RxPathCounters &rx = this->rx_task_counters_.local();
   const uint32_t total_wait_ms = 60000;
   // Hop interval: how often restart_rx() is called while waiting for a packet.
   // 500ms was too aggressive — radio is blind during SPI re-arm, so a packet
@@ -852,12 +971,15 @@ void Radio::receive_frame() {
     }
     waited += hop_ms;
   }
+  // What the radio was armed with when the frame started: restart_rx() may
+  // have moved on by the time the frame is queued.
+  const uint8_t sync2 = this->radio->sync_scheduler().current_sync2();
+  if (got_irq && this->radio->uses_sync_schedule()) {
+    rx.sync_schedule.captures[SyncScheduler::variant_of(sync2)]++;
+  }
   if (!got_irq) {
-    this->diag_rx_path_.irq_timeout++;
-    this->diag_15m_rx_path_.irq_timeout++;
-    this->diag_60min_rx_path_.irq_timeout++;
-    this->collect_radio_rx_diag_();
-    this->publish_rx_path_event_("rx_path", "receive_wait", "interrupt_timeout");
+    rx.irq_timeout++;
+    this->record_rx_path_event_(make_rx_path_event(RxPathStage::RECEIVE_WAIT, RxPathDetail::INTERRUPT_TIMEOUT));
     if (this->diag_verbose_) {
       this->radio->dump_debug_status("interrupt_timeout");
     }
@@ -865,24 +987,37 @@ void Radio::receive_frame() {
     return;
   }
 
-  auto packet = std::make_unique<Packet>();
+  // Take a preallocated slot. A slot that was not queued last time (dropped
+  // attempt) is reused as is; reset() keeps its buffer, so nothing here
+  // allocates.
+  if (this->rx_slot_ == nullptr) {
+    this->rx_slot_ = this->packet_pool_.acquire();
+  } else {
+    this->rx_slot_->reset();
+  }
+  if (this->rx_slot_ == nullptr) {
+    rx.pool_exhausted++;
+    this->record_rx_path_event_(
+        make_rx_path_event(RxPathStage::RECEIVE_SLOT, RxPathDetail::PACKET_POOL_EXHAUSTED, this->radio->get_rssi()));
+    ESP_LOGW(TAG, "Packet pool exhausted, frame dropped / brak wolnych slotow pakietow, ramka odrzucona");
+    return;
+  }
+  Packet *packet = this->rx_slot_;
+  packet->set_sync2(sync2);
 
-  auto queue_packet = [this](std::unique_ptr<Packet> &pkt) -> bool {
+  auto queue_packet = [this, &rx](Packet *pkt) -> bool {
     pkt->set_rssi(this->radio->get_rssi());
-    auto packet_ptr = pkt.get();
-    if (xQueueSend(this->packet_queue_, &packet_ptr, 0) == pdTRUE) {
-      ESP_LOGV(TAG, "Queue items: %zu", uxQueueMessagesWaiting(this->packet_queue_));
+    pkt->set_rx_ms((uint32_t) esphome::millis());
+    if (this->packet_pool_.queue(pkt)) {
+      ESP_LOGV(TAG, "Queue items: %zu", this->packet_pool_.queued());
       ESP_LOGV(TAG, "Queue send success");
-      this->collect_radio_rx_diag_();
-      pkt.release();
+      this->rx_slot_ = nullptr;  // now owned by loop()
       return true;
     }
 
-    this->diag_rx_path_.queue_send_failed++;
-    this->diag_15m_rx_path_.queue_send_failed++;
-    this->diag_60min_rx_path_.queue_send_failed++;
-    this->collect_radio_rx_diag_();
-    this->publish_rx_path_event_("rx_path", "queue_send", "queue_full_or_busy", this->radio->get_rssi());
+    rx.queue_send_failed++;
+    this->record_rx_path_event_(
+        make_rx_path_event(RxPathStage::QUEUE_SEND, RxPathDetail::QUEUE_FULL_OR_BUSY, this->radio->get_rssi()));
     ESP_LOGW(TAG, "Queue send failed / wyslanie do kolejki nie powiodlo sie");
     return false;
   };
@@ -895,34 +1030,29 @@ void Radio::receive_frame() {
     this->radio->read_in_task_partial(raw, max_raw, got_raw, 1, 3);
     packet->resize(got_raw);
     if (got_raw == 0) {
-      this->diag_rx_path_.preamble_read_failed++;
-      this->diag_15m_rx_path_.preamble_read_failed++;
-      this->diag_60min_rx_path_.preamble_read_failed++;
-      this->collect_radio_rx_diag_();
-      this->publish_rx_path_event_("rx_path", "receive_s1_raw", "no_bytes_after_s1_sync", this->radio->get_rssi());
+      rx.preamble_read_failed++;
+      this->record_rx_path_event_(make_rx_path_event(RxPathStage::RECEIVE_S1_RAW, RxPathDetail::NO_BYTES_AFTER_S1_SYNC,
+                                                     this->radio->get_rssi()));
       ESP_LOGV(TAG, "S1 sync IRQ but no raw bytes read");
       return;
     }
-    char detail[96];
-    snprintf(detail, sizeof(detail), "s1_raw_len=%u", (unsigned) got_raw);
-    this->publish_rx_path_event_("rx_path", "receive_s1_raw", detail, this->radio->get_rssi());
+    this->record_rx_path_event_(
+        make_rx_path_event(RxPathStage::RECEIVE_S1_RAW, RxPathDetail::S1_RAW_LEN, this->radio->get_rssi(), got_raw));
     queue_packet(packet);
     return;
   }
 
-  auto raw_drain_fallback = [this, &packet, &queue_packet](const char *stage, const char *reason_detail,
-                                                           size_t already_read, bool is_c_mode) -> bool {
+  // ev describes why the strict path gave up; a drain attempt is reported as
+  // that event with the drain result appended.
+  auto raw_drain_fallback = [this, &rx, &packet, &queue_packet](RxPathEvent ev, size_t already_read,
+                                                                bool is_c_mode) -> bool {
     const int current_rssi = this->radio->get_rssi();
-    if (!this->should_attempt_raw_drain_(current_rssi, already_read, is_c_mode)) {
-      this->diag_rx_path_.raw_drain_skipped_weak++;
-      this->diag_15m_rx_path_.raw_drain_skipped_weak++;
-      this->diag_60min_rx_path_.raw_drain_skipped_weak++;
+    if (!this->should_attempt_raw_drain_(this->rx_task_view_(), current_rssi, already_read, is_c_mode)) {
+      rx.raw_drain_skipped_weak++;
       return false;
     }
 
-    this->diag_rx_path_.raw_drain_attempted++;
-    this->diag_15m_rx_path_.raw_drain_attempted++;
-    this->diag_60min_rx_path_.raw_drain_attempted++;
+    rx.raw_drain_attempted++;
     const size_t max_extra = (already_read < WMBUS_RAW_DRAIN_MAX_BYTES)
                                  ? (WMBUS_RAW_DRAIN_MAX_BYTES - already_read)
                                  : 0;
@@ -932,20 +1062,17 @@ void Radio::receive_frame() {
     size_t extra_read = 0;
     this->radio->read_in_task_partial(tail, max_extra, extra_read, 1, 1);
     packet->resize(already_read + extra_read);
-    this->diag_rx_path_.raw_drain_bytes += (uint32_t) extra_read;
-    this->diag_15m_rx_path_.raw_drain_bytes += (uint32_t) extra_read;
-    this->diag_60min_rx_path_.raw_drain_bytes += (uint32_t) extra_read;
+    rx.raw_drain_bytes += (uint32_t) extra_read;
 
-    char detail[144];
-    snprintf(detail, sizeof(detail), "%s already_read=%u extra=%u final_raw=%u",
-             reason_detail != nullptr ? reason_detail : "raw_drain",
-             (unsigned) already_read, (unsigned) extra_read, (unsigned) packet->size());
-    this->publish_rx_path_event_("rx_path", stage, detail, current_rssi);
+    ev.rssi = rx_path_rssi(current_rssi);
+    ev.flags |= RX_PATH_FLAG_RAW_DRAIN;
+    ev.drain[0] = (uint16_t) already_read;
+    ev.drain[1] = (uint16_t) extra_read;
+    ev.drain[2] = (uint16_t) packet->size();
+    this->record_rx_path_event_(ev);
 
     if (packet->size() > already_read) {
-      this->diag_rx_path_.raw_drain_recovered++;
-      this->diag_15m_rx_path_.raw_drain_recovered++;
-      this->diag_60min_rx_path_.raw_drain_recovered++;
+      rx.raw_drain_recovered++;
       ESP_LOGD(TAG, "Queued raw-drain fallback packet (%u -> %u bytes)",
                (unsigned) already_read, (unsigned) packet->size());
       return queue_packet(packet);
@@ -965,32 +1092,23 @@ void Radio::receive_frame() {
                                         got_retry, 1, 1);
       got_preamble += got_retry;
       if (got_preamble == WMBUS_PREAMBLE_SIZE) {
-        this->diag_rx_path_.preamble_retry_recovered++;
-        this->diag_15m_rx_path_.preamble_retry_recovered++;
-        this->diag_60min_rx_path_.preamble_retry_recovered++;
+        rx.preamble_retry_recovered++;
       }
     }
   }
 
   if (got_preamble < WMBUS_PREAMBLE_SIZE) {
     packet->resize(got_preamble);
-    this->diag_rx_path_.preamble_read_failed++;
-    this->diag_15m_rx_path_.preamble_read_failed++;
-    this->diag_60min_rx_path_.preamble_read_failed++;
+    rx.preamble_read_failed++;
     const int current_rssi = this->radio->get_rssi();
-    char detail[128];
-    snprintf(detail, sizeof(detail), "got=%u need=%u", (unsigned) got_preamble, (unsigned) WMBUS_PREAMBLE_SIZE);
-    if (this->should_abort_weak_partial_start_(current_rssi, got_preamble, false)) {
-      this->diag_rx_path_.weak_start_aborted++;
-      this->diag_15m_rx_path_.weak_start_aborted++;
-      this->diag_60min_rx_path_.weak_start_aborted++;
-      this->diag_rx_path_.weak_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      this->diag_15m_rx_path_.weak_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      this->diag_60min_rx_path_.weak_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      strlcat(detail, " weak_partial_start", sizeof(detail));
+    auto ev = make_rx_path_event(RxPathStage::RECEIVE_PREAMBLE, RxPathDetail::PREAMBLE_SHORT, current_rssi,
+                                 got_preamble, WMBUS_PREAMBLE_SIZE);
+    if (this->should_abort_weak_partial_start_(this->rx_task_view_(), current_rssi, got_preamble, false)) {
+      rx.weak_start_aborted++;
+      rx.weak_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
+      ev.flags |= RX_PATH_FLAG_WEAK_PARTIAL_START;
     }
-    this->collect_radio_rx_diag_();
-    this->publish_rx_path_event_("rx_path", "receive_preamble", detail, current_rssi);
+    this->record_rx_path_event_(ev);
     ESP_LOGV(TAG, "Failed to read preamble");
     return;
   }
@@ -999,67 +1117,45 @@ void Radio::receive_frame() {
   size_t already_read = WMBUS_PREAMBLE_SIZE;
   if (!is_c_mode) {
     const int current_rssi = this->radio->get_rssi();
-    if (this->should_abort_t1_probe_start_(current_rssi)) {
-      this->diag_rx_path_.probe_start_aborted++;
-      this->diag_15m_rx_path_.probe_start_aborted++;
-      this->diag_60min_rx_path_.probe_start_aborted++;
-      this->diag_rx_path_.probe_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      this->diag_15m_rx_path_.probe_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      this->diag_60min_rx_path_.probe_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      this->collect_radio_rx_diag_();
-      this->publish_rx_path_event_("rx_path", "receive_probe_start", "weak_t1_probe_start", current_rssi);
+    if (this->should_abort_t1_probe_start_(this->rx_task_view_(), current_rssi)) {
+      rx.probe_start_aborted++;
+      rx.probe_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
+      this->record_rx_path_event_(
+          make_rx_path_event(RxPathStage::RECEIVE_PROBE_START, RxPathDetail::WEAK_T1_PROBE_START, current_rssi));
       ESP_LOGV(TAG, "Abort weak T1 start before probe read");
       return;
     }
   }
-  if (!is_c_mode && WMBUS_T1_LEN_PROBE_BYTES > WMBUS_PREAMBLE_SIZE) {
-    const size_t extra = WMBUS_T1_LEN_PROBE_BYTES - WMBUS_PREAMBLE_SIZE;
-    auto *hdr = packet->append_space(extra);
-    size_t got_hdr = 0;
-    this->radio->read_in_task_partial(hdr, extra, got_hdr, 1, 1);
-    already_read += got_hdr;
-    if (got_hdr < extra) {
-      this->diag_rx_path_.t1_header_read_failed++;
-      this->diag_15m_rx_path_.t1_header_read_failed++;
-      this->diag_60min_rx_path_.t1_header_read_failed++;
-      packet->resize(already_read);
-      ESP_LOGV(TAG, "Short T1 probe read: got=%u need=%u", (unsigned) got_hdr, (unsigned) extra);
-    }
-  }
-
+  // T1 no longer reads an 18-byte probe first: the packet decodes 3-of-6
+  // symbols as they arrive, so the 3 bytes already read (4 symbols) carry the
+  // L-field. Lengths shorter than the old probe still take the unknown-size
+  // path, as before; no valid T1 frame is that short.
   const size_t total_len = packet->expected_size();
-  if (total_len == 0 || total_len < already_read) {
-    this->diag_rx_path_.payload_size_unknown++;
-    this->diag_15m_rx_path_.payload_size_unknown++;
-    this->diag_60min_rx_path_.payload_size_unknown++;
+  if (total_len == 0 || total_len < already_read || (!is_c_mode && total_len < WMBUS_T1_LEN_PROBE_BYTES)) {
+    rx.payload_size_unknown++;
     const int current_rssi = this->radio->get_rssi();
-    char detail[144];
-    snprintf(detail, sizeof(detail), "total_len=%u already_read=%u", (unsigned) total_len, (unsigned) already_read);
-
-    if (this->should_abort_weak_partial_start_(current_rssi, already_read, is_c_mode)) {
-      this->diag_rx_path_.weak_start_aborted++;
-      this->diag_15m_rx_path_.weak_start_aborted++;
-      this->diag_60min_rx_path_.weak_start_aborted++;
-      this->diag_rx_path_.weak_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      this->diag_15m_rx_path_.weak_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      this->diag_60min_rx_path_.weak_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
-      strlcat(detail, " weak_partial_start", sizeof(detail));
-      this->collect_radio_rx_diag_();
-      this->publish_rx_path_event_("rx_path", "receive_expected_size", detail, current_rssi);
+    auto ev = make_rx_path_event(RxPathStage::RECEIVE_EXPECTED_SIZE, RxPathDetail::PAYLOAD_SIZE_UNKNOWN,
+                                 current_rssi, total_len, already_read);
+
+    if (this->should_abort_weak_partial_start_(this->rx_task_view_(), current_rssi, already_read, is_c_mode)) {
+      rx.weak_start_aborted++;
+      rx.weak_abort_rssi[rssi_abort_bucket_(current_rssi)]++;
+      ev.flags |= RX_PATH_FLAG_WEAK_PARTIAL_START;
+      this->record_rx_path_event_(ev);
       ESP_LOGD(TAG, "Abort weak partial start before raw-drain");
       return;
     }
 
-    if (raw_drain_fallback("receive_expected_size", detail, already_read, is_c_mode)) {
+    if (raw_drain_fallback(ev, already_read, is_c_mode)) {
       return;
     }
-    if (this->diag_rx_path_.raw_drain_skipped_weak > 0 &&
-        this->should_abort_weak_partial_start_(current_rssi, already_read, is_c_mode)) {
-      strlcat(detail, " raw_drain_skipped_weak", sizeof(detail));
+    const RxTaskView &view = this->rx_task_view_();
+    if (view.rx_path.raw_drain_skipped_weak > 0 &&
+        this->should_abort_weak_partial_start_(view, current_rssi, already_read, is_c_mode)) {
+      ev.flags |= RX_PATH_FLAG_RAW_DRAIN_SKIPPED_WEAK;
     }
 
-    this->collect_radio_rx_diag_();
-    this->publish_rx_path_event_("rx_path", "receive_expected_size", detail, current_rssi);
+    this->record_rx_path_event_(ev);
     ESP_LOGD(TAG, "Cannot calculate payload size");
     return;
   }
@@ -1067,25 +1163,59 @@ void Radio::receive_frame() {
   const size_t remaining = total_len - already_read;
   if (remaining > 0) {
     auto *rest = packet->append_space(remaining);
-    if (!this->radio->read_in_task(rest, remaining)) {
+    bool read_ok = true;
+    if (is_c_mode) {
+      read_ok = this->radio->read_in_task(rest, remaining);
+    } else {
+      // T1: read the body in chunks and keep the streaming decoder up to date.
+      // 3-of-6 has no error correction, so the first invalid symbol already
+      // decides the frame; stop there and let the parser record the drop
+      // instead of waiting for (and draining) the rest of a lost frame.
+      size_t done = 0;
+      while (done < remaining) {
+        // The first chunk ends where the old 18-byte probe did, so
+        // t1_header_read_failed keeps its meaning.
+        const size_t have = already_read + done;
+        const size_t chunk = std::min<size_t>(remaining - done, have < WMBUS_T1_LEN_PROBE_BYTES
+                                                                    ? WMBUS_T1_LEN_PROBE_BYTES - have
+                                                                    : WMBUS_T1_STREAM_CHUNK_BYTES);
+        if (!this->radio->read_in_task(rest + done, chunk)) {
+          if (already_read + done < WMBUS_T1_LEN_PROBE_BYTES) {
+            rx.t1_header_read_failed++;
+          }
+          // Keep the complete chunks for the raw-drain fallback below.
+          already_read += done;
+          read_ok = false;
+          break;
+        }
+        done += chunk;
+        if (done < remaining && !packet->t1_stream_update()) {
+          rx.t1_symbol_abort++;
+          packet->resize(already_read + done);
+          ESP_LOGV(TAG, "T1 invalid symbol after %u/%u raw bytes, body read stopped", (unsigned) (already_read + done),
+                   (unsigned) total_len);
+          queue_packet(packet);
+          return;
+        }
+      }
+    }
+    if (!read_ok) {
       packet->resize(already_read);
-      this->diag_rx_path_.payload_read_failed++;
-      this->diag_15m_rx_path_.payload_read_failed++;
-      this->diag_60min_rx_path_.payload_read_failed++;
-      char detail[112];
-      snprintf(detail, sizeof(detail), "remaining=%u total_len=%u already_read=%u", (unsigned) remaining,
-               (unsigned) total_len, (unsigned) already_read);
-
-      if (raw_drain_fallback("receive_payload", detail, already_read, is_c_mode)) {
+      rx.payload_read_failed++;
+      auto ev = make_rx_path_event(RxPathStage::RECEIVE_PAYLOAD, RxPathDetail::PAYLOAD_SHORT, 0, remaining,
+                                   total_len, already_read);
+
+      if (raw_drain_fallback(ev, already_read, is_c_mode)) {
         return;
       }
-      if (this->diag_rx_path_.raw_drain_skipped_weak > 0 &&
-          this->should_abort_weak_partial_start_(this->radio->get_rssi(), already_read, is_c_mode)) {
-        strlcat(detail, " raw_drain_skipped_weak", sizeof(detail));
+      const RxTaskView &view = this->rx_task_view_();
+      if (view.rx_path.raw_drain_skipped_weak > 0 &&
+          this->should_abort_weak_partial_start_(view, this->radio->get_rssi(), already_read, is_c_mode)) {
+        ev.flags |= RX_PATH_FLAG_RAW_DRAIN_SKIPPED_WEAK;
       }
 
-      this->collect_radio_rx_diag_();
-      this->publish_rx_path_event_("rx_path", "receive_payload", detail, this->radio->get_rssi());
+      ev.rssi = rx_path_rssi(this->radio->get_rssi());
+      this->record_rx_path_event_(ev);
       ESP_LOGW(TAG, "Failed to read data / nie udalo sie odczytac danych");
       return;
     }
@@ -1095,8 +1225,11 @@ void Radio::receive_frame() {
 }
 
 void Radio::receiver_task(Radio *arg) {
-  while (true)
+  while (true) {
     arg->receive_frame();
+    arg->collect_radio_rx_diag_();
+    arg->rx_task_counters_.publish();
+  }
 }
 
 void Radio::add_frame_handler(std::function<void(Frame *)> &&callback) {
@@ -13,12 +13,21 @@
 
 #include "esphome/core/component.h"
 #include "esphome/core/gpio.h"
+#include "esphome/core/helpers.h"
 
 #include "esphome/components/spi/spi.h"
 // Keep component lightweight (no full wmbusmeters stack)
+#include "dedup_cache.h"
+#include "frame_store.h"
+#include "json_writer.h"
 #include "link_mode.h"
+#include "meter_filter.h"
 
 #include "packet.h"
+#include "packet_pool.h"
+#include "rx_path_event.h"
+#include "seqlock_counters.h"
+#include "spsc_ring.h"
 #include "transceiver.h"
 
 namespace esphome {
@@ -41,8 +50,55 @@ public:
   void set_telegram_topic(const std::string &topic) { this->telegram_topic_ = topic; }
   void set_target_meter_id_str(const std::string &meter_id) { this->target_meter_id_str_ = meter_id; }
   void set_target_topic(const std::string &topic) { this->target_topic_ = topic; }
+  // More forwarding targets (targets: in YAML), added to target_meter_id.
+  // topic "" uses target_topic_template, or the derived <base>/target_<id>
+  // when that is empty too; "{id}" in either becomes the 8-digit meter id.
+  void add_target(const std::string &meter_id, const std::string &topic) {
+    this->target_specs_.push_back({meter_id, topic});
+  }
+  void set_target_topic_template(const std::string &tmpl) { this->target_topic_template_ = tmpl; }
   void set_target_log(bool enabled) { this->target_log_ = enabled; }
   void set_publish_radio_raw(bool enabled) { this->publish_radio_raw_ = enabled; }
+  // Binary records (telegram_wire.h) instead of hex/JSON text on
+  // telegram_topic, its batches and the raw tap. target_topic stays hex.
+  void set_telegram_binary(bool enabled) { this->telegram_binary_ = enabled; }
+  // Optional telegram batching: coalesce frames for telegram_topic into one
+  // message on <telegram_topic>/batch, flushed at max_frames frames or
+  // max_delay_ms after the first one, whichever comes first. max_frames <= 1
+  // keeps one publish per frame.
+  void set_telegram_batch(uint8_t max_frames, uint32_t max_delay_ms, bool json) {
+    this->telegram_batch_max_frames_ = max_frames;
+    this->telegram_batch_max_delay_ms_ = max_delay_ms;
+    this->telegram_batch_json_ = json;
+  }
+
+  // Forward a telegram repeated within ttl_ms (same meter, same content, any
+  // link mode) only once. 0 = off.
+  void set_duplicate_suppression_ttl(uint32_t ttl_ms) { this->dedup_ttl_ms_ = ttl_ms; }
+
+  // meter_filter: allow/deny rules checked in order, first match decides
+  // (see meter_filter.h). fields is a MeterFilter::Field mask; the other
+  // values are ignored unless their bit is set.
+  void add_meter_filter_rule(bool allow, uint8_t fields, uint16_t mfr, uint32_t id, uint8_t type, uint8_t ci) {
+    MeterFilter::Rule r;
+    r.allow = allow;
+    r.fields = fields;
+    r.mfr = mfr;
+    r.id = id;
+    r.type = type;
+    r.ci = ci;
+    this->meter_filter_.add_rule(r);
+  }
+  void set_meter_filter_default(bool allow) { this->meter_filter_.set_default_allow(allow); }
+
+  // Store-and-forward: while MQTT is down, keep forwarded frames in a ring of
+  // bytes bytes (in PSRAM if psram and available; 0 = off), and replay them
+  // oldest first at up to replay_per_s frames per second once it is back.
+  void set_offline_buffer(uint32_t bytes, bool psram, uint16_t replay_per_s) {
+    this->offline_buffer_bytes_ = bytes;
+    this->offline_buffer_psram_ = psram;
+    this->offline_replay_interval_ms_ = 1000U / (replay_per_s == 0 ? 1U : replay_per_s);
+  }
 
   // Optional log highlighting for selected meter IDs (configured from YAML).
   // Meters are provided as a CSV string in YAML (list is joined in python).
@@ -105,6 +161,11 @@ public:
     this->receiver_task_stack_size_ = stack_size < 2048 ? 2048 : stack_size;
   }
 
+  // loop() keeps taking packets until none is waiting or budget_us has
+  // passed (checked after each packet; at least one is always processed).
+  // 0 = one packet per loop() call, as before.
+  void set_loop_budget_us(uint32_t budget_us) { this->loop_budget_us_ = budget_us; }
+
   void setup() override;
   void loop() override;
   void dump_config() override;
@@ -118,11 +179,26 @@ protected:
 
   RadioTransceiver *radio{nullptr};
   TaskHandle_t receiver_task_handle_{nullptr};
-  QueueHandle_t packet_queue_{nullptr};
+  // Packet slots handed between the receiver task and loop() (replaces the
+  // FreeRTOS queue of heap-allocated packets). rx_slot_ is the slot the
+  // receiver task is filling; it is only touched by that task and is kept
+  // across dropped attempts, so nothing is freed or allocated per frame.
+  PacketPool packet_pool_;
+  Packet *rx_slot_{nullptr};
   // Stack for the dedicated radio_recv task. Default stays at 3 KB so existing
   // configs behave exactly as before unless the user overrides it in YAML.
   uint32_t receiver_task_stack_size_{3 * 1024};
 
+  uint32_t loop_budget_us_{5000};
+  HighFrequencyLoopRequester high_freq_;
+  void drain_packets_(uint32_t loop_now_ms);
+  void process_packet_(Packet *p, uint32_t loop_now_ms);
+
+  // Forwarding and handlers for one frame.
+  void dispatch_frame_(Frame &frame, uint32_t meter_id, const char *id_str, const char *log_tag);
+  // Batch timeout and offline replay.
+  void publish_pending_(uint32_t now_ms);
+
   // Default false = legacy/stable behavior: filter listen_mode by preliminary
   // raw packet mode before running the full parser. True = experimental behavior:
   // parse first, then filter by parser/CRC-selected final mode.
@@ -192,11 +268,89 @@ protected:
   // Optional RAW forwarding / target forwarding.
   std::string telegram_topic_{};
   std::string target_meter_id_str_{};
-  uint32_t target_meter_id_{0};
-  bool target_meter_enabled_{false};
   std::string target_topic_{};
+  std::string target_topic_template_{};
+  // YAML input, resolved into targets_ by setup_targets_() and then freed.
+  struct TargetSpec {
+    std::string meter_id;
+    std::string topic;
+  };
+  std::vector<TargetSpec> target_specs_{};
+  // Forwarding table: sorted by meter id, topics built once in setup(), so
+  // routing a frame is one binary search and no string work.
+  struct ForwardTarget {
+    uint32_t meter_id;
+    std::string topic;
+    std::string replay_topic;  // topic + "/replay", with the offline buffer on
+  };
+  std::vector<ForwardTarget> targets_{};
+  void setup_targets_();
+  const ForwardTarget *target_for_(uint32_t meter_id) const;
   bool target_log_{true};
   bool publish_radio_raw_{false};
+  bool telegram_binary_{false};
+  // One binary record, reserved in setup() for the longest packet. The raw
+  // tap has its own.
+  std::vector<uint8_t> wire_buf_{};
+  std::vector<uint8_t> raw_wire_buf_{};
+
+  // Telegram batching (set_telegram_batch()). The buffer is reserved once in
+  // setup(); a batch that would grow past TELEGRAM_BATCH_MAX_BYTES is flushed
+  // before the frame that does not fit.
+  enum TelegramBatchFlush : uint8_t { TBF_FULL = 0, TBF_TIMEOUT, TBF_BYTES, TBF_OFFLINE };
+  static constexpr size_t TELEGRAM_BATCH_MAX_BYTES = 4096;
+  uint8_t telegram_batch_max_frames_{0};
+  uint32_t telegram_batch_max_delay_ms_{1000};
+  bool telegram_batch_json_{true};
+  std::string telegram_batch_topic_{};
+  std::string telegram_batch_buf_{};
+  uint8_t telegram_batch_frames_{0};
+  uint32_t telegram_batch_first_ms_{0};
+  // With the offline buffer on and a text batch format, the open batch's
+  // frames again as binary records (a binary batch already is one), so a
+  // batch that cannot be sent goes into the offline buffer frame by frame.
+  std::vector<uint8_t> telegram_batch_records_{};
+  bool telegram_batch_enabled_() const {
+    return this->telegram_batch_max_frames_ > 1 && !this->telegram_topic_.empty();
+  }
+  void telegram_batch_add_(Frame &frame, uint32_t now_ms);
+  void telegram_batch_flush_(uint32_t now_ms, TelegramBatchFlush why);
+  void maybe_flush_telegram_batch_(uint32_t now_ms);
+  // Returns how many of the open batch's frames the offline buffer took.
+  uint32_t telegram_batch_to_offline_();
+
+  // Store-and-forward (set_offline_buffer()). Frames for telegram_topic or
+  // the target meter are stored while MQTT is disconnected, and also while
+  // older ones are still waiting, so the order is kept, and when a publish
+  // is refused. loop() replays one record per offline_replay_interval_ms_
+  // through forward_frame_(), and drops it only once that went through.
+  uint32_t offline_buffer_bytes_{0};
+  bool offline_buffer_psram_{false};
+  uint32_t offline_replay_interval_ms_{100};
+  FrameStore offline_store_;
+  std::vector<uint8_t> offline_rec_{};  // one record, reserved in setup()
+  uint32_t offline_last_replay_ms_{0};
+  void offline_store_frame_(Frame &frame);
+  bool offline_store_record_(const TelegramWireHeader &h, const uint8_t *payload, size_t len);
+  void maybe_replay_offline_(uint32_t now_ms);
+  // Returns false when the MQTT client refused a publish.
+  bool forward_frame_(Frame &frame, bool want_all, const ForwardTarget *target, const char *id_str,
+                      const char *log_tag, bool replay = false);
+  // A replayed frame's text payload: {"uptime_ms","age_ms","rssi","mode","hex"}
+  // on <topic>/replay, as plain hex cannot say the frame is late.
+  std::string telegram_replay_topic_{};
+  bool publish_replay_(const std::string &topic, Frame &frame);
+
+  // Duplicate suppression (set_duplicate_suppression_ttl()).
+  static constexpr size_t DEDUP_CACHE_SIZE = 32;
+  uint32_t dedup_ttl_ms_{0};
+  DedupCache<DEDUP_CACHE_SIZE> dedup_cache_;
+  bool is_duplicate_telegram_(Frame &frame, uint32_t meter_id, uint32_t now_ms);
+
+  MeterFilter meter_filter_;
+  // Counts the decision; false = drop the packet. early: decided on the raw
+  // header, before convert_to_frame().
+  bool meter_filter_pass_(const MeterHeader &h, bool early, uint32_t now_ms);
 
   // Highlight configuration
   std::string highlight_meters_csv_{};
@@ -272,7 +426,12 @@ protected:
     uint32_t raw_drain_recovered{0};
     uint32_t raw_drain_bytes{0};
     uint32_t payload_read_failed{0};
+    // T1 body read stopped early: the streaming 3-of-6 decode hit an invalid
+    // symbol, so the frame was already lost (no FEC) and the rest was not read.
+    uint32_t t1_symbol_abort{0};
     uint32_t queue_send_failed{0};
+    // IRQ arrived while every packet slot was queued or being processed.
+    uint32_t pool_exhausted{0};
     uint32_t fifo_overrun{0};
     uint32_t weak_start_aborted{0};
     uint32_t probe_start_aborted{0};
@@ -281,107 +440,214 @@ protected:
     // Buckets: [0]>-70  [1]-70..-79  [2]-80..-89  [3]-90..-99  [4]<=-100
     uint32_t probe_abort_rssi[5]{};
     uint32_t weak_abort_rssi[5]{};
+    // rx-path events not published because rx_path_events_ was full.
+    uint32_t events_lost{0};
+    StreamCaptureStats stream_capture{};
+    SyncScheduleStats sync_schedule{};
+    RearmStats rearm{};
+    FifoDrainStats fifo_drain{};
+  };
+
+  // Telegram batching. Histograms rather than maxima, so windows can be
+  // summed like every other counter.
+  struct TelegramBatchCounters {
+    uint32_t batches{0};
+    uint32_t frames{0};
+    uint32_t flush_full{0};
+    uint32_t flush_timeout{0};
+    uint32_t flush_bytes{0};
+    // Flushed early because MQTT went down with the offline buffer on.
+    uint32_t flush_offline{0};
+    // Frames in batches the MQTT client did not accept, unless the offline
+    // buffer took them.
+    uint32_t frames_dropped{0};
+    // Age of the oldest frame when its batch was flushed.
+    uint32_t latency_sum_ms{0};
+    // Frames per batch: [0]1 [1]2-3 [2]4-7 [3]8-15 [4]16+
+    uint32_t size_hist[5]{};
+    // Flush latency: [0]<100ms [1]100-499 [2]500-1999 [3]>=2000
+    uint32_t latency_hist[4]{};
+  };
+
+  struct OfflineBufferCounters {
+    uint32_t buffered{0};
+    // Stored frames evicted, oldest first, to make room for newer ones.
+    uint32_t evicted{0};
+    uint32_t replayed{0};
+    // Records that no longer decoded when replayed; dropped.
+    uint32_t corrupt{0};
+  };
+
+  struct MeterFilterCounters {
+    uint32_t passed{0};
+    // Rejected on the raw header (no parse) / on the parsed frame.
+    uint32_t rejected_early{0};
+    uint32_t rejected_late{0};
+    // Decisions per rule; the last entry counts the default.
+    uint32_t rule_hits[MeterFilter::MAX_RULES + 1]{};
+  };
+
+  // loop() passes that processed at least one packet (drain_packets_()).
+  struct LoopDrainCounters {
+    uint32_t loops{0};
+    uint32_t packets{0};
+    // Packets per pass: [0]1 [1]2 [2]3 [3]4+
+    uint32_t per_loop_hist[4]{};
+    // Passes that stopped on loop_budget_us_ with packets still waiting.
+    uint32_t budget_exhausted{0};
   };
 
   SX1276BusyEtherMode sx1276_busy_ether_mode_{SX1276BusyEtherMode::ADAPTIVE};
 
-  // Windowed counters (reset after each published summary)
-  uint32_t diag_total_{0};
-  uint32_t diag_ok_{0};
-  uint32_t diag_truncated_{0};
-  uint32_t diag_dropped_{0};
-  // RSSI aggregates (integer averages)
-  int32_t diag_rssi_ok_sum_{0};
-  uint32_t diag_rssi_ok_n_{0};
-  int32_t diag_rssi_drop_sum_{0};
-  uint32_t diag_rssi_drop_n_{0};
-
-  // Per-mode window stats (index: (uint8_t)LinkMode)
-  std::array<uint32_t, 4> diag_mode_total_{};
-  std::array<uint32_t, 4> diag_mode_ok_{};
-  std::array<uint32_t, 4> diag_mode_dropped_{};
-  std::array<uint32_t, 4> diag_mode_crc_failed_{};
-  std::array<int32_t, 4> diag_mode_rssi_ok_sum_{};
-  std::array<uint32_t, 4> diag_mode_rssi_ok_n_{};
-  std::array<int32_t, 4> diag_mode_rssi_drop_sum_{};
-  std::array<uint32_t, 4> diag_mode_rssi_drop_n_{};
-
-  std::array<uint32_t, DB_COUNT> diag_dropped_by_bucket_{};
-  std::array<uint32_t, SB_COUNT> diag_dropped_by_stage_{};
-  RxPathCounters diag_rx_path_{};
-
-  // Independent 15-minute diagnostic counters (disabled when publish flag = false).
-  uint32_t diag_15m_total_{0};
-  uint32_t diag_15m_ok_{0};
-  uint32_t diag_15m_truncated_{0};
-  uint32_t diag_15m_dropped_{0};
-  int32_t diag_15m_rssi_ok_sum_{0};
-  uint32_t diag_15m_rssi_ok_n_{0};
-  int32_t diag_15m_rssi_drop_sum_{0};
-  uint32_t diag_15m_rssi_drop_n_{0};
-  std::array<uint32_t, 4> diag_15m_mode_total_{};
-  std::array<uint32_t, 4> diag_15m_mode_ok_{};
-  std::array<uint32_t, 4> diag_15m_mode_dropped_{};
-  std::array<uint32_t, 4> diag_15m_mode_crc_failed_{};
-  std::array<int32_t, 4> diag_15m_mode_rssi_ok_sum_{};
-  std::array<uint32_t, 4> diag_15m_mode_rssi_ok_n_{};
-  std::array<int32_t, 4> diag_15m_mode_rssi_drop_sum_{};
-  std::array<uint32_t, 4> diag_15m_mode_rssi_drop_n_{};
-  std::array<uint32_t, DB_COUNT> diag_15m_dropped_by_bucket_{};
-  std::array<uint32_t, SB_COUNT> diag_15m_dropped_by_stage_{};
-  RxPathCounters diag_15m_rx_path_{};
-
-  // Independent 60-minute diagnostic counters (disabled when publish flag = false).
-  uint32_t diag_60min_total_{0};
-  uint32_t diag_60min_ok_{0};
-  uint32_t diag_60min_truncated_{0};
-  uint32_t diag_60min_dropped_{0};
-  int32_t diag_60min_rssi_ok_sum_{0};
-  uint32_t diag_60min_rssi_ok_n_{0};
-  int32_t diag_60min_rssi_drop_sum_{0};
-  uint32_t diag_60min_rssi_drop_n_{0};
-  std::array<uint32_t, 4> diag_60min_mode_total_{};
-  std::array<uint32_t, 4> diag_60min_mode_ok_{};
-  std::array<uint32_t, 4> diag_60min_mode_dropped_{};
-  std::array<uint32_t, 4> diag_60min_mode_crc_failed_{};
-  std::array<int32_t, 4> diag_60min_mode_rssi_ok_sum_{};
-  std::array<uint32_t, 4> diag_60min_mode_rssi_ok_n_{};
-  std::array<int32_t, 4> diag_60min_mode_rssi_drop_sum_{};
-  std::array<uint32_t, 4> diag_60min_mode_rssi_drop_n_{};
-  std::array<uint32_t, DB_COUNT> diag_60min_dropped_by_bucket_{};
-  std::array<uint32_t, SB_COUNT> diag_60min_dropped_by_stage_{};
-  RxPathCounters diag_60min_rx_path_{};
-
-  // T1 symbol-level diagnostics (windowed, reset after each summary)
-  uint32_t diag_t1_symbols_total_{0};
-  uint32_t diag_t1_symbols_invalid_{0};
-  uint32_t diag_15m_t1_symbols_total_{0};
-  uint32_t diag_15m_t1_symbols_invalid_{0};
-  uint32_t diag_60min_t1_symbols_total_{0};
-  uint32_t diag_60min_t1_symbols_invalid_{0};
+  // Everything one diagnostic window counts. Only 32-bit fields (and arrays
+  // of them): windows are combined word by word, see diag_counters_fold_().
+  struct DiagCounters {
+    uint32_t total{0};
+    uint32_t ok{0};
+    uint32_t truncated{0};
+    uint32_t dropped{0};
+    int32_t rssi_ok_sum{0};
+    uint32_t rssi_ok_n{0};
+    int32_t rssi_drop_sum{0};
+    uint32_t rssi_drop_n{0};
+    // Per-mode stats (index = (uint8_t) LinkMode)
+    std::array<uint32_t, 4> mode_total{};
+    std::array<uint32_t, 4> mode_ok{};
+    std::array<uint32_t, 4> mode_dropped{};
+    std::array<uint32_t, 4> mode_crc_failed{};
+    std::array<int32_t, 4> mode_rssi_ok_sum{};
+    std::array<uint32_t, 4> mode_rssi_ok_n{};
+    std::array<int32_t, 4> mode_rssi_drop_sum{};
+    std::array<uint32_t, 4> mode_rssi_drop_n{};
+    std::array<uint32_t, DB_COUNT> dropped_by_bucket{};
+    std::array<uint32_t, SB_COUNT> dropped_by_stage{};
+    RxPathCounters rx_path{};
+    TelegramBatchCounters telegram_batch{};
+    OfflineBufferCounters offline_buffer{};
+    // Telegrams not forwarded by duplicate suppression, by link mode of the
+    // repeat, and live cache entries evicted to make room.
+    std::array<uint32_t, 4> mode_duplicates{};
+    uint32_t dedup_evicted_live{0};
+    MeterFilterCounters meter_filter{};
+    LoopDrainCounters loop_drain{};
+    // Valid frames by the second sync byte armed when they started:
+    // [0] 0x3D, [1] 0xCD (SyncScheduler::variant_of()).
+    std::array<uint32_t, 2> sync_hits{};
+    // T1 symbol-level diagnostics
+    uint32_t t1_symbols_total{0};
+    uint32_t t1_symbols_invalid{0};
+  };
+
+  // Diagnostic windows. Every event is counted once into diag_: the current
+  // summary interval (1 min by default), which the adaptive RF logic also
+  // reads. loop() owns diag_; receiver-task counts reach it through
+  // diag_sync_rx_task_(), below. When that interval closes it is folded into
+  // one accumulator per longer window and cleared. A longer window's summary
+  // is its accumulator plus the still-open interval, so it never lags by up
+  // to one interval; after publishing, the accumulator is set to minus the
+  // open interval (mod 2^32), so the part already reported cancels out when
+  // that interval is folded in. Another window (24 h, say) costs one more
+  // accumulator and no work per packet.
+  enum DiagWindow : uint8_t { DW_15MIN = 0, DW_60MIN, DW_COUNT };
+  DiagCounters diag_{};
+  std::array<DiagCounters, DW_COUNT> diag_windows_{};
+  void diag_close_interval_();
+  void diag_window_counters_(DiagWindow window, DiagCounters &out) const;
+  void diag_window_reset_(DiagWindow window);
+
+  // Packet-queue high-water marks. Maxima do not add up like the counters,
+  // so every window keeps its own, cleared when that window is published;
+  // QHW_INTERVAL is the summary interval.
+  struct QueueHighWater {
+    uint32_t packet{0};
+  };
+  static constexpr size_t QHW_INTERVAL = DW_COUNT;
+  std::array<QueueHighWater, DW_COUNT + 1> queue_hwm_{};
+  void note_queue_depth_(uint32_t packet) {
+    for (auto &h : this->queue_hwm_) {
+      if (packet > h.packet) h.packet = packet;
+    }
+  }
+
+  // Counter exchange between the radio_recv task and loop(), neither of which
+  // ever blocks the other (see SeqlockCounters).
+  //
+  // receive_frame() counts into rx_task_counters_.local(), which is never
+  // reset, and receiver_task() publishes it after each frame. loop() reads a
+  // snapshot each pass and adds what changed since rx_task_seen_ to
+  // diag_.rx_path, so closing an interval is a loop-only affair.
+  //
+  // The other way round, loop() publishes the loop-owned numbers the receive
+  // heuristics need (LoopRxStats). The receiver combines them with its own
+  // counts since the interval started into rx_view_, see rx_task_view_().
+  struct LoopRxStats {
+    uint32_t total{0};
+    uint32_t ok{0};
+    uint32_t t1_symbols_total{0};
+    uint32_t t1_symbols_invalid{0};
+    int32_t recent_ok_rssi_avg{-80};
+    uint32_t recent_ok_rssi_valid{0};
+    // Bumped when loop() closes a summary interval.
+    uint32_t interval{0};
+  };
+  struct RxTaskView {
+    RxPathCounters rx_path{};
+    LoopRxStats loop{};
+  };
+  SeqlockCounters<RxPathCounters> rx_task_counters_;
+  RxPathCounters rx_task_seen_{};
+  SeqlockCounters<LoopRxStats> loop_rx_stats_;
+  // Receiver task only.
+  RxTaskView rx_view_{};
+  RxPathCounters rx_view_base_{};
+  uint32_t rx_view_interval_{0};
+  void diag_sync_rx_task_();
+  void publish_loop_rx_stats_();
+
+  const RxTaskView &rx_task_view_();
+
   uint32_t last_diag_summary_ms_{0};
   uint32_t last_diag_15min_summary_ms_{0};
   uint32_t last_diag_60min_summary_ms_{0};
   int32_t recent_ok_rssi_avg_{-80};
   bool recent_ok_rssi_valid_{false};
 
-  static DropBucket bucket_for_reason_(const std::string &reason);
-  static StageBucket bucket_for_stage_(const std::string &stage);
+  static DropBucket bucket_for_reason_(DropReason reason);
+  static StageBucket bucket_for_stage_(DropStage stage);
   bool meter_is_highlighted_(uint32_t meter_id) const;
   void collect_radio_rx_diag_();
-  uint32_t current_false_start_like_() const;
+  static uint32_t current_false_start_like_(const RxPathCounters &rx);
   bool sx1276_busy_ether_aggressive_now_() const;
-  bool sx1276_busy_ether_severe_now_() const;
-  bool should_abort_weak_partial_start_(int rssi_dbm, size_t bytes_read, bool is_c_mode) const;
-  bool should_abort_t1_probe_start_(int rssi_dbm) const;
-  bool should_attempt_raw_drain_(int rssi_dbm, size_t bytes_read, bool is_c_mode) const;
-  std::string derived_target_topic_() const;
+  bool sx1276_busy_ether_severe_now_(const RxTaskView &v) const;
+  bool should_abort_weak_partial_start_(const RxTaskView &v, int rssi_dbm, size_t bytes_read, bool is_c_mode) const;
+  bool should_abort_t1_probe_start_(const RxTaskView &v, int rssi_dbm) const;
+  bool should_attempt_raw_drain_(const RxTaskView &v, int rssi_dbm, size_t bytes_read, bool is_c_mode) const;
+  std::string target_topic_for_(uint32_t meter_id, const std::string &topic) const;
   void maybe_forward_frame_(Frame &frame, uint32_t meter_id, const char *id_str, const char *log_tag);
   void maybe_publish_radio_raw_(Packet *packet, uint32_t now_ms);
   bool should_publish_packet_event_(const Packet *packet) const;
+  void publish_packet_event_(const char *event, const Packet *p, uint32_t now_ms, const char *listen_mode,
+                             const char *drop_reason, const char *drop_stage, const char *drop_detail,
+                             const char *mode);
+
+  // Every JSON payload is built in json_buf_, allocated once in setup(): loop()
+  // publishes one payload at a time, so one buffer serves all of them and the
+  // largest (the summary) no longer sits on the loop task's stack.
+  // JSON_BUF_BYTES covers the summary with every optional field (about 2.2 KB
+  // without them, up to ~4.2 KB with batching, the offline buffer, meter_filter,
+  // stream capture, re-arms, FIFO draining and the sync schedule); the meter
+  // snapshot adds METER_SNAPSHOT_ENTRY_BYTES per highlight meter and link mode.
+  static constexpr size_t JSON_BUF_BYTES = 4608;
+  static constexpr size_t METER_SNAPSHOT_ENTRY_BYTES = 256;
+  std::vector<char> json_buf_{};
+  JsonWriter json_writer_() { return JsonWriter(this->json_buf_.data(), this->json_buf_.size()); }
+  // Publishes a complete payload; a truncated one is logged and not sent.
+  bool publish_json_(const std::string &topic, const JsonWriter &w, bool retain = false);
   void maybe_publish_diag_summary_(uint32_t now_ms);
   void maybe_publish_diag_15min_summary_(uint32_t now_ms);
   void maybe_publish_diag_60min_summary_(uint32_t now_ms);
+  void publish_diag_summary_(const DiagCounters &c, uint32_t elapsed_ms, uint32_t now_ms, const std::string &topic,
+                             const char *log_label, bool with_busy_ether_state, const QueueHighWater &hwm);
   std::string diag_summary_topic_() const;
   std::string diag_summary_15min_topic_() const;
   std::string diag_summary_60min_topic_() const;
@@ -402,7 +668,13 @@ protected:
   uint32_t last_meter_window_ms_{0};
   // Count-based trigger: publish after this many packets per window (0 = disabled)
   uint32_t meter_window_count_threshold_{10};
-  void publish_rx_path_event_(const char *event, const char *stage, const char *detail = nullptr, int rssi = 0);
+
+  // rx-path events: recorded by the receiver task, published from loop().
+  static constexpr size_t RX_PATH_EVENT_RING_SIZE = 16;
+  SpscRing<RxPathEvent, RX_PATH_EVENT_RING_SIZE> rx_path_events_;
+  void record_rx_path_event_(RxPathEvent ev);
+  void publish_rx_path_events_();
+  static void format_rx_path_detail_(const RxPathEvent &ev, char *out, size_t out_len);
 
   // Boot log / boot info fields
   bool boot_log_done_{false};
@@ -435,6 +707,9 @@ protected:
   // Throttled per suggestion code — at most once per hour per code.
   std::unordered_map<std::string, uint32_t> last_suggestion_ms_{};
   void maybe_publish_suggestion_(uint32_t now_ms);
+  void publish_suggestion_(const std::string &topic, uint32_t now_ms, const char *chip, const char *code,
+                           const char *yaml_key, const char *suggested_value, const char *yaml_snippet,
+                           const char *hint_en, const char *hint_pl);
   std::string diag_suggestion_topic_() const;
   static constexpr uint32_t SUGGESTION_THROTTLE_MS_ = 60U * 60U * 1000U; // 1 hour
 
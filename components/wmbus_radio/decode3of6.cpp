@@ -6,7 +6,8 @@
 
 namespace esphome {
 namespace wmbus_radio {
-static const char *TAG = "3of6";
+// Kept for the commented-out logs below.
+[[maybe_unused]] static const char *TAG = "3of6";
 
 // Flat 6-bit -> nibble lookup. `code` is always masked to 0..63 below, so a
 // 64-entry array is a direct index (O(1), cache-friendly) instead of an
@@ -14,7 +15,7 @@ static const char *TAG = "3of6";
 // of the 16-symbol 3-of-6 alphabet (EN 13757-4); seeing one means a bit error
 // or collision, exactly like a failed map lookup did before.
 static constexpr uint8_t INVALID = 0xFF;
-static const uint8_t LOOKUP_3OF6[64] = {
+static constexpr uint8_t LOOKUP_3OF6[64] = {
     // 0x00-0x07
     INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
     // 0x08-0x0F
@@ -33,65 +34,102 @@ static const uint8_t LOOKUP_3OF6[64] = {
     INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID, INVALID,
 };
 
-std::optional<std::vector<uint8_t>>
-decode3of6(const std::vector<uint8_t> &coded_data, Decode3of6Stats *stats) {
+// Paired-symbol lookup: 12 raw bits (two 6-bit symbols) -> one decoded byte in
+// bits 7..0 and the number of invalid symbols among the two (0..2) in bits
+// 9..8. Three raw bytes are exactly four symbols, so the hot loop turns every
+// 3 raw bytes into 2 decoded bytes with two lookups and no per-symbol shifting
+// or branching. Generated at compile time from LOOKUP_3OF6; 8 KB of flash.
+struct PairLookup3of6 {
+  uint16_t entries[4096];
+  constexpr PairLookup3of6() : entries() {
+    for (int i = 0; i < 4096; i++) {
+      const uint8_t hi = LOOKUP_3OF6[i >> 6];
+      const uint8_t lo = LOOKUP_3OF6[i & 0x3F];
+      const uint16_t invalid = (uint16_t) ((hi == INVALID ? 1 : 0) + (lo == INVALID ? 1 : 0));
+      const uint16_t byte = (uint16_t) (((hi == INVALID ? 0 : hi) << 4) | (lo == INVALID ? 0 : lo));
+      this->entries[i] = (uint16_t) ((invalid << 8) | byte);
+    }
+  }
+};
+static constexpr PairLookup3of6 PAIR_LOOKUP_3OF6{};
 
-  // ESP_LOGD(TAG, "Decoding 3of6 data: %s", format_hex(coded_data).c_str());
+uint16_t decode3of6_pair(uint16_t bits12) { return PAIR_LOOKUP_3OF6.entries[bits12 & 0x0FFF]; }
 
-  std::vector<uint8_t> decodedBytes;
-  // Number of 6-bit symbols that can be extracted from the coded buffer.
-  // NOTE: decoding a symbol can span across byte boundary, so we must guard
-  // against reading past the end of the buffer.
-  auto segments = coded_data.size() * 8 / 6;
-  auto data = coded_data.data();
+size_t decoded_size(size_t coded_len) {
+  const size_t symbols = coded_len * 8 / 6;
+  return (symbols + 1) / 2;
+}
 
-  uint16_t invalid = 0;
+bool decode3of6_into(const uint8_t *coded, size_t coded_len, uint8_t *out, size_t out_cap, size_t *decoded_len,
+                     Decode3of6Stats *stats) {
+  // Number of 6-bit symbols that can be extracted from the coded buffer.
+  // Partial trailing bits (fewer than 6) are ignored, as before.
+  const size_t symbols = coded_len * 8 / 6;
   if (stats != nullptr) {
-    stats->symbols_total = (uint16_t) segments;
+    stats->symbols_total = (uint16_t) symbols;
     stats->symbols_invalid = 0;
   }
+  if (decoded_len != nullptr) *decoded_len = 0;
+  if (out_cap < decoded_size(coded_len)) return false;
+
+  const uint16_t *pair = PAIR_LOOKUP_3OF6.entries;
+  uint16_t invalid = 0;
+  size_t in = 0;
+  size_t o = 0;
 
-  for (size_t i = 0; i < segments; i++) {
-    auto bit_idx = i * 6;
-    auto byte_idx = bit_idx / 8;
-    auto bit_offset = bit_idx % 8;
-
-    uint8_t code = (data[byte_idx] << bit_offset);
-    if (bit_offset > 0) {
-      // Guard against out-of-bounds for the last symbol.
-      uint8_t next = 0;
-      if ((byte_idx + 1) < coded_data.size())
-        next = data[byte_idx + 1];
-      code |= (next >> (8 - bit_offset));
+  // Main loop: 3 raw bytes = 24 bits = 4 symbols = 2 decoded bytes.
+  for (; in + 3 <= coded_len; in += 3, o += 2) {
+    const uint32_t bits = ((uint32_t) coded[in] << 16) | ((uint32_t) coded[in + 1] << 8) | coded[in + 2];
+    const uint16_t hi = pair[bits >> 12];
+    const uint16_t lo = pair[bits & 0x0FFF];
+    out[o] = (uint8_t) hi;
+    out[o + 1] = (uint8_t) lo;
+    if (((hi | lo) >> 8) != 0) {
+      if (stats == nullptr) return false;  // fail-fast: nobody wants the count
+      invalid += (uint16_t) ((hi >> 8) + (lo >> 8));
     }
-    code >>= 2;
+  }
 
-    // `code` holds the 6-bit symbol in bits 5..0 (top two bits already shifted
-    // out above), so it is guaranteed to be 0..63 — a safe direct LUT index.
-    const uint8_t nibble = LOOKUP_3OF6[code];
+  // Tail: one raw byte left holds one symbol (high nibble only, like the odd
+  // trailing symbol always produced); two raw bytes hold two symbols.
+  const size_t rest = coded_len - in;
+  if (rest == 1) {
+    const uint8_t nibble = LOOKUP_3OF6[coded[in] >> 2];
     if (nibble == INVALID) {
-      // Invalid 6-bit symbol.
       invalid++;
-      // Keep alignment so we can continue counting and preserve nibble pairing.
-      // We still return nullopt at the end if any invalid symbols were seen.
-      if (i % 2 == 0)
-        decodedBytes.push_back(0x00);
-      continue;
+      out[o++] = 0x00;
+    } else {
+      out[o++] = (uint8_t) (nibble << 4);
     }
-
-    if (i % 2 == 0)
-      decodedBytes.push_back(nibble << 4);
-    else
-      decodedBytes.back() |= nibble;
+  } else if (rest == 2) {
+    const uint16_t e = pair[(((uint32_t) coded[in] << 8) | coded[in + 1]) >> 4];
+    out[o++] = (uint8_t) e;
+    invalid += (uint16_t) (e >> 8);
   }
 
   if (stats != nullptr) {
     stats->symbols_invalid = invalid;
   }
-
   if (invalid > 0) {
+    return false;
+  }
+
+  if (decoded_len != nullptr) *decoded_len = o;
+  return true;
+}
+
+std::optional<std::vector<uint8_t>>
+decode3of6(const std::vector<uint8_t> &coded_data, Decode3of6Stats *stats) {
+
+  // ESP_LOGD(TAG, "Decoding 3of6 data: %s", format_hex(coded_data).c_str());
+
+  std::vector<uint8_t> decodedBytes(decoded_size(coded_data.size()));
+  size_t decoded_len = 0;
+  if (!decode3of6_into(coded_data.data(), coded_data.size(), decodedBytes.data(), decodedBytes.size(), &decoded_len,
+                       stats)) {
     return {};
   }
+  decodedBytes.resize(decoded_len);
 
   // ESP_LOGV(TAG, "Successfully decoded %zu bytes", decodedBytes.size());
   return decodedBytes;
@@ -103,4 +141,4 @@ size_t encoded_size(size_t decoded_size) {
   return (3 * decoded_size + 1) / 2;
 }
 } // namespace wmbus_radio
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <vector>
@@ -16,8 +17,29 @@ struct Decode3of6Stats {
   uint16_t symbols_invalid{0};
 };
 
+// Decode `coded_len` raw 3-of-6 bytes into the caller's buffer `out`, which
+// must hold at least decoded_size(coded_len) bytes. On success returns true and
+// stores the number of decoded bytes in *decoded_len.
+//
+// With `stats` set, every symbol is examined so symbols_invalid is the full
+// count. Without it the decoder is fail-fast: it returns false at the first
+// 3-byte group holding an invalid symbol, which is all a caller that only
+// wants "decodes or not" needs.
+bool decode3of6_into(const uint8_t *coded, size_t coded_len, uint8_t *out, size_t out_cap, size_t *decoded_len,
+                     Decode3of6Stats *stats = nullptr);
+
+// One entry of the paired-symbol table: 12 raw bits (two symbols, first one
+// in bits 11..6) -> decoded byte in bits 7..0 and the number of invalid
+// symbols (0..2) in bits 9..8. Lets streaming callers decode as bytes arrive.
+uint16_t decode3of6_pair(uint16_t bits12);
+
+// Convenience wrapper returning a new vector (same stats/fail-fast rules).
 std::optional<std::vector<uint8_t>>
 decode3of6(const std::vector<uint8_t> &coded_data, Decode3of6Stats *stats = nullptr);
+
+// Number of bytes decode3of6_into() produces for `coded_len` raw bytes. An odd
+// trailing symbol yields a final byte with only its high nibble set.
+size_t decoded_size(size_t coded_len);
 size_t encoded_size(size_t decoded_size);
 } // namespace wmbus_radio
 } // namespace esphome
\ No newline at end of file
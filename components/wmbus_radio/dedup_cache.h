@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace wmbus_radio {
+
+// Recently forwarded telegrams, so a repeat is forwarded once
+// (duplicate_suppression_ttl).
+//
+// Meters repeat a telegram several times, and dual-mode meters send the same
+// one on T1 and C1. An entry is (meter id, hash of the telegram from the
+// C-field on, first-seen ms); the L-field is left out because it differs
+// between frame formats A and B for the same content. A telegram whose entry
+// is younger than the TTL is a duplicate. The TTL runs from the first copy:
+// repeats do not extend it, so a meter that really sends the same reading
+// every few minutes is still forwarded once per TTL.
+//
+// N entries, linear scan, no heap: with a TTL of a few seconds only the
+// meters heard in those seconds are live. A miss takes an expired slot or,
+// failing that, the oldest one; evicting an entry that was still live is
+// counted, since it means a duplicate may get through and N is too small
+// for the TTL.
+template<size_t N> class DedupCache {
+  static_assert(N >= 1, "DedupCache needs at least one entry");
+
+ public:
+  // FNV-1a; cheap and good enough to tell telegrams of one meter apart.
+  static uint32_t hash(const uint8_t *data, size_t len) {
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < len; i++) {
+      h ^= data[i];
+      h *= 16777619U;
+    }
+    return h;
+  }
+
+  // True if (meter_id, h) was first seen less than ttl_ms ago. Otherwise
+  // records it as first seen now and returns false. evicted_live is set when
+  // a still-live entry had to make room.
+  bool seen(uint32_t meter_id, uint32_t h, uint32_t now_ms, uint32_t ttl_ms, bool &evicted_live) {
+    // Victim preference: a free slot, then an expired one, then the oldest
+    // live one.
+    enum : uint8_t { FREE = 0, EXPIRED, LIVE };
+    Entry *victim = nullptr;
+    uint8_t victim_class = LIVE;
+    uint32_t victim_age = 0;
+    for (auto &e : this->entries_) {
+      const uint32_t age = now_ms - e.first_ms;
+      const uint8_t cls = !e.used ? FREE : (age >= ttl_ms ? EXPIRED : LIVE);
+      if (e.used && e.meter_id == meter_id && e.hash == h) {
+        if (cls == LIVE) return true;
+        // Same telegram after the TTL: forward it again, restart the TTL.
+        victim = &e;
+        victim_class = EXPIRED;
+        break;
+      }
+      if (victim == nullptr || cls < victim_class || (cls == LIVE && victim_class == LIVE && age > victim_age)) {
+        victim = &e;
+        victim_class = cls;
+        victim_age = age;
+      }
+    }
+    evicted_live = victim_class == LIVE;
+    victim->used = true;
+    victim->meter_id = meter_id;
+    victim->hash = h;
+    victim->first_ms = now_ms;
+    return false;
+  }
+
+  static constexpr size_t capacity() { return N; }
+
+ protected:
+  struct Entry {
+    uint32_t meter_id{0};
+    uint32_t hash{0};
+    uint32_t first_ms{0};
+    bool used{false};
+  };
+  Entry entries_[N]{};
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
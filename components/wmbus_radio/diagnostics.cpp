@@ -1,10 +1,11 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
 // Diagnostics for the wmbus_radio component: drop/stage bucket classification,
-// RX-path and drop events, actionable suggestions, the health publish and the
-// periodic diagnostic summaries (summary, summary_15min, summary_60min). Split
-// out of component.cpp unchanged (move-only refactor); event names, field names,
-// payload structure, topics and thresholds are identical.
+// RX-path and drop events queued by the receiver task, actionable suggestions,
+// the health publish, the counter block with its 15/60 min windows and the
+// seqlock sync with the receiver task, and the periodic diagnostic summaries
+// (summary, summary_15min, summary_60min) with the loop budget, queue
+// high-water marks and driver RX counters. Runs on the loop task.
 
 #include "component.h"
 #include "wmbus_radio_internal.h"
@@ -26,35 +27,58 @@ namespace wmbus_radio {
 
 static const char *TAG = "wmbus";
 
-Radio::DropBucket Radio::bucket_for_reason_(const std::string &reason) {
-  // Keep this stable: these strings come from Packet::set_drop_()
-  if (reason == "too_short") return DB_TOO_SHORT;
-  if (reason == "decode_failed") return DB_DECODE_FAILED;
-  // Backwards compatible: older builds used dll_crc_strip_failed
-  if (reason == "dll_crc_failed" || reason == "dll_crc_strip_failed") return DB_DLL_CRC_FAILED;
-  if (reason == "unknown_preamble") return DB_UNKNOWN_PREAMBLE;
-  if (reason == "l_field_invalid") return DB_L_FIELD_INVALID;
-  if (reason == "unknown_link_mode") return DB_UNKNOWN_LINK_MODE;
-  return DB_OTHER;
+// DB_UNKNOWN_LINK_MODE and SB_LINK_MODE stay in the summary for payload
+// compatibility; no current parser stage maps to them.
+Radio::DropBucket Radio::bucket_for_reason_(DropReason reason) {
+  switch (reason) {
+    case DropReason::TOO_SHORT:
+      return DB_TOO_SHORT;
+    case DropReason::DECODE_FAILED:
+      return DB_DECODE_FAILED;
+    case DropReason::DLL_CRC_FAILED:
+      return DB_DLL_CRC_FAILED;
+    case DropReason::UNKNOWN_PREAMBLE:
+      return DB_UNKNOWN_PREAMBLE;
+    case DropReason::L_FIELD_INVALID:
+      return DB_L_FIELD_INVALID;
+    default:
+      return DB_OTHER;
+  }
 }
 
-Radio::StageBucket Radio::bucket_for_stage_(const std::string &stage) {
-  if (stage == "precheck") return SB_PRECHECK;
-  if (stage == "t1_decode3of6") return SB_T1_DECODE3OF6;
-  if (stage == "t1_l_field") return SB_T1_L_FIELD;
-  if (stage == "t1_length_check") return SB_T1_LENGTH_CHECK;
-  if (stage == "c1_precheck") return SB_C1_PRECHECK;
-  if (stage == "c1_preamble") return SB_C1_PREAMBLE;
-  if (stage == "c1_suffix") return SB_C1_SUFFIX;
-  if (stage == "c1_l_field") return SB_C1_L_FIELD;
-  if (stage == "c1_length_check") return SB_C1_LENGTH_CHECK;
-  if (stage == "dll_crc_first") return SB_DLL_CRC_FIRST;
-  if (stage == "dll_crc_mid") return SB_DLL_CRC_MID;
-  if (stage == "dll_crc_final") return SB_DLL_CRC_FINAL;
-  if (stage == "dll_crc_b1") return SB_DLL_CRC_B1;
-  if (stage == "dll_crc_b2") return SB_DLL_CRC_B2;
-  if (stage == "link_mode" || stage == "listen_mode_filter") return SB_LINK_MODE;
-  return SB_OTHER;
+Radio::StageBucket Radio::bucket_for_stage_(DropStage stage) {
+  switch (stage) {
+    case DropStage::PRECHECK:
+      return SB_PRECHECK;
+    case DropStage::T1_DECODE3OF6:
+      return SB_T1_DECODE3OF6;
+    case DropStage::T1_L_FIELD:
+      return SB_T1_L_FIELD;
+    case DropStage::T1_LENGTH_CHECK:
+      return SB_T1_LENGTH_CHECK;
+    case DropStage::C1_PRECHECK:
+      return SB_C1_PRECHECK;
+    case DropStage::C1_PREAMBLE:
+      return SB_C1_PREAMBLE;
+    case DropStage::C1_SUFFIX:
+      return SB_C1_SUFFIX;
+    case DropStage::C1_L_FIELD:
+      return SB_C1_L_FIELD;
+    case DropStage::C1_LENGTH_CHECK:
+      return SB_C1_LENGTH_CHECK;
+    case DropStage::DLL_CRC_FIRST:
+      return SB_DLL_CRC_FIRST;
+    case DropStage::DLL_CRC_MID:
+      return SB_DLL_CRC_MID;
+    case DropStage::DLL_CRC_FINAL:
+      return SB_DLL_CRC_FINAL;
+    case DropStage::DLL_CRC_B1:
+      return SB_DLL_CRC_B1;
+    case DropStage::DLL_CRC_B2:
+      return SB_DLL_CRC_B2;
+    default:
+      return SB_OTHER;
+  }
 }
 
 bool Radio::should_publish_packet_event_(const Packet *packet) const {
@@ -66,64 +90,134 @@ bool Radio::should_publish_packet_event_(const Packet *packet) const {
   return this->meter_is_highlighted_(meter_id);
 }
 
-void Radio::publish_rx_path_event_(const char *event, const char *stage, const char *detail, int rssi) {
+// "truncated" and "dropped" events; raw is appended with diag_publish_raw_.
+void Radio::publish_packet_event_(const char *event, const Packet *p, uint32_t now_ms, const char *listen_mode,
+                                  const char *drop_reason, const char *drop_stage, const char *drop_detail,
+                                  const char *mode) {
+  JsonWriter w = this->json_writer_();
+  w.begin_object()
+      .str("event", event)
+      .u32("uptime_ms", now_ms)
+      .str("listen_mode", listen_mode)
+      .str("reason", drop_reason)
+      .str("stage", drop_stage)
+      .str("detail", drop_detail)
+      .str("mode", mode)
+      .i32("rssi", p->get_rssi())
+      .u32("want", p->want_len())
+      .u32("got", p->got_len())
+      .u32("raw_got", p->raw_got_len())
+      .u32("decoded_len", p->decoded_len())
+      .u32("final_len", p->final_len())
+      .u32("dll_crc_removed", p->dll_crc_removed())
+      .u32("suffix_ignored", p->suffix_ignored());
+  if (this->diag_publish_raw_) w.str("raw", p->raw_hex().c_str());
+  w.end_object();
+  this->publish_json_(this->diag_topic_, w);
+}
+
+// Receiver task side: no formatting, no MQTT, no locks. The flag is checked
+// here so a disabled feature costs one branch per event.
+void Radio::record_rx_path_event_(RxPathEvent ev) {
   if (!this->diag_publish_rx_path_events_) return;
-  auto *mqtt = esphome::mqtt::global_mqtt_client;
-  if (mqtt == nullptr || !mqtt->is_connected() || this->diag_topic_.empty()) return;
+  ev.uptime_ms = (uint32_t) esphome::millis();
+  if (!this->rx_path_events_.push(ev)) this->rx_task_counters_.local().events_lost++;
+}
+
+void Radio::format_rx_path_detail_(const RxPathEvent &ev, char *out, size_t out_len) {
+  switch (ev.detail) {
+    case RxPathDetail::INTERRUPT_TIMEOUT:
+      snprintf(out, out_len, "interrupt_timeout");
+      break;
+    case RxPathDetail::PACKET_POOL_EXHAUSTED:
+      snprintf(out, out_len, "packet_pool_exhausted");
+      break;
+    case RxPathDetail::QUEUE_FULL_OR_BUSY:
+      snprintf(out, out_len, "queue_full_or_busy");
+      break;
+    case RxPathDetail::NO_BYTES_AFTER_S1_SYNC:
+      snprintf(out, out_len, "no_bytes_after_s1_sync");
+      break;
+    case RxPathDetail::S1_RAW_LEN:
+      snprintf(out, out_len, "s1_raw_len=%u", (unsigned) ev.value[0]);
+      break;
+    case RxPathDetail::WEAK_T1_PROBE_START:
+      snprintf(out, out_len, "weak_t1_probe_start");
+      break;
+    case RxPathDetail::PREAMBLE_SHORT:
+      snprintf(out, out_len, "got=%u need=%u", (unsigned) ev.value[0], (unsigned) ev.value[1]);
+      break;
+    case RxPathDetail::PAYLOAD_SIZE_UNKNOWN:
+      snprintf(out, out_len, "total_len=%u already_read=%u", (unsigned) ev.value[0], (unsigned) ev.value[1]);
+      break;
+    case RxPathDetail::PAYLOAD_SHORT:
+      snprintf(out, out_len, "remaining=%u total_len=%u already_read=%u", (unsigned) ev.value[0],
+               (unsigned) ev.value[1], (unsigned) ev.value[2]);
+      break;
+    default:
+      out[0] = '\0';
+      break;
+  }
+  if (ev.flags & RX_PATH_FLAG_RAW_DRAIN) {
+    const size_t len = strlen(out);
+    snprintf(out + len, out_len - len, " already_read=%u extra=%u final_raw=%u", (unsigned) ev.drain[0],
+             (unsigned) ev.drain[1], (unsigned) ev.drain[2]);
+  }
+  if (ev.flags & RX_PATH_FLAG_WEAK_PARTIAL_START) strlcat(out, " weak_partial_start", out_len);
+  if (ev.flags & RX_PATH_FLAG_RAW_DRAIN_SKIPPED_WEAK) strlcat(out, " raw_drain_skipped_weak", out_len);
+}
 
-  const uint32_t now_ms = (uint32_t) esphome::millis();
+// loop() side: drain the ring every pass, so it does not stay full (and lose
+// later events) while MQTT is down or the feature was switched off.
+void Radio::publish_rx_path_events_() {
+  auto *mqtt = esphome::mqtt::global_mqtt_client;
+  const bool can_publish = this->diag_publish_rx_path_events_ && mqtt != nullptr && mqtt->is_connected() &&
+                           !this->diag_topic_.empty();
   const char *listen_mode = (this->radio != nullptr)
                                 ? listen_mode_to_string_(this->radio->get_listen_mode())
                                 : "unknown";
 
-  char payload[448];
-  if (detail != nullptr && detail[0] != '\0') {
-    snprintf(payload, sizeof(payload),
-             "{\"event\":\"%s\",\"uptime_ms\":%lu,\"listen_mode\":\"%s\",\"stage\":\"%s\",\"rssi\":%d,\"detail\":\"%s\"}",
-             event, (unsigned long) now_ms, listen_mode, stage, rssi, detail);
-  } else {
-    snprintf(payload, sizeof(payload),
-             "{\"event\":\"%s\",\"uptime_ms\":%lu,\"listen_mode\":\"%s\",\"stage\":\"%s\",\"rssi\":%d}",
-             event, (unsigned long) now_ms, listen_mode, stage, rssi);
+  RxPathEvent ev;
+  while (this->rx_path_events_.pop(ev)) {
+    if (!can_publish) continue;
+    char detail[224];
+    format_rx_path_detail_(ev, detail, sizeof(detail));
+    JsonWriter w = this->json_writer_();
+    w.begin_object()
+        .str("event", "rx_path")
+        .u32("uptime_ms", ev.uptime_ms)
+        .str("listen_mode", listen_mode)
+        .str("stage", rx_path_stage_name(ev.stage))
+        .i32("rssi", ev.rssi)
+        .str("detail", detail)
+        .end_object();
+    this->publish_json_(this->diag_topic_, w);
   }
-  mqtt->publish(this->diag_topic_, payload);
 }
 
 // Publish a suggestion event, throttled to once per hour per code.
 // Suggestions are not retained — they are one-time actionable hints.
 // yaml_snippet is a ready-to-copy YAML fragment the user can paste directly.
-static void publish_suggestion_(esphome::mqtt::MQTTClientComponent *mqtt,
-                                const std::string &topic,
-                                std::unordered_map<std::string, uint32_t> &last_ms,
-                                uint32_t now_ms,
-                                uint32_t throttle_ms,
-                                const char *chip,
-                                const char *code,
-                                const char *yaml_key,
-                                const char *suggested_value,
-                                const char *yaml_snippet,
-                                const char *hint_en,
-                                const char *hint_pl) {
+void Radio::publish_suggestion_(const std::string &topic, uint32_t now_ms, const char *chip, const char *code,
+                                const char *yaml_key, const char *suggested_value, const char *yaml_snippet,
+                                const char *hint_en, const char *hint_pl) {
   if (topic.empty()) return;
-  auto it = last_ms.find(code);
-  if (it != last_ms.end() && (now_ms - it->second) < throttle_ms) return;
-  last_ms[code] = now_ms;
-
-  char payload[640];
-  snprintf(payload, sizeof(payload),
-           "{"
-           "\"event\":\"suggestion\","
-           "\"chip\":\"%s\","
-           "\"code\":\"%s\","
-           "\"yaml_key\":\"%s\","
-           "\"suggested_value\":\"%s\","
-           "\"yaml_snippet\":\"%s\","
-           "\"hint_en\":\"%s\","
-           "\"hint_pl\":\"%s\""
-           "}",
-           chip, code, yaml_key, suggested_value, yaml_snippet, hint_en, hint_pl);
-
-  mqtt->publish(topic, std::string(payload), static_cast<uint8_t>(0), false);
+  auto it = this->last_suggestion_ms_.find(code);
+  if (it != this->last_suggestion_ms_.end() && (now_ms - it->second) < SUGGESTION_THROTTLE_MS_) return;
+  this->last_suggestion_ms_[code] = now_ms;
+
+  JsonWriter w = this->json_writer_();
+  w.begin_object()
+      .str("event", "suggestion")
+      .str("chip", chip)
+      .str("code", code)
+      .str("yaml_key", yaml_key)
+      .str("suggested_value", suggested_value)
+      .str("yaml_snippet", yaml_snippet)
+      .str("hint_en", hint_en)
+      .str("hint_pl", hint_pl)
+      .end_object();
+  this->publish_json_(topic, w);
   ESP_LOGI("wmbus", "SUGGESTION / SUGESTIA [%s]: %s", code, hint_en);
 }
 
@@ -137,16 +231,16 @@ void Radio::maybe_publish_suggestion_(uint32_t now_ms) {
   const bool is_sx1276 = (this->radio != nullptr && strcmp(this->radio->get_name(), "SX1276") == 0);
   const char *chip = is_sx1276 ? "SX1276" : "SX1262";
 
-  const uint32_t fsl = this->current_false_start_like_();
-  const uint32_t total = this->diag_total_;
-  const uint32_t drop_pct = (total > 0) ? (((total - this->diag_ok_) * 100U) / total) : 0U;
-  const uint32_t t1_sym_inv_pct = (this->diag_t1_symbols_total_ > 0)
-      ? ((this->diag_t1_symbols_invalid_ * 100U) / this->diag_t1_symbols_total_) : 0U;
+  const uint32_t fsl = current_false_start_like_(this->diag_.rx_path);
+  const uint32_t total = this->diag_.total;
+  const uint32_t drop_pct = (total > 0) ? (((total - this->diag_.ok) * 100U) / total) : 0U;
+  const uint32_t t1_sym_inv_pct = (this->diag_.t1_symbols_total > 0)
+      ? ((this->diag_.t1_symbols_invalid * 100U) / this->diag_.t1_symbols_total) : 0U;
 
   // ── STAGE 1: orientation ────────────────────────────────────────────────────
   // No packets at all — user may have a wiring/config problem.
   if (total == 0) {
-    publish_suggestion_(mqtt, topic, this->last_suggestion_ms_, now_ms, SUGGESTION_THROTTLE_MS_,
+    this->publish_suggestion_(topic, now_ms,
         chip, "NO_METERS_DETECTED",
         "listen_mode", "t1",
         "listen_mode: t1",
@@ -160,7 +254,7 @@ void Radio::maybe_publish_suggestion_(uint32_t now_ms) {
   // NOTE: check highlight_meter_ids_ (user config), not highlight_meter_stats_ (runtime),
   // because stats may be empty simply because the listed meters haven't been seen yet.
   if (this->highlight_meter_ids_.empty()) {
-    publish_suggestion_(mqtt, topic, this->last_suggestion_ms_, now_ms, SUGGESTION_THROTTLE_MS_,
+    this->publish_suggestion_(topic, now_ms,
         chip, "ADD_HIGHLIGHT_METERS",
         "highlight_meters", "<meter_id>",
         "highlight_meters:\n  - \"<meter_id>\"",
@@ -176,7 +270,7 @@ void Radio::maybe_publish_suggestion_(uint32_t now_ms) {
   // when high fsl is just RF background noise with no actual losses.
   // Skip if already enabled in YAML.
   if (is_sx1276 && fsl >= 80 && drop_pct >= 10 && !this->diag_publish_rx_path_events_) {
-    publish_suggestion_(mqtt, topic, this->last_suggestion_ms_, now_ms, SUGGESTION_THROTTLE_MS_,
+    this->publish_suggestion_(topic, now_ms,
         chip, "ENABLE_RX_PATH_EVENTS",
         "diagnostic_publish_rx_path_events", "true",
         "diagnostic_publish_rx_path_events: true",
@@ -187,10 +281,10 @@ void Radio::maybe_publish_suggestion_(uint32_t now_ms) {
   // Weak signal — suggest drop_events + raw.
   // Require total >= 20 to avoid firing on a handful of packets right after boot.
   // Skip if already enabled in YAML.
-  if (total >= 20 && drop_pct >= 40 && this->diag_rssi_ok_n_ > 0 && (!this->diag_publish_drop_events_ || !this->diag_publish_raw_)) {
-    const int32_t avg_ok_rssi = this->diag_rssi_ok_sum_ / (int32_t) this->diag_rssi_ok_n_;
+  if (total >= 20 && drop_pct >= 40 && this->diag_.rssi_ok_n > 0 && (!this->diag_publish_drop_events_ || !this->diag_publish_raw_)) {
+    const int32_t avg_ok_rssi = this->diag_.rssi_ok_sum / (int32_t) this->diag_.rssi_ok_n;
     if (avg_ok_rssi <= -85) {
-      publish_suggestion_(mqtt, topic, this->last_suggestion_ms_, now_ms, SUGGESTION_THROTTLE_MS_,
+      this->publish_suggestion_(topic, now_ms,
           chip, "ENABLE_DROP_EVENTS_RAW",
           "diagnostic_publish_drop_events", "true",
           "diagnostic_publish_drop_events: true\ndiagnostic_publish_raw: true",
@@ -206,10 +300,10 @@ void Radio::maybe_publish_suggestion_(uint32_t now_ms) {
   // No YAML state to check — cpu_frequency is an ESPHome board setting, not a wmbus option.
   if (!is_sx1276
       && t1_sym_inv_pct >= 10
-      && this->diag_t1_symbols_total_ >= 500
+      && this->diag_.t1_symbols_total >= 500
       && drop_pct >= 5
       && total >= 20) {
-    publish_suggestion_(mqtt, topic, this->last_suggestion_ms_, now_ms, SUGGESTION_THROTTLE_MS_,
+    this->publish_suggestion_(topic, now_ms,
         chip, "SX1262_SYMBOL_ERRORS",
         "cpu_frequency", "160MHz",
         "cpu_frequency: 160MHz",
@@ -224,7 +318,7 @@ void Radio::maybe_publish_suggestion_(uint32_t now_ms) {
       this->sx1276_busy_ether_mode_ == SX1276BusyEtherMode::ADAPTIVE &&
       now_ms > this->busy_ether_active_until_ms_ &&
       fsl < 20 && total >= 30) {
-    publish_suggestion_(mqtt, topic, this->last_suggestion_ms_, now_ms, SUGGESTION_THROTTLE_MS_,
+    this->publish_suggestion_(topic, now_ms,
         chip, "QUIET_ETHER_ADAPTIVE_IDLE",
         "sx1276_busy_ether_mode", "normal",
         "sx1276_busy_ether_mode: normal",
@@ -263,122 +357,172 @@ void Radio::maybe_publish_health_(uint32_t now_ms) {
     // the RAW-hex stream downstream. 1 = "no valid sample yet" (RSSI is always
     // negative); the consumer should treat rx_total==0 as "no signal data".
     const int32_t rssi = this->recent_ok_rssi_valid_ ? this->recent_ok_rssi_avg_ : 1;
-    char payload[224];
-    snprintf(payload, sizeof(payload),
-             "{\"uptime_s\":%lu,\"rx_total\":%u,\"sec_since_last_rx\":%ld,"
-             "\"rssi\":%ld,\"chip\":\"%s\",\"listen_mode\":\"%s\"}",
-             (unsigned long) (now_ms / 1000U),
-             (unsigned) this->rx_total_lifetime_,
-             (long) sec_since_last_rx,
-             (long) rssi,
-             chip, listen_mode);
-    // std::string(...) disambiguates the publish() overload set: a bare char[]
-    // is ambiguous between the (const char*, size_t, ...) and (const std::string&,
-    // ...) signatures; wrapping forces the string overload (as elsewhere here).
-    mqtt->publish(this->health_topic_, std::string(payload), static_cast<uint8_t>(0), false);
+    JsonWriter w = this->json_writer_();
+    w.begin_object()
+        .u32("uptime_s", now_ms / 1000U)
+        .u32("rx_total", this->rx_total_lifetime_)
+        .i32("sec_since_last_rx", sec_since_last_rx)
+        .i32("rssi", rssi)
+        .str("chip", chip)
+        .str("listen_mode", listen_mode)
+        .end_object();
+    this->publish_json_(this->health_topic_, w);
   }
 
   if (!this->meters_topic_.empty()) {
     // highlight_meters_csv_ is a comma-separated list joined in python; emit it
-    // as a JSON array of quoted ids. target is a single id ("" when unset).
-    std::string arr = "[";
-    bool first = true;
-    const std::string &csv = this->highlight_meters_csv_;
-    size_t start = 0;
-    while (start <= csv.size()) {
-      size_t comma = csv.find(',', start);
-      std::string tok = csv.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
-      // trim spaces
-      while (!tok.empty() && (tok.front() == ' ' || tok.front() == '\t')) tok.erase(tok.begin());
-      while (!tok.empty() && (tok.back() == ' ' || tok.back() == '\t')) tok.pop_back();
-      if (!tok.empty()) {
-        if (!first) arr += ',';
-        arr += '"';
-        arr += tok;
-        arr += '"';
-        first = false;
+    // as a JSON array of quoted ids. target is the target_meter_id as written
+    // in YAML ("" when unset), targets every forwarded meter id.
+    JsonWriter w = this->json_writer_();
+    w.begin_object().str("target", this->target_meter_id_str_.c_str()).begin_array("targets");
+    for (const auto &t : this->targets_) {
+      char id_buf[9];
+      snprintf(id_buf, sizeof(id_buf), "%08u", (unsigned) t.meter_id);
+      w.str(nullptr, id_buf);
+    }
+    w.end_array().begin_array("highlight");
+    const char *p = this->highlight_meters_csv_.c_str();
+    while (*p != '\0') {
+      while (*p == ' ' || *p == '\t') p++;
+      const char *end = p;
+      while (*end != '\0' && *end != ',') end++;
+      const char *last = end;
+      while (last > p && (last[-1] == ' ' || last[-1] == '\t')) last--;
+      char tok[32];
+      const size_t n = std::min<size_t>((size_t) (last - p), sizeof(tok) - 1);
+      if (n != 0) {
+        std::memcpy(tok, p, n);
+        tok[n] = '\0';
+        w.str(nullptr, tok);
       }
-      if (comma == std::string::npos) break;
-      start = comma + 1;
+      p = (*end == ',') ? end + 1 : end;
     }
-    arr += ']';
-    std::string payload = "{\"target\":\"" + this->target_meter_id_str_ + "\",\"highlight\":" + arr + "}";
-    mqtt->publish(this->meters_topic_, payload, static_cast<uint8_t>(0), false);
+    w.end_array().end_object();
+    this->publish_json_(this->meters_topic_, w);
   }
 }
 
-void Radio::maybe_publish_diag_summary_(uint32_t now_ms) {
-  if (!this->diag_publish_summary_) return;
-  if (this->diag_topic_.empty()) return;
-  if (this->last_diag_summary_ms_ == 0) {
-    this->last_diag_summary_ms_ = now_ms;
-    return;
+// Window accumulators are combined with counters_fold(), which wraps mod
+// 2^32 on purpose: an accumulator may hold "minus the open interval" (see
+// diag_window_reset_()), which only cancels out with modular arithmetic.
+void Radio::diag_close_interval_() {
+  for (auto &acc : this->diag_windows_) counters_fold(acc, this->diag_, false);
+  this->diag_ = {};
+  this->queue_hwm_[QHW_INTERVAL] = {};
+  this->loop_rx_stats_.local().interval++;
+  this->publish_loop_rx_stats_();
+}
+
+void Radio::diag_window_counters_(DiagWindow window, DiagCounters &out) const {
+  out = this->diag_windows_[window];
+  counters_fold(out, this->diag_, false);
+}
+
+void Radio::diag_window_reset_(DiagWindow window) {
+  this->diag_windows_[window] = {};
+  counters_fold(this->diag_windows_[window], this->diag_, true);
+  this->queue_hwm_[window] = {};
+}
+
+// Once per loop() pass. Receiver-task counters only ever grow, so adding the
+// difference to the previous snapshot counts each increment exactly once; a
+// snapshot missed because the receiver was publishing is caught up next pass.
+void Radio::diag_sync_rx_task_() {
+  RxPathCounters now;
+  if (this->rx_task_counters_.read(now)) {
+    RxPathCounters delta = now;
+    counters_fold(delta, this->rx_task_seen_, true);
+    counters_fold(this->diag_.rx_path, delta, false);
+    this->rx_task_seen_ = now;
   }
-  uint32_t elapsed = now_ms - this->last_diag_summary_ms_;
-  if (elapsed < this->diag_summary_interval_ms_) return;
-  this->last_diag_summary_ms_ = now_ms;
+  this->publish_loop_rx_stats_();
+}
+
+void Radio::publish_loop_rx_stats_() {
+  auto &s = this->loop_rx_stats_.local();
+  s.total = this->diag_.total;
+  s.ok = this->diag_.ok;
+  s.t1_symbols_total = this->diag_.t1_symbols_total;
+  s.t1_symbols_invalid = this->diag_.t1_symbols_invalid;
+  s.recent_ok_rssi_avg = this->recent_ok_rssi_avg_;
+  s.recent_ok_rssi_valid = this->recent_ok_rssi_valid_ ? 1U : 0U;
+  this->loop_rx_stats_.publish();
+}
+
+// rssi_abort_bucket_() buckets: > -70, -70..-79, -80..-89, -90..-99, -100 and below.
+static void write_rssi_buckets_(JsonWriter &w, const char *key, const uint32_t (&b)[5]) {
+  w.begin_object(key)
+      .u32("gt70", b[0])
+      .u32("70_79", b[1])
+      .u32("80_89", b[2])
+      .u32("90_99", b[3])
+      .u32("lt100", b[4])
+      .end_object();
+}
 
+void Radio::publish_diag_summary_(const DiagCounters &c, uint32_t elapsed_ms, uint32_t now_ms,
+                                  const std::string &topic, const char *log_label, bool with_busy_ether_state,
+                                  const QueueHighWater &hwm) {
   auto *mqtt = esphome::mqtt::global_mqtt_client;
-  if (mqtt == nullptr || !mqtt->is_connected()) return;
+  if (mqtt == nullptr) return;
 
   const char *listen_mode = (this->radio != nullptr)
                                 ? listen_mode_to_string_(this->radio->get_listen_mode())
                                 : "unknown";
-  const uint32_t interval_s = elapsed / 1000U;
+  const uint32_t interval_s = elapsed_ms / 1000U;
 
-  char payload[2048];
-  const uint32_t crc_failed = this->diag_dropped_by_bucket_[DB_DLL_CRC_FAILED];
-  const uint32_t total = this->diag_total_;
-  const uint32_t ok = this->diag_ok_;
+  const uint32_t crc_failed = c.dropped_by_bucket[DB_DLL_CRC_FAILED];
+  const uint32_t total = c.total;
+  const uint32_t ok = c.ok;
   const uint32_t crc_fail_pct = (total == 0) ? 0 : (crc_failed * 100U) / total;
-  const uint32_t drop_pct = (total == 0) ? 0 : (this->diag_dropped_ * 100U) / total;
-  const uint32_t trunc_pct = (total == 0) ? 0 : (this->diag_truncated_ * 100U) / total;
-  const int32_t avg_ok_rssi = (this->diag_rssi_ok_n_ == 0) ? 0 : (this->diag_rssi_ok_sum_ / (int32_t) this->diag_rssi_ok_n_);
-  const int32_t avg_drop_rssi = (this->diag_rssi_drop_n_ == 0) ? 0 : (this->diag_rssi_drop_sum_ / (int32_t) this->diag_rssi_drop_n_);
+  const uint32_t drop_pct = (total == 0) ? 0 : (c.dropped * 100U) / total;
+  const uint32_t trunc_pct = (total == 0) ? 0 : (c.truncated * 100U) / total;
+  const int32_t avg_ok_rssi = (c.rssi_ok_n == 0) ? 0 : (c.rssi_ok_sum / (int32_t) c.rssi_ok_n);
+  const int32_t avg_drop_rssi = (c.rssi_drop_n == 0) ? 0 : (c.rssi_drop_sum / (int32_t) c.rssi_drop_n);
 
   const uint8_t T1 = (uint8_t) LinkMode::T1;
   const uint8_t C1 = (uint8_t) LinkMode::C1;
-  const uint32_t t1_total = this->diag_mode_total_[T1];
-  const uint32_t c1_total = this->diag_mode_total_[C1];
-  const uint32_t t1_ok = this->diag_mode_ok_[T1];
-  const uint32_t c1_ok = this->diag_mode_ok_[C1];
-  const uint32_t t1_drop = this->diag_mode_dropped_[T1];
-  const uint32_t c1_drop = this->diag_mode_dropped_[C1];
-  const uint32_t t1_crc = this->diag_mode_crc_failed_[T1];
-  const uint32_t c1_crc = this->diag_mode_crc_failed_[C1];
+  const uint32_t t1_total = c.mode_total[T1];
+  const uint32_t c1_total = c.mode_total[C1];
+  const uint32_t t1_ok = c.mode_ok[T1];
+  const uint32_t c1_ok = c.mode_ok[C1];
+  const uint32_t t1_drop = c.mode_dropped[T1];
+  const uint32_t c1_drop = c.mode_dropped[C1];
+  const uint32_t t1_crc = c.mode_crc_failed[T1];
+  const uint32_t c1_crc = c.mode_crc_failed[C1];
   const uint32_t t1_per_pct = (t1_total == 0) ? 0 : (t1_drop * 100U) / t1_total;
   const uint32_t c1_per_pct = (c1_total == 0) ? 0 : (c1_drop * 100U) / c1_total;
   const uint32_t t1_crc_pct = (t1_total == 0) ? 0 : (t1_crc * 100U) / t1_total;
   const uint32_t c1_crc_pct = (c1_total == 0) ? 0 : (c1_crc * 100U) / c1_total;
-  const int32_t t1_avg_ok_rssi = (this->diag_mode_rssi_ok_n_[T1] == 0) ? 0 : (this->diag_mode_rssi_ok_sum_[T1] / (int32_t) this->diag_mode_rssi_ok_n_[T1]);
-  const int32_t c1_avg_ok_rssi = (this->diag_mode_rssi_ok_n_[C1] == 0) ? 0 : (this->diag_mode_rssi_ok_sum_[C1] / (int32_t) this->diag_mode_rssi_ok_n_[C1]);
-  const int32_t t1_avg_drop_rssi = (this->diag_mode_rssi_drop_n_[T1] == 0) ? 0 : (this->diag_mode_rssi_drop_sum_[T1] / (int32_t) this->diag_mode_rssi_drop_n_[T1]);
-  const int32_t c1_avg_drop_rssi = (this->diag_mode_rssi_drop_n_[C1] == 0) ? 0 : (this->diag_mode_rssi_drop_sum_[C1] / (int32_t) this->diag_mode_rssi_drop_n_[C1]);
+  const int32_t t1_avg_ok_rssi = (c.mode_rssi_ok_n[T1] == 0) ? 0 : (c.mode_rssi_ok_sum[T1] / (int32_t) c.mode_rssi_ok_n[T1]);
+  const int32_t c1_avg_ok_rssi = (c.mode_rssi_ok_n[C1] == 0) ? 0 : (c.mode_rssi_ok_sum[C1] / (int32_t) c.mode_rssi_ok_n[C1]);
+  const int32_t t1_avg_drop_rssi = (c.mode_rssi_drop_n[T1] == 0) ? 0 : (c.mode_rssi_drop_sum[T1] / (int32_t) c.mode_rssi_drop_n[T1]);
+  const int32_t c1_avg_drop_rssi = (c.mode_rssi_drop_n[C1] == 0) ? 0 : (c.mode_rssi_drop_sum[C1] / (int32_t) c.mode_rssi_drop_n[C1]);
 
-  const uint32_t t1_sym_total = this->diag_t1_symbols_total_;
-  const uint32_t t1_sym_invalid = this->diag_t1_symbols_invalid_;
+  const uint32_t t1_sym_total = c.t1_symbols_total;
+  const uint32_t t1_sym_invalid = c.t1_symbols_invalid;
   const uint32_t t1_sym_invalid_pct = (t1_sym_total == 0) ? 0 : (t1_sym_invalid * 100U) / t1_sym_total;
   const bool is_sx1276 = (this->radio != nullptr && strcmp(this->radio->get_name(), "SX1276") == 0);
   const int32_t ok_vs_drop_rssi_gap =
-      (this->diag_rssi_ok_n_ == 0 || this->diag_rssi_drop_n_ == 0) ? 0 : (avg_ok_rssi - avg_drop_rssi);
+      (c.rssi_ok_n == 0 || c.rssi_drop_n == 0) ? 0 : (avg_ok_rssi - avg_drop_rssi);
   const uint32_t rx_false_start_like =
-      this->diag_rx_path_.preamble_read_failed + this->diag_rx_path_.payload_size_unknown +
-      this->diag_rx_path_.weak_start_aborted + this->diag_rx_path_.probe_start_aborted +
-      this->diag_rx_path_.raw_drain_skipped_weak;
+      c.rx_path.preamble_read_failed + c.rx_path.payload_size_unknown +
+      c.rx_path.weak_start_aborted + c.rx_path.probe_start_aborted +
+      c.rx_path.raw_drain_skipped_weak;
   const uint32_t raw_drain_recovery_pct =
-      (this->diag_rx_path_.raw_drain_attempted == 0)
+      (c.rx_path.raw_drain_attempted == 0)
           ? 0
-          : (this->diag_rx_path_.raw_drain_recovered * 100U) / this->diag_rx_path_.raw_drain_attempted;
+          : (c.rx_path.raw_drain_recovered * 100U) / c.rx_path.raw_drain_attempted;
 
   const uint32_t reasons_sum =
-      this->diag_dropped_by_bucket_[DB_TOO_SHORT] +
-      this->diag_dropped_by_bucket_[DB_DECODE_FAILED] +
-      this->diag_dropped_by_bucket_[DB_DLL_CRC_FAILED] +
-      this->diag_dropped_by_bucket_[DB_UNKNOWN_PREAMBLE] +
-      this->diag_dropped_by_bucket_[DB_L_FIELD_INVALID] +
-      this->diag_dropped_by_bucket_[DB_UNKNOWN_LINK_MODE] +
-      this->diag_dropped_by_bucket_[DB_OTHER];
-  const uint32_t reasons_sum_mismatch = (reasons_sum != this->diag_dropped_) ? 1U : 0U;
+      c.dropped_by_bucket[DB_TOO_SHORT] +
+      c.dropped_by_bucket[DB_DECODE_FAILED] +
+      c.dropped_by_bucket[DB_DLL_CRC_FAILED] +
+      c.dropped_by_bucket[DB_UNKNOWN_PREAMBLE] +
+      c.dropped_by_bucket[DB_L_FIELD_INVALID] +
+      c.dropped_by_bucket[DB_UNKNOWN_LINK_MODE] +
+      c.dropped_by_bucket[DB_OTHER];
+  const uint32_t reasons_sum_mismatch = (reasons_sum != c.dropped) ? 1U : 0U;
 
   const char *hint_code = "OK";
   const char *hint_en = "looks good";
@@ -411,7 +555,7 @@ void Radio::maybe_publish_diag_summary_(uint32_t now_ms) {
                avg_drop_rssi <= -90 &&
                avg_ok_rssi >= -82 &&
                ok_vs_drop_rssi_gap >= 10 &&
-               (rx_false_start_like >= 40 || this->diag_rx_path_.raw_drain_attempted >= 20 || this->diag_rx_path_.fifo_overrun > 0)) {
+               (rx_false_start_like >= 40 || c.rx_path.raw_drain_attempted >= 20 || c.rx_path.fifo_overrun > 0)) {
       hint_code = "SX1276_BUSY_ETHER";
       hint_en = "SX1276 is picking up many very weak/partial T1 starts while valid packets are much stronger; this looks like dense ether with distant or overlapping meters, not just a bad antenna.";
       hint_pl = "SX1276 łapie dużo bardzo słabych/częściowych startów T1, podczas gdy poprawne pakiety są znacznie silniejsze; to wygląda na gęsty eter z dalekimi lub nakładającymi się licznikami, a nie tylko złą antenę.";
@@ -436,8 +580,8 @@ void Radio::maybe_publish_diag_summary_(uint32_t now_ms) {
       hint_pl = "T1: dekoduje się, ale często pada CRC DLL; możliwe sporadyczne bitflipy";
     } else if (is_sx1276 &&
                drop_pct >= 20 &&
-               (this->diag_rx_path_.preamble_read_failed >= 20 ||
-                this->diag_rx_path_.payload_size_unknown >= 10)) {
+               (c.rx_path.preamble_read_failed >= 20 ||
+                c.rx_path.payload_size_unknown >= 10)) {
       hint_code = "SX1276_RX_NOISY";
       hint_en = "SX1276 sees many false starts or undecodable starts; RX frontend likely needs tuning";
       hint_pl = "SX1276 ma dużo fałszywych startów lub nieustalonych początków ramek; ścieżka RX wymaga strojenia";
@@ -448,224 +592,308 @@ void Radio::maybe_publish_diag_summary_(uint32_t now_ms) {
     }
   }
 
-  snprintf(payload, sizeof(payload),
-           "{"
-           "\"event\":\"summary\"," 
-           "\"interval_s\":%u,"
-           "\"uptime_ms\":%lu,"
-           "\"listen_mode\":\"%s\","
-           "\"total\":%u,"
-           "\"ok\":%u,"
-           "\"truncated\":%u,"
-           "\"dropped\":%u,"
-           "\"crc_failed\":%u,"
-           "\"crc_fail_pct\":%u,"
-           "\"drop_pct\":%u,"
-           "\"trunc_pct\":%u,"
-           "\"avg_ok_rssi\":%d,"
-           "\"avg_drop_rssi\":%d,"
-           "\"t1\":{"
-             "\"total\":%u,\"ok\":%u,\"dropped\":%u,\"per_pct\":%u,"
-             "\"crc_failed\":%u,\"crc_pct\":%u,\"avg_ok_rssi\":%d,\"avg_drop_rssi\":%d,"
-             "\"sym_total\":%u,\"sym_invalid\":%u,\"sym_invalid_pct\":%u"
-           "},"
-           "\"c1\":{"
-             "\"total\":%u,\"ok\":%u,\"dropped\":%u,\"per_pct\":%u,"
-             "\"crc_failed\":%u,\"crc_pct\":%u,\"avg_ok_rssi\":%d,\"avg_drop_rssi\":%d"
-           "},"
-           "\"dropped_by_reason\":{"
-             "\"too_short\":%u,"
-             "\"decode_failed\":%u,"
-             "\"dll_crc_failed\":%u,"
-             "\"unknown_preamble\":%u,"
-             "\"l_field_invalid\":%u,"
-             "\"unknown_link_mode\":%u,"
-             "\"other\":%u"
-           "},"
-           "\"dropped_by_stage\":{"
-             "\"precheck\":%u,"
-             "\"t1_decode3of6\":%u,"
-             "\"t1_l_field\":%u,"
-             "\"t1_length_check\":%u,"
-             "\"c1_precheck\":%u,"
-             "\"c1_preamble\":%u,"
-             "\"c1_suffix\":%u,"
-             "\"c1_l_field\":%u,"
-             "\"c1_length_check\":%u,"
-             "\"dll_crc_first\":%u,"
-             "\"dll_crc_mid\":%u,"
-             "\"dll_crc_final\":%u,"
-             "\"dll_crc_b1\":%u,"
-             "\"dll_crc_b2\":%u,"
-             "\"link_mode\":%u,"
-             "\"other\":%u"
-           "},"
-           "\"rx_path\":{"
-             "\"irq_timeout\":%u,"
-             "\"preamble_read_failed\":%u,"
-             "\"preamble_retry_recovered\":%u,"
-             "\"t1_header_read_failed\":%u,"
-             "\"payload_size_unknown\":%u,"
-             "\"raw_drain_attempted\":%u,"
-             "\"raw_drain_recovered\":%u,"
-             "\"raw_drain_recovery_pct\":%u,"
-             "\"raw_drain_bytes\":%u,"
-             "\"payload_read_failed\":%u,"
-             "\"queue_send_failed\":%u,"
-             "\"fifo_overrun\":%u,"
-             "\"weak_start_aborted\":%u,"
-             "\"probe_start_aborted\":%u,"
-             "\"raw_drain_skipped_weak\":%u,"
-             "\"false_start_like\":%u,"
-             "\"probe_abort_rssi\":{\"gt70\":%u,\"70_79\":%u,\"80_89\":%u,\"90_99\":%u,\"lt100\":%u},"
-             "\"weak_abort_rssi\":{\"gt70\":%u,\"70_79\":%u,\"80_89\":%u,\"90_99\":%u,\"lt100\":%u}"
-           "},"
-           "\"reasons_sum\":%u,"
-           "\"reasons_sum_mismatch\":%u,"
-           "\"hint_code\":\"%s\","
-           "\"hint_en\":\"%s\",\"hint_pl\":\"%s\","
-           "\"busy_ether_state\":\"%s\""
-           "}",
-           (unsigned) interval_s,
-           (unsigned long) now_ms,
-           listen_mode,
-           (unsigned) total,
-           (unsigned) this->diag_ok_,
-           (unsigned) this->diag_truncated_,
-           (unsigned) this->diag_dropped_,
-           (unsigned) crc_failed,
-           (unsigned) crc_fail_pct,
-           (unsigned) drop_pct,
-           (unsigned) trunc_pct,
-           (int) avg_ok_rssi,
-           (int) avg_drop_rssi,
-           (unsigned) t1_total,
-           (unsigned) t1_ok,
-           (unsigned) t1_drop,
-           (unsigned) t1_per_pct,
-           (unsigned) t1_crc,
-           (unsigned) t1_crc_pct,
-           (int) t1_avg_ok_rssi,
-           (int) t1_avg_drop_rssi,
-           (unsigned) t1_sym_total,
-           (unsigned) t1_sym_invalid,
-           (unsigned) t1_sym_invalid_pct,
-           (unsigned) c1_total,
-           (unsigned) c1_ok,
-           (unsigned) c1_drop,
-           (unsigned) c1_per_pct,
-           (unsigned) c1_crc,
-           (unsigned) c1_crc_pct,
-           (int) c1_avg_ok_rssi,
-           (int) c1_avg_drop_rssi,
-           (unsigned) this->diag_dropped_by_bucket_[DB_TOO_SHORT],
-           (unsigned) this->diag_dropped_by_bucket_[DB_DECODE_FAILED],
-           (unsigned) this->diag_dropped_by_bucket_[DB_DLL_CRC_FAILED],
-           (unsigned) this->diag_dropped_by_bucket_[DB_UNKNOWN_PREAMBLE],
-           (unsigned) this->diag_dropped_by_bucket_[DB_L_FIELD_INVALID],
-           (unsigned) this->diag_dropped_by_bucket_[DB_UNKNOWN_LINK_MODE],
-           (unsigned) this->diag_dropped_by_bucket_[DB_OTHER],
-           (unsigned) this->diag_dropped_by_stage_[SB_PRECHECK],
-           (unsigned) this->diag_dropped_by_stage_[SB_T1_DECODE3OF6],
-           (unsigned) this->diag_dropped_by_stage_[SB_T1_L_FIELD],
-           (unsigned) this->diag_dropped_by_stage_[SB_T1_LENGTH_CHECK],
-           (unsigned) this->diag_dropped_by_stage_[SB_C1_PRECHECK],
-           (unsigned) this->diag_dropped_by_stage_[SB_C1_PREAMBLE],
-           (unsigned) this->diag_dropped_by_stage_[SB_C1_SUFFIX],
-           (unsigned) this->diag_dropped_by_stage_[SB_C1_L_FIELD],
-           (unsigned) this->diag_dropped_by_stage_[SB_C1_LENGTH_CHECK],
-           (unsigned) this->diag_dropped_by_stage_[SB_DLL_CRC_FIRST],
-           (unsigned) this->diag_dropped_by_stage_[SB_DLL_CRC_MID],
-           (unsigned) this->diag_dropped_by_stage_[SB_DLL_CRC_FINAL],
-           (unsigned) this->diag_dropped_by_stage_[SB_DLL_CRC_B1],
-           (unsigned) this->diag_dropped_by_stage_[SB_DLL_CRC_B2],
-           (unsigned) this->diag_dropped_by_stage_[SB_LINK_MODE],
-           (unsigned) this->diag_dropped_by_stage_[SB_OTHER],
-           (unsigned) this->diag_rx_path_.irq_timeout,
-           (unsigned) this->diag_rx_path_.preamble_read_failed,
-           (unsigned) this->diag_rx_path_.preamble_retry_recovered,
-           (unsigned) this->diag_rx_path_.t1_header_read_failed,
-           (unsigned) this->diag_rx_path_.payload_size_unknown,
-           (unsigned) this->diag_rx_path_.raw_drain_attempted,
-           (unsigned) this->diag_rx_path_.raw_drain_recovered,
-           (unsigned) raw_drain_recovery_pct,
-           (unsigned) this->diag_rx_path_.raw_drain_bytes,
-           (unsigned) this->diag_rx_path_.payload_read_failed,
-           (unsigned) this->diag_rx_path_.queue_send_failed,
-           (unsigned) this->diag_rx_path_.fifo_overrun,
-           (unsigned) this->diag_rx_path_.weak_start_aborted,
-           (unsigned) this->diag_rx_path_.probe_start_aborted,
-           (unsigned) this->diag_rx_path_.raw_drain_skipped_weak,
-           (unsigned) rx_false_start_like,
-           // probe_abort_rssi buckets
-           (unsigned) this->diag_rx_path_.probe_abort_rssi[0],
-           (unsigned) this->diag_rx_path_.probe_abort_rssi[1],
-           (unsigned) this->diag_rx_path_.probe_abort_rssi[2],
-           (unsigned) this->diag_rx_path_.probe_abort_rssi[3],
-           (unsigned) this->diag_rx_path_.probe_abort_rssi[4],
-           // weak_abort_rssi buckets
-           (unsigned) this->diag_rx_path_.weak_abort_rssi[0],
-           (unsigned) this->diag_rx_path_.weak_abort_rssi[1],
-           (unsigned) this->diag_rx_path_.weak_abort_rssi[2],
-           (unsigned) this->diag_rx_path_.weak_abort_rssi[3],
-           (unsigned) this->diag_rx_path_.weak_abort_rssi[4],
-           (unsigned) reasons_sum,
-           (unsigned) reasons_sum_mismatch,
-           hint_code,
-           hint_en,
-           hint_pl,
-           // busy_ether_state: reflects state BEFORE evaluating this window.
-           // evaluate_busy_ether_adaptive_() runs after publish to access full window counters.
-           // Use busy_ether_changed event for precise transition timestamps.
-           !is_sx1276 ? "n/a"
-               : (this->sx1276_busy_ether_mode_ == SX1276BusyEtherMode::ADAPTIVE)
-                   ? (this->busy_ether_was_active_ ? "adaptive_active" : "adaptive_passive")
-                   : (this->sx1276_busy_ether_mode_ == SX1276BusyEtherMode::AGGRESSIVE ? "aggressive" : "normal"));
-
-  const std::string summary_topic = this->diag_summary_topic_();
-  mqtt->publish(summary_topic, payload);
-  ESP_LOGI(TAG, "DIAG summary / podsumowanie diag: topic=%s interval=%us uptime_ms=%lu listen_mode=%s total=%u ok=%u truncated=%u dropped=%u crc_failed=%u",
-           summary_topic.c_str(), (unsigned) interval_s, (unsigned long) now_ms, listen_mode,
-           (unsigned) total, (unsigned) this->diag_ok_,
-           (unsigned) this->diag_truncated_, (unsigned) this->diag_dropped_, (unsigned) crc_failed);
+  JsonWriter w = this->json_writer_();
+  w.begin_object()
+      .str("event", "summary")
+      .u32("interval_s", interval_s)
+      .u32("uptime_ms", now_ms)
+      .str("listen_mode", listen_mode)
+      .u32("total", total)
+      .u32("ok", c.ok)
+      .u32("truncated", c.truncated)
+      .u32("dropped", c.dropped)
+      .u32("crc_failed", crc_failed)
+      .u32("crc_fail_pct", crc_fail_pct)
+      .u32("drop_pct", drop_pct)
+      .u32("trunc_pct", trunc_pct)
+      .i32("avg_ok_rssi", avg_ok_rssi)
+      .i32("avg_drop_rssi", avg_drop_rssi);
+  w.begin_object("t1")
+      .u32("total", t1_total)
+      .u32("ok", t1_ok)
+      .u32("dropped", t1_drop)
+      .u32("per_pct", t1_per_pct)
+      .u32("crc_failed", t1_crc)
+      .u32("crc_pct", t1_crc_pct)
+      .i32("avg_ok_rssi", t1_avg_ok_rssi)
+      .i32("avg_drop_rssi", t1_avg_drop_rssi)
+      .u32("sym_total", t1_sym_total)
+      .u32("sym_invalid", t1_sym_invalid)
+      .u32("sym_invalid_pct", t1_sym_invalid_pct)
+      .end_object();
+  w.begin_object("c1")
+      .u32("total", c1_total)
+      .u32("ok", c1_ok)
+      .u32("dropped", c1_drop)
+      .u32("per_pct", c1_per_pct)
+      .u32("crc_failed", c1_crc)
+      .u32("crc_pct", c1_crc_pct)
+      .i32("avg_ok_rssi", c1_avg_ok_rssi)
+      .i32("avg_drop_rssi", c1_avg_drop_rssi)
+      .end_object();
+  w.begin_object("dropped_by_reason")
+      .u32("too_short", c.dropped_by_bucket[DB_TOO_SHORT])
+      .u32("decode_failed", c.dropped_by_bucket[DB_DECODE_FAILED])
+      .u32("dll_crc_failed", c.dropped_by_bucket[DB_DLL_CRC_FAILED])
+      .u32("unknown_preamble", c.dropped_by_bucket[DB_UNKNOWN_PREAMBLE])
+      .u32("l_field_invalid", c.dropped_by_bucket[DB_L_FIELD_INVALID])
+      .u32("unknown_link_mode", c.dropped_by_bucket[DB_UNKNOWN_LINK_MODE])
+      .u32("other", c.dropped_by_bucket[DB_OTHER])
+      .end_object();
+  w.begin_object("dropped_by_stage")
+      .u32("precheck", c.dropped_by_stage[SB_PRECHECK])
+      .u32("t1_decode3of6", c.dropped_by_stage[SB_T1_DECODE3OF6])
+      .u32("t1_l_field", c.dropped_by_stage[SB_T1_L_FIELD])
+      .u32("t1_length_check", c.dropped_by_stage[SB_T1_LENGTH_CHECK])
+      .u32("c1_precheck", c.dropped_by_stage[SB_C1_PRECHECK])
+      .u32("c1_preamble", c.dropped_by_stage[SB_C1_PREAMBLE])
+      .u32("c1_suffix", c.dropped_by_stage[SB_C1_SUFFIX])
+      .u32("c1_l_field", c.dropped_by_stage[SB_C1_L_FIELD])
+      .u32("c1_length_check", c.dropped_by_stage[SB_C1_LENGTH_CHECK])
+      .u32("dll_crc_first", c.dropped_by_stage[SB_DLL_CRC_FIRST])
+      .u32("dll_crc_mid", c.dropped_by_stage[SB_DLL_CRC_MID])
+      .u32("dll_crc_final", c.dropped_by_stage[SB_DLL_CRC_FINAL])
+      .u32("dll_crc_b1", c.dropped_by_stage[SB_DLL_CRC_B1])
+      .u32("dll_crc_b2", c.dropped_by_stage[SB_DLL_CRC_B2])
+      .u32("link_mode", c.dropped_by_stage[SB_LINK_MODE])
+      .u32("other", c.dropped_by_stage[SB_OTHER])
+      .end_object();
+  const RxPathCounters &rx = c.rx_path;
+  w.begin_object("rx_path")
+      .u32("irq_timeout", rx.irq_timeout)
+      .u32("preamble_read_failed", rx.preamble_read_failed)
+      .u32("preamble_retry_recovered", rx.preamble_retry_recovered)
+      .u32("t1_header_read_failed", rx.t1_header_read_failed)
+      .u32("payload_size_unknown", rx.payload_size_unknown)
+      .u32("raw_drain_attempted", rx.raw_drain_attempted)
+      .u32("raw_drain_recovered", rx.raw_drain_recovered)
+      .u32("raw_drain_recovery_pct", raw_drain_recovery_pct)
+      .u32("raw_drain_bytes", rx.raw_drain_bytes)
+      .u32("payload_read_failed", rx.payload_read_failed)
+      .u32("t1_symbol_abort", rx.t1_symbol_abort)
+      .u32("queue_send_failed", rx.queue_send_failed)
+      .u32("pool_exhausted", rx.pool_exhausted)
+      .u32("fifo_overrun", rx.fifo_overrun)
+      .u32("weak_start_aborted", rx.weak_start_aborted)
+      .u32("probe_start_aborted", rx.probe_start_aborted)
+      .u32("raw_drain_skipped_weak", rx.raw_drain_skipped_weak)
+      .u32("false_start_like", rx_false_start_like);
+  write_rssi_buckets_(w, "probe_abort_rssi", rx.probe_abort_rssi);
+  write_rssi_buckets_(w, "weak_abort_rssi", rx.weak_abort_rssi);
+  w.u32("events_lost", rx.events_lost);
+  // Only when the radio streamed frames in this window (SX1262 long GFSK
+  // hold, S1): deaf time is from the last byte read to RX armed again.
+  const StreamCaptureStats &sc = rx.stream_capture;
+  if (sc.frames != 0) {
+    w.begin_object("stream_capture")
+        .u32("frames", sc.frames)
+        .u32("length_stops", sc.length_stops)
+        .u32("avg_deaf_us", sc.deaf_us_sum / sc.frames);
+    w.begin_object("deaf_ms_hist")
+        .u32("lt1", sc.deaf_hist[0])
+        .u32("1_4", sc.deaf_hist[1])
+        .u32("5_19", sc.deaf_hist[2])
+        .u32("ge20", sc.deaf_hist[3])
+        .end_object();
+    w.end_object();
+  }
+  // restart_rx() after every frame and hop: blind window from the command
+  // that stops reception to RX armed again, per path (see RearmStats).
+  const RearmStats &ra = rx.rearm;
+  if (ra.rearms != 0) {
+    const uint32_t full = ra.rearms - ra.fast;
+    w.begin_object("rearm")
+        .u32("rearms", ra.rearms)
+        .u32("fast", ra.fast)
+        .u32("avg_full_us", full != 0 ? ra.blind_us_sum_full / full : 0)
+        .u32("avg_fast_us", ra.fast != 0 ? ra.blind_us_sum_fast / ra.fast : 0);
+    w.begin_object("blind_us_hist")
+        .u32("lt50", ra.blind_hist[0])
+        .u32("50_199", ra.blind_hist[1])
+        .u32("200_499", ra.blind_hist[2])
+        .u32("500_1999", ra.blind_hist[3])
+        .u32("ge2000", ra.blind_hist[4])
+        .end_object();
+    w.end_object();
+  }
+  // CC1101, SX1276: what reading the frames from the RX FIFO cost the
+  // receiver task.
+  const FifoDrainStats &fd = rx.fifo_drain;
+  if (fd.frames != 0) {
+    w.begin_object("fifo_drain")
+        .u32("frames", fd.frames)
+        .u32("event_frames", fd.event_frames)
+        .u32("avg_spi_txns", fd.spi_txns / fd.frames)
+        .u32("avg_cpu_us", fd.busy_us_sum / fd.frames)
+        .u32("sleeps", fd.sleeps)
+        .end_object();
+  }
+  w.end_object();
+  w.u32("reasons_sum", reasons_sum)
+      .u32("reasons_sum_mismatch", reasons_sum_mismatch)
+      .str("hint_code", hint_code)
+      .str("hint_en", hint_en)
+      .str("hint_pl", hint_pl);
+
+  // Only the main summary carries busy_ether_state: it reflects the state
+  // BEFORE this window is evaluated (evaluate_busy_ether_adaptive_() runs after
+  // publish so it sees the full window). Use the busy_ether_changed event for
+  // precise transition timestamps.
+  if (with_busy_ether_state) {
+    w.str("busy_ether_state",
+          !is_sx1276 ? "n/a"
+          : (this->sx1276_busy_ether_mode_ == SX1276BusyEtherMode::ADAPTIVE)
+              ? (this->busy_ether_was_active_ ? "adaptive_active" : "adaptive_passive")
+              : (this->sx1276_busy_ether_mode_ == SX1276BusyEtherMode::AGGRESSIVE ? "aggressive" : "normal"));
+  }
+
+  // Only with telegram batching on, so default payloads are unchanged.
+  if (this->telegram_batch_enabled_()) {
+    const auto &tb = c.telegram_batch;
+    w.begin_object("telegram_batch")
+        .u32("batches", tb.batches)
+        .u32("frames", tb.frames)
+        .u32("avg_frames_x10", tb.batches == 0 ? 0 : (tb.frames * 10U) / tb.batches)
+        .u32("flush_full", tb.flush_full)
+        .u32("flush_timeout", tb.flush_timeout)
+        .u32("flush_bytes", tb.flush_bytes)
+        .u32("flush_offline", tb.flush_offline)
+        .u32("frames_dropped", tb.frames_dropped)
+        .u32("avg_latency_ms", tb.batches == 0 ? 0 : tb.latency_sum_ms / tb.batches);
+    w.begin_object("size_hist")
+        .u32("1", tb.size_hist[0])
+        .u32("2_3", tb.size_hist[1])
+        .u32("4_7", tb.size_hist[2])
+        .u32("8_15", tb.size_hist[3])
+        .u32("16p", tb.size_hist[4])
+        .end_object();
+    w.begin_object("latency_ms_hist")
+        .u32("lt100", tb.latency_hist[0])
+        .u32("100_499", tb.latency_hist[1])
+        .u32("500_1999", tb.latency_hist[2])
+        .u32("ge2000", tb.latency_hist[3])
+        .end_object();
+    w.end_object();
+  }
+  // Only with the offline buffer on. pending/pending_bytes are the state at
+  // publish time, not window totals.
+  if (this->offline_store_.enabled()) {
+    const auto &ob = c.offline_buffer;
+    w.begin_object("offline_buffer")
+        .u32("buffered", ob.buffered)
+        .u32("evicted", ob.evicted)
+        .u32("replayed", ob.replayed)
+        .u32("corrupt", ob.corrupt)
+        .u32("pending", this->offline_store_.frames())
+        .u32("pending_bytes", this->offline_store_.bytes())
+        .u32("capacity_bytes", this->offline_store_.capacity())
+        .end_object();
+  }
+
+  // Deepest the packet queue got in this window (the packet being processed
+  // included).
+  w.begin_object("queues").u32("packet_slots", PacketPool::SLOTS).u32("packet_hwm", hwm.packet).end_object();
+
+  // Only when restart_rx() alternates sync bytes (listen modes both, c1):
+  // the share of listening time the schedule gives 0xCD now, and per variant
+  // the window's dwells, listening time, radio interrupts and valid frames.
+  if (this->radio != nullptr && this->radio->uses_sync_schedule()) {
+    const SyncScheduleStats &ss = c.rx_path.sync_schedule;
+    w.begin_object("sync_schedule")
+        .str("mode", this->radio->sync_scheduler().adaptive() ? "adaptive" : "fixed")
+        .u32("cd_share_permille", this->radio->sync_scheduler().cd_share_permille());
+    static const char *const VARIANT_KEYS[2] = {"3d", "cd"};
+    for (size_t v = 0; v < 2; v++) {
+      w.begin_object(VARIANT_KEYS[v])
+          .u32("dwells", ss.dwells[v])
+          .u32("listen_ms", ss.listen_ms[v])
+          .u32("captures", ss.captures[v])
+          .u32("hits", c.sync_hits[v])
+          .end_object();
+    }
+    w.end_object();
+  }
+
+  // loop() passes that found packets: how many each took, and how often the
+  // budget ran out before the queue was empty.
+  const auto &ld = c.loop_drain;
+  w.begin_object("loop_drain")
+      .u32("budget_us", this->loop_budget_us_)
+      .u32("loops", ld.loops)
+      .u32("packets", ld.packets)
+      .u32("budget_exhausted", ld.budget_exhausted);
+  w.begin_object("per_loop_hist")
+      .u32("1", ld.per_loop_hist[0])
+      .u32("2", ld.per_loop_hist[1])
+      .u32("3", ld.per_loop_hist[2])
+      .u32("4p", ld.per_loop_hist[3])
+      .end_object();
+  w.end_object();
+
+  // Only with duplicate suppression on, likewise.
+  if (this->dedup_ttl_ms_ != 0) {
+    w.begin_object("duplicates")
+        .u32("t1", c.mode_duplicates[T1])
+        .u32("c1", c.mode_duplicates[C1])
+        .u32("s1", c.mode_duplicates[(uint8_t) LinkMode::S1])
+        .u32("evicted_live", c.dedup_evicted_live)
+        .end_object();
+  }
+
+  // Only with meter_filter rules; rule_hits follows the configured order.
+  if (this->meter_filter_.enabled()) {
+    const auto &mf = c.meter_filter;
+    w.begin_object("meter_filter")
+        .u32("passed", mf.passed)
+        .u32("rejected_early", mf.rejected_early)
+        .u32("rejected_late", mf.rejected_late)
+        .u32("default_hits", mf.rule_hits[MeterFilter::DEFAULT_RULE])
+        .begin_array("rule_hits");
+    for (size_t i = 0; i < this->meter_filter_.size(); i++) w.u32(nullptr, mf.rule_hits[i]);
+    w.end_array().end_object();
+  }
+  w.end_object();
+
+  this->publish_json_(topic, w);
+  ESP_LOGI(TAG, "%s: topic=%s interval=%us uptime_ms=%lu listen_mode=%s total=%u ok=%u truncated=%u dropped=%u crc_failed=%u",
+           log_label, topic.c_str(), (unsigned) interval_s, (unsigned long) now_ms, listen_mode,
+           (unsigned) total, (unsigned) c.ok,
+           (unsigned) c.truncated, (unsigned) c.dropped, (unsigned) crc_failed);
 
   if (std::strcmp(hint_code, "OK") == 0 || std::strcmp(hint_code, "GOOD") == 0) {
     ESP_LOGI(TAG, "DIAG hint: %s | %s / %s", hint_code, hint_en, hint_pl);
   } else {
     ESP_LOGW(TAG, "DIAG hint: %s | %s / %s", hint_code, hint_en, hint_pl);
   }
+}
+
+void Radio::maybe_publish_diag_summary_(uint32_t now_ms) {
+  if (!this->diag_publish_summary_) return;
+  if (this->diag_topic_.empty()) return;
+  if (this->last_diag_summary_ms_ == 0) {
+    this->last_diag_summary_ms_ = now_ms;
+    return;
+  }
+  uint32_t elapsed = now_ms - this->last_diag_summary_ms_;
+  if (elapsed < this->diag_summary_interval_ms_) return;
+  this->last_diag_summary_ms_ = now_ms;
+
+  auto *mqtt = esphome::mqtt::global_mqtt_client;
+  if (mqtt == nullptr || !mqtt->is_connected()) return;
 
-  // Evaluate adaptive busy-ether state BEFORE resetting windowed counters —
-  // this is the only point where all current-window accumulations are visible.
+  this->publish_diag_summary_(this->diag_, elapsed, now_ms, this->diag_summary_topic_(),
+                              "DIAG summary / podsumowanie diag", true, this->queue_hwm_[QHW_INTERVAL]);
+
+  // Evaluate adaptive busy-ether state BEFORE closing the interval —
+  // this is the only point where all current-interval accumulations are visible.
   this->evaluate_busy_ether_adaptive_(now_ms);
 
-  // Publish suggestion event based on current window data (before reset).
+  // Publish suggestion event based on current interval data (before reset).
   this->maybe_publish_suggestion_(now_ms);
 
-  this->diag_total_ = 0;
-  this->diag_ok_ = 0;
-  this->diag_truncated_ = 0;
-  this->diag_dropped_ = 0;
-  this->diag_dropped_by_bucket_.fill(0);
-  this->diag_dropped_by_stage_.fill(0);
-  this->diag_rssi_ok_sum_ = 0;
-  this->diag_rssi_ok_n_ = 0;
-  this->diag_rssi_drop_sum_ = 0;
-  this->diag_rssi_drop_n_ = 0;
-  this->diag_mode_total_.fill(0);
-  this->diag_mode_ok_.fill(0);
-  this->diag_mode_dropped_.fill(0);
-  this->diag_mode_crc_failed_.fill(0);
-  this->diag_mode_rssi_ok_sum_.fill(0);
-  this->diag_mode_rssi_ok_n_.fill(0);
-  this->diag_mode_rssi_drop_sum_.fill(0);
-  this->diag_mode_rssi_drop_n_.fill(0);
-  this->diag_t1_symbols_total_ = 0;
-  this->diag_t1_symbols_invalid_ = 0;
-  this->diag_rx_path_ = {};
+  this->diag_close_interval_();
 }
 
-
 void Radio::maybe_publish_diag_15min_summary_(uint32_t now_ms) {
   if (!this->diag_publish_summary_) return;
   if (!this->diag_publish_summary_15min_) return;
@@ -681,311 +909,10 @@ void Radio::maybe_publish_diag_15min_summary_(uint32_t now_ms) {
   auto *mqtt = esphome::mqtt::global_mqtt_client;
   if (mqtt == nullptr || !mqtt->is_connected()) return;
 
-  const char *listen_mode = (this->radio != nullptr)
-                                ? listen_mode_to_string_(this->radio->get_listen_mode())
-                                : "unknown";
-  const uint32_t interval_s = elapsed / 1000U;
-
-  char payload[2048];
-  const uint32_t crc_failed = this->diag_15m_dropped_by_bucket_[DB_DLL_CRC_FAILED];
-  const uint32_t total = this->diag_15m_total_;
-  const uint32_t ok = this->diag_15m_ok_;
-  const uint32_t crc_fail_pct = (total == 0) ? 0 : (crc_failed * 100U) / total;
-  const uint32_t drop_pct = (total == 0) ? 0 : (this->diag_15m_dropped_ * 100U) / total;
-  const uint32_t trunc_pct = (total == 0) ? 0 : (this->diag_15m_truncated_ * 100U) / total;
-  const int32_t avg_ok_rssi = (this->diag_15m_rssi_ok_n_ == 0) ? 0 : (this->diag_15m_rssi_ok_sum_ / (int32_t) this->diag_15m_rssi_ok_n_);
-  const int32_t avg_drop_rssi = (this->diag_15m_rssi_drop_n_ == 0) ? 0 : (this->diag_15m_rssi_drop_sum_ / (int32_t) this->diag_15m_rssi_drop_n_);
-
-  const uint8_t T1 = (uint8_t) LinkMode::T1;
-  const uint8_t C1 = (uint8_t) LinkMode::C1;
-  const uint32_t t1_total = this->diag_15m_mode_total_[T1];
-  const uint32_t c1_total = this->diag_15m_mode_total_[C1];
-  const uint32_t t1_ok = this->diag_15m_mode_ok_[T1];
-  const uint32_t c1_ok = this->diag_15m_mode_ok_[C1];
-  const uint32_t t1_drop = this->diag_15m_mode_dropped_[T1];
-  const uint32_t c1_drop = this->diag_15m_mode_dropped_[C1];
-  const uint32_t t1_crc = this->diag_15m_mode_crc_failed_[T1];
-  const uint32_t c1_crc = this->diag_15m_mode_crc_failed_[C1];
-  const uint32_t t1_per_pct = (t1_total == 0) ? 0 : (t1_drop * 100U) / t1_total;
-  const uint32_t c1_per_pct = (c1_total == 0) ? 0 : (c1_drop * 100U) / c1_total;
-  const uint32_t t1_crc_pct = (t1_total == 0) ? 0 : (t1_crc * 100U) / t1_total;
-  const uint32_t c1_crc_pct = (c1_total == 0) ? 0 : (c1_crc * 100U) / c1_total;
-  const int32_t t1_avg_ok_rssi = (this->diag_15m_mode_rssi_ok_n_[T1] == 0) ? 0 : (this->diag_15m_mode_rssi_ok_sum_[T1] / (int32_t) this->diag_15m_mode_rssi_ok_n_[T1]);
-  const int32_t c1_avg_ok_rssi = (this->diag_15m_mode_rssi_ok_n_[C1] == 0) ? 0 : (this->diag_15m_mode_rssi_ok_sum_[C1] / (int32_t) this->diag_15m_mode_rssi_ok_n_[C1]);
-  const int32_t t1_avg_drop_rssi = (this->diag_15m_mode_rssi_drop_n_[T1] == 0) ? 0 : (this->diag_15m_mode_rssi_drop_sum_[T1] / (int32_t) this->diag_15m_mode_rssi_drop_n_[T1]);
-  const int32_t c1_avg_drop_rssi = (this->diag_15m_mode_rssi_drop_n_[C1] == 0) ? 0 : (this->diag_15m_mode_rssi_drop_sum_[C1] / (int32_t) this->diag_15m_mode_rssi_drop_n_[C1]);
-
-  const uint32_t t1_sym_total = this->diag_15m_t1_symbols_total_;
-  const uint32_t t1_sym_invalid = this->diag_15m_t1_symbols_invalid_;
-  const uint32_t t1_sym_invalid_pct = (t1_sym_total == 0) ? 0 : (t1_sym_invalid * 100U) / t1_sym_total;
-  const bool is_sx1276 = (this->radio != nullptr && strcmp(this->radio->get_name(), "SX1276") == 0);
-  const int32_t ok_vs_drop_rssi_gap =
-      (this->diag_15m_rssi_ok_n_ == 0 || this->diag_15m_rssi_drop_n_ == 0) ? 0 : (avg_ok_rssi - avg_drop_rssi);
-  const uint32_t rx_false_start_like =
-      this->diag_15m_rx_path_.preamble_read_failed + this->diag_15m_rx_path_.payload_size_unknown +
-      this->diag_15m_rx_path_.weak_start_aborted + this->diag_15m_rx_path_.probe_start_aborted +
-      this->diag_15m_rx_path_.raw_drain_skipped_weak;
-  const uint32_t raw_drain_recovery_pct =
-      (this->diag_15m_rx_path_.raw_drain_attempted == 0)
-          ? 0
-          : (this->diag_15m_rx_path_.raw_drain_recovered * 100U) / this->diag_15m_rx_path_.raw_drain_attempted;
-
-  const uint32_t reasons_sum =
-      this->diag_15m_dropped_by_bucket_[DB_TOO_SHORT] +
-      this->diag_15m_dropped_by_bucket_[DB_DECODE_FAILED] +
-      this->diag_15m_dropped_by_bucket_[DB_DLL_CRC_FAILED] +
-      this->diag_15m_dropped_by_bucket_[DB_UNKNOWN_PREAMBLE] +
-      this->diag_15m_dropped_by_bucket_[DB_L_FIELD_INVALID] +
-      this->diag_15m_dropped_by_bucket_[DB_UNKNOWN_LINK_MODE] +
-      this->diag_15m_dropped_by_bucket_[DB_OTHER];
-  const uint32_t reasons_sum_mismatch = (reasons_sum != this->diag_15m_dropped_) ? 1U : 0U;
-
-  const char *hint_code = "OK";
-  const char *hint_en = "looks good";
-  const char *hint_pl = "wygląda dobrze";
-  if (total == 0) {
-    hint_code = "NO_DATA";
-    hint_en = "no packets received yet";
-    hint_pl = "brak odebranych ramek";
-  } else {
-    if (c1_total > 0 && c1_ok == 0 && c1_crc == c1_total) {
-      if (c1_avg_drop_rssi <= -95) {
-        hint_code = "C1_WEAK_SIGNAL";
-        hint_en = "C1 frames fail DLL CRC at very low RSSI; improve antenna/placement";
-        hint_pl = "C1: CRC DLL nie przechodzi przy bardzo niskim RSSI; popraw antenę/pozycję";
-      } else {
-        hint_code = "C1_INTERFERENCE_OR_RX";
-        hint_en = "C1 frames fail DLL CRC despite decent RSSI; check interference/RX settings";
-        hint_pl = "C1: CRC DLL nie przechodzi mimo niezłego RSSI; sprawdź zakłócenia/ustawienia RX";
-      }
-    } else if (c1_total > 0 && c1_crc > 0 && c1_avg_ok_rssi >= -65 && c1_avg_drop_rssi >= -80) {
-      hint_code = "C1_OVERLOAD_OR_MULTIPATH";
-      hint_en = "C1 CRC fails despite strong RSSI; possible receiver overload or multipath. Move antenna 0.5-2m, change polarization, or attenuate.";
-      hint_pl = "C1: CRC pada mimo dobrego RSSI; możliwy przester odbiornika lub wielodrogowość. Odsuń antenę 0,5-2m, zmień polaryzację lub stłum sygnał.";
-    } else if (t1_total > 0 && t1_crc > 0 && t1_avg_ok_rssi >= -65 && t1_avg_drop_rssi >= -80) {
-      hint_code = "T1_OVERLOAD_OR_MULTIPATH";
-      hint_en = "T1 CRC fails despite strong RSSI; possible receiver overload or multipath. Move/rotate antenna or attenuate.";
-      hint_pl = "T1: CRC pada mimo dobrego RSSI; możliwy przester lub wielodrogowość. Przestaw/obróć antenę lub stłum sygnał.";
-    } else if (is_sx1276 &&
-               drop_pct >= 40 &&
-               avg_drop_rssi <= -90 &&
-               avg_ok_rssi >= -82 &&
-               ok_vs_drop_rssi_gap >= 10 &&
-               (rx_false_start_like >= 40 || this->diag_15m_rx_path_.raw_drain_attempted >= 20 || this->diag_15m_rx_path_.fifo_overrun > 0)) {
-      hint_code = "SX1276_BUSY_ETHER";
-      hint_en = "SX1276 is picking up many very weak/partial T1 starts while valid packets are much stronger; this looks like dense ether with distant or overlapping meters, not just a bad antenna.";
-      hint_pl = "SX1276 łapie dużo bardzo słabych/częściowych startów T1, podczas gdy poprawne pakiety są znacznie silniejsze; to wygląda na gęsty eter z dalekimi lub nakładającymi się licznikami, a nie tylko złą antenę.";
-    } else if (drop_pct >= 40 &&
-               avg_drop_rssi <= -90 &&
-               avg_ok_rssi >= -82 &&
-               ok_vs_drop_rssi_gap >= 10) {
-      hint_code = "BUSY_ETHER_WEAK_TRASH";
-      hint_en = "many dropped packets are far weaker than valid ones; the receiver likely hears lots of distant or overlapping neighbor meters.";
-      hint_pl = "wiele odrzuconych ramek jest dużo słabszych niż poprawne; odbiornik prawdopodobnie słyszy dużo dalekich lub nakładających się liczników sąsiadów.";
-    } else if (drop_pct >= 60 && avg_drop_rssi <= -92 && (ok == 0 || avg_ok_rssi <= -86)) {
-      hint_code = "WEAK_SIGNAL";
-      hint_en = "many drops at very low RSSI and weak valid packets; improve antenna/placement";
-      hint_pl = "dużo dropów przy bardzo niskim RSSI i słabych poprawnych pakietach; popraw antenę/pozycję";
-    } else if (t1_total > 0 && t1_sym_total >= 200 && t1_sym_invalid_pct >= 5) {
-      hint_code = "T1_SYMBOL_ERRORS";
-      hint_en = "T1 has many invalid 3-of-6 symbols; likely collisions, interference, or bit errors";
-      hint_pl = "T1: dużo błędnych symboli 3-of-6; możliwe kolizje, zakłócenia lub błędy bitów";
-    } else if (t1_total > 0 && t1_crc_pct >= 10 && t1_sym_invalid_pct < 2) {
-      hint_code = "T1_BITFLIPS";
-      hint_en = "T1 mostly decodes but often fails DLL CRC; likely occasional bitflips";
-      hint_pl = "T1: dekoduje się, ale często pada CRC DLL; możliwe sporadyczne bitflipy";
-    } else if (is_sx1276 &&
-               drop_pct >= 20 &&
-               (this->diag_15m_rx_path_.preamble_read_failed >= 20 ||
-                this->diag_15m_rx_path_.payload_size_unknown >= 10)) {
-      hint_code = "SX1276_RX_NOISY";
-      hint_en = "SX1276 sees many false starts or undecodable starts; RX frontend likely needs tuning";
-      hint_pl = "SX1276 ma dużo fałszywych startów lub nieustalonych początków ramek; ścieżka RX wymaga strojenia";
-    } else if (ok > 0 && drop_pct <= 10) {
-      hint_code = "GOOD";
-      hint_en = "RF link looks stable";
-      hint_pl = "łącze radiowe wygląda stabilnie";
-    }
-  }
-
-  snprintf(payload, sizeof(payload),
-           "{"
-           "\"event\":\"summary\"," 
-           "\"interval_s\":%u,"
-           "\"uptime_ms\":%lu,"
-           "\"listen_mode\":\"%s\","
-           "\"total\":%u,"
-           "\"ok\":%u,"
-           "\"truncated\":%u,"
-           "\"dropped\":%u,"
-           "\"crc_failed\":%u,"
-           "\"crc_fail_pct\":%u,"
-           "\"drop_pct\":%u,"
-           "\"trunc_pct\":%u,"
-           "\"avg_ok_rssi\":%d,"
-           "\"avg_drop_rssi\":%d,"
-           "\"t1\":{"
-             "\"total\":%u,\"ok\":%u,\"dropped\":%u,\"per_pct\":%u,"
-             "\"crc_failed\":%u,\"crc_pct\":%u,\"avg_ok_rssi\":%d,\"avg_drop_rssi\":%d,"
-             "\"sym_total\":%u,\"sym_invalid\":%u,\"sym_invalid_pct\":%u"
-           "},"
-           "\"c1\":{"
-             "\"total\":%u,\"ok\":%u,\"dropped\":%u,\"per_pct\":%u,"
-             "\"crc_failed\":%u,\"crc_pct\":%u,\"avg_ok_rssi\":%d,\"avg_drop_rssi\":%d"
-           "},"
-           "\"dropped_by_reason\":{"
-             "\"too_short\":%u,"
-             "\"decode_failed\":%u,"
-             "\"dll_crc_failed\":%u,"
-             "\"unknown_preamble\":%u,"
-             "\"l_field_invalid\":%u,"
-             "\"unknown_link_mode\":%u,"
-             "\"other\":%u"
-           "},"
-           "\"dropped_by_stage\":{"
-             "\"precheck\":%u,"
-             "\"t1_decode3of6\":%u,"
-             "\"t1_l_field\":%u,"
-             "\"t1_length_check\":%u,"
-             "\"c1_precheck\":%u,"
-             "\"c1_preamble\":%u,"
-             "\"c1_suffix\":%u,"
-             "\"c1_l_field\":%u,"
-             "\"c1_length_check\":%u,"
-             "\"dll_crc_first\":%u,"
-             "\"dll_crc_mid\":%u,"
-             "\"dll_crc_final\":%u,"
-             "\"dll_crc_b1\":%u,"
-             "\"dll_crc_b2\":%u,"
-             "\"link_mode\":%u,"
-             "\"other\":%u"
-           "},"
-           "\"rx_path\":{"
-             "\"irq_timeout\":%u,"
-             "\"preamble_read_failed\":%u,"
-             "\"preamble_retry_recovered\":%u,"
-             "\"t1_header_read_failed\":%u,"
-             "\"payload_size_unknown\":%u,"
-             "\"raw_drain_attempted\":%u,"
-             "\"raw_drain_recovered\":%u,"
-             "\"raw_drain_recovery_pct\":%u,"
-             "\"raw_drain_bytes\":%u,"
-             "\"payload_read_failed\":%u,"
-             "\"queue_send_failed\":%u,"
-             "\"fifo_overrun\":%u,"
-             "\"weak_start_aborted\":%u,"
-             "\"probe_start_aborted\":%u,"
-             "\"raw_drain_skipped_weak\":%u,"
-             "\"false_start_like\":%u,"
-             "\"probe_abort_rssi\":{\"gt70\":%u,\"70_79\":%u,\"80_89\":%u,\"90_99\":%u,\"lt100\":%u},"
-             "\"weak_abort_rssi\":{\"gt70\":%u,\"70_79\":%u,\"80_89\":%u,\"90_99\":%u,\"lt100\":%u}"
-           "},"
-           "\"reasons_sum\":%u,"
-           "\"reasons_sum_mismatch\":%u,"
-           "\"hint_code\":\"%s\","
-           "\"hint_en\":\"%s\",\"hint_pl\":\"%s\""
-           "}",
-           (unsigned) interval_s,
-           (unsigned long) now_ms,
-           listen_mode,
-           (unsigned) total,
-           (unsigned) this->diag_15m_ok_,
-           (unsigned) this->diag_15m_truncated_,
-           (unsigned) this->diag_15m_dropped_,
-           (unsigned) crc_failed,
-           (unsigned) crc_fail_pct,
-           (unsigned) drop_pct,
-           (unsigned) trunc_pct,
-           (int) avg_ok_rssi,
-           (int) avg_drop_rssi,
-           (unsigned) t1_total,
-           (unsigned) t1_ok,
-           (unsigned) t1_drop,
-           (unsigned) t1_per_pct,
-           (unsigned) t1_crc,
-           (unsigned) t1_crc_pct,
-           (int) t1_avg_ok_rssi,
-           (int) t1_avg_drop_rssi,
-           (unsigned) t1_sym_total,
-           (unsigned) t1_sym_invalid,
-           (unsigned) t1_sym_invalid_pct,
-           (unsigned) c1_total,
-           (unsigned) c1_ok,
-           (unsigned) c1_drop,
-           (unsigned) c1_per_pct,
-           (unsigned) c1_crc,
-           (unsigned) c1_crc_pct,
-           (int) c1_avg_ok_rssi,
-           (int) c1_avg_drop_rssi,
-           (unsigned) this->diag_15m_dropped_by_bucket_[DB_TOO_SHORT],
-           (unsigned) this->diag_15m_dropped_by_bucket_[DB_DECODE_FAILED],
-           (unsigned) this->diag_15m_dropped_by_bucket_[DB_DLL_CRC_FAILED],
-           (unsigned) this->diag_15m_dropped_by_bucket_[DB_UNKNOWN_PREAMBLE],
-           (unsigned) this->diag_15m_dropped_by_bucket_[DB_L_FIELD_INVALID],
-           (unsigned) this->diag_15m_dropped_by_bucket_[DB_UNKNOWN_LINK_MODE],
-           (unsigned) this->diag_15m_dropped_by_bucket_[DB_OTHER],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_PRECHECK],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_T1_DECODE3OF6],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_T1_L_FIELD],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_T1_LENGTH_CHECK],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_C1_PRECHECK],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_C1_PREAMBLE],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_C1_SUFFIX],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_C1_L_FIELD],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_C1_LENGTH_CHECK],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_DLL_CRC_FIRST],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_DLL_CRC_MID],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_DLL_CRC_FINAL],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_DLL_CRC_B1],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_DLL_CRC_B2],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_LINK_MODE],
-           (unsigned) this->diag_15m_dropped_by_stage_[SB_OTHER],
-           (unsigned) this->diag_15m_rx_path_.irq_timeout,
-           (unsigned) this->diag_15m_rx_path_.preamble_read_failed,
-           (unsigned) this->diag_15m_rx_path_.preamble_retry_recovered,
-           (unsigned) this->diag_15m_rx_path_.t1_header_read_failed,
-           (unsigned) this->diag_15m_rx_path_.payload_size_unknown,
-           (unsigned) this->diag_15m_rx_path_.raw_drain_attempted,
-           (unsigned) this->diag_15m_rx_path_.raw_drain_recovered,
-           (unsigned) raw_drain_recovery_pct,
-           (unsigned) this->diag_15m_rx_path_.raw_drain_bytes,
-           (unsigned) this->diag_15m_rx_path_.payload_read_failed,
-           (unsigned) this->diag_15m_rx_path_.queue_send_failed,
-           (unsigned) this->diag_15m_rx_path_.fifo_overrun,
-           (unsigned) this->diag_15m_rx_path_.weak_start_aborted,
-           (unsigned) this->diag_15m_rx_path_.probe_start_aborted,
-           (unsigned) this->diag_15m_rx_path_.raw_drain_skipped_weak,
-           (unsigned) rx_false_start_like,
-           // probe_abort_rssi buckets
-           (unsigned) this->diag_15m_rx_path_.probe_abort_rssi[0],
-           (unsigned) this->diag_15m_rx_path_.probe_abort_rssi[1],
-           (unsigned) this->diag_15m_rx_path_.probe_abort_rssi[2],
-           (unsigned) this->diag_15m_rx_path_.probe_abort_rssi[3],
-           (unsigned) this->diag_15m_rx_path_.probe_abort_rssi[4],
-           // weak_abort_rssi buckets
-           (unsigned) this->diag_15m_rx_path_.weak_abort_rssi[0],
-           (unsigned) this->diag_15m_rx_path_.weak_abort_rssi[1],
-           (unsigned) this->diag_15m_rx_path_.weak_abort_rssi[2],
-           (unsigned) this->diag_15m_rx_path_.weak_abort_rssi[3],
-           (unsigned) this->diag_15m_rx_path_.weak_abort_rssi[4],
-           (unsigned) reasons_sum,
-           (unsigned) reasons_sum_mismatch,
-           hint_code,
-           hint_en,
-           hint_pl);
-
-  const std::string summary_topic = this->diag_summary_15min_topic_();
-  mqtt->publish(summary_topic, payload);
-  ESP_LOGI(TAG, "DIAG 15min summary / podsumowanie 15min diag: topic=%s interval=%us uptime_ms=%lu listen_mode=%s total=%u ok=%u truncated=%u dropped=%u crc_failed=%u",
-           summary_topic.c_str(), (unsigned) interval_s, (unsigned long) now_ms, listen_mode,
-           (unsigned) total, (unsigned) this->diag_15m_ok_,
-           (unsigned) this->diag_15m_truncated_, (unsigned) this->diag_15m_dropped_, (unsigned) crc_failed);
-
-  if (std::strcmp(hint_code, "OK") == 0 || std::strcmp(hint_code, "GOOD") == 0) {
-    ESP_LOGI(TAG, "DIAG hint: %s | %s / %s", hint_code, hint_en, hint_pl);
-  } else {
-    ESP_LOGW(TAG, "DIAG hint: %s | %s / %s", hint_code, hint_en, hint_pl);
-  }
+  DiagCounters c;
+  this->diag_window_counters_(DW_15MIN, c);
+  this->publish_diag_summary_(c, elapsed, now_ms, this->diag_summary_15min_topic_(),
+                              "DIAG 15min summary / podsumowanie 15min diag", false, this->queue_hwm_[DW_15MIN]);
 
   // Publish snapshot of all highlight meters alongside this summary (read-only, no window reset).
   if (this->diag_publish_summary_highlight_meters_ && !this->highlight_meter_stats_.empty()) {
@@ -1007,27 +934,8 @@ void Radio::maybe_publish_diag_15min_summary_(uint32_t now_ms) {
     // Publish all highlight meters as a single batch payload for easier log analysis.
     this->publish_meter_window_batch_("summary_15min", elapsed / 1000U, now_ms);
   }
-  this->diag_15m_total_ = 0;
-  this->diag_15m_ok_ = 0;
-  this->diag_15m_truncated_ = 0;
-  this->diag_15m_dropped_ = 0;
-  this->diag_15m_dropped_by_bucket_.fill(0);
-  this->diag_15m_dropped_by_stage_.fill(0);
-  this->diag_15m_rssi_ok_sum_ = 0;
-  this->diag_15m_rssi_ok_n_ = 0;
-  this->diag_15m_rssi_drop_sum_ = 0;
-  this->diag_15m_rssi_drop_n_ = 0;
-  this->diag_15m_mode_total_.fill(0);
-  this->diag_15m_mode_ok_.fill(0);
-  this->diag_15m_mode_dropped_.fill(0);
-  this->diag_15m_mode_crc_failed_.fill(0);
-  this->diag_15m_mode_rssi_ok_sum_.fill(0);
-  this->diag_15m_mode_rssi_ok_n_.fill(0);
-  this->diag_15m_mode_rssi_drop_sum_.fill(0);
-  this->diag_15m_mode_rssi_drop_n_.fill(0);
-  this->diag_15m_t1_symbols_total_ = 0;
-  this->diag_15m_t1_symbols_invalid_ = 0;
-  this->diag_15m_rx_path_ = {};
+
+  this->diag_window_reset_(DW_15MIN);
 }
 
 
@@ -1046,311 +954,10 @@ void Radio::maybe_publish_diag_60min_summary_(uint32_t now_ms) {
   auto *mqtt = esphome::mqtt::global_mqtt_client;
   if (mqtt == nullptr || !mqtt->is_connected()) return;
 
-  const char *listen_mode = (this->radio != nullptr)
-                                ? listen_mode_to_string_(this->radio->get_listen_mode())
-                                : "unknown";
-  const uint32_t interval_s = elapsed / 1000U;
-
-  char payload[2048];
-  const uint32_t crc_failed = this->diag_60min_dropped_by_bucket_[DB_DLL_CRC_FAILED];
-  const uint32_t total = this->diag_60min_total_;
-  const uint32_t ok = this->diag_60min_ok_;
-  const uint32_t crc_fail_pct = (total == 0) ? 0 : (crc_failed * 100U) / total;
-  const uint32_t drop_pct = (total == 0) ? 0 : (this->diag_60min_dropped_ * 100U) / total;
-  const uint32_t trunc_pct = (total == 0) ? 0 : (this->diag_60min_truncated_ * 100U) / total;
-  const int32_t avg_ok_rssi = (this->diag_60min_rssi_ok_n_ == 0) ? 0 : (this->diag_60min_rssi_ok_sum_ / (int32_t) this->diag_60min_rssi_ok_n_);
-  const int32_t avg_drop_rssi = (this->diag_60min_rssi_drop_n_ == 0) ? 0 : (this->diag_60min_rssi_drop_sum_ / (int32_t) this->diag_60min_rssi_drop_n_);
-
-  const uint8_t T1 = (uint8_t) LinkMode::T1;
-  const uint8_t C1 = (uint8_t) LinkMode::C1;
-  const uint32_t t1_total = this->diag_60min_mode_total_[T1];
-  const uint32_t c1_total = this->diag_60min_mode_total_[C1];
-  const uint32_t t1_ok = this->diag_60min_mode_ok_[T1];
-  const uint32_t c1_ok = this->diag_60min_mode_ok_[C1];
-  const uint32_t t1_drop = this->diag_60min_mode_dropped_[T1];
-  const uint32_t c1_drop = this->diag_60min_mode_dropped_[C1];
-  const uint32_t t1_crc = this->diag_60min_mode_crc_failed_[T1];
-  const uint32_t c1_crc = this->diag_60min_mode_crc_failed_[C1];
-  const uint32_t t1_per_pct = (t1_total == 0) ? 0 : (t1_drop * 100U) / t1_total;
-  const uint32_t c1_per_pct = (c1_total == 0) ? 0 : (c1_drop * 100U) / c1_total;
-  const uint32_t t1_crc_pct = (t1_total == 0) ? 0 : (t1_crc * 100U) / t1_total;
-  const uint32_t c1_crc_pct = (c1_total == 0) ? 0 : (c1_crc * 100U) / c1_total;
-  const int32_t t1_avg_ok_rssi = (this->diag_60min_mode_rssi_ok_n_[T1] == 0) ? 0 : (this->diag_60min_mode_rssi_ok_sum_[T1] / (int32_t) this->diag_60min_mode_rssi_ok_n_[T1]);
-  const int32_t c1_avg_ok_rssi = (this->diag_60min_mode_rssi_ok_n_[C1] == 0) ? 0 : (this->diag_60min_mode_rssi_ok_sum_[C1] / (int32_t) this->diag_60min_mode_rssi_ok_n_[C1]);
-  const int32_t t1_avg_drop_rssi = (this->diag_60min_mode_rssi_drop_n_[T1] == 0) ? 0 : (this->diag_60min_mode_rssi_drop_sum_[T1] / (int32_t) this->diag_60min_mode_rssi_drop_n_[T1]);
-  const int32_t c1_avg_drop_rssi = (this->diag_60min_mode_rssi_drop_n_[C1] == 0) ? 0 : (this->diag_60min_mode_rssi_drop_sum_[C1] / (int32_t) this->diag_60min_mode_rssi_drop_n_[C1]);
-
-  const uint32_t t1_sym_total = this->diag_60min_t1_symbols_total_;
-  const uint32_t t1_sym_invalid = this->diag_60min_t1_symbols_invalid_;
-  const uint32_t t1_sym_invalid_pct = (t1_sym_total == 0) ? 0 : (t1_sym_invalid * 100U) / t1_sym_total;
-  const bool is_sx1276 = (this->radio != nullptr && strcmp(this->radio->get_name(), "SX1276") == 0);
-  const int32_t ok_vs_drop_rssi_gap =
-      (this->diag_60min_rssi_ok_n_ == 0 || this->diag_60min_rssi_drop_n_ == 0) ? 0 : (avg_ok_rssi - avg_drop_rssi);
-  const uint32_t rx_false_start_like =
-      this->diag_60min_rx_path_.preamble_read_failed + this->diag_60min_rx_path_.payload_size_unknown +
-      this->diag_60min_rx_path_.weak_start_aborted + this->diag_60min_rx_path_.probe_start_aborted +
-      this->diag_60min_rx_path_.raw_drain_skipped_weak;
-  const uint32_t raw_drain_recovery_pct =
-      (this->diag_60min_rx_path_.raw_drain_attempted == 0)
-          ? 0
-          : (this->diag_60min_rx_path_.raw_drain_recovered * 100U) / this->diag_60min_rx_path_.raw_drain_attempted;
-
-  const uint32_t reasons_sum =
-      this->diag_60min_dropped_by_bucket_[DB_TOO_SHORT] +
-      this->diag_60min_dropped_by_bucket_[DB_DECODE_FAILED] +
-      this->diag_60min_dropped_by_bucket_[DB_DLL_CRC_FAILED] +
-      this->diag_60min_dropped_by_bucket_[DB_UNKNOWN_PREAMBLE] +
-      this->diag_60min_dropped_by_bucket_[DB_L_FIELD_INVALID] +
-      this->diag_60min_dropped_by_bucket_[DB_UNKNOWN_LINK_MODE] +
-      this->diag_60min_dropped_by_bucket_[DB_OTHER];
-  const uint32_t reasons_sum_mismatch = (reasons_sum != this->diag_60min_dropped_) ? 1U : 0U;
-
-  const char *hint_code = "OK";
-  const char *hint_en = "looks good";
-  const char *hint_pl = "wygląda dobrze";
-  if (total == 0) {
-    hint_code = "NO_DATA";
-    hint_en = "no packets received yet";
-    hint_pl = "brak odebranych ramek";
-  } else {
-    if (c1_total > 0 && c1_ok == 0 && c1_crc == c1_total) {
-      if (c1_avg_drop_rssi <= -95) {
-        hint_code = "C1_WEAK_SIGNAL";
-        hint_en = "C1 frames fail DLL CRC at very low RSSI; improve antenna/placement";
-        hint_pl = "C1: CRC DLL nie przechodzi przy bardzo niskim RSSI; popraw antenę/pozycję";
-      } else {
-        hint_code = "C1_INTERFERENCE_OR_RX";
-        hint_en = "C1 frames fail DLL CRC despite decent RSSI; check interference/RX settings";
-        hint_pl = "C1: CRC DLL nie przechodzi mimo niezłego RSSI; sprawdź zakłócenia/ustawienia RX";
-      }
-    } else if (c1_total > 0 && c1_crc > 0 && c1_avg_ok_rssi >= -65 && c1_avg_drop_rssi >= -80) {
-      hint_code = "C1_OVERLOAD_OR_MULTIPATH";
-      hint_en = "C1 CRC fails despite strong RSSI; possible receiver overload or multipath. Move antenna 0.5-2m, change polarization, or attenuate.";
-      hint_pl = "C1: CRC pada mimo dobrego RSSI; możliwy przester odbiornika lub wielodrogowość. Odsuń antenę 0,5-2m, zmień polaryzację lub stłum sygnał.";
-    } else if (t1_total > 0 && t1_crc > 0 && t1_avg_ok_rssi >= -65 && t1_avg_drop_rssi >= -80) {
-      hint_code = "T1_OVERLOAD_OR_MULTIPATH";
-      hint_en = "T1 CRC fails despite strong RSSI; possible receiver overload or multipath. Move/rotate antenna or attenuate.";
-      hint_pl = "T1: CRC pada mimo dobrego RSSI; możliwy przester lub wielodrogowość. Przestaw/obróć antenę lub stłum sygnał.";
-    } else if (is_sx1276 &&
-               drop_pct >= 40 &&
-               avg_drop_rssi <= -90 &&
-               avg_ok_rssi >= -82 &&
-               ok_vs_drop_rssi_gap >= 10 &&
-               (rx_false_start_like >= 40 || this->diag_60min_rx_path_.raw_drain_attempted >= 20 || this->diag_60min_rx_path_.fifo_overrun > 0)) {
-      hint_code = "SX1276_BUSY_ETHER";
-      hint_en = "SX1276 is picking up many very weak/partial T1 starts while valid packets are much stronger; this looks like dense ether with distant or overlapping meters, not just a bad antenna.";
-      hint_pl = "SX1276 łapie dużo bardzo słabych/częściowych startów T1, podczas gdy poprawne pakiety są znacznie silniejsze; to wygląda na gęsty eter z dalekimi lub nakładającymi się licznikami, a nie tylko złą antenę.";
-    } else if (drop_pct >= 40 &&
-               avg_drop_rssi <= -90 &&
-               avg_ok_rssi >= -82 &&
-               ok_vs_drop_rssi_gap >= 10) {
-      hint_code = "BUSY_ETHER_WEAK_TRASH";
-      hint_en = "many dropped packets are far weaker than valid ones; the receiver likely hears lots of distant or overlapping neighbor meters.";
-      hint_pl = "wiele odrzuconych ramek jest dużo słabszych niż poprawne; odbiornik prawdopodobnie słyszy dużo dalekich lub nakładających się liczników sąsiadów.";
-    } else if (drop_pct >= 60 && avg_drop_rssi <= -92 && (ok == 0 || avg_ok_rssi <= -86)) {
-      hint_code = "WEAK_SIGNAL";
-      hint_en = "many drops at very low RSSI and weak valid packets; improve antenna/placement";
-      hint_pl = "dużo dropów przy bardzo niskim RSSI i słabych poprawnych pakietach; popraw antenę/pozycję";
-    } else if (t1_total > 0 && t1_sym_total >= 200 && t1_sym_invalid_pct >= 5) {
-      hint_code = "T1_SYMBOL_ERRORS";
-      hint_en = "T1 has many invalid 3-of-6 symbols; likely collisions, interference, or bit errors";
-      hint_pl = "T1: dużo błędnych symboli 3-of-6; możliwe kolizje, zakłócenia lub błędy bitów";
-    } else if (t1_total > 0 && t1_crc_pct >= 10 && t1_sym_invalid_pct < 2) {
-      hint_code = "T1_BITFLIPS";
-      hint_en = "T1 mostly decodes but often fails DLL CRC; likely occasional bitflips";
-      hint_pl = "T1: dekoduje się, ale często pada CRC DLL; możliwe sporadyczne bitflipy";
-    } else if (is_sx1276 &&
-               drop_pct >= 20 &&
-               (this->diag_60min_rx_path_.preamble_read_failed >= 20 ||
-                this->diag_60min_rx_path_.payload_size_unknown >= 10)) {
-      hint_code = "SX1276_RX_NOISY";
-      hint_en = "SX1276 sees many false starts or undecodable starts; RX frontend likely needs tuning";
-      hint_pl = "SX1276 ma dużo fałszywych startów lub nieustalonych początków ramek; ścieżka RX wymaga strojenia";
-    } else if (ok > 0 && drop_pct <= 10) {
-      hint_code = "GOOD";
-      hint_en = "RF link looks stable";
-      hint_pl = "łącze radiowe wygląda stabilnie";
-    }
-  }
-
-  snprintf(payload, sizeof(payload),
-           "{"
-           "\"event\":\"summary\"," 
-           "\"interval_s\":%u,"
-           "\"uptime_ms\":%lu,"
-           "\"listen_mode\":\"%s\","
-           "\"total\":%u,"
-           "\"ok\":%u,"
-           "\"truncated\":%u,"
-           "\"dropped\":%u,"
-           "\"crc_failed\":%u,"
-           "\"crc_fail_pct\":%u,"
-           "\"drop_pct\":%u,"
-           "\"trunc_pct\":%u,"
-           "\"avg_ok_rssi\":%d,"
-           "\"avg_drop_rssi\":%d,"
-           "\"t1\":{"
-             "\"total\":%u,\"ok\":%u,\"dropped\":%u,\"per_pct\":%u,"
-             "\"crc_failed\":%u,\"crc_pct\":%u,\"avg_ok_rssi\":%d,\"avg_drop_rssi\":%d,"
-             "\"sym_total\":%u,\"sym_invalid\":%u,\"sym_invalid_pct\":%u"
-           "},"
-           "\"c1\":{"
-             "\"total\":%u,\"ok\":%u,\"dropped\":%u,\"per_pct\":%u,"
-             "\"crc_failed\":%u,\"crc_pct\":%u,\"avg_ok_rssi\":%d,\"avg_drop_rssi\":%d"
-           "},"
-           "\"dropped_by_reason\":{"
-             "\"too_short\":%u,"
-             "\"decode_failed\":%u,"
-             "\"dll_crc_failed\":%u,"
-             "\"unknown_preamble\":%u,"
-             "\"l_field_invalid\":%u,"
-             "\"unknown_link_mode\":%u,"
-             "\"other\":%u"
-           "},"
-           "\"dropped_by_stage\":{"
-             "\"precheck\":%u,"
-             "\"t1_decode3of6\":%u,"
-             "\"t1_l_field\":%u,"
-             "\"t1_length_check\":%u,"
-             "\"c1_precheck\":%u,"
-             "\"c1_preamble\":%u,"
-             "\"c1_suffix\":%u,"
-             "\"c1_l_field\":%u,"
-             "\"c1_length_check\":%u,"
-             "\"dll_crc_first\":%u,"
-             "\"dll_crc_mid\":%u,"
-             "\"dll_crc_final\":%u,"
-             "\"dll_crc_b1\":%u,"
-             "\"dll_crc_b2\":%u,"
-             "\"link_mode\":%u,"
-             "\"other\":%u"
-           "},"
-           "\"rx_path\":{"
-             "\"irq_timeout\":%u,"
-             "\"preamble_read_failed\":%u,"
-             "\"preamble_retry_recovered\":%u,"
-             "\"t1_header_read_failed\":%u,"
-             "\"payload_size_unknown\":%u,"
-             "\"raw_drain_attempted\":%u,"
-             "\"raw_drain_recovered\":%u,"
-             "\"raw_drain_recovery_pct\":%u,"
-             "\"raw_drain_bytes\":%u,"
-             "\"payload_read_failed\":%u,"
-             "\"queue_send_failed\":%u,"
-             "\"fifo_overrun\":%u,"
-             "\"weak_start_aborted\":%u,"
-             "\"probe_start_aborted\":%u,"
-             "\"raw_drain_skipped_weak\":%u,"
-             "\"false_start_like\":%u,"
-             "\"probe_abort_rssi\":{\"gt70\":%u,\"70_79\":%u,\"80_89\":%u,\"90_99\":%u,\"lt100\":%u},"
-             "\"weak_abort_rssi\":{\"gt70\":%u,\"70_79\":%u,\"80_89\":%u,\"90_99\":%u,\"lt100\":%u}"
-           "},"
-           "\"reasons_sum\":%u,"
-           "\"reasons_sum_mismatch\":%u,"
-           "\"hint_code\":\"%s\","
-           "\"hint_en\":\"%s\",\"hint_pl\":\"%s\""
-           "}",
-           (unsigned) interval_s,
-           (unsigned long) now_ms,
-           listen_mode,
-           (unsigned) total,
-           (unsigned) this->diag_60min_ok_,
-           (unsigned) this->diag_60min_truncated_,
-           (unsigned) this->diag_60min_dropped_,
-           (unsigned) crc_failed,
-           (unsigned) crc_fail_pct,
-           (unsigned) drop_pct,
-           (unsigned) trunc_pct,
-           (int) avg_ok_rssi,
-           (int) avg_drop_rssi,
-           (unsigned) t1_total,
-           (unsigned) t1_ok,
-           (unsigned) t1_drop,
-           (unsigned) t1_per_pct,
-           (unsigned) t1_crc,
-           (unsigned) t1_crc_pct,
-           (int) t1_avg_ok_rssi,
-           (int) t1_avg_drop_rssi,
-           (unsigned) t1_sym_total,
-           (unsigned) t1_sym_invalid,
-           (unsigned) t1_sym_invalid_pct,
-           (unsigned) c1_total,
-           (unsigned) c1_ok,
-           (unsigned) c1_drop,
-           (unsigned) c1_per_pct,
-           (unsigned) c1_crc,
-           (unsigned) c1_crc_pct,
-           (int) c1_avg_ok_rssi,
-           (int) c1_avg_drop_rssi,
-           (unsigned) this->diag_60min_dropped_by_bucket_[DB_TOO_SHORT],
-           (unsigned) this->diag_60min_dropped_by_bucket_[DB_DECODE_FAILED],
-           (unsigned) this->diag_60min_dropped_by_bucket_[DB_DLL_CRC_FAILED],
-           (unsigned) this->diag_60min_dropped_by_bucket_[DB_UNKNOWN_PREAMBLE],
-           (unsigned) this->diag_60min_dropped_by_bucket_[DB_L_FIELD_INVALID],
-           (unsigned) this->diag_60min_dropped_by_bucket_[DB_UNKNOWN_LINK_MODE],
-           (unsigned) this->diag_60min_dropped_by_bucket_[DB_OTHER],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_PRECHECK],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_T1_DECODE3OF6],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_T1_L_FIELD],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_T1_LENGTH_CHECK],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_C1_PRECHECK],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_C1_PREAMBLE],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_C1_SUFFIX],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_C1_L_FIELD],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_C1_LENGTH_CHECK],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_DLL_CRC_FIRST],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_DLL_CRC_MID],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_DLL_CRC_FINAL],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_DLL_CRC_B1],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_DLL_CRC_B2],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_LINK_MODE],
-           (unsigned) this->diag_60min_dropped_by_stage_[SB_OTHER],
-           (unsigned) this->diag_60min_rx_path_.irq_timeout,
-           (unsigned) this->diag_60min_rx_path_.preamble_read_failed,
-           (unsigned) this->diag_60min_rx_path_.preamble_retry_recovered,
-           (unsigned) this->diag_60min_rx_path_.t1_header_read_failed,
-           (unsigned) this->diag_60min_rx_path_.payload_size_unknown,
-           (unsigned) this->diag_60min_rx_path_.raw_drain_attempted,
-           (unsigned) this->diag_60min_rx_path_.raw_drain_recovered,
-           (unsigned) raw_drain_recovery_pct,
-           (unsigned) this->diag_60min_rx_path_.raw_drain_bytes,
-           (unsigned) this->diag_60min_rx_path_.payload_read_failed,
-           (unsigned) this->diag_60min_rx_path_.queue_send_failed,
-           (unsigned) this->diag_60min_rx_path_.fifo_overrun,
-           (unsigned) this->diag_60min_rx_path_.weak_start_aborted,
-           (unsigned) this->diag_60min_rx_path_.probe_start_aborted,
-           (unsigned) this->diag_60min_rx_path_.raw_drain_skipped_weak,
-           (unsigned) rx_false_start_like,
-           // probe_abort_rssi buckets
-           (unsigned) this->diag_60min_rx_path_.probe_abort_rssi[0],
-           (unsigned) this->diag_60min_rx_path_.probe_abort_rssi[1],
-           (unsigned) this->diag_60min_rx_path_.probe_abort_rssi[2],
-           (unsigned) this->diag_60min_rx_path_.probe_abort_rssi[3],
-           (unsigned) this->diag_60min_rx_path_.probe_abort_rssi[4],
-           // weak_abort_rssi buckets
-           (unsigned) this->diag_60min_rx_path_.weak_abort_rssi[0],
-           (unsigned) this->diag_60min_rx_path_.weak_abort_rssi[1],
-           (unsigned) this->diag_60min_rx_path_.weak_abort_rssi[2],
-           (unsigned) this->diag_60min_rx_path_.weak_abort_rssi[3],
-           (unsigned) this->diag_60min_rx_path_.weak_abort_rssi[4],
-           (unsigned) reasons_sum,
-           (unsigned) reasons_sum_mismatch,
-           hint_code,
-           hint_en,
-           hint_pl);
-
-  const std::string summary_topic = this->diag_summary_60min_topic_();
-  mqtt->publish(summary_topic, payload);
-  ESP_LOGI(TAG, "DIAG 60min summary / podsumowanie 60min diag: topic=%s interval=%us uptime_ms=%lu listen_mode=%s total=%u ok=%u truncated=%u dropped=%u crc_failed=%u",
-           summary_topic.c_str(), (unsigned) interval_s, (unsigned long) now_ms, listen_mode,
-           (unsigned) total, (unsigned) this->diag_60min_ok_,
-           (unsigned) this->diag_60min_truncated_, (unsigned) this->diag_60min_dropped_, (unsigned) crc_failed);
-
-  if (std::strcmp(hint_code, "OK") == 0 || std::strcmp(hint_code, "GOOD") == 0) {
-    ESP_LOGI(TAG, "DIAG hint: %s | %s / %s", hint_code, hint_en, hint_pl);
-  } else {
-    ESP_LOGW(TAG, "DIAG hint: %s | %s / %s", hint_code, hint_en, hint_pl);
-  }
+  DiagCounters c;
+  this->diag_window_counters_(DW_60MIN, c);
+  this->publish_diag_summary_(c, elapsed, now_ms, this->diag_summary_60min_topic_(),
+                              "DIAG 60min summary / podsumowanie 60min diag", false, this->queue_hwm_[DW_60MIN]);
 
   // Publish snapshot of all highlight meters alongside this summary (read-only, no window reset).
   if (this->diag_publish_summary_highlight_meters_ && !this->highlight_meter_stats_.empty()) {
@@ -1382,28 +989,9 @@ void Radio::maybe_publish_diag_60min_summary_(uint32_t now_ms) {
     }
   }
 
-  this->diag_60min_total_ = 0;
-  this->diag_60min_ok_ = 0;
-  this->diag_60min_truncated_ = 0;
-  this->diag_60min_dropped_ = 0;
-  this->diag_60min_dropped_by_bucket_.fill(0);
-  this->diag_60min_dropped_by_stage_.fill(0);
-  this->diag_60min_rssi_ok_sum_ = 0;
-  this->diag_60min_rssi_ok_n_ = 0;
-  this->diag_60min_rssi_drop_sum_ = 0;
-  this->diag_60min_rssi_drop_n_ = 0;
-  this->diag_60min_mode_total_.fill(0);
-  this->diag_60min_mode_ok_.fill(0);
-  this->diag_60min_mode_dropped_.fill(0);
-  this->diag_60min_mode_crc_failed_.fill(0);
-  this->diag_60min_mode_rssi_ok_sum_.fill(0);
-  this->diag_60min_mode_rssi_ok_n_.fill(0);
-  this->diag_60min_mode_rssi_drop_sum_.fill(0);
-  this->diag_60min_mode_rssi_drop_n_.fill(0);
-  this->diag_60min_t1_symbols_total_ = 0;
-  this->diag_60min_t1_symbols_invalid_ = 0;
-  this->diag_60min_rx_path_ = {};
+  this->diag_window_reset_(DW_60MIN);
 }
 
+
 }  // namespace wmbus_radio
 }  // namespace esphome
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 namespace esphome {
@@ -9,16 +11,28 @@ namespace wmbus_common {
 // EN 13757 CRC16 used in wM-Bus DLL
 static constexpr uint16_t CRC16_EN_13757_POLY = 0x3D65;
 
-inline uint16_t crc16_en13757_per_byte(uint16_t crc, uint8_t b) {
-  for (int i = 0; i < 8; i++) {
-    if ((((crc & 0x8000) >> 8) ^ (b & 0x80)) != 0) {
-      crc = (uint16_t)((crc << 1) ^ CRC16_EN_13757_POLY);
-    } else {
-      crc = (uint16_t)(crc << 1);
+// Byte-at-a-time lookup table for the MSB-first CRC above, generated at
+// compile time (512 B of flash). Every good frame runs the CRC over all of
+// its bytes, so this replaces 8 shift/xor rounds per byte with one lookup.
+// A slice-by-4 variant was not worth another 1.5 KB: DLL blocks are only
+// 10 or 16 bytes long.
+struct Crc16En13757Table {
+  uint16_t entries[256];
+  constexpr Crc16En13757Table() : entries() {
+    for (int i = 0; i < 256; i++) {
+      uint16_t crc = (uint16_t)(i << 8);
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_EN_13757_POLY) : (uint16_t)(crc << 1);
+      }
+      this->entries[i] = crc;
     }
-    b <<= 1;
   }
-  return crc;
+};
+
+inline constexpr Crc16En13757Table CRC16_EN_13757_TABLE{};
+
+inline uint16_t crc16_en13757_per_byte(uint16_t crc, uint8_t b) {
+  return (uint16_t)((crc << 8) ^ CRC16_EN_13757_TABLE.entries[((crc >> 8) ^ b) & 0xFF]);
 }
 
 inline uint16_t crc16_en13757(const uint8_t *data, size_t len) {
@@ -29,10 +43,50 @@ inline uint16_t crc16_en13757(const uint8_t *data, size_t len) {
   return (uint16_t)(~crc);
 }
 
+// Where trim_dll_crc_format_a/b stopped. An enum rather than a string so a
+// failing frame costs no string work; dll_crc_stage_name() gives the text.
+enum class DLLCRCStage : uint8_t {
+  NONE = 0,
+  FORMAT_A_TOO_SHORT,
+  FORMAT_B_TOO_SHORT,
+  FORMAT_B_BAD_LENGTH,
+  FIRST,
+  MID,
+  FINAL,
+  B1,
+  B2,
+  OK,
+};
+
+inline const char *dll_crc_stage_name(DLLCRCStage s) {
+  switch (s) {
+    case DLLCRCStage::FORMAT_A_TOO_SHORT:
+      return "format_a_too_short";
+    case DLLCRCStage::FORMAT_B_TOO_SHORT:
+      return "format_b_too_short";
+    case DLLCRCStage::FORMAT_B_BAD_LENGTH:
+      return "format_b_bad_length";
+    case DLLCRCStage::FIRST:
+      return "dll_crc_first";
+    case DLLCRCStage::MID:
+      return "dll_crc_mid";
+    case DLLCRCStage::FINAL:
+      return "dll_crc_final";
+    case DLLCRCStage::B1:
+      return "dll_crc_b1";
+    case DLLCRCStage::B2:
+      return "dll_crc_b2";
+    case DLLCRCStage::OK:
+      return "ok";
+    default:
+      return "none";
+  }
+}
+
 struct DLLCRCResult {
   bool ok{false};
   const char *format{""};
-  const char *stage{"none"};
+  DLLCRCStage stage{DLLCRCStage::NONE};
   uint16_t calculated{0};
   uint16_t expected{0};
   size_t data_pos{0};
@@ -48,26 +102,30 @@ inline void dll_crc_result_reset_(DLLCRCResult *diag, const char *format, size_t
   *diag = {};
   diag->format = format;
   diag->input_len = input_len;
-  diag->stage = "none";
 }
 
 // Try trim DLL CRC for Frame Format A (returns true if trimmed & CRCs OK)
+//
+// All block CRCs are verified first without touching the buffer, so a frame
+// that fails is left exactly as received (callers may retry it as format B).
+// Only then are the CRC bytes squeezed out in place: data only ever moves
+// towards the front, and the final resize() shrinks, so the success path does
+// not allocate.
 inline bool trim_dll_crc_format_a(std::vector<uint8_t> &payload, DLLCRCResult *diag = nullptr) {
   dll_crc_result_reset_(diag, "A", payload.size());
   if (payload.size() < 12) {
-    if (diag != nullptr) diag->stage = "format_a_too_short";
+    if (diag != nullptr) diag->stage = DLLCRCStage::FORMAT_A_TOO_SHORT;
     return false;
   }
 
   const size_t len = payload.size();
-  std::vector<uint8_t> out;
 
   // First block: 10 bytes + 2 CRC
   {
     uint16_t calc = crc16_en13757(payload.data(), 10);
     uint16_t check = (uint16_t)(payload[10] << 8 | payload[11]);
     if (diag != nullptr) {
-      diag->stage = "dll_crc_first";
+      diag->stage = DLLCRCStage::FIRST;
       diag->calculated = calc;
       diag->expected = check;
       diag->data_pos = 0;
@@ -75,7 +133,6 @@ inline bool trim_dll_crc_format_a(std::vector<uint8_t> &payload, DLLCRCResult *d
       diag->crc_pos = 10;
     }
     if (calc != check) return false;
-    out.insert(out.end(), payload.begin(), payload.begin() + 10);
   }
 
   // Middle blocks: 16 bytes + 2 CRC
@@ -85,7 +142,7 @@ inline bool trim_dll_crc_format_a(std::vector<uint8_t> &payload, DLLCRCResult *d
     size_t crc_pos = pos + 16;
     uint16_t check = (uint16_t)(payload[crc_pos] << 8 | payload[crc_pos + 1]);
     if (diag != nullptr) {
-      diag->stage = "dll_crc_mid";
+      diag->stage = DLLCRCStage::MID;
       diag->calculated = calc;
       diag->expected = check;
       diag->data_pos = pos;
@@ -93,16 +150,16 @@ inline bool trim_dll_crc_format_a(std::vector<uint8_t> &payload, DLLCRCResult *d
       diag->crc_pos = crc_pos;
     }
     if (calc != check) return false;
-    out.insert(out.end(), payload.begin() + pos, payload.begin() + pos + 16);
   }
 
   // Final block: (len-2 - pos) bytes + 2 CRC
+  size_t final_len = 0;
   if (pos < len - 2) {
     const size_t data_len = (len - 2) - pos;
     uint16_t calc = crc16_en13757(payload.data() + pos, data_len);
     uint16_t check = (uint16_t)(payload[len - 2] << 8 | payload[len - 1]);
     if (diag != nullptr) {
-      diag->stage = "dll_crc_final";
+      diag->stage = DLLCRCStage::FINAL;
       diag->calculated = calc;
       diag->expected = check;
       diag->data_pos = pos;
@@ -110,42 +167,58 @@ inline bool trim_dll_crc_format_a(std::vector<uint8_t> &payload, DLLCRCResult *d
       diag->crc_pos = len - 2;
     }
     if (calc != check) return false;
-    out.insert(out.end(), payload.begin() + pos, payload.begin() + (len - 2));
+    final_len = data_len;
   }
 
-  if (out.empty()) {
-    if (diag != nullptr) diag->stage = "format_a_empty_output";
-    return false;
+  // Compact: first block stays where it is, each following block slides
+  // down over the CRC bytes in front of it.
+  uint8_t *p = payload.data();
+  size_t out_len = 10;
+  size_t src = 12;
+  for (; src + 18 <= len; src += 18) {
+    std::memmove(p + out_len, p + src, 16);
+    out_len += 16;
+  }
+  if (final_len > 0) {
+    std::memmove(p + out_len, p + src, final_len);
+    out_len += final_len;
   }
+  payload.resize(out_len);
 
   // Fix L-field (length without itself)
-  out[0] = (uint8_t)(out.size() - 1);
+  payload[0] = (uint8_t)(out_len - 1);
   if (diag != nullptr) {
     diag->ok = true;
-    diag->stage = "ok";
-    diag->output_len = out.size();
-    diag->removed_bytes = (uint16_t)(len - out.size());
+    diag->stage = DLLCRCStage::OK;
+    diag->output_len = out_len;
+    diag->removed_bytes = (uint16_t)(len - out_len);
   }
-  payload = std::move(out);
   return true;
 }
 
 // Try trim DLL CRC for Frame Format B (returns true if trimmed & CRCs OK)
+// Same verify-then-compact-in-place scheme as format A.
 inline bool trim_dll_crc_format_b(std::vector<uint8_t> &payload, DLLCRCResult *diag = nullptr) {
   dll_crc_result_reset_(diag, "B", payload.size());
   if (payload.size() < 12) {
-    if (diag != nullptr) diag->stage = "format_b_too_short";
+    if (diag != nullptr) diag->stage = DLLCRCStage::FORMAT_B_TOO_SHORT;
     return false;
   }
 
   const size_t len = payload.size();
-  std::vector<uint8_t> out;
 
   size_t crc1_pos, crc2_pos;
   if (len <= 128) {
     crc1_pos = len - 2;
     crc2_pos = 0;
   } else {
+    // 129 bytes would put the second CRC on top of the first one (the old
+    // copy-based code read one byte past the end here); nothing valid has
+    // that length, so reject it before computing the second block.
+    if (len < 130) {
+      if (diag != nullptr) diag->stage = DLLCRCStage::FORMAT_B_BAD_LENGTH;
+      return false;
+    }
     crc1_pos = 126;
     crc2_pos = len - 2;
   }
@@ -155,7 +228,7 @@ inline bool trim_dll_crc_format_b(std::vector<uint8_t> &payload, DLLCRCResult *d
     uint16_t calc = crc16_en13757(payload.data(), crc1_pos);
     uint16_t check = (uint16_t)(payload[crc1_pos] << 8 | payload[crc1_pos + 1]);
     if (diag != nullptr) {
-      diag->stage = "dll_crc_b1";
+      diag->stage = DLLCRCStage::B1;
       diag->calculated = calc;
       diag->expected = check;
       diag->data_pos = 0;
@@ -163,17 +236,17 @@ inline bool trim_dll_crc_format_b(std::vector<uint8_t> &payload, DLLCRCResult *d
       diag->crc_pos = crc1_pos;
     }
     if (calc != check) return false;
-    out.insert(out.end(), payload.begin(), payload.begin() + crc1_pos);
   }
 
   // Optional CRC2 over [crc1_pos+2 .. crc2_pos)
+  size_t out_len = crc1_pos;
   if (crc2_pos > 0) {
     const size_t start = crc1_pos + 2;
     const size_t data_len = crc2_pos - start;
     uint16_t calc = crc16_en13757(payload.data() + start, data_len);
     uint16_t check = (uint16_t)(payload[crc2_pos] << 8 | payload[crc2_pos + 1]);
     if (diag != nullptr) {
-      diag->stage = "dll_crc_b2";
+      diag->stage = DLLCRCStage::B2;
       diag->calculated = calc;
       diag->expected = check;
       diag->data_pos = start;
@@ -181,22 +254,18 @@ inline bool trim_dll_crc_format_b(std::vector<uint8_t> &payload, DLLCRCResult *d
       diag->crc_pos = crc2_pos;
     }
     if (calc != check) return false;
-    out.insert(out.end(), payload.begin() + start, payload.begin() + crc2_pos);
-  }
-
-  if (out.empty()) {
-    if (diag != nullptr) diag->stage = "format_b_empty_output";
-    return false;
+    std::memmove(payload.data() + crc1_pos, payload.data() + start, data_len);
+    out_len += data_len;
   }
+  payload.resize(out_len);
 
-  out[0] = (uint8_t)(out.size() - 1);
+  payload[0] = (uint8_t)(out_len - 1);
   if (diag != nullptr) {
     diag->ok = true;
-    diag->stage = "ok";
-    diag->output_len = out.size();
-    diag->removed_bytes = (uint16_t)(len - out.size());
+    diag->stage = DLLCRCStage::OK;
+    diag->output_len = out_len;
+    diag->removed_bytes = (uint16_t)(len - out_len);
   }
-  payload = std::move(out);
   return true;
 }
 
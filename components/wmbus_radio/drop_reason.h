@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <cstdint>
+
+// Why and where convert_to_frame() rejected a packet.
+//
+// Busy sites drop a large share of what they hear, so the parser records a
+// failure as two small enums plus the handful of numbers the human-readable
+// detail is built from. The text ("stage=... reason=... detail=...") is only
+// formatted when a drop event is actually logged or published; the names
+// below are the exact strings earlier builds stored per packet, so MQTT and
+// log output is unchanged.
+
+namespace esphome {
+namespace wmbus_radio {
+
+enum class DropStage : uint8_t {
+  NONE = 0,
+  PRECHECK,
+  T1_DECODE3OF6,
+  T1_L_FIELD,
+  T1_LENGTH_CHECK,
+  C1_PRECHECK,
+  C1_PREAMBLE,
+  C1_SUFFIX,
+  C1_L_FIELD,
+  C1_LENGTH_CHECK,
+  S1_PRECHECK,
+  S1_MANCHESTER,
+  S1_L_FIELD,
+  S1_LENGTH_CHECK,
+  DLL_CRC_FIRST,
+  DLL_CRC_MID,
+  DLL_CRC_FINAL,
+  DLL_CRC_B1,
+  DLL_CRC_B2,
+  FORMAT_A_TOO_SHORT,
+  FORMAT_B_TOO_SHORT,
+  FORMAT_B_BAD_LENGTH,
+};
+
+enum class DropReason : uint8_t {
+  NONE = 0,
+  TOO_SHORT,
+  DECODE_FAILED,
+  L_FIELD_INVALID,
+  TRUNCATED,
+  DLL_CRC_FAILED,
+  UNKNOWN_PREAMBLE,
+};
+
+inline const char *drop_stage_name(DropStage s) {
+  switch (s) {
+    case DropStage::PRECHECK:
+      return "precheck";
+    case DropStage::T1_DECODE3OF6:
+      return "t1_decode3of6";
+    case DropStage::T1_L_FIELD:
+      return "t1_l_field";
+    case DropStage::T1_LENGTH_CHECK:
+      return "t1_length_check";
+    case DropStage::C1_PRECHECK:
+      return "c1_precheck";
+    case DropStage::C1_PREAMBLE:
+      return "c1_preamble";
+    case DropStage::C1_SUFFIX:
+      return "c1_suffix";
+    case DropStage::C1_L_FIELD:
+      return "c1_l_field";
+    case DropStage::C1_LENGTH_CHECK:
+      return "c1_length_check";
+    case DropStage::S1_PRECHECK:
+      return "s1_precheck";
+    case DropStage::S1_MANCHESTER:
+      return "s1_manchester";
+    case DropStage::S1_L_FIELD:
+      return "s1_l_field";
+    case DropStage::S1_LENGTH_CHECK:
+      return "s1_length_check";
+    case DropStage::DLL_CRC_FIRST:
+      return "dll_crc_first";
+    case DropStage::DLL_CRC_MID:
+      return "dll_crc_mid";
+    case DropStage::DLL_CRC_FINAL:
+      return "dll_crc_final";
+    case DropStage::DLL_CRC_B1:
+      return "dll_crc_b1";
+    case DropStage::DLL_CRC_B2:
+      return "dll_crc_b2";
+    case DropStage::FORMAT_A_TOO_SHORT:
+      return "format_a_too_short";
+    case DropStage::FORMAT_B_TOO_SHORT:
+      return "format_b_too_short";
+    case DropStage::FORMAT_B_BAD_LENGTH:
+      return "format_b_bad_length";
+    default:
+      return "";
+  }
+}
+
+inline const char *drop_reason_name(DropReason r) {
+  switch (r) {
+    case DropReason::TOO_SHORT:
+      return "too_short";
+    case DropReason::DECODE_FAILED:
+      return "decode_failed";
+    case DropReason::L_FIELD_INVALID:
+      return "l_field_invalid";
+    case DropReason::TRUNCATED:
+      return "truncated";
+    case DropReason::DLL_CRC_FAILED:
+      return "dll_crc_failed";
+    case DropReason::UNKNOWN_PREAMBLE:
+      return "unknown_preamble";
+    default:
+      return "";
+  }
+}
+
+// Values that only the drop detail text needs. Lengths, symbol counts and
+// the frame format are already kept on the packet and are not repeated here.
+struct DropInfo {
+  DropStage stage{DropStage::NONE};
+  DropReason reason{DropReason::NONE};
+  uint8_t l_field{0};
+  // Rejected C1 first byte / block preamble
+  uint8_t byte{0};
+  // S1 Manchester polarity that produced this result, -1 outside S1
+  int8_t polarity{-1};
+  // T1 decoded without symbol statistics (C1 -> T1 fallback)
+  bool fail_fast{false};
+  bool fallback_used{false};
+  // DLL CRC block that failed (DLL_CRC_* stages)
+  uint16_t crc_calculated{0};
+  uint16_t crc_expected{0};
+  uint16_t crc_data_pos{0};
+  uint16_t crc_data_len{0};
+  uint16_t crc_pos{0};
+  uint16_t crc_input_len{0};
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "telegram_wire.h"
+
+namespace esphome {
+namespace wmbus_radio {
+
+// Frames waiting for MQTT (offline_buffer_size): a byte ring of binary
+// telegram records (telegram_wire.h), oldest first.
+//
+// Records are variable length, so a short T1 frame costs its own size and
+// not a 256-byte slot; every record carries its receive time and length, and
+// a record may wrap around the end of the buffer. When a new record does not
+// fit, the oldest ones are evicted until it does.
+//
+// The buffer is owned by the caller (setup() allocates it, in PSRAM if asked
+// to); loop() is the only user, so there is no locking.
+class FrameStore {
+ public:
+  void attach(uint8_t *buf, size_t cap) {
+    this->buf_ = buf;
+    this->cap_ = buf != nullptr ? cap : 0;
+    this->head_ = this->used_ = 0;
+    this->frames_ = 0;
+  }
+  bool enabled() const { return this->cap_ != 0; }
+
+  // Appends one record; returns the number of older records evicted to make
+  // room. A record longer than the whole buffer is not stored (returns
+  // false) and evicts nothing.
+  bool push(const TelegramWireHeader &h, const uint8_t *payload, size_t len, uint32_t &evicted) {
+    evicted = 0;
+    const size_t rec_len = TELEGRAM_WIRE_HEADER_LEN + len;
+    if (len > 0xFFFF || rec_len > this->cap_) return false;
+    while (this->cap_ - this->used_ < rec_len) {
+      this->drop_oldest_();
+      evicted++;
+    }
+    uint8_t hdr[TELEGRAM_WIRE_HEADER_LEN];
+    telegram_wire_encode_header(hdr, h, len);
+    const size_t tail = (this->head_ + this->used_) % this->cap_;
+    this->copy_in_(tail, hdr, sizeof(hdr));
+    this->copy_in_((tail + sizeof(hdr)) % this->cap_, payload, len);
+    this->used_ += rec_len;
+    this->frames_++;
+    return true;
+  }
+
+  // Copies the oldest record, contiguous, into rec (decode it with
+  // telegram_wire_decode()) and leaves it stored; pop_front() removes it once
+  // it has been sent. rec keeps its capacity, so a caller that reserved it
+  // once does not allocate here.
+  bool front(std::vector<uint8_t> &rec) const {
+    if (this->frames_ == 0) return false;
+    const size_t rec_len = this->oldest_len_();
+    rec.resize(rec_len);
+    this->copy_out_(this->head_, rec.data(), rec_len);
+    return true;
+  }
+  void pop_front() {
+    if (this->frames_ != 0) this->drop_oldest_();
+  }
+
+  uint32_t frames() const { return this->frames_; }
+  size_t bytes() const { return this->used_; }
+  size_t capacity() const { return this->cap_; }
+
+ protected:
+  size_t oldest_len_() const {
+    uint8_t lens[2];
+    this->copy_out_((this->head_ + 10) % this->cap_, lens, 2);
+    return TELEGRAM_WIRE_HEADER_LEN + (size_t) (lens[0] | (lens[1] << 8));
+  }
+  void drop_oldest_() {
+    const size_t rec_len = this->oldest_len_();
+    this->head_ = (this->head_ + rec_len) % this->cap_;
+    this->used_ -= rec_len;
+    this->frames_--;
+  }
+  void copy_in_(size_t at, const uint8_t *src, size_t n) {
+    if (n == 0) return;
+    const size_t first = n < this->cap_ - at ? n : this->cap_ - at;
+    std::memcpy(this->buf_ + at, src, first);
+    std::memcpy(this->buf_, src + first, n - first);
+  }
+  void copy_out_(size_t at, uint8_t *dst, size_t n) const {
+    const size_t first = n < this->cap_ - at ? n : this->cap_ - at;
+    std::memcpy(dst, this->buf_ + at, first);
+    std::memcpy(dst + first, this->buf_, n - first);
+  }
+
+  uint8_t *buf_{nullptr};
+  size_t cap_{0};
+  size_t head_{0};  // offset of the oldest record
+  size_t used_{0};
+  uint32_t frames_{0};
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
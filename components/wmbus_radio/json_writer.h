@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace wmbus_radio {
+
+// Append-only JSON writer over a caller-owned buffer. Used by every MQTT
+// publisher instead of hand-written snprintf() templates and std::string
+// concatenation.
+//
+// It never allocates and never writes past cap. A token (a key with its
+// comma, or a whole value, escaped string values included) that does not fit
+// is not written at all: the writer sets truncated() and ignores everything
+// after it, so the buffer always holds a NUL-terminated prefix and a caller
+// checks one flag instead of every snprintf() return value. Commas between
+// members are inserted automatically (up to MAX_DEPTH levels of nesting).
+//
+// String values are escaped (quotes, backslashes, control characters);
+// bytes >= 0x80 pass through, so UTF-8 text stays as it is. Keys are written
+// verbatim and must not need escaping.
+class JsonWriter {
+ public:
+  static constexpr uint8_t MAX_DEPTH = 31;
+
+  JsonWriter(char *buf, size_t cap) : buf_(buf), cap_(cap) {
+    if (cap == 0)
+      this->truncated_ = true;
+    else
+      buf[0] = '\0';
+  }
+
+  // nullptr key: array element or the top-level value.
+  JsonWriter &begin_object(const char *key = nullptr) { return this->open_(key, '{'); }
+  JsonWriter &end_object() { return this->close_('}'); }
+  JsonWriter &begin_array(const char *key = nullptr) { return this->open_(key, '['); }
+  JsonWriter &end_array() { return this->close_(']'); }
+
+  JsonWriter &str(const char *key, const char *value) {
+    if (!this->key_(key)) return *this;
+    if (value == nullptr) value = "";
+    size_t n = 2;
+    for (const char *s = value; *s != '\0'; s++) n += escaped_len_(*s);
+    if (!this->fits_(n)) return *this;
+    this->put_('"');
+    for (const char *s = value; *s != '\0'; s++) this->put_escaped_(*s);
+    this->put_('"');
+    return *this;
+  }
+  JsonWriter &u32(const char *key, uint32_t value) {
+    if (this->key_(key)) this->put_u32_(value);
+    return *this;
+  }
+  JsonWriter &i32(const char *key, int32_t value) {
+    if (!this->key_(key)) return *this;
+    if (value < 0) this->put_('-');
+    this->put_u32_(value < 0 ? 0U - (uint32_t) value : (uint32_t) value);
+    return *this;
+  }
+  JsonWriter &boolean(const char *key, bool value) {
+    if (!this->key_(key)) return *this;
+    this->put_raw_(value ? "true" : "false");
+    return *this;
+  }
+  // Lowercase hex string of data, as format_hex() prints it.
+  JsonWriter &hex(const char *key, const uint8_t *data, size_t len) {
+    static const char DIGITS[] = "0123456789abcdef";
+    if (!this->key_(key)) return *this;
+    if (!this->fits_(2 * len + 2)) return *this;
+    char *out = this->buf_ + this->len_;
+    *out++ = '"';
+    for (size_t i = 0; i < len; i++) {
+      *out++ = DIGITS[data[i] >> 4];
+      *out++ = DIGITS[data[i] & 0x0F];
+    }
+    *out++ = '"';
+    this->len_ = (size_t) (out - this->buf_);
+    this->buf_[this->len_] = '\0';
+    return *this;
+  }
+
+  bool truncated() const { return this->truncated_; }
+  const char *c_str() const { return this->cap_ != 0 ? this->buf_ : ""; }
+  size_t size() const { return this->len_; }
+  // Bytes still free, not counting the terminator.
+  size_t remaining() const { return this->truncated_ ? 0 : this->cap_ - 1 - this->len_; }
+
+ protected:
+  bool fits_(size_t n) {
+    if (this->truncated_) return false;
+    if (n > this->cap_ - 1 - this->len_) {
+      this->truncated_ = true;
+      return false;
+    }
+    return true;
+  }
+  void put_(char c) {
+    if (!this->fits_(1)) return;
+    this->buf_[this->len_++] = c;
+    this->buf_[this->len_] = '\0';
+  }
+  void put_u32_(uint32_t value) {
+    char tmp[10];
+    size_t n = 0;
+    do {
+      tmp[n++] = (char) ('0' + value % 10U);
+      value /= 10U;
+    } while (value != 0);
+    if (!this->fits_(n)) return;
+    while (n != 0) this->buf_[this->len_++] = tmp[--n];
+    this->buf_[this->len_] = '\0';
+  }
+  void put_raw_(const char *s) {
+    const size_t n = std::strlen(s);
+    if (!this->fits_(n)) return;
+    std::memcpy(this->buf_ + this->len_, s, n + 1);
+    this->len_ += n;
+  }
+  static size_t escaped_len_(char c) {
+    switch (c) {
+      case '"':
+      case '\\':
+      case '\n':
+      case '\r':
+      case '\t':
+        return 2;
+      default:
+        return (unsigned char) c < 0x20 ? 6 : 1;
+    }
+  }
+  // Only after fits_() has been checked for the escaped length.
+  void put_escaped_(char c) {
+    switch (c) {
+      case '"':
+        this->put_raw_("\\\"");
+        return;
+      case '\\':
+        this->put_raw_("\\\\");
+        return;
+      case '\n':
+        this->put_raw_("\\n");
+        return;
+      case '\r':
+        this->put_raw_("\\r");
+        return;
+      case '\t':
+        this->put_raw_("\\t");
+        return;
+      default:
+        break;
+    }
+    if ((unsigned char) c < 0x20) {
+      static const char DIGITS[] = "0123456789abcdef";
+      const char esc[7] = {'\\', 'u', '0', '0', DIGITS[(unsigned char) c >> 4], DIGITS[c & 0x0F], '\0'};
+      this->put_raw_(esc);
+      return;
+    }
+    this->put_(c);
+  }
+  // Comma if needed, then "key": when key is given. False once truncated.
+  bool key_(const char *key) {
+    if (this->truncated_) return false;
+    const uint32_t bit = 1U << this->depth_;
+    const bool comma = (this->has_member_ & bit) != 0;
+    if (!this->fits_((comma ? 1 : 0) + (key != nullptr ? std::strlen(key) + 3 : 0))) return false;
+    if (comma) this->put_(',');
+    this->has_member_ |= bit;
+    if (key != nullptr) {
+      this->put_('"');
+      this->put_raw_(key);
+      this->put_raw_("\":");
+    }
+    return !this->truncated_;
+  }
+  JsonWriter &open_(const char *key, char c) {
+    if (!this->key_(key)) return *this;
+    if (this->depth_ >= MAX_DEPTH) {
+      this->truncated_ = true;
+      return *this;
+    }
+    this->put_(c);
+    this->depth_++;
+    this->has_member_ &= ~(1U << this->depth_);
+    return *this;
+  }
+  JsonWriter &close_(char c) {
+    if (this->depth_ == 0) {
+      this->truncated_ = true;
+      return *this;
+    }
+    this->put_(c);
+    this->depth_--;
+    return *this;
+  }
+
+  char *buf_;
+  size_t cap_;
+  size_t len_{0};
+  uint32_t has_member_{0};  // bit d: the container at depth d has a member
+  uint8_t depth_{0};
+  bool truncated_{false};
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
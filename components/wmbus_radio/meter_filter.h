@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace wmbus_radio {
+
+// Link-layer header of a telegram: the fields meter_filter rules look at.
+struct MeterHeader {
+  uint16_t mfr{0};
+  // BCD ids as the decimal number they spell (12345678), like highlight_meters
+  // and target_meter_id; non-BCD ids as the hex value of the printed id.
+  uint32_t id{0};
+  uint8_t version{0};
+  uint8_t type{0};
+  uint8_t ci{0};
+};
+
+// Fills h from a block starting at the L-field: C, M (2), A (6) follow, and
+// the CI field sits at ci_at (10 without a CRC after the first block, 12 with
+// one). Returns false when len does not reach the CI field.
+inline bool meter_header_from_block(const uint8_t *d, size_t len, size_t ci_at, MeterHeader &h) {
+  if (len <= ci_at || ci_at < 10) return false;
+  h.mfr = (uint16_t) (d[2] | (d[3] << 8));
+  bool bcd = true;
+  for (size_t i = 4; i < 8; i++) {
+    if ((d[i] & 0x0F) > 9 || (d[i] >> 4) > 9) bcd = false;
+  }
+  h.id = 0;
+  for (size_t i = 8; i-- > 4;) {
+    h.id = bcd ? h.id * 100U + (uint32_t) (d[i] >> 4) * 10U + (d[i] & 0x0F) : (h.id << 8) | d[i];
+  }
+  h.version = d[8];
+  h.type = d[9];
+  h.ci = d[ci_at];
+  return true;
+}
+
+// Allow/deny rules on manufacturer, meter id, device type and CI field
+// (meter_filter in YAML). Rules are checked in order and the first one whose
+// fields all match decides; a rule without a field matches any value of it.
+// Without a matching rule the default applies.
+//
+// Radio::loop() asks as early as the header is known: before the full parse
+// from the raw C1 header or the first decoded T1 block (Packet::
+// peek_meter_header()), otherwise from the parsed frame. A rejected telegram
+// skips the parse (when decided early), stats, logging and forwarding.
+class MeterFilter {
+ public:
+  static constexpr size_t MAX_RULES = 16;
+  // Index match() returns when no rule matched.
+  static constexpr size_t DEFAULT_RULE = MAX_RULES;
+
+  enum Field : uint8_t { FIELD_MFR = 1 << 0, FIELD_ID = 1 << 1, FIELD_TYPE = 1 << 2, FIELD_CI = 1 << 3 };
+  struct Rule {
+    bool allow{false};
+    uint8_t fields{0};
+    uint16_t mfr{0};
+    uint32_t id{0};
+    uint8_t type{0};
+    uint8_t ci{0};
+  };
+
+  // False when MAX_RULES rules are set already.
+  bool add_rule(const Rule &rule) {
+    if (this->count_ >= MAX_RULES) return false;
+    this->rules_[this->count_++] = rule;
+    return true;
+  }
+  void set_default_allow(bool allow) { this->default_allow_ = allow; }
+  bool default_allow() const { return this->default_allow_; }
+  size_t size() const { return this->count_; }
+  const Rule &rule(size_t i) const { return this->rules_[i]; }
+  bool enabled() const { return this->count_ != 0 || !this->default_allow_; }
+
+  // Returns the index of the deciding rule, or DEFAULT_RULE.
+  size_t match(const MeterHeader &h, bool &allow) const {
+    for (size_t i = 0; i < this->count_; i++) {
+      const Rule &r = this->rules_[i];
+      if ((r.fields & FIELD_MFR) && r.mfr != h.mfr) continue;
+      if ((r.fields & FIELD_ID) && r.id != h.id) continue;
+      if ((r.fields & FIELD_TYPE) && r.type != h.type) continue;
+      if ((r.fields & FIELD_CI) && r.ci != h.ci) continue;
+      allow = r.allow;
+      return i;
+    }
+    allow = this->default_allow_;
+    return DEFAULT_RULE;
+  }
+
+ protected:
+  std::array<Rule, MAX_RULES> rules_{};
+  size_t count_{0};
+  bool default_allow_{true};
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
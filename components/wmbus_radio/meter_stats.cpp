@@ -40,23 +40,28 @@ void Radio::publish_meter_window_batch_(const char *trigger, uint32_t elapsed_s,
                                 ? listen_mode_to_string_(this->radio->get_listen_mode())
                                 : "unknown";
 
-  // Build JSON array of all highlight meters in one payload.
-  // Topic: {diag_topic}/meter_snapshot
-  std::string batch = "{";
-  batch += "\"event\":\"meter_snapshot\",";
-  batch += "\"trigger\":\"";
-  batch += trigger;
-  batch += "\",";
-  batch += "\"uptime_ms\":";
-  batch += std::to_string(now_ms);
-  batch += ",\"listen_mode\":\"";
-  batch += listen_mode;
-  batch += "\",\"elapsed_s\":";
-  batch += std::to_string(elapsed_s);
-  batch += ",\"meters\":[";
-
-  bool first = true;
+  // All highlight meters in one payload. Topic: {diag_topic}/meter_snapshot
+  // json_buf_ is sized in setup() for every highlight meter in two link
+  // modes; entries that would not fit anyway are counted in meters_omitted
+  // rather than losing the whole snapshot.
+  JsonWriter w = this->json_writer_();
+  w.begin_object()
+      .str("event", "meter_snapshot")
+      .str("trigger", trigger)
+      .u32("uptime_ms", now_ms)
+      .str("listen_mode", listen_mode)
+      .u32("elapsed_s", elapsed_s)
+      .begin_array("meters");
+
+  // Use dedicated 60min counters for summary_60min trigger to avoid
+  // showing only the last 15min of data (count_window_time is reset every 15min).
+  const bool is_60min = (std::strcmp(trigger, "summary_60min") == 0);
+  uint32_t omitted = 0;
   for (auto &kv : this->highlight_meter_stats_) {
+    if (w.remaining() < METER_SNAPSHOT_ENTRY_BYTES + 32) {
+      omitted++;
+      continue;
+    }
     const uint64_t key = kv.first;
     MeterStats &st = kv.second;
     const uint32_t meter_id = (uint32_t)(key >> 8);
@@ -65,9 +70,6 @@ void Radio::publish_meter_window_batch_(const char *trigger, uint32_t elapsed_s,
     snprintf(id_str, sizeof(id_str), "%08" PRIu32, meter_id);
     const char *mode_str = (mode_byte == (uint8_t) LinkMode::C1) ? "C1" : ((mode_byte == (uint8_t) LinkMode::S1) ? "S1" : "T1");
 
-    // Use dedicated 60min counters for summary_60min trigger to avoid
-    // showing only the last 15min of data (count_window_time is reset every 15min).
-    const bool is_60min = (std::strcmp(trigger, "summary_60min") == 0);
     const uint32_t count_window = is_60min ? st.count_window_60min    : st.count_window_time;
     const int32_t rssi_sum      = is_60min ? st.rssi_sum_window_60min : st.rssi_sum_window_time;
     const uint32_t rssi_n       = is_60min ? st.rssi_n_window_60min   : st.rssi_n_window_time;
@@ -78,35 +80,23 @@ void Radio::publish_meter_window_batch_(const char *trigger, uint32_t elapsed_s,
     const uint32_t avg_interval_s = (st.interval_n > 0) ? (st.interval_sum_ms / st.interval_n) / 1000 : 0;
     const uint32_t win_avg_interval_s = (interval_n > 0) ? (interval_sum_ms / interval_n) / 1000 : 0;
 
-    char entry[256];
-    snprintf(entry, sizeof(entry),
-             "%s{"
-             "\"id\":\"%s\","
-             "\"mode\":\"%s\","
-             "\"count_window\":%u,"
-             "\"count_total\":%u,"
-             "\"avg_interval_s\":%u,"
-             "\"win_avg_interval_s\":%u,"
-             "\"win_interval_n\":%u,"
-             "\"last_rssi\":%d,"
-             "\"win_avg_rssi\":%d"
-             "}",
-             first ? "" : ",",
-             id_str, mode_str,
-             (unsigned) count_window,
-             (unsigned) st.count,
-             (unsigned) avg_interval_s,
-             (unsigned) win_avg_interval_s,
-             (unsigned) interval_n,
-             (int) st.rssi_last,
-             (int) win_avg_rssi);
-    batch += entry;
-    first = false;
+    w.begin_object()
+        .str("id", id_str)
+        .str("mode", mode_str)
+        .u32("count_window", count_window)
+        .u32("count_total", st.count)
+        .u32("avg_interval_s", avg_interval_s)
+        .u32("win_avg_interval_s", win_avg_interval_s)
+        .u32("win_interval_n", interval_n)
+        .i32("last_rssi", st.rssi_last)
+        .i32("win_avg_rssi", win_avg_rssi)
+        .end_object();
   }
-  batch += "]}";
+  w.end_array();
+  if (omitted != 0) w.u32("meters_omitted", omitted);
+  w.end_object();
 
-  const std::string snapshot_topic = this->diag_topic_ + "/meter_snapshot";
-  mqtt->publish(snapshot_topic, batch, static_cast<uint8_t>(0), false);
+  this->publish_json_(this->diag_topic_ + "/meter_snapshot", w);
   ESP_LOGI(TAG, "METER SNAPSHOT / snapshot licznikow: trigger=%s meters=%zu", trigger, this->highlight_meter_stats_.size());
 }
 
@@ -136,39 +126,26 @@ void Radio::publish_meter_window_for_(const char *trigger, uint32_t elapsed_s,
                                 ? listen_mode_to_string_(this->radio->get_listen_mode())
                                 : "unknown";
 
-  char payload[512];
-  snprintf(payload, sizeof(payload),
-           "{"
-           "\"event\":\"meter_window\","
-           "\"uptime_ms\":%lu,"
-           "\"listen_mode\":\"%s\","
-           "\"trigger\":\"%s\","
-           "\"id\":\"%s\","
-           "\"mode\":\"%s\","
-           "\"elapsed_s\":%u,"
-           "\"count_window\":%u,"
-           "\"count_total\":%u,"
-           "\"avg_interval_s\":%u,"
-           "\"win_avg_interval_s\":%u,"
-           "\"win_interval_n\":%u,"
-           "\"last_rssi\":%d,"
-           "\"win_avg_rssi\":%d"
-           "}",
-           (unsigned long) now_ms,
-           listen_mode,
-           trigger, id_str, mode_str,
-           (unsigned) elapsed_s,
-           (unsigned) count_window,
-           (unsigned) st.count,
-           (unsigned) avg_interval_s,
-           (unsigned) win_avg_interval_s,
-           (unsigned) interval_n_window,
-           (int) st.rssi_last,
-           (int) win_avg_rssi);
-
   const std::string meter_window_topic = this->meter_window_topic_for_(id_str, trigger, mode_str);
   if (!meter_window_topic.empty()) {
-    mqtt->publish(meter_window_topic, payload);
+    JsonWriter w = this->json_writer_();
+    w.begin_object()
+        .str("event", "meter_window")
+        .u32("uptime_ms", now_ms)
+        .str("listen_mode", listen_mode)
+        .str("trigger", trigger)
+        .str("id", id_str)
+        .str("mode", mode_str)
+        .u32("elapsed_s", elapsed_s)
+        .u32("count_window", count_window)
+        .u32("count_total", st.count)
+        .u32("avg_interval_s", avg_interval_s)
+        .u32("win_avg_interval_s", win_avg_interval_s)
+        .u32("win_interval_n", interval_n_window)
+        .i32("last_rssi", st.rssi_last)
+        .i32("win_avg_rssi", win_avg_rssi)
+        .end_object();
+    this->publish_json_(meter_window_topic, w);
   }
   ESP_LOGI(TAG, "METER / LICZNIK [%s] uptime_ms=%lu listen_mode=%s id=%s mode=%s win=%us count_window=%u total=%u avg_interval=%us win_avg_interval=%us win_avg_rssi=%ddBm",
            trigger, (unsigned long) now_ms, listen_mode, id_str, mode_str,
@@ -1,31 +1,54 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
-// MQTT publishing for the wmbus_radio component: target-topic derivation,
-// raw-frame and forwarded-frame publishing, and the diagnostic/meter-window
-// topic builders. Split out of component.cpp unchanged (move-only refactor);
-// topic names, payloads and the MQTT contract are identical.
+// MQTT side of the wmbus_radio component: the forwarding table of target
+// topics, the raw-frame tap, duplicate-telegram suppression, forwarding of
+// frames as hex or binary records, telegram batching, the offline buffer
+// with its replay, and the diagnostic/meter-window topic builders. All of it
+// runs on the loop task; payloads are built with JsonWriter.
 
 #include "component.h"
+#include "telegram_wire.h"
 #include "wmbus_radio_internal.h"
 
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
 #include "esphome/components/mqtt/mqtt_client.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <vector>
 
 namespace esphome {
 namespace wmbus_radio {
 
 static const char *TAG = "wmbus";
 
-std::string Radio::derived_target_topic_() const {
-  if (!this->target_topic_.empty()) return this->target_topic_;
-  if (!this->target_meter_enabled_) return {};
+bool Radio::publish_json_(const std::string &topic, const JsonWriter &w, bool retain) {
+  auto *mqtt = esphome::mqtt::global_mqtt_client;
+  if (mqtt == nullptr) return false;
+  if (w.truncated()) {
+    ESP_LOGW(TAG, "JSON payload for %s exceeds %u B, not published / payload JSON za duzy, nie opublikowano",
+             topic.c_str(), (unsigned) this->json_buf_.size());
+    return false;
+  }
+  return mqtt->publish(topic, w.c_str(), w.size(), static_cast<uint8_t>(0), retain);
+}
 
+// Setup only: targets_ keeps the result.
+std::string Radio::target_topic_for_(uint32_t meter_id, const std::string &topic) const {
   char id_buf[9];
-  snprintf(id_buf, sizeof(id_buf), "%08u", (unsigned) this->target_meter_id_);
+  snprintf(id_buf, sizeof(id_buf), "%08u", (unsigned) meter_id);
+
+  const std::string &tmpl = !topic.empty() ? topic : this->target_topic_template_;
+  if (!tmpl.empty()) {
+    std::string out = tmpl;
+    for (size_t at = out.find("{id}"); at != std::string::npos; at = out.find("{id}", at + 8)) {
+      out.replace(at, 4, id_buf);
+    }
+    return out;
+  }
 
   if (!this->telegram_topic_.empty()) {
     const std::string suffix = "/telegram";
@@ -42,6 +65,30 @@ std::string Radio::derived_target_topic_() const {
   return {};
 }
 
+const Radio::ForwardTarget *Radio::target_for_(uint32_t meter_id) const {
+  if (meter_id == 0 || this->targets_.empty()) return nullptr;
+  auto it = std::lower_bound(this->targets_.begin(), this->targets_.end(), meter_id,
+                             [](const ForwardTarget &t, uint32_t id) { return t.meter_id < id; });
+  return (it != this->targets_.end() && it->meter_id == meter_id) ? &*it : nullptr;
+}
+
+
+// Header fields of a validated telegram.
+static TelegramWireHeader wire_header_(Frame &frame) {
+  TelegramWireHeader h;
+  h.link_mode = frame.link_mode();
+  h.format = telegram_wire_format(frame.format().c_str());
+  h.rssi = frame.rssi();
+  h.rx_ms = frame.rx_ms();
+  return h;
+}
+
+// Encodes one record into buf. Stays within the capacity setup() reserved, so
+// it does not allocate.
+static bool wire_record_(std::vector<uint8_t> &buf, const TelegramWireHeader &h, const std::vector<uint8_t> &data) {
+  buf.resize(TELEGRAM_WIRE_HEADER_LEN + data.size());
+  return telegram_wire_encode(buf.data(), buf.size(), h, data.data(), data.size()) != 0;
+}
 
 void Radio::maybe_publish_radio_raw_(Packet *packet, uint32_t now_ms) {
   if (!this->publish_radio_raw_ || packet == nullptr) return;
@@ -49,51 +96,333 @@ void Radio::maybe_publish_radio_raw_(Packet *packet, uint32_t now_ms) {
   auto *mqtt = esphome::mqtt::global_mqtt_client;
   if (mqtt == nullptr || !mqtt->is_connected()) return;
 
-  const std::string raw = packet->packet_hex();
+  if (this->telegram_binary_) {
+    TelegramWireHeader h;
+    h.link_mode = packet->get_link_mode();
+    h.rssi = packet->get_rssi();
+    h.rx_ms = packet->rx_ms();
+    h.flags = TELEGRAM_WIRE_FLAG_RAW;
+    if (wire_record_(this->raw_wire_buf_, h, packet->raw_bytes())) {
+      mqtt->publish("wmbus_bridge/raw", (const char *) this->raw_wire_buf_.data(), this->raw_wire_buf_.size(),
+                    static_cast<uint8_t>(0), false);
+    }
+    return;
+  }
+
+  const std::vector<uint8_t> &raw = packet->raw_bytes();
   const char *chip = (this->radio != nullptr) ? this->radio->get_name() : "unknown";
   const char *listen_mode = (this->radio != nullptr) ? listen_mode_to_string_(this->radio->get_listen_mode()) : "unknown";
-  const char *mode = link_mode_name(packet->get_link_mode());
 
-  std::string payload = str_sprintf(
-      "{\"event\":\"radio_raw\",\"uptime_ms\":%lu,\"chip\":\"%s\",\"listen_mode\":\"%s\",\"mode\":\"%s\",\"rssi\":%d,\"raw_len\":%u,\"hex_len\":%u,\"raw\":\"%s\"}",
-      (unsigned long) now_ms,
-      chip,
-      listen_mode,
-      mode,
-      (int) packet->get_rssi(),
-      (unsigned) packet->size(),
-      (unsigned) raw.size(),
-      raw.c_str());
+  JsonWriter w = this->json_writer_();
+  w.begin_object()
+      .str("event", "radio_raw")
+      .u32("uptime_ms", now_ms)
+      .str("chip", chip)
+      .str("listen_mode", listen_mode)
+      .str("mode", link_mode_name(packet->get_link_mode()))
+      .i32("rssi", packet->get_rssi())
+      .u32("raw_len", raw.size())
+      .u32("hex_len", 2 * raw.size())
+      .hex("raw", raw.data(), raw.size())
+      .end_object();
+  this->publish_json_("wmbus_bridge/raw", w);
+}
 
-  mqtt->publish("wmbus_bridge/raw", payload, static_cast<uint8_t>(0), false);
+bool Radio::is_duplicate_telegram_(Frame &frame, uint32_t meter_id, uint32_t now_ms) {
+  const auto &data = frame.data();
+  if (data.size() < 2) return false;
+  // From the C-field on: the L-field differs between formats A and B.
+  const uint32_t h = DedupCache<DEDUP_CACHE_SIZE>::hash(data.data() + 1, data.size() - 1);
+  bool evicted_live = false;
+  const bool duplicate = this->dedup_cache_.seen(meter_id, h, now_ms, this->dedup_ttl_ms_, evicted_live);
+  if (evicted_live) this->diag_.dedup_evicted_live++;
+  if (duplicate) {
+    const uint8_t mode = (uint8_t) frame.link_mode();
+    if (mode < this->diag_.mode_duplicates.size()) this->diag_.mode_duplicates[mode]++;
+  }
+  return duplicate;
 }
 
 void Radio::maybe_forward_frame_(Frame &frame, uint32_t meter_id, const char *id_str, const char *log_tag) {
+  const bool want_all = !this->telegram_topic_.empty();
+  const ForwardTarget *target = this->target_for_(meter_id);
+  if (!want_all && target == nullptr) return;
+
   auto *mqtt = esphome::mqtt::global_mqtt_client;
-  if (mqtt == nullptr || !mqtt->is_connected()) return;
+  const bool online = mqtt != nullptr && mqtt->is_connected();
+  if (this->offline_store_.enabled() && (!online || this->offline_store_.frames() != 0)) {
+    // The open batch holds older frames; it goes into the store first.
+    if (!online && this->telegram_batch_frames_ != 0) {
+      this->telegram_batch_flush_((uint32_t) esphome::millis(), TBF_OFFLINE);
+    }
+    this->offline_store_frame_(frame);
+    return;
+  }
+  if (!online) return;
 
-  std::string hex;
-  const bool want_all = !this->telegram_topic_.empty();
-  const bool want_target = this->target_meter_enabled_ && meter_id == this->target_meter_id_;
-  if (!want_all && !want_target) return;
+  // Refused although is_connected() said yes (the link dropped under the
+  // publish): buffered like a frame received offline. Should only one of
+  // telegram/target topics have failed, the other one gets it twice.
+  if (!this->forward_frame_(frame, want_all, target, id_str, log_tag) && this->offline_store_.enabled()) {
+    this->offline_store_frame_(frame);
+  }
+}
+
+void Radio::dispatch_frame_(Frame &frame, uint32_t meter_id, const char *id_str, const char *log_tag) {
+  this->maybe_forward_frame_(frame, meter_id, id_str, log_tag);
+
+  for (auto &handler : this->handlers_)
+    handler(&frame);
+
+  if (frame.handlers_count()) {
+    ESP_LOGI(TAG, "Telegram handled / obsluzono przez %d handlers", frame.handlers_count());
+  } else {
+    // Braces are required: at log level INFO the ESP_LOGD below compiles to an
+    // empty statement, and an unbraced 'else' with an empty body warns
+    // -Wempty-body (seen on the SX1276 arduino build, 2026.7.0).
+    ESP_LOGD(TAG, "Telegram not handled by any handler");
+  }
+}
+
+void Radio::publish_pending_(uint32_t now_ms) {
+  this->maybe_replay_offline_(now_ms);
+  this->maybe_flush_telegram_batch_(now_ms);
+}
+
+bool Radio::forward_frame_(Frame &frame, bool want_all, const ForwardTarget *target, const char *id_str,
+                           const char *log_tag, bool replay) {
+  auto *mqtt = esphome::mqtt::global_mqtt_client;
+  bool sent = true;
+
+  // Replayed text payloads go to <topic>/replay instead (publish_replay_()),
+  // and are not batched: a hex batch has no field for the receive time.
+  // Binary records carry it and keep their usual path.
+  const bool text_replay = replay && !this->telegram_binary_;
+
+  // Batching covers telegram_topic only; the single target meter keeps its
+  // immediate per-frame publish. A batched frame counts as sent here,
+  // telegram_batch_flush_() looks after the batch.
+  const bool batch = want_all && this->telegram_batch_enabled_() && !text_replay;
+  if (batch) {
+    this->telegram_batch_add_(frame, (uint32_t) esphome::millis());
+    if (target == nullptr) return sent;
+  }
 
-  hex = frame.as_hex();
-  if (want_all) {
-    mqtt->publish(this->telegram_topic_, hex);
+  if (want_all && !batch && this->telegram_binary_) {
+    if (wire_record_(this->wire_buf_, wire_header_(frame), frame.data())) {
+      sent = mqtt->publish(this->telegram_topic_, (const char *) this->wire_buf_.data(), this->wire_buf_.size());
+    }
+    if (target == nullptr) return sent;
   }
 
-  if (want_target) {
+  if (replay) {
+    if (want_all && !batch && !this->telegram_binary_) {
+      sent = this->publish_replay_(this->telegram_replay_topic_, frame) && sent;
+    }
+    if (target != nullptr) sent = this->publish_replay_(target->replay_topic, frame) && sent;
+    return sent;
+  }
+
+  const std::string hex = frame.as_hex();
+  if (want_all && !batch && !this->telegram_binary_) {
+    sent = mqtt->publish(this->telegram_topic_, hex) && sent;
+  }
+
+  if (target != nullptr) {
     if (this->target_log_) {
       ESP_LOGI(log_tag != nullptr ? log_tag : TAG, "TARGET %s caught / przechwycono RSSI=%d len=%u",
                id_str != nullptr ? id_str : "????????",
                (int) frame.rssi(),
                (unsigned) frame.data().size());
     }
-    const std::string topic = this->derived_target_topic_();
-    if (!topic.empty()) {
-      mqtt->publish(topic, hex);
-    }
+    sent = mqtt->publish(target->topic, hex) && sent;
   }
+  return sent;
+}
+
+bool Radio::publish_replay_(const std::string &topic, Frame &frame) {
+  JsonWriter w = this->json_writer_();
+  w.begin_object()
+      .u32("uptime_ms", frame.rx_ms())
+      .u32("age_ms", (uint32_t) esphome::millis() - frame.rx_ms())
+      .i32("rssi", frame.rssi())
+      .str("mode", link_mode_name(frame.link_mode()))
+      .hex("hex", frame.data().data(), frame.data().size())
+      .end_object();
+  return this->publish_json_(topic, w);
+}
+
+void Radio::offline_store_frame_(Frame &frame) {
+  const auto &data = frame.data();
+  this->offline_store_record_(wire_header_(frame), data.data(), data.size());
+}
+
+bool Radio::offline_store_record_(const TelegramWireHeader &h, const uint8_t *payload, size_t len) {
+  auto &ob = this->diag_.offline_buffer;
+  if (this->offline_store_.frames() == 0) {
+    ESP_LOGW(TAG, "MQTT offline, buffering frames / MQTT niedostepny, buforowanie ramek (capacity=%u B)",
+             (unsigned) this->offline_store_.capacity());
+  }
+  uint32_t evicted = 0;
+  if (!this->offline_store_.push(h, payload, len, evicted)) {
+    // Longer than the whole buffer: lost like an unbuffered frame.
+    ob.evicted++;
+    return false;
+  }
+  ob.buffered++;
+  ob.evicted += evicted;
+  return true;
+}
+
+void Radio::maybe_replay_offline_(uint32_t now_ms) {
+  if (this->offline_store_.frames() == 0) return;
+  auto *mqtt = esphome::mqtt::global_mqtt_client;
+  if (mqtt == nullptr || !mqtt->is_connected()) return;
+  if (now_ms - this->offline_last_replay_ms_ < this->offline_replay_interval_ms_) return;
+  this->offline_last_replay_ms_ = now_ms;
+
+  if (!this->offline_store_.front(this->offline_rec_)) return;
+  TelegramWireHeader h;
+  const uint8_t *payload = nullptr;
+  if (telegram_wire_decode(this->offline_rec_.data(), this->offline_rec_.size(), h, payload) == 0) {
+    this->offline_store_.pop_front();
+    this->diag_.offline_buffer.corrupt++;
+    ESP_LOGW(TAG, "Offline buffer: corrupt record dropped / bufor offline: uszkodzony rekord odrzucony (%u B)",
+             (unsigned) this->offline_rec_.size());
+    return;
+  }
+
+  Frame frame(payload, h.payload_len, h.link_mode, h.rssi, h.rx_ms,
+              h.format == TelegramWireFormat::A ? "A" : h.format == TelegramWireFormat::B ? "B" : "");
+  uint32_t meter_id = 0;
+  char id_str[12] = "????????";
+  if (frame.try_get_meter_id(meter_id)) snprintf(id_str, sizeof(id_str), "%08u", (unsigned) meter_id);
+  const bool want_all = !this->telegram_topic_.empty();
+  const ForwardTarget *target = this->target_for_(meter_id);
+  // A refused publish leaves the record at the head, tried again next time.
+  if ((want_all || target != nullptr) && !this->forward_frame_(frame, want_all, target, id_str, nullptr, true)) return;
+  this->offline_store_.pop_front();
+  this->diag_.offline_buffer.replayed++;
+
+  if (this->offline_store_.frames() == 0) {
+    ESP_LOGI(TAG, "Offline buffer replayed / bufor offline wyslany (newest frame age=%us)",
+             (unsigned) ((now_ms - h.rx_ms) / 1000U));
+  }
+}
+
+static void append_hex_(std::string &out, const std::vector<uint8_t> &data) {
+  static const char DIGITS[] = "0123456789abcdef";
+  for (uint8_t b : data) {
+    out += DIGITS[b >> 4];
+    out += DIGITS[b & 0x0F];
+  }
+}
+
+// One batch is either newline-separated hex, one telegram per line, a JSON
+// array of {"uptime_ms","rssi","mode","hex"} objects, or binary records back
+// to back (telegram_binary_).
+void Radio::telegram_batch_add_(Frame &frame, uint32_t now_ms) {
+  auto &buf = this->telegram_batch_buf_;
+  const size_t entry_len = this->telegram_binary_ ? TELEGRAM_WIRE_HEADER_LEN + frame.data().size()
+                                                  : 2 * frame.data().size() + (this->telegram_batch_json_ ? 72 : 1);
+  if (this->telegram_batch_frames_ > 0 && buf.size() + entry_len + 1 > TELEGRAM_BATCH_MAX_BYTES) {
+    this->telegram_batch_flush_(now_ms, TBF_BYTES);
+  }
+
+  if (this->telegram_batch_frames_ == 0) {
+    this->telegram_batch_first_ms_ = now_ms;
+    buf.clear();  // keeps the capacity reserved in setup()
+    if (this->telegram_batch_json_ && !this->telegram_binary_) buf += '[';
+  } else if (!this->telegram_binary_) {
+    buf += this->telegram_batch_json_ ? ',' : '\n';
+  }
+
+  if (!this->telegram_binary_ && this->offline_store_.enabled()) {
+    auto &rec = this->telegram_batch_records_;
+    if (this->telegram_batch_frames_ == 0) rec.clear();
+    const size_t at = rec.size();
+    const size_t rec_len = TELEGRAM_WIRE_HEADER_LEN + frame.data().size();
+    rec.resize(at + rec_len);
+    telegram_wire_encode(&rec[at], rec_len, wire_header_(frame), frame.data().data(), frame.data().size());
+  }
+
+  if (this->telegram_binary_) {
+    const size_t at = buf.size();
+    buf.resize(at + entry_len);
+    telegram_wire_encode((uint8_t *) &buf[at], entry_len, wire_header_(frame), frame.data().data(),
+                         frame.data().size());
+  } else if (this->telegram_batch_json_) {
+    // Written in place; the writer may also use the terminator slot
+    // std::string keeps past size().
+    const size_t at = buf.size();
+    buf.resize(at + entry_len);
+    JsonWriter w(&buf[at], entry_len + 1);
+    w.begin_object()
+        .u32("uptime_ms", frame.rx_ms())
+        .i32("rssi", frame.rssi())
+        .str("mode", link_mode_name(frame.link_mode()))
+        .hex("hex", frame.data().data(), frame.data().size())
+        .end_object();
+    buf.resize(at + w.size());
+  } else {
+    append_hex_(buf, frame.data());
+  }
+
+  if (++this->telegram_batch_frames_ >= this->telegram_batch_max_frames_) {
+    this->telegram_batch_flush_(now_ms, TBF_FULL);
+  }
+}
+
+void Radio::telegram_batch_flush_(uint32_t now_ms, TelegramBatchFlush why) {
+  const uint32_t frames = this->telegram_batch_frames_;
+  if (frames == 0) return;
+  if (this->telegram_batch_json_ && !this->telegram_binary_) this->telegram_batch_buf_ += ']';
+
+  auto *mqtt = esphome::mqtt::global_mqtt_client;
+  const bool sent = mqtt != nullptr && mqtt->is_connected() &&
+                    mqtt->publish(this->telegram_batch_topic_, this->telegram_batch_buf_);
+
+  auto &tb = this->diag_.telegram_batch;
+  const uint32_t latency_ms = now_ms - this->telegram_batch_first_ms_;
+  tb.batches++;
+  tb.frames += frames;
+  if (!sent) tb.frames_dropped += frames - this->telegram_batch_to_offline_();
+  if (why == TBF_FULL) tb.flush_full++;
+  else if (why == TBF_TIMEOUT) tb.flush_timeout++;
+  else if (why == TBF_BYTES) tb.flush_bytes++;
+  else tb.flush_offline++;
+  tb.latency_sum_ms += latency_ms;
+  tb.size_hist[frames < 2 ? 0 : frames < 4 ? 1 : frames < 8 ? 2 : frames < 16 ? 3 : 4]++;
+  tb.latency_hist[latency_ms < 100 ? 0 : latency_ms < 500 ? 1 : latency_ms < 2000 ? 2 : 3]++;
+
+  this->telegram_batch_frames_ = 0;
+  this->telegram_batch_buf_.clear();
+  this->telegram_batch_records_.clear();
+}
+
+// The records are oldest first, so stored this way they replay in order.
+uint32_t Radio::telegram_batch_to_offline_() {
+  if (!this->offline_store_.enabled()) return 0;
+  const uint8_t *in = this->telegram_binary_ ? (const uint8_t *) this->telegram_batch_buf_.data()
+                                             : this->telegram_batch_records_.data();
+  size_t left = this->telegram_binary_ ? this->telegram_batch_buf_.size() : this->telegram_batch_records_.size();
+  uint32_t stored = 0;
+  while (left != 0) {
+    TelegramWireHeader h;
+    const uint8_t *payload = nullptr;
+    const size_t n = telegram_wire_decode(in, left, h, payload);
+    if (n == 0) break;
+    if (this->offline_store_record_(h, payload, h.payload_len)) stored++;
+    in += n;
+    left -= n;
+  }
+  return stored;
+}
+
+void Radio::maybe_flush_telegram_batch_(uint32_t now_ms) {
+  if (this->telegram_batch_frames_ == 0) return;
+  if (now_ms - this->telegram_batch_first_ms_ < this->telegram_batch_max_delay_ms_) return;
+  this->telegram_batch_flush_(now_ms, TBF_TIMEOUT);
 }
 
 std::string Radio::diag_summary_topic_() const {
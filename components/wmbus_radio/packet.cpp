@@ -37,19 +37,28 @@ static std::string hex_prefix_(const std::vector<uint8_t> &in, size_t max_bytes)
   return out;
 }
 
-static std::string dll_crc_detail_(const wmbus_common::DLLCRCResult &crc) {
-  char buf[160];
-  snprintf(buf, sizeof(buf),
-           "format=%s stage=%s calc=%04x expected=%04x data_pos=%u data_len=%u crc_pos=%u input_len=%u",
-           crc.format,
-           crc.stage,
-           (unsigned) crc.calculated,
-           (unsigned) crc.expected,
-           (unsigned) crc.data_pos,
-           (unsigned) crc.data_len,
-           (unsigned) crc.crc_pos,
-           (unsigned) crc.input_len);
-  return std::string(buf);
+static DropStage drop_stage_for_crc_(wmbus_common::DLLCRCStage stage) {
+  using wmbus_common::DLLCRCStage;
+  switch (stage) {
+    case DLLCRCStage::FORMAT_A_TOO_SHORT:
+      return DropStage::FORMAT_A_TOO_SHORT;
+    case DLLCRCStage::FORMAT_B_TOO_SHORT:
+      return DropStage::FORMAT_B_TOO_SHORT;
+    case DLLCRCStage::FORMAT_B_BAD_LENGTH:
+      return DropStage::FORMAT_B_BAD_LENGTH;
+    case DLLCRCStage::FIRST:
+      return DropStage::DLL_CRC_FIRST;
+    case DLLCRCStage::MID:
+      return DropStage::DLL_CRC_MID;
+    case DLLCRCStage::FINAL:
+      return DropStage::DLL_CRC_FINAL;
+    case DLLCRCStage::B1:
+      return DropStage::DLL_CRC_B1;
+    case DLLCRCStage::B2:
+      return DropStage::DLL_CRC_B2;
+    default:
+      return DropStage::NONE;
+  }
 }
 
 
@@ -89,12 +98,134 @@ Packet::Packet() { this->data_.reserve(WMBUS_PREAMBLE_SIZE); }
 
 bool Packet::try_get_meter_id(uint32_t &out_id) const { return try_extract_meter_id_(this->data_, out_id); }
 
+// Format A block 1: L..A (10 bytes), its CRC, then the CI field.
+static bool block_a_header_(const uint8_t *d, size_t len, MeterHeader &h) {
+  if (len < 13) return false;
+  if (wmbus_common::crc16_en13757(d, 10) != (uint16_t) ((d[10] << 8) | d[11])) return false;
+  return meter_header_from_block(d, len, 12, h);
+}
+
+bool Packet::peek_meter_header(MeterHeader &h) {
+  const uint8_t *d = this->data_.data();
+  const size_t n = this->data_.size();
+  switch (this->link_mode()) {
+    case LinkMode::C1:
+      if (n < 3) return false;
+      if (d[1] == WMBUS_BLOCK_A_PREAMBLE) return block_a_header_(d + 2, n - 2, h);
+      if (d[1] == WMBUS_BLOCK_B_PREAMBLE) return meter_header_from_block(d + 2, n - 2, 10, h);
+      return false;
+
+    case LinkMode::T1: {
+      // 13 decoded bytes (block 1 + CI) take 26 symbols, 19.5 raw bytes.
+      const size_t coded = encoded_size(13);
+      uint8_t hdr[16];
+      size_t hdr_len = 0;
+      if (n < coded || !decode3of6_into(d, coded, hdr, sizeof(hdr), &hdr_len)) return false;
+      return block_a_header_(hdr, hdr_len, h);
+    }
+
+    default:
+      return false;
+  }
+}
+
 std::string Packet::packet_hex() const { return hex_prefix_(this->data_, 0); }
 
-void Packet::set_drop_(const char *stage, const char *reason, const std::string &detail) {
-  this->drop_stage_ = stage != nullptr ? stage : "";
-  this->drop_reason_ = reason != nullptr ? reason : "";
-  this->drop_detail_ = detail;
+std::string Packet::drop_detail() const {
+  char buf[DROP_DETAIL_MAX];
+  return std::string(this->format_drop_detail(buf, sizeof(buf)));
+}
+
+// Rebuilds the detail text earlier builds stored per packet, field for field.
+// Lengths come from the packet's own diagnostics: at every drop point
+// decoded_len is the decoded buffer size, want_len is the L-field's total
+// length including CRC bytes and raw_got_len is the raw size.
+const char *Packet::format_drop_detail(char *buf, size_t cap) const {
+  if (buf == nullptr || cap == 0) return "";
+  buf[0] = '\0';
+  const DropInfo &d = this->drop_;
+  const unsigned raw_len = (unsigned) this->raw_got_len_;
+  const unsigned decoded = (unsigned) this->decoded_len_;
+  const unsigned need_total = (unsigned) this->want_len_;
+  const unsigned l = d.l_field;
+  const unsigned want = l + 1;
+  const unsigned sym_total = this->t1_symbols_total_;
+  const unsigned sym_invalid = this->t1_symbols_invalid_;
+  const char *format = this->frame_format_.c_str();
+  int n = 0;
+
+  switch (d.stage) {
+    case DropStage::NONE:
+      break;
+    case DropStage::PRECHECK:
+      n = snprintf(buf, cap, "mode=T1 raw_len=%u min=12", raw_len);
+      break;
+    case DropStage::S1_PRECHECK:
+      n = snprintf(buf, cap, "mode=S1 raw_len=%u min=6", raw_len);
+      break;
+    case DropStage::C1_PRECHECK:
+      if (d.reason == DropReason::UNKNOWN_PREAMBLE) {
+        n = snprintf(buf, cap, "first_byte=%02X raw_len=%u", (unsigned) d.byte, raw_len);
+      } else {
+        n = snprintf(buf, cap, "mode=C1 raw_len=%u min=3", raw_len);
+      }
+      break;
+    case DropStage::C1_PREAMBLE:
+      n = snprintf(buf, cap, "preamble=%02X raw_len=%u", (unsigned) d.byte, raw_len);
+      break;
+    case DropStage::C1_SUFFIX:
+      n = snprintf(buf, cap, "raw_len=%u min_suffix=2", raw_len);
+      break;
+    case DropStage::T1_DECODE3OF6:
+      if (d.fail_fast) {
+        n = snprintf(buf, cap, "fail_fast=1 raw_len=%u", raw_len);
+      } else {
+        n = snprintf(buf, cap, "symbols_total=%u symbols_invalid=%u raw_len=%u", sym_total, sym_invalid, raw_len);
+      }
+      break;
+    case DropStage::T1_L_FIELD:
+      n = snprintf(buf, cap, "l_field=%u decoded_len=%u want=%u need_total=%u", l, decoded, want, need_total);
+      break;
+    case DropStage::T1_LENGTH_CHECK:
+      n = snprintf(buf, cap, "decoded_len=%u need_total=%u l_field=%u", decoded, need_total, l);
+      break;
+    case DropStage::C1_L_FIELD:
+      n = snprintf(buf, cap, "format=%s l_field=%u decoded_len=%u want=%u need_total=%u", format, l, decoded, want,
+                   need_total);
+      break;
+    case DropStage::C1_LENGTH_CHECK:
+      n = snprintf(buf, cap, "format=%s decoded_len=%u need_total=%u l_field=%u", format, decoded, need_total, l);
+      break;
+    case DropStage::S1_MANCHESTER:
+      n = snprintf(buf, cap, "polarity=%d symbols_total=%u symbols_invalid=%u raw_len=%u", (int) d.polarity,
+                   sym_total, sym_invalid, raw_len);
+      break;
+    case DropStage::S1_L_FIELD:
+      n = snprintf(buf, cap, "polarity=%d l_field=%u decoded_len=%u want=%u need_total=%u symbols_invalid=%u",
+                   (int) d.polarity, l, decoded, want, need_total, sym_invalid);
+      break;
+    case DropStage::S1_LENGTH_CHECK:
+      n = snprintf(buf, cap, "polarity=%d decoded_len=%u need_total=%u l_field=%u symbols_invalid=%u",
+                   (int) d.polarity, decoded, need_total, l, sym_invalid);
+      break;
+    default:
+      // DLL CRC stages (including the format_*_too_short/bad_length guards).
+      n = snprintf(buf, cap,
+                   "format=%s stage=%s calc=%04x expected=%04x data_pos=%u data_len=%u crc_pos=%u input_len=%u",
+                   format, drop_stage_name(d.stage), (unsigned) d.crc_calculated, (unsigned) d.crc_expected,
+                   (unsigned) d.crc_data_pos, (unsigned) d.crc_data_len, (unsigned) d.crc_pos,
+                   (unsigned) d.crc_input_len);
+      if (d.polarity >= 0 && n >= 0 && (size_t) n < cap) {
+        n += snprintf(buf + n, cap - n, " polarity=%d symbols_invalid=%u", (int) d.polarity, sym_invalid);
+      }
+      break;
+  }
+
+  if (d.fallback_used) {
+    size_t used = (n < 0) ? 0 : std::min((size_t) n, cap - 1);
+    snprintf(buf + used, cap - used, "%sfallback_used=1", used > 0 ? " " : "");
+  }
+  return buf;
 }
 
 // Determine the link mode based on the first byte of the data
@@ -119,14 +250,12 @@ uint8_t Packet::l_field() {
       if (this->data_.size() < 3) return 0;
       return this->data_[2];
 
-    case LinkMode::T1: {
-      // Decode a minimal prefix to obtain decoded[0] (L-field)
-      const size_t n = std::min<size_t>(this->data_.size(), 18);  // safer than 3
-      std::vector<uint8_t> tmp(this->data_.begin(), this->data_.begin() + n);
-      auto decoded = decode3of6(tmp, nullptr);
-      if (decoded && !decoded->empty()) return (*decoded)[0];
+    case LinkMode::T1:
+      // decoded[0] is the L-field. The streaming decoder only decodes bytes
+      // that arrived since the last call; any invalid symbol seen so far means
+      // the length cannot be trusted.
+      if (this->t1_stream_update() && this->t1_stream_.decoded > 0) return this->t1_stream_.l_field;
       break;
-    }
 
     case LinkMode::S1:
       // S-mode is Manchester-coded. The receiver task uses raw-drain for S1,
@@ -165,6 +294,48 @@ size_t Packet::expected_size() {
   return this->expected_size_;
 }
 
+bool Packet::t1_stream_update() {
+  auto &st = this->t1_stream_;
+  while (!st.invalid && st.raw_consumed < this->data_.size()) {
+    st.bits = (st.bits << 8) | this->data_[st.raw_consumed++];
+    st.bit_count += 8;
+    if (st.bit_count < 12) continue;
+    st.bit_count -= 12;
+    const uint16_t entry = decode3of6_pair((uint16_t) (st.bits >> st.bit_count));
+    if ((entry >> 8) != 0) {
+      st.invalid = true;
+      break;
+    }
+    if (st.decoded == 0) st.l_field = (uint8_t) entry;
+    st.decoded++;
+  }
+  return !st.invalid;
+}
+
+void Packet::reset() {
+  this->data_.clear();
+  this->expected_size_ = 0;
+  this->rssi_ = 0;
+  this->rx_ms_ = 0;
+  this->sync2_ = 0;
+  this->link_mode_ = LinkMode::UNKNOWN;
+  this->frame_format_.clear();
+  this->t1_stream_ = {};
+  this->truncated_ = false;
+  this->want_len_ = 0;
+  this->got_len_ = 0;
+  this->raw_got_len_ = 0;
+  this->decoded_len_ = 0;
+  this->final_len_ = 0;
+  this->dll_crc_removed_ = 0;
+  this->suffix_ignored_ = 0;
+  this->drop_ = {};
+  this->raw_hex_.clear();
+  this->capture_raw_hex_ = true;
+  this->t1_symbols_total_ = 0;
+  this->t1_symbols_invalid_ = 0;
+}
+
 uint8_t *Packet::append_space(size_t len) {
   const size_t old = this->data_.size();
   this->data_.resize(old + len);
@@ -174,6 +345,7 @@ uint8_t *Packet::append_space(size_t len) {
 void Packet::resize(size_t len) {
   this->data_.resize(len);
   if (this->expected_size_ > len) this->expected_size_ = 0;
+  if (this->t1_stream_.raw_consumed > len) this->t1_stream_ = {};
   if (this->link_mode_ != LinkMode::UNKNOWN && len == 0) this->link_mode_ = LinkMode::UNKNOWN;
 }
 
@@ -215,37 +387,62 @@ struct ParseAttemptResult {
   uint16_t dll_crc_removed{0};
   uint8_t suffix_ignored{0};
 
-  std::string drop_reason{};
-  std::string drop_stage{};
-  std::string drop_detail{};
+  DropInfo drop{};
   uint16_t t1_symbols_total{0};
   uint16_t t1_symbols_invalid{0};
 };
 
-static inline void set_attempt_drop_(ParseAttemptResult &out, const char *stage, const char *reason,
-                                     const std::string &detail = {}) {
+// Records where the attempt failed and returns the drop info so the caller
+// can add the few values its detail text needs. No text is built here.
+static inline DropInfo &set_attempt_drop_(ParseAttemptResult &out, DropStage stage, DropReason reason) {
   out.ok = false;
-  out.drop_stage = stage != nullptr ? stage : "";
-  out.drop_reason = reason != nullptr ? reason : "";
-  out.drop_detail = detail;
+  out.drop = {};
+  out.drop.stage = stage;
+  out.drop.reason = reason;
+  return out.drop;
+}
+
+static inline void set_attempt_crc_drop_(ParseAttemptResult &out, const wmbus_common::DLLCRCResult &crc) {
+  DropInfo &d = set_attempt_drop_(out, drop_stage_for_crc_(crc.stage), DropReason::DLL_CRC_FAILED);
+  d.crc_calculated = crc.calculated;
+  d.crc_expected = crc.expected;
+  d.crc_data_pos = (uint16_t) crc.data_pos;
+  d.crc_data_len = (uint16_t) crc.data_len;
+  d.crc_pos = (uint16_t) crc.crc_pos;
+  d.crc_input_len = (uint16_t) crc.input_len;
 }
 
 // Rough stage ordering used when both parsing attempts fail.
 // Higher rank means the parser got further and usually has a more useful reason.
-static int stage_rank_(const std::string &stage) {
-  if (stage == "precheck" || stage == "c1_precheck") return 1;
-  if (stage == "c1_preamble" || stage == "c1_suffix" || stage == "t1_decode3of6") return 2;
-  if (stage == "t1_l_field" || stage == "c1_l_field") return 3;
-  if (stage == "t1_length_check" || stage == "c1_length_check") return 4;
-  if (stage == "dll_crc_first" || stage == "dll_crc_mid" || stage == "dll_crc_final" ||
-      stage == "dll_crc_b1" || stage == "dll_crc_b2") return 5;
-  if (stage == "link_mode") return 0;
-  return 0;
+static int stage_rank_(DropStage stage) {
+  switch (stage) {
+    case DropStage::PRECHECK:
+    case DropStage::C1_PRECHECK:
+      return 1;
+    case DropStage::C1_PREAMBLE:
+    case DropStage::C1_SUFFIX:
+    case DropStage::T1_DECODE3OF6:
+      return 2;
+    case DropStage::T1_L_FIELD:
+    case DropStage::C1_L_FIELD:
+      return 3;
+    case DropStage::T1_LENGTH_CHECK:
+    case DropStage::C1_LENGTH_CHECK:
+      return 4;
+    case DropStage::DLL_CRC_FIRST:
+    case DropStage::DLL_CRC_MID:
+    case DropStage::DLL_CRC_FINAL:
+    case DropStage::DLL_CRC_B1:
+    case DropStage::DLL_CRC_B2:
+      return 5;
+    default:
+      return 0;
+  }
 }
 
 static const ParseAttemptResult &pick_better_failure_(const ParseAttemptResult &a, const ParseAttemptResult &b) {
-  const int ra = stage_rank_(a.drop_stage);
-  const int rb = stage_rank_(b.drop_stage);
+  const int ra = stage_rank_(a.drop.stage);
+  const int rb = stage_rank_(b.drop.stage);
   if (ra != rb) return (ra > rb) ? a : b;
   // Prefer the attempt that collected more decoded data.
   if (a.decoded_len != b.decoded_len) return (a.decoded_len > b.decoded_len) ? a : b;
@@ -257,31 +454,37 @@ static const ParseAttemptResult &pick_better_failure_(const ParseAttemptResult &
 // T1 parser with a soft precheck.
 // We intentionally avoid a hard early reject like "raw < 60 => drop" because
 // some borderline packets can still reach a valid L-field after 3-of-6 decode.
-static ParseAttemptResult try_parse_t1_(const std::vector<uint8_t> &raw) {
+//
+// `symbol_stats` selects the full invalid-symbol count (feeds the T1 symbol
+// quality counters) over a fail-fast decode. The C1 -> T1 fallback passes
+// false: a packet that started with the C preamble says nothing about T1
+// symbol quality, and most of them fail within the first few symbols.
+static ParseAttemptResult try_parse_t1_(const std::vector<uint8_t> &raw, bool symbol_stats = true) {
   ParseAttemptResult out;
   out.mode = LinkMode::T1;
   out.frame_format = "A";  // Current bridge handles T1 as format A.
   out.raw_got_len = raw.size();
 
   if (raw.size() < 12) {
-    set_attempt_drop_(out, "precheck", "too_short",
-                      "mode=T1 raw_len=" + std::to_string((unsigned) raw.size()) + " min=12");
+    set_attempt_drop_(out, DropStage::PRECHECK, DropReason::TOO_SHORT);
     return out;
   }
 
+  // Decode straight into the attempt's own buffer, sized once up front.
   Decode3of6Stats st;
-  auto decoded_data = decode3of6(raw, &st);
+  size_t decoded_len = 0;
+  out.data.resize(decoded_size(raw.size()));
+  const bool decoded = decode3of6_into(raw.data(), raw.size(), out.data.data(), out.data.size(), &decoded_len,
+                                       symbol_stats ? &st : nullptr);
   out.t1_symbols_total = st.symbols_total;
   out.t1_symbols_invalid = st.symbols_invalid;
-  if (!decoded_data || decoded_data->size() < 2) {
-    char detail[160];
-    snprintf(detail, sizeof(detail), "symbols_total=%u symbols_invalid=%u raw_len=%u",
-             (unsigned) out.t1_symbols_total, (unsigned) out.t1_symbols_invalid, (unsigned) out.raw_got_len);
-    set_attempt_drop_(out, "t1_decode3of6", "decode_failed", detail);
+  if (!decoded || decoded_len < 2) {
+    out.data.clear();
+    set_attempt_drop_(out, DropStage::T1_DECODE3OF6, DropReason::DECODE_FAILED).fail_fast = !symbol_stats;
     return out;
   }
 
-  out.data = std::move(decoded_data.value());
+  out.data.resize(decoded_len);
   out.decoded_len = out.data.size();
 
   const uint8_t l = out.data[0];
@@ -291,19 +494,13 @@ static ParseAttemptResult try_parse_t1_(const std::vector<uint8_t> &raw) {
   out.got_len = out.data.size();
 
   if (want < 12 || want > 260) {
-    char detail[128];
-    snprintf(detail, sizeof(detail), "l_field=%u decoded_len=%u want=%u need_total=%u",
-             (unsigned) l, (unsigned) out.decoded_len, (unsigned) want, (unsigned) need_total);
-    set_attempt_drop_(out, "t1_l_field", "l_field_invalid", detail);
+    set_attempt_drop_(out, DropStage::T1_L_FIELD, DropReason::L_FIELD_INVALID).l_field = l;
     return out;
   }
 
   if (out.data.size() < need_total) {
     out.truncated = true;
-    char detail[128];
-    snprintf(detail, sizeof(detail), "decoded_len=%u need_total=%u l_field=%u",
-             (unsigned) out.data.size(), (unsigned) need_total, (unsigned) l);
-    set_attempt_drop_(out, "t1_length_check", "truncated", detail);
+    set_attempt_drop_(out, DropStage::T1_LENGTH_CHECK, DropReason::TRUNCATED).l_field = l;
     return out;
   }
 
@@ -311,7 +508,7 @@ static ParseAttemptResult try_parse_t1_(const std::vector<uint8_t> &raw) {
 
   wmbus_common::DLLCRCResult crc_diag;
   if (!wmbus_common::trim_dll_crc_format_a(out.data, &crc_diag)) {
-    set_attempt_drop_(out, crc_diag.stage, "dll_crc_failed", dll_crc_detail_(crc_diag));
+    set_attempt_crc_drop_(out, crc_diag);
     return out;
   }
 
@@ -323,14 +520,18 @@ static ParseAttemptResult try_parse_t1_(const std::vector<uint8_t> &raw) {
 
 // C1 parser. Format A/B is selected from the block preamble after the two
 // leading C-mode bytes are removed.
-static ParseAttemptResult try_parse_c1_(const std::vector<uint8_t> &raw) {
+//
+// As the T1 -> C1 fallback (`fallback`), a first byte other than the C
+// preamble is taken for a bit error when the block preamble after it is
+// valid: such a frame was routed to T1 because of that byte, and the L-field
+// and DLL CRC checks below still have to pass.
+static ParseAttemptResult try_parse_c1_(const std::vector<uint8_t> &raw, bool fallback = false) {
   ParseAttemptResult out;
   out.mode = LinkMode::C1;
   out.raw_got_len = raw.size();
 
   if (raw.size() < 3) {
-    set_attempt_drop_(out, "c1_precheck", "too_short",
-                      "mode=C1 raw_len=" + std::to_string((unsigned) raw.size()) + " min=3");
+    set_attempt_drop_(out, DropStage::C1_PRECHECK, DropReason::TOO_SHORT);
     return out;
   }
 
@@ -340,12 +541,10 @@ static ParseAttemptResult try_parse_c1_(const std::vector<uint8_t> &raw) {
   // packet. Failure paths below still copy the whole raw frame into out.data
   // so downstream diagnostics (try_get_meter_id on dropped packets, which
   // understands a raw C1 frame with its suffix) see exactly what they used to.
-  if (raw[0] != WMBUS_MODE_C_PREAMBLE) {
+  const bool block_preamble = raw[1] == WMBUS_BLOCK_A_PREAMBLE || raw[1] == WMBUS_BLOCK_B_PREAMBLE;
+  if (raw[0] != WMBUS_MODE_C_PREAMBLE && !(fallback && block_preamble)) {
     out.data = raw;
-    char detail[64];
-    snprintf(detail, sizeof(detail), "first_byte=%02X raw_len=%u",
-             (unsigned) raw[0], (unsigned) raw.size());
-    set_attempt_drop_(out, "c1_precheck", "unknown_preamble", detail);
+    set_attempt_drop_(out, DropStage::C1_PRECHECK, DropReason::UNKNOWN_PREAMBLE).byte = raw[0];
     return out;
   }
 
@@ -355,16 +554,13 @@ static ParseAttemptResult try_parse_c1_(const std::vector<uint8_t> &raw) {
     out.frame_format = "B";
   } else {
     out.data = raw;
-    char detail[64];
-    snprintf(detail, sizeof(detail), "preamble=%02X raw_len=%u", (unsigned) raw[1], (unsigned) raw.size());
-    set_attempt_drop_(out, "c1_preamble", "unknown_preamble", detail);
+    set_attempt_drop_(out, DropStage::C1_PREAMBLE, DropReason::UNKNOWN_PREAMBLE).byte = raw[1];
     return out;
   }
 
   if (raw.size() < WMBUS_MODE_C_SUFIX_LEN) {
     out.data = raw;
-    set_attempt_drop_(out, "c1_suffix", "too_short",
-                      "raw_len=" + std::to_string((unsigned) raw.size()) + " min_suffix=2");
+    set_attempt_drop_(out, DropStage::C1_SUFFIX, DropReason::TOO_SHORT);
     return out;
   }
 
@@ -380,20 +576,13 @@ static ParseAttemptResult try_parse_c1_(const std::vector<uint8_t> &raw) {
   out.got_len = out.data.size();
 
   if (want < 12 || want > 260) {
-    char detail[144];
-    snprintf(detail, sizeof(detail), "format=%s l_field=%u decoded_len=%u want=%u need_total=%u",
-             out.frame_format.c_str(), (unsigned) l, (unsigned) out.decoded_len,
-             (unsigned) want, (unsigned) need_total);
-    set_attempt_drop_(out, "c1_l_field", "l_field_invalid", detail);
+    set_attempt_drop_(out, DropStage::C1_L_FIELD, DropReason::L_FIELD_INVALID).l_field = l;
     return out;
   }
 
   if (out.data.size() < need_total) {
     out.truncated = true;
-    char detail[144];
-    snprintf(detail, sizeof(detail), "format=%s decoded_len=%u need_total=%u l_field=%u",
-             out.frame_format.c_str(), (unsigned) out.data.size(), (unsigned) need_total, (unsigned) l);
-    set_attempt_drop_(out, "c1_length_check", "truncated", detail);
+    set_attempt_drop_(out, DropStage::C1_LENGTH_CHECK, DropReason::TRUNCATED).l_field = l;
     return out;
   }
 
@@ -402,12 +591,12 @@ static ParseAttemptResult try_parse_c1_(const std::vector<uint8_t> &raw) {
   wmbus_common::DLLCRCResult crc_diag;
   if (out.frame_format == "A") {
     if (!wmbus_common::trim_dll_crc_format_a(out.data, &crc_diag)) {
-      set_attempt_drop_(out, crc_diag.stage, "dll_crc_failed", dll_crc_detail_(crc_diag));
+      set_attempt_crc_drop_(out, crc_diag);
       return out;
     }
   } else {
     if (!wmbus_common::trim_dll_crc_format_b(out.data, &crc_diag)) {
-      set_attempt_drop_(out, crc_diag.stage, "dll_crc_failed", dll_crc_detail_(crc_diag));
+      set_attempt_crc_drop_(out, crc_diag);
       return out;
     }
   }
@@ -418,53 +607,79 @@ static ParseAttemptResult try_parse_c1_(const std::vector<uint8_t> &raw) {
   return out;
 }
 
-static inline uint8_t bit_at_msb_(const std::vector<uint8_t> &raw, size_t bit_index) {
-  const uint8_t b = raw[bit_index >> 3];
-  return (uint8_t) ((b >> (7 - (bit_index & 7))) & 0x01);
-}
-
-// S-mode/S1 uses Manchester coding at 32.768 kcps. Try both common polarities:
+// S-mode/S1 uses Manchester coding at 32.768 kcps. Both common polarities are
+// tried:
 // polarity=false: 01 -> 0, 10 -> 1
 // polarity=true : 01 -> 1, 10 -> 0
-static bool manchester_decode_s_mode_(const std::vector<uint8_t> &raw, bool polarity,
-                                      std::vector<uint8_t> &decoded,
-                                      uint16_t &symbols_total, uint16_t &symbols_invalid) {
-  decoded.clear();
+//
+// One raw byte carries four chip pairs, so a 256-entry table decodes it in a
+// single lookup. Entry layout:
+//   bits 3..0  decoded nibble for polarity=false (invalid 00/11 pairs -> 0)
+//   bits 7..4  mask of the valid pairs
+//   bits 10..8 number of invalid pairs
+// The polarity=true nibble is the complement over the valid pairs only
+// (nibble ^ mask), which lets one pass produce both candidates.
+struct ManchesterByteLookup {
+  uint16_t entries[256];
+  constexpr ManchesterByteLookup() : entries() {
+    for (int b = 0; b < 256; b++) {
+      uint16_t nibble = 0, mask = 0, invalid = 0;
+      for (int pair = 0; pair < 4; pair++) {
+        const int chips = (b >> (6 - 2 * pair)) & 0x03;
+        nibble <<= 1;
+        mask <<= 1;
+        if (chips == 0x2) {
+          nibble |= 1;
+          mask |= 1;
+        } else if (chips == 0x1) {
+          mask |= 1;
+        } else {
+          invalid++;
+        }
+      }
+      this->entries[b] = (uint16_t) (nibble | (mask << 4) | (invalid << 8));
+    }
+  }
+};
+
+static constexpr ManchesterByteLookup MANCHESTER_LOOKUP{};
+
+// Decodes `raw` under both polarities in one pass. Every two raw bytes give
+// one decoded byte per polarity; an incomplete trailing byte is ignored (the
+// radio tail may stop mid-byte in raw-drain diagnostics) but its pairs still
+// count towards the symbol totals, as they always have. The invalid-pair
+// count is the same for both polarities.
+static bool manchester_decode_s_mode_(const std::vector<uint8_t> &raw, std::vector<uint8_t> &decoded_pos,
+                                      std::vector<uint8_t> &decoded_neg, uint16_t &symbols_total,
+                                      uint16_t &symbols_invalid) {
+  const size_t pairs = raw.size() * 4U;
   symbols_total = 0;
   symbols_invalid = 0;
-  const size_t pairs = (raw.size() * 8U) / 2U;
+  decoded_pos.clear();
+  decoded_neg.clear();
   if (pairs < 16) return false;
-
-  decoded.reserve((pairs + 7U) / 8U);
-  uint8_t out_byte = 0;
-  uint8_t out_bits = 0;
-
-  for (size_t i = 0; i < pairs; i++) {
-    const uint8_t a = bit_at_msb_(raw, i * 2U);
-    const uint8_t b = bit_at_msb_(raw, i * 2U + 1U);
-    symbols_total++;
-
-    uint8_t bit;
-    if (a == 0 && b == 1) {
-      bit = polarity ? 1 : 0;
-    } else if (a == 1 && b == 0) {
-      bit = polarity ? 0 : 1;
-    } else {
-      symbols_invalid++;
-      bit = 0;
-    }
-
-    out_byte = (uint8_t) ((out_byte << 1) | bit);
-    out_bits++;
-    if (out_bits == 8) {
-      decoded.push_back(out_byte);
-      out_byte = 0;
-      out_bits = 0;
-    }
+  symbols_total = (uint16_t) pairs;
+
+  const size_t out_len = raw.size() / 2U;
+  decoded_pos.resize(out_len);
+  decoded_neg.resize(out_len);
+  const uint8_t *in = raw.data();
+  uint8_t *pos = decoded_pos.data();
+  uint8_t *neg = decoded_neg.data();
+  uint32_t invalid = 0;
+  for (size_t i = 0; i < out_len; i++) {
+    const uint16_t hi = MANCHESTER_LOOKUP.entries[in[2 * i]];
+    const uint16_t lo = MANCHESTER_LOOKUP.entries[in[2 * i + 1]];
+    const uint8_t p = (uint8_t) (((hi & 0x0F) << 4) | (lo & 0x0F));
+    const uint8_t mask = (uint8_t) ((hi & 0xF0) | ((lo >> 4) & 0x0F));
+    pos[i] = p;
+    neg[i] = (uint8_t) (p ^ mask);
+    invalid += (uint32_t) (hi >> 8) + (uint32_t) (lo >> 8);
   }
+  if (raw.size() & 1U) invalid += (uint32_t) (MANCHESTER_LOOKUP.entries[in[raw.size() - 1]] >> 8);
+  symbols_invalid = (uint16_t) invalid;
 
-  // Ignore incomplete trailing byte; radio tail may stop mid-byte in raw-drain diagnostics.
-  return !decoded.empty();
+  return out_len > 0;
 }
 
 static ParseAttemptResult try_parse_s1_(const std::vector<uint8_t> &raw) {
@@ -474,31 +689,31 @@ static ParseAttemptResult try_parse_s1_(const std::vector<uint8_t> &raw) {
   best.raw_got_len = raw.size();
 
   if (raw.size() < 6) {
-    set_attempt_drop_(best, "s1_precheck", "too_short",
-                      "mode=S1 raw_len=" + std::to_string((unsigned) raw.size()) + " min=6");
+    set_attempt_drop_(best, DropStage::S1_PRECHECK, DropReason::TOO_SHORT);
     return best;
   }
 
+  // Both polarities come out of a single pass over the raw-drain buffer; the
+  // L-field and length checks below are cheap, so only a polarity that
+  // passes them pays for the DLL CRC check.
   ParseAttemptResult attempts[2];
+  uint16_t total = 0, invalid = 0;
+  const bool decoded = manchester_decode_s_mode_(raw, attempts[0].data, attempts[1].data, total, invalid) &&
+                       attempts[0].data.size() >= 2;
   for (int pol = 0; pol < 2; pol++) {
     auto &out = attempts[pol];
     out.mode = LinkMode::S1;
     out.frame_format = "A";
     out.raw_got_len = raw.size();
 
-    std::vector<uint8_t> decoded;
-    uint16_t total = 0, invalid = 0;
-    if (!manchester_decode_s_mode_(raw, pol != 0, decoded, total, invalid) || decoded.size() < 2) {
-      char detail[160];
-      snprintf(detail, sizeof(detail), "polarity=%d symbols_total=%u symbols_invalid=%u raw_len=%u",
-               pol, (unsigned) total, (unsigned) invalid, (unsigned) raw.size());
-      set_attempt_drop_(out, "s1_manchester", "decode_failed", detail);
+    if (!decoded) {
+      out.data.clear();
+      set_attempt_drop_(out, DropStage::S1_MANCHESTER, DropReason::DECODE_FAILED).polarity = (int8_t) pol;
       out.t1_symbols_total = total;
       out.t1_symbols_invalid = invalid;
       continue;
     }
 
-    out.data = std::move(decoded);
     out.decoded_len = out.data.size();
     out.t1_symbols_total = total;      // reused as generic symbol counters for S1 diagnostics
     out.t1_symbols_invalid = invalid;
@@ -510,20 +725,17 @@ static ParseAttemptResult try_parse_s1_(const std::vector<uint8_t> &raw) {
     out.got_len = out.data.size();
 
     if (want < 12 || want > 260) {
-      char detail[160];
-      snprintf(detail, sizeof(detail), "polarity=%d l_field=%u decoded_len=%u want=%u need_total=%u symbols_invalid=%u",
-               pol, (unsigned) l, (unsigned) out.decoded_len, (unsigned) want,
-               (unsigned) need_total, (unsigned) invalid);
-      set_attempt_drop_(out, "s1_l_field", "l_field_invalid", detail);
+      DropInfo &d = set_attempt_drop_(out, DropStage::S1_L_FIELD, DropReason::L_FIELD_INVALID);
+      d.polarity = (int8_t) pol;
+      d.l_field = l;
       continue;
     }
 
     if (out.data.size() < need_total) {
       out.truncated = true;
-      char detail[160];
-      snprintf(detail, sizeof(detail), "polarity=%d decoded_len=%u need_total=%u l_field=%u symbols_invalid=%u",
-               pol, (unsigned) out.data.size(), (unsigned) need_total, (unsigned) l, (unsigned) invalid);
-      set_attempt_drop_(out, "s1_length_check", "truncated", detail);
+      DropInfo &d = set_attempt_drop_(out, DropStage::S1_LENGTH_CHECK, DropReason::TRUNCATED);
+      d.polarity = (int8_t) pol;
+      d.l_field = l;
       continue;
     }
 
@@ -531,16 +743,15 @@ static ParseAttemptResult try_parse_s1_(const std::vector<uint8_t> &raw) {
 
     wmbus_common::DLLCRCResult crc_diag;
     if (!wmbus_common::trim_dll_crc_format_a(out.data, &crc_diag)) {
-      std::string detail = dll_crc_detail_(crc_diag) + " polarity=" + std::to_string(pol) +
-                           " symbols_invalid=" + std::to_string((unsigned) invalid);
-      set_attempt_drop_(out, crc_diag.stage, "dll_crc_failed", detail);
+      set_attempt_crc_drop_(out, crc_diag);
+      out.drop.polarity = (int8_t) pol;
       continue;
     }
 
     out.dll_crc_removed = crc_diag.removed_bytes;
     out.final_len = out.data.size();
     out.ok = true;
-    return out;
+    return std::move(out);
   }
 
   return pick_better_failure_(attempts[0], attempts[1]);
@@ -548,6 +759,38 @@ static ParseAttemptResult try_parse_s1_(const std::vector<uint8_t> &raw) {
 
 }  // namespace
 
+size_t Packet::raw_frame_size(const uint8_t *raw, size_t len, bool s1) {
+  if (s1) {
+    // The L-field alone does not tell the polarity (nearly every byte is a
+    // valid L either way), so the first block is decoded under both and the
+    // one whose CRC matches wins.
+    if (len < RAW_FRAME_SIZE_PREFIX_S1) return 0;
+    uint8_t block[2][12];
+    for (size_t i = 0; i < 12; i++) {
+      const uint16_t hi = MANCHESTER_LOOKUP.entries[raw[2 * i]];
+      const uint16_t lo = MANCHESTER_LOOKUP.entries[raw[2 * i + 1]];
+      if ((hi >> 8) != 0 || (lo >> 8) != 0) return 0;
+      block[0][i] = (uint8_t) (((hi & 0x0F) << 4) | (lo & 0x0F));
+      block[1][i] = (uint8_t) ~block[0][i];
+    }
+    for (const auto &d : block) {
+      if (d[0] < 11 || wmbus_common::crc16_en13757(d, 10) != (uint16_t) ((d[10] << 8) | d[11])) continue;
+      return 2 * total_len_format_a_with_crc_(d[0]);
+    }
+    return 0;
+  }
+  if (len < RAW_FRAME_SIZE_PREFIX) return 0;
+  if (raw[0] == WMBUS_MODE_C_PREAMBLE) {
+    if (raw[2] < 9) return 0;
+    if (raw[1] == WMBUS_BLOCK_A_PREAMBLE) return WMBUS_MODE_C_SUFIX_LEN + total_len_format_a_with_crc_(raw[2]);
+    if (raw[1] == WMBUS_BLOCK_B_PREAMBLE) return WMBUS_MODE_C_SUFIX_LEN + total_len_format_b_with_crc_(raw[2]);
+    return 0;
+  }
+  const uint16_t entry = decode3of6_pair((uint16_t) (((raw[0] << 4) | (raw[1] >> 4)) & 0x0FFF));
+  if ((entry >> 8) != 0 || (uint8_t) entry < 9) return 0;
+  return encoded_size(total_len_format_a_with_crc_((uint8_t) entry));
+}
+
 std::optional<Frame> Packet::convert_to_frame() {
   std::optional<Frame> frame = {};
 
@@ -560,9 +803,7 @@ std::optional<Frame> Packet::convert_to_frame() {
   this->final_len_ = 0;
   this->dll_crc_removed_ = 0;
   this->suffix_ignored_ = 0;
-  this->drop_reason_.clear();
-  this->drop_stage_.clear();
-  this->drop_detail_.clear();
+  this->drop_ = {};
   this->t1_symbols_total_ = 0;
   this->t1_symbols_invalid_ = 0;
 
@@ -592,9 +833,7 @@ std::optional<Frame> Packet::convert_to_frame() {
     this->final_len_ = s1.final_len;
     this->dll_crc_removed_ = s1.dll_crc_removed;
     this->suffix_ignored_ = s1.suffix_ignored;
-    this->drop_reason_ = s1.drop_reason;
-    this->drop_stage_ = s1.drop_stage;
-    this->drop_detail_ = s1.drop_detail;
+    this->drop_ = s1.drop;
     this->t1_symbols_total_ = s1.t1_symbols_total;
     this->t1_symbols_invalid_ = s1.t1_symbols_invalid;
     if (!s1.ok) return {};
@@ -616,7 +855,7 @@ std::optional<Frame> Packet::convert_to_frame() {
   if (first.ok) {
     chosen = &first;
   } else {
-    second = looks_c1 ? try_parse_t1_(raw) : try_parse_c1_(raw);
+    second = looks_c1 ? try_parse_t1_(raw, false) : try_parse_c1_(raw, true);
     if (second.ok) {
       chosen = &second;
       fallback_used = true;
@@ -626,11 +865,11 @@ std::optional<Frame> Packet::convert_to_frame() {
   }
 
   // Copy chosen result back into the packet object used by the rest of the pipeline.
-  // The frame buffer is moved (not copied): `chosen` points at the non-const
-  // locals `first`/`second` (directly, or via pick_better_failure_), whose
-  // `data` is not read again after this. const_cast is safe — the referents are
-  // non-const. The small scalar/string fields below are still copied.
-  this->data_ = std::move(const_cast<ParseAttemptResult &>(*chosen).data);
+  // The frame bytes are copied into the packet's own buffer rather than moved:
+  // pooled packets (PacketPool) must keep their preallocated capacity, and the
+  // result is never longer than the raw bytes it came from, so this does not
+  // allocate. The remaining fields are small scalars (plus the format letter).
+  this->data_.assign(chosen->data.begin(), chosen->data.end());
   this->link_mode_ = chosen->mode;
   this->frame_format_ = chosen->frame_format;
   this->truncated_ = chosen->truncated;
@@ -640,33 +879,28 @@ std::optional<Frame> Packet::convert_to_frame() {
   this->final_len_ = chosen->final_len;
   this->dll_crc_removed_ = chosen->dll_crc_removed;
   this->suffix_ignored_ = chosen->suffix_ignored;
-  this->drop_reason_ = chosen->drop_reason;
-  this->drop_stage_ = chosen->drop_stage;
-  this->drop_detail_ = chosen->drop_detail;
+  this->drop_ = chosen->drop;
   this->t1_symbols_total_ = chosen->t1_symbols_total;
   this->t1_symbols_invalid_ = chosen->t1_symbols_invalid;
 
-  if (!chosen->ok) {
-    if (fallback_used) {
-      this->drop_detail_ += (this->drop_detail_.empty() ? "" : " ");
-      this->drop_detail_ += "fallback_used=1";
-    }
-    return {};
-  }
+  // Keep a short breadcrumb in diagnostics: it helps explain why an apparently
+  // odd packet still decoded successfully (or which parser the drop came from).
+  this->drop_.fallback_used = fallback_used;
 
-  if (fallback_used) {
-    // Keep a short breadcrumb in diagnostics: it helps explain why an apparently
-    // odd packet still decoded successfully.
-    this->drop_detail_ = "fallback_used=1";
-  }
+  if (!chosen->ok) return {};
 
   frame.emplace(this);
   return frame;
 }
 
+// Copies the packet bytes (the frame outlives the packet, which goes back to
+// the pool with its buffer intact).
 Frame::Frame(Packet *packet)
-    : data_(std::move(packet->data_)), link_mode_(packet->link_mode_),
-      rssi_(packet->rssi_), format_(packet->frame_format_) {}
+    : data_(packet->data_), link_mode_(packet->link_mode_),
+      rssi_(packet->rssi_), rx_ms_(packet->rx_ms_), format_(packet->frame_format_) {}
+
+Frame::Frame(const uint8_t *data, size_t len, LinkMode link_mode, int8_t rssi, uint32_t rx_ms, const char *format)
+    : data_(data, data + len), link_mode_(link_mode), rssi_(rssi), rx_ms_(rx_ms), format_(format) {}
 
 std::vector<uint8_t> &Frame::data() { return this->data_; }
 LinkMode Frame::link_mode() { return this->link_mode_; }
@@ -677,6 +911,9 @@ std::vector<uint8_t> Frame::as_raw() { return this->data_; }
 std::string Frame::as_hex() { return format_hex(this->data_); }
 
 bool Frame::try_get_meter_id(uint32_t &out_id) const { return try_extract_meter_id_(this->data_, out_id); }
+bool Frame::meter_header(MeterHeader &h) const {
+  return meter_header_from_block(this->data_.data(), this->data_.size(), 10, h);
+}
 
 std::string Frame::as_rtlwmbus() {
   const size_t time_repr_size = sizeof("YYYY-MM-DD HH:MM:SS.00Z");
@@ -10,6 +10,8 @@
 // Keep wmbus_radio lightweight: do NOT pull full wmbusmeters/wmbus_common.
 // We only need LinkMode names and basic helpers.
 #include "link_mode.h"
+#include "drop_reason.h"
+#include "meter_filter.h"
 #include "esphome/core/helpers.h"
 
 namespace esphome {
@@ -29,11 +31,41 @@ public:
   void resize(size_t len);
   size_t size() const { return this->data_.size(); }
 
+  // Pool support (see PacketPool): reserve the buffer once, then reset() the
+  // packet to its freshly constructed state between frames. reset() keeps
+  // every buffer's capacity, so a reused packet does not touch the heap while
+  // bytes are appended up to that capacity.
+  void reserve_capacity(size_t len) { this->data_.reserve(len); }
+  void reset();
+
   // Expected total packet size (including PHY header bytes as provided by
   // the transceiver). Returns 0 if it can't be determined from current data.
   size_t expected_size();
 
+  // On-air length of a frame, in raw radio bytes, from its first bytes as the
+  // transceiver captures them: 0x54 + CD/3D + L for C1, the 3-of-6 coded L
+  // for T1, and for S1 (s1 set) the whole Manchester coded first block, as
+  // only its CRC tells the polarity. Returns 0 before RAW_FRAME_SIZE_PREFIX
+  // (_S1) bytes are in, or when the L-field or block CRC is invalid. Lets a
+  // streaming receiver stop as soon as the frame is in instead of waiting
+  // for silence.
+  static constexpr size_t RAW_FRAME_SIZE_PREFIX = 3;
+  static constexpr size_t RAW_FRAME_SIZE_PREFIX_S1 = 24;
+  static size_t raw_frame_size(const uint8_t *raw, size_t len, bool s1);
+
+  // Incremental T1 (3-of-6) decode of the bytes received so far. Each call
+  // decodes only the raw bytes appended since the previous call, so the
+  // receiver can follow a T1 frame while it arrives: the L-field is known once
+  // 2 raw bytes are in, and an invalid symbol shows up as soon as the byte
+  // carrying it has been read. Returns false once an invalid symbol was seen.
+  bool t1_stream_update();
+
   void set_rssi(int8_t rssi);
+  // millis() when the receiver task queued the packet.
+  void set_rx_ms(uint32_t ms) { this->rx_ms_ = ms; }
+  // Second sync byte the radio was armed with when the frame started.
+  void set_sync2(uint8_t sync2) { this->sync2_ = sync2; }
+  uint8_t sync2() const { return this->sync2_; }
   void set_forced_link_mode(LinkMode mode);
 
   std::optional<Frame> convert_to_frame();
@@ -41,6 +73,7 @@ public:
   // Basic getters for diagnostics
   LinkMode get_link_mode() { return this->link_mode(); }
   int8_t get_rssi() const { return this->rssi_; }
+  uint32_t rx_ms() const { return this->rx_ms_; }
 
   // Diagnostics (populated when convert_to_frame() rejects a packet)
   bool is_truncated() const { return this->truncated_; }
@@ -51,9 +84,18 @@ public:
   size_t final_len() const { return this->final_len_; }
   uint16_t dll_crc_removed() const { return this->dll_crc_removed_; }
   uint8_t suffix_ignored() const { return this->suffix_ignored_; }
-  const std::string &drop_reason() const { return this->drop_reason_; }
-  const std::string &drop_stage() const { return this->drop_stage_; }
-  const std::string &drop_detail() const { return this->drop_detail_; }
+  DropReason drop_reason() const { return this->drop_.reason; }
+  DropStage drop_stage() const { return this->drop_.stage; }
+  // The C1 <-> T1 fallback parser was needed (set on drops and on frames
+  // that only decoded through the fallback).
+  bool fallback_used() const { return this->drop_.fallback_used; }
+
+  // Human-readable drop detail ("l_field=... decoded_len=..."), formatted on
+  // demand from the values recorded during parsing. Writes at most `cap`
+  // bytes including the terminator and returns `buf`.
+  static constexpr size_t DROP_DETAIL_MAX = 192;
+  const char *format_drop_detail(char *buf, size_t cap) const;
+  std::string drop_detail() const;
 
   // Raw packet bytes (hex) captured at the beginning of convert_to_frame().
   // Intended for diagnostics; may be truncated to keep MQTT/log payloads small.
@@ -64,11 +106,21 @@ public:
   // callers that never set it (e.g. host tests) keep the old behaviour.
   void set_capture_raw_hex(bool enabled) { this->capture_raw_hex_ = enabled; }
   std::string packet_hex() const;
+  // The packet buffer itself: raw radio bytes until convert_to_frame() runs.
+  const std::vector<uint8_t> &raw_bytes() const { return this->data_; }
 
   // Best-effort meter id extraction from the current packet buffer.
   // Works after successful decode and for some late-stage failures.
   bool try_get_meter_id(uint32_t &out_id) const;
 
+  // Link-layer header of a packet that has not been parsed yet, for the
+  // early meter_filter check: read straight from a raw C1 frame, or from the
+  // first 3-of-6-decoded T1 block (20 raw bytes). The format A block 1
+  // (C1 and T1) must pass its CRC; format B has no CRC before the CI field
+  // and is taken as is. False when the header is not known yet (S1, short or
+  // broken packet); the full parse then decides.
+  bool peek_meter_header(MeterHeader &h);
+
   // T1 (3-of-6) symbol diagnostics (only meaningful for LinkMode::T1)
   uint16_t t1_symbols_total() const { return this->t1_symbols_total_; }
   uint16_t t1_symbols_invalid() const { return this->t1_symbols_invalid_; }
@@ -80,13 +132,25 @@ protected:
 
   uint8_t l_field();
   int8_t rssi_ = 0;
+  uint32_t rx_ms_ = 0;
+  uint8_t sync2_ = 0;
 
   LinkMode link_mode();
   LinkMode link_mode_ = LinkMode::UNKNOWN;
 
   std::string frame_format_;
 
-  void set_drop_(const char *stage, const char *reason, const std::string &detail = {});
+  // State of t1_stream_update(). Only full symbol pairs (one decoded byte)
+  // are checked; a lone trailing symbol waits for the next raw byte.
+  struct T1StreamState {
+    size_t raw_consumed{0};
+    uint32_t bits{0};
+    uint8_t bit_count{0};
+    uint16_t decoded{0};
+    uint8_t l_field{0};
+    bool invalid{false};
+  };
+  T1StreamState t1_stream_{};
 
   // Diagnostics
   bool truncated_{false};
@@ -97,9 +161,7 @@ protected:
   size_t final_len_{0};
   uint16_t dll_crc_removed_{0};
   uint8_t suffix_ignored_{0};
-  std::string drop_reason_{};
-  std::string drop_stage_{};
-  std::string drop_detail_{};
+  DropInfo drop_{};
   std::string raw_hex_{};
   bool capture_raw_hex_{true};
 
@@ -111,16 +173,21 @@ protected:
 struct Frame {
 public:
   Frame(Packet *packet);
+  // A frame replayed from a stored record (offline buffer).
+  Frame(const uint8_t *data, size_t len, LinkMode link_mode, int8_t rssi, uint32_t rx_ms, const char *format);
 
   std::vector<uint8_t> &data();
   LinkMode link_mode();
   int8_t rssi();
+  uint32_t rx_ms() const { return this->rx_ms_; }
   std::string format();
 
   std::vector<uint8_t> as_raw();
   std::string as_hex();
   std::string as_rtlwmbus();
   bool try_get_meter_id(uint32_t &out_id) const;
+  // Header of the parsed frame (L-field first, DLL CRCs removed).
+  bool meter_header(MeterHeader &h) const;
 
   void mark_as_handled();
   uint8_t handlers_count();
@@ -129,6 +196,7 @@ protected:
   std::vector<uint8_t> data_;
   LinkMode link_mode_;
   int8_t rssi_;
+  uint32_t rx_ms_;
   std::string format_;
   uint8_t handlers_count_ = 0;
 };
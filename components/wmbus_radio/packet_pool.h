@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "packet.h"
+#include "spsc_ring.h"
+
+namespace esphome {
+namespace wmbus_radio {
+
+// Fixed set of Packet slots shared by the receiver task and loop().
+//
+// Before: every IRQ did std::make_unique<Packet>(), grew its vector while
+// bytes arrived, passed the pointer through a 3-deep FreeRTOS queue and
+// loop() deleted it. After weeks of uptime that churn fragmented the heap.
+// Now every slot buffer is reserved once in init() and slots only move
+// between two SPSC rings:
+//
+//   free ring:  loop() releases  -> receiver task acquires
+//   ready ring: receiver queues  -> loop() takes
+//
+// Each ring has exactly one producer and one consumer, so both are
+// wait-free. The receiver task never touches the heap.
+//
+// SLOTS = 1 slot being filled by the receiver + 3 in flight, the same depth
+// as the old queue.
+class PacketPool {
+ public:
+  static constexpr size_t SLOTS = 4;
+  // Longest raw frame the receive path can store: a T1 telegram with L=255 is
+  // 290 bytes with DLL CRCs, 435 bytes 3-of-6 encoded. The raw-drain limit
+  // (416) and C1 (2 + 290) are shorter.
+  static constexpr size_t SLOT_BYTES = 436;
+
+  // Call once from setup(), before the receiver task starts.
+  void init() {
+    for (auto &slot : this->slots_) {
+      slot.reserve_capacity(SLOT_BYTES);
+      this->free_.push(&slot);
+    }
+  }
+
+  // Receiver task. nullptr when every slot is queued or being processed.
+  Packet *acquire() {
+    Packet *p = nullptr;
+    if (!this->free_.pop(p)) return nullptr;
+    p->reset();
+    return p;
+  }
+  // Receiver task. Cannot fail while the ready ring holds all SLOTS.
+  bool queue(Packet *p) { return this->ready_.push(p); }
+
+  // loop(). nullptr when nothing is waiting.
+  Packet *take() {
+    Packet *p = nullptr;
+    return this->ready_.pop(p) ? p : nullptr;
+  }
+  // loop(). Hands a processed slot back to the receiver task.
+  void release(Packet *p) {
+    if (p != nullptr) this->free_.push(p);
+  }
+
+  size_t queued() const { return this->ready_.size(); }
+  size_t free_slots() const { return this->free_.size(); }
+
+ protected:
+  Packet slots_[SLOTS];
+  SpscRing<Packet *, SLOTS> free_;
+  SpscRing<Packet *, SLOTS> ready_;
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
@@ -1,9 +1,11 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 //
-// RF runtime heuristics for the wmbus_radio component: busy-ether adaptive
-// state, weak/partial-start and T1-probe abort decisions, raw-drain gating and
-// the related RX diagnostics collection. Split out of component.cpp unchanged
-// (move-only refactor); behaviour, timings and thresholds are identical.
+// RF runtime heuristics for the wmbus_radio component. On the receiver task:
+// weak/partial-start and T1-probe abort decisions and raw-drain gating, read
+// from the receiver's own view of the current interval (rx_task_view_()), and
+// collection of the driver-side RX counters (FIFO overruns and reads, stream
+// capture, re-arm, sync schedule). On the loop task: the busy-ether adaptive
+// hold, re-evaluated once per diagnostic summary window.
 
 #include "component.h"
 #include "wmbus_radio_internal.h"
@@ -31,20 +33,39 @@ static bool radio_supports_weak_partial_start_abort_(const RadioTransceiver *rad
   return radio != nullptr && radio->supports_weak_partial_start_abort();
 }
 
+// Receiver task only: the drivers count overruns in their read path, which
+// runs on the same task, so the count needs no locking.
 void Radio::collect_radio_rx_diag_() {
   if (this->radio == nullptr) return;
-  const uint32_t fifo_overrun = this->radio->take_fifo_overrun_count();
-  this->diag_rx_path_.fifo_overrun += fifo_overrun;
-  this->diag_15m_rx_path_.fifo_overrun += fifo_overrun;
-  this->diag_60min_rx_path_.fifo_overrun += fifo_overrun;
+  RxPathCounters &rx = this->rx_task_counters_.local();
+  rx.fifo_overrun += this->radio->take_fifo_overrun_count();
+  this->radio->take_stream_capture_stats(rx.stream_capture);
+  this->radio->sync_scheduler().take_stats(rx.sync_schedule);
+  this->radio->take_rearm_stats(rx.rearm);
+  this->radio->take_fifo_drain_stats(rx.fifo_drain);
 }
 
-uint32_t Radio::current_false_start_like_() const {
-  return this->diag_rx_path_.preamble_read_failed +
-         this->diag_rx_path_.payload_size_unknown +
-         this->diag_rx_path_.weak_start_aborted +
-         this->diag_rx_path_.probe_start_aborted +
-         this->diag_rx_path_.raw_drain_skipped_weak;
+uint32_t Radio::current_false_start_like_(const RxPathCounters &rx) {
+  return rx.preamble_read_failed +
+         rx.payload_size_unknown +
+         rx.weak_start_aborted +
+         rx.probe_start_aborted +
+         rx.raw_drain_skipped_weak;
+}
+
+// Receiver task only: the current interval as far as the receiver can tell.
+// Its own counts are exact; the loop-owned ones are those of the last
+// publish_loop_rx_stats_(), or older if loop() was mid-publish on this core.
+const Radio::RxTaskView &Radio::rx_task_view_() {
+  this->loop_rx_stats_.read(this->rx_view_.loop);
+  const RxPathCounters &now = this->rx_task_counters_.local();
+  if (this->rx_view_.loop.interval != this->rx_view_interval_) {
+    this->rx_view_interval_ = this->rx_view_.loop.interval;
+    this->rx_view_base_ = now;
+  }
+  this->rx_view_.rx_path = now;
+  counters_fold(this->rx_view_.rx_path, this->rx_view_base_, true);
+  return this->rx_view_;
 }
 
 bool Radio::sx1276_busy_ether_aggressive_now_() const {
@@ -56,24 +77,24 @@ bool Radio::sx1276_busy_ether_aggressive_now_() const {
   return millis() < this->busy_ether_active_until_ms_;
 }
 
-bool Radio::sx1276_busy_ether_severe_now_() const {
+bool Radio::sx1276_busy_ether_severe_now_(const RxTaskView &v) const {
   if (!radio_supports_weak_partial_start_abort_(this->radio)) return false;
-  const uint32_t false_start_like = this->current_false_start_like_();
-  const uint32_t drop_pct_window = (this->diag_total_ > 0 && this->diag_total_ > this->diag_ok_)
-      ? (((this->diag_total_ - this->diag_ok_) * 100U) / this->diag_total_) : 0U;
-  const uint32_t t1_sym_invalid_pct = (this->diag_t1_symbols_total_ > 0)
-      ? ((this->diag_t1_symbols_invalid_ * 100U) / this->diag_t1_symbols_total_) : 0U;
+  const uint32_t false_start_like = current_false_start_like_(v.rx_path);
+  const uint32_t drop_pct_window = (v.loop.total > 0 && v.loop.total > v.loop.ok)
+      ? (((v.loop.total - v.loop.ok) * 100U) / v.loop.total) : 0U;
+  const uint32_t t1_sym_invalid_pct = (v.loop.t1_symbols_total > 0)
+      ? ((v.loop.t1_symbols_invalid * 100U) / v.loop.t1_symbols_total) : 0U;
 
   if (this->sx1276_busy_ether_mode_ == SX1276BusyEtherMode::AGGRESSIVE) {
     // Raised thresholds: previous values (20/10/15) fired almost immediately in a typical
     // wMBus building due to normal transmission collisions, making AGGRESSIVE + SEVERE the
     // permanent state and killing distant-but-valid meters via RSSI threshold escalation.
-    return false_start_like >= 60 || this->diag_rx_path_.preamble_read_failed >= 30 || drop_pct_window >= 25;
+    return false_start_like >= 60 || v.rx_path.preamble_read_failed >= 30 || drop_pct_window >= 25;
   }
   if (this->sx1276_busy_ether_mode_ == SX1276BusyEtherMode::NORMAL) return false;
 
   if (false_start_like >= 140) return true;
-  if (this->diag_rx_path_.preamble_read_failed >= 40 && this->diag_rx_path_.probe_start_aborted >= 40) return true;
+  if (v.rx_path.preamble_read_failed >= 40 && v.rx_path.probe_start_aborted >= 40) return true;
   if (drop_pct_window >= 30) return true;
   if (t1_sym_invalid_pct >= 8 && false_start_like >= 30) return true;
   return false;
@@ -89,18 +110,18 @@ void Radio::evaluate_busy_ether_adaptive_(uint32_t now_ms) {
   if (!radio_supports_weak_partial_start_abort_(this->radio)) return;
 
   const char *chip = (this->radio != nullptr) ? this->radio->get_name() : "unknown";
-  const uint32_t fsl = this->current_false_start_like_();
-  const uint32_t drop_pct = (this->diag_total_ > 0 && this->diag_total_ > this->diag_ok_)
-      ? (((this->diag_total_ - this->diag_ok_) * 100U) / this->diag_total_) : 0U;
-  const uint32_t t1_sym_inv_pct = (this->diag_t1_symbols_total_ > 0)
-      ? ((this->diag_t1_symbols_invalid_ * 100U) / this->diag_t1_symbols_total_) : 0U;
+  const uint32_t fsl = current_false_start_like_(this->diag_.rx_path);
+  const uint32_t drop_pct = (this->diag_.total > 0 && this->diag_.total > this->diag_.ok)
+      ? (((this->diag_.total - this->diag_.ok) * 100U) / this->diag_.total) : 0U;
+  const uint32_t t1_sym_inv_pct = (this->diag_.t1_symbols_total > 0)
+      ? ((this->diag_.t1_symbols_invalid * 100U) / this->diag_.t1_symbols_total) : 0U;
 
   const bool trigger =
-      (this->diag_rx_path_.fifo_overrun > 0) ||
+      (this->diag_.rx_path.fifo_overrun > 0) ||
       // fsl alone is not enough — high fsl with low drop_pct means RF background noise
       // that does not actually harm reception. Require drop_pct >= 10 to confirm real collisions.
       (fsl >= 80 && drop_pct >= 10) ||
-      (this->diag_rx_path_.preamble_read_failed >= 25 && this->diag_rx_path_.probe_start_aborted >= 20 && drop_pct >= 10) ||
+      (this->diag_.rx_path.preamble_read_failed >= 25 && this->diag_.rx_path.probe_start_aborted >= 20 && drop_pct >= 10) ||
       (drop_pct >= 20 && fsl >= 30) ||
       (t1_sym_inv_pct >= 5 && fsl >= 20 && drop_pct >= 10);
 
@@ -119,20 +140,22 @@ void Radio::evaluate_busy_ether_adaptive_(uint32_t now_ms) {
                "(fsl=%" PRIu32 " drop_pct=%" PRIu32 " t1_sym_inv_pct=%" PRIu32
                " preamble_fail=%" PRIu32 " probe_abort=%" PRIu32 " fifo_overrun=%" PRIu32 ")",
                fsl, drop_pct, t1_sym_inv_pct,
-               this->diag_rx_path_.preamble_read_failed,
-               this->diag_rx_path_.probe_start_aborted,
-               this->diag_rx_path_.fifo_overrun);
+               this->diag_.rx_path.preamble_read_failed,
+               this->diag_.rx_path.probe_start_aborted,
+               this->diag_.rx_path.fifo_overrun);
       // Publish busy_ether_changed event: passive -> active
       if (!this->diag_topic_.empty()) {
         auto *mqtt = esphome::mqtt::global_mqtt_client;
         if (mqtt != nullptr && mqtt->is_connected()) {
-          char ev[256];
-          snprintf(ev, sizeof(ev),
-                   "{\"event\":\"busy_ether_changed\",\"chip\":\"%s\","
-                   "\"state\":\"adaptive_active\","
-                   "\"fsl\":%" PRIu32 ",\"drop_pct\":%" PRIu32 "}",
-                   chip, fsl, drop_pct);
-          mqtt->publish(this->diag_topic_ + "/busy_ether_changed", std::string(ev), static_cast<uint8_t>(0), false);
+          JsonWriter w = this->json_writer_();
+          w.begin_object()
+              .str("event", "busy_ether_changed")
+              .str("chip", chip)
+              .str("state", "adaptive_active")
+              .u32("fsl", fsl)
+              .u32("drop_pct", drop_pct)
+              .end_object();
+          this->publish_json_(this->diag_topic_ + "/busy_ether_changed", w);
         }
       }
       this->busy_ether_was_active_ = true;
@@ -146,13 +169,15 @@ void Radio::evaluate_busy_ether_adaptive_(uint32_t now_ms) {
     if (!this->diag_topic_.empty()) {
       auto *mqtt = esphome::mqtt::global_mqtt_client;
       if (mqtt != nullptr && mqtt->is_connected()) {
-        char ev[256];
-        snprintf(ev, sizeof(ev),
-                 "{\"event\":\"busy_ether_changed\",\"chip\":\"%s\","
-                 "\"state\":\"adaptive_passive\","
-                 "\"fsl\":%" PRIu32 ",\"drop_pct\":%" PRIu32 "}",
-                 chip, fsl, drop_pct);
-        mqtt->publish(this->diag_topic_ + "/busy_ether_changed", std::string(ev), static_cast<uint8_t>(0), false);
+        JsonWriter w = this->json_writer_();
+        w.begin_object()
+            .str("event", "busy_ether_changed")
+            .str("chip", chip)
+            .str("state", "adaptive_passive")
+            .u32("fsl", fsl)
+            .u32("drop_pct", drop_pct)
+            .end_object();
+        this->publish_json_(this->diag_topic_ + "/busy_ether_changed", w);
       }
     }
     this->busy_ether_was_active_ = false;
@@ -160,18 +185,18 @@ void Radio::evaluate_busy_ether_adaptive_(uint32_t now_ms) {
   // else: was_active && is_active_now && !trigger — still in hold, quiet window, don't extend, don't log.
 }
 
-bool Radio::should_abort_weak_partial_start_(int rssi_dbm, size_t bytes_read, bool is_c_mode) const {
+bool Radio::should_abort_weak_partial_start_(const RxTaskView &v, int rssi_dbm, size_t bytes_read, bool is_c_mode) const {
   if (!radio_supports_weak_partial_start_abort_(this->radio)) return false;
   if (is_c_mode) return false;
   if (rssi_dbm <= -126 || rssi_dbm >= 0) return false;
 
-  const uint32_t false_start_like = this->current_false_start_like_();
-  int32_t recent_ok = this->recent_ok_rssi_valid_ ? this->recent_ok_rssi_avg_ : -80;
+  const uint32_t false_start_like = current_false_start_like_(v.rx_path);
+  int32_t recent_ok = v.loop.recent_ok_rssi_valid ? v.loop.recent_ok_rssi_avg : -80;
   int32_t threshold = recent_ok - 10;
-  if (false_start_like >= 40 || this->diag_rx_path_.fifo_overrun > 0) threshold += 2;
+  if (false_start_like >= 40 || v.rx_path.fifo_overrun > 0) threshold += 2;
   if (false_start_like >= 100) threshold += 2;
   if (this->sx1276_busy_ether_aggressive_now_()) threshold += 3;
-  if (this->sx1276_busy_ether_severe_now_()) threshold += 2;
+  if (this->sx1276_busy_ether_severe_now_(v)) threshold += 2;
   // Clamp upper bound at -88 dBm: wMBus meters in a building routinely transmit at
   // -80..-90 dBm. The previous -78 limit killed distant-but-valid meters even without severe.
   threshold = std::clamp<int32_t>(threshold, -96, -88);
@@ -179,43 +204,43 @@ bool Radio::should_abort_weak_partial_start_(int rssi_dbm, size_t bytes_read, bo
 
   size_t max_partial = WMBUS_T1_LEN_PROBE_BYTES + 8;
   if (this->sx1276_busy_ether_aggressive_now_()) max_partial = WMBUS_T1_LEN_PROBE_BYTES + 4;
-  if (this->sx1276_busy_ether_severe_now_()) max_partial = WMBUS_T1_LEN_PROBE_BYTES + 2;
+  if (this->sx1276_busy_ether_severe_now_(v)) max_partial = WMBUS_T1_LEN_PROBE_BYTES + 2;
 
   // Only for clearly partial / short starts. Once we already have a long body, keep the current path.
   if (bytes_read > max_partial) return false;
   return true;
 }
 
-bool Radio::should_abort_t1_probe_start_(int rssi_dbm) const {
+bool Radio::should_abort_t1_probe_start_(const RxTaskView &v, int rssi_dbm) const {
   if (!radio_supports_weak_partial_start_abort_(this->radio)) return false;
   if (rssi_dbm <= -126 || rssi_dbm >= 0) return false;
 
-  const uint32_t false_start_like = this->current_false_start_like_();
+  const uint32_t false_start_like = current_false_start_like_(v.rx_path);
   if (this->sx1276_busy_ether_mode_ == SX1276BusyEtherMode::NORMAL &&
-      false_start_like < 20 && this->diag_rx_path_.fifo_overrun == 0) return false;
+      false_start_like < 20 && v.rx_path.fifo_overrun == 0) return false;
 
-  int32_t recent_ok = this->recent_ok_rssi_valid_ ? this->recent_ok_rssi_avg_ : -80;
+  int32_t recent_ok = v.loop.recent_ok_rssi_valid ? v.loop.recent_ok_rssi_avg : -80;
   int32_t threshold = recent_ok - 12;
-  if (false_start_like >= 60 || this->diag_rx_path_.fifo_overrun > 0) threshold += 2;
+  if (false_start_like >= 60 || v.rx_path.fifo_overrun > 0) threshold += 2;
   if (false_start_like >= 120) threshold += 2;
   if (this->sx1276_busy_ether_aggressive_now_()) threshold += 4;
-  if (this->sx1276_busy_ether_severe_now_()) threshold += 3;
+  if (this->sx1276_busy_ether_severe_now_(v)) threshold += 3;
   // Clamp upper bound at -86 dBm: the previous -76 limit aborted T1 probe starts for
   // any meter weaker than -76 dBm once AGGRESSIVE+SEVERE was active (which was almost always).
   threshold = std::clamp<int32_t>(threshold, -96, -86);
   return rssi_dbm <= threshold;
 }
 
-bool Radio::should_attempt_raw_drain_(int rssi_dbm, size_t bytes_read, bool is_c_mode) const {
+bool Radio::should_attempt_raw_drain_(const RxTaskView &v, int rssi_dbm, size_t bytes_read, bool is_c_mode) const {
   if (!radio_supports_unknown_size_raw_drain_(this->radio)) return false;
   if (bytes_read == 0 || bytes_read >= WMBUS_RAW_DRAIN_MAX_BYTES) return false;
   if (is_c_mode) return true;
 
-  if (this->should_abort_weak_partial_start_(rssi_dbm, bytes_read, is_c_mode)) return false;
-  if (bytes_read <= (WMBUS_T1_LEN_PROBE_BYTES + 4) && this->should_abort_t1_probe_start_(rssi_dbm)) return false;
+  if (this->should_abort_weak_partial_start_(v, rssi_dbm, bytes_read, is_c_mode)) return false;
+  if (bytes_read <= (WMBUS_T1_LEN_PROBE_BYTES + 4) && this->should_abort_t1_probe_start_(v, rssi_dbm)) return false;
 
-  const int32_t recent_ok = this->recent_ok_rssi_valid_ ? this->recent_ok_rssi_avg_ : -80;
-  if (this->sx1276_busy_ether_severe_now_()) {
+  const int32_t recent_ok = v.loop.recent_ok_rssi_valid ? v.loop.recent_ok_rssi_avg : -80;
+  if (this->sx1276_busy_ether_severe_now_(v)) {
     if (bytes_read <= (WMBUS_T1_LEN_PROBE_BYTES + 16)) return false;
     if (rssi_dbm <= (recent_ok - 8)) return false;
   } else if (this->sx1276_busy_ether_aggressive_now_()) {
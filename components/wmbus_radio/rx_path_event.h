@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// One rx-path diagnostic event (diagnostic_publish_rx_path_events).
+//
+// receive_frame() runs on the radio_recv task, which has to re-arm the radio
+// within milliseconds and must not share the MQTT client with loop(). It
+// therefore only fills in this small record and pushes it into a ring;
+// Radio::loop() turns the records into the JSON text earlier builds
+// published straight from the receiver task (same "stage" and "detail"
+// strings, see format_rx_path_detail_()).
+
+namespace esphome {
+namespace wmbus_radio {
+
+enum class RxPathStage : uint8_t {
+  RECEIVE_WAIT = 0,
+  RECEIVE_SLOT,
+  QUEUE_SEND,
+  RECEIVE_S1_RAW,
+  RECEIVE_PREAMBLE,
+  RECEIVE_PROBE_START,
+  RECEIVE_EXPECTED_SIZE,
+  RECEIVE_PAYLOAD,
+};
+
+// What the "detail" text says; value[] holds its numbers.
+enum class RxPathDetail : uint8_t {
+  INTERRUPT_TIMEOUT = 0,
+  PACKET_POOL_EXHAUSTED,
+  QUEUE_FULL_OR_BUSY,
+  NO_BYTES_AFTER_S1_SYNC,
+  S1_RAW_LEN,  // s1_raw_len=value[0]
+  WEAK_T1_PROBE_START,
+  PREAMBLE_SHORT,  // got=value[0] need=value[1]
+  PAYLOAD_SIZE_UNKNOWN,  // total_len=value[0] already_read=value[1]
+  PAYLOAD_SHORT,  // remaining=value[0] total_len=value[1] already_read=value[2]
+};
+
+// Appended to the detail text, in this order.
+static constexpr uint8_t RX_PATH_FLAG_RAW_DRAIN = 1 << 0;  // " already_read=.. extra=.. final_raw=.."
+static constexpr uint8_t RX_PATH_FLAG_WEAK_PARTIAL_START = 1 << 1;
+static constexpr uint8_t RX_PATH_FLAG_RAW_DRAIN_SKIPPED_WEAK = 1 << 2;
+
+inline const char *rx_path_stage_name(RxPathStage s) {
+  switch (s) {
+    case RxPathStage::RECEIVE_WAIT:
+      return "receive_wait";
+    case RxPathStage::RECEIVE_SLOT:
+      return "receive_slot";
+    case RxPathStage::QUEUE_SEND:
+      return "queue_send";
+    case RxPathStage::RECEIVE_S1_RAW:
+      return "receive_s1_raw";
+    case RxPathStage::RECEIVE_PREAMBLE:
+      return "receive_preamble";
+    case RxPathStage::RECEIVE_PROBE_START:
+      return "receive_probe_start";
+    case RxPathStage::RECEIVE_EXPECTED_SIZE:
+      return "receive_expected_size";
+    case RxPathStage::RECEIVE_PAYLOAD:
+      return "receive_payload";
+    default:
+      return "";
+  }
+}
+
+struct RxPathEvent {
+  uint32_t uptime_ms{0};
+  uint16_t value[3]{};
+  // already_read, extra, final_raw of a raw-drain attempt (RX_PATH_FLAG_RAW_DRAIN)
+  uint16_t drain[3]{};
+  RxPathStage stage{RxPathStage::RECEIVE_WAIT};
+  RxPathDetail detail{RxPathDetail::INTERRUPT_TIMEOUT};
+  uint8_t flags{0};
+  int8_t rssi{0};
+};
+
+inline int8_t rx_path_rssi(int rssi) { return (int8_t) (rssi < -128 ? -128 : (rssi > 127 ? 127 : rssi)); }
+
+inline RxPathEvent make_rx_path_event(RxPathStage stage, RxPathDetail detail, int rssi = 0, size_t v0 = 0,
+                                      size_t v1 = 0, size_t v2 = 0) {
+  RxPathEvent ev;
+  ev.stage = stage;
+  ev.detail = detail;
+  ev.rssi = rx_path_rssi(rssi);
+  ev.value[0] = (uint16_t) v0;
+  ev.value[1] = (uint16_t) v1;
+  ev.value[2] = (uint16_t) v2;
+  return ev;
+}
+
+}  // namespace wmbus_radio
+}  // namespace esphome
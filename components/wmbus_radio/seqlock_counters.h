@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace wmbus_radio {
+
+// Word-wise add (or subtract) of two counter blocks made of 32-bit fields
+// only. Wraps mod 2^32 on purpose, so "now - then" of two snapshots of a
+// free-running counter block is right across a wrap, and signed sums come
+// out right as two's complement.
+template<typename T> inline void counters_fold(T &dst, const T &src, bool subtract) {
+  static_assert(sizeof(T) % sizeof(uint32_t) == 0, "counter blocks must be 32-bit fields only");
+  constexpr size_t WORDS = sizeof(T) / sizeof(uint32_t);
+  uint32_t d[WORDS];
+  uint32_t s[WORDS];
+  std::memcpy(d, &dst, sizeof(d));
+  std::memcpy(s, &src, sizeof(s));
+  for (size_t i = 0; i < WORDS; i++) d[i] = subtract ? (d[i] - s[i]) : (d[i] + s[i]);
+  std::memcpy(&dst, d, sizeof(d));
+}
+
+// A block of 32-bit counters owned by one task and read by others through a
+// sequence lock.
+//
+// The owner edits local() with plain stores, as often as it likes, and calls
+// publish() when the block is in a consistent state. Readers get a copy of the
+// last published state, never a mix of two. Neither side ever waits for the
+// other: publish() is a fixed number of stores, and read() gives up after a
+// few attempts rather than spin. That matters on single-core chips, where a
+// higher-priority reader that interrupted publish() could otherwise spin
+// forever; the caller then keeps its previous copy and tries again later.
+//
+// Nothing is ever reset by a reader. A reader that wants "since last time"
+// keeps the previous snapshot and subtracts (counters_fold()), so an increment
+// is counted exactly once however the two tasks interleave.
+template<typename T> class SeqlockCounters {
+  static_assert(sizeof(T) % sizeof(uint32_t) == 0, "counter blocks must be 32-bit fields only");
+
+ public:
+  static constexpr int READ_ATTEMPTS = 4;
+
+  // Owner only.
+  T &local() { return this->local_; }
+  const T &local() const { return this->local_; }
+
+  // Owner only: make local() visible to readers.
+  void publish() {
+    uint32_t w[WORDS];
+    std::memcpy(w, &this->local_, sizeof(w));
+    const uint32_t seq = this->seq_.load(std::memory_order_relaxed);
+    this->seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; i++) this->words_[i].store(w[i], std::memory_order_relaxed);
+    this->seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // Any other task. Returns false, leaving out untouched, if every attempt
+  // overlapped a publish().
+  bool read(T &out) const {
+    uint32_t w[WORDS];
+    for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+      const uint32_t seq = this->seq_.load(std::memory_order_acquire);
+      if (seq & 1U) continue;
+      for (size_t i = 0; i < WORDS; i++) w[i] = this->words_[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (this->seq_.load(std::memory_order_relaxed) != seq) continue;
+      std::memcpy(&out, w, sizeof(w));
+      return true;
+    }
+    return false;
+  }
+
+ protected:
+  static constexpr size_t WORDS = sizeof(T) / sizeof(uint32_t);
+  T local_{};
+  std::atomic<uint32_t> seq_{0};
+  std::atomic<uint32_t> words_[WORDS]{};
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
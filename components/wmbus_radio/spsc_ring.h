@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace wmbus_radio {
+
+// Wait-free single-producer / single-consumer ring of N trivially copyable
+// items (N a power of two). One task may only push(), one other task may only
+// pop(). No locks, no heap, no FreeRTOS calls, so it is safe to use from the
+// priority-24 receiver task on one core while loop() consumes on the other.
+//
+// head_ is written only by the producer, tail_ only by the consumer; the
+// release/acquire pair publishes the slot contents together with the index.
+// Indices run freely and wrap at 2^32, which stays correct because N divides
+// 2^32.
+template<typename T, size_t N> class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+ public:
+  // Producer side. Returns false when the ring is full.
+  bool push(const T &item) {
+    const uint32_t head = this->head_.load(std::memory_order_relaxed);
+    if (head - this->tail_.load(std::memory_order_acquire) >= N) return false;
+    this->items_[head & (N - 1)] = item;
+    this->head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false when the ring is empty.
+  bool pop(T &out) {
+    const uint32_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (this->head_.load(std::memory_order_acquire) == tail) return false;
+    out = this->items_[tail & (N - 1)];
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate from any task; exact from either side's own point of view.
+  size_t size() const {
+    return (size_t) (this->head_.load(std::memory_order_acquire) - this->tail_.load(std::memory_order_acquire));
+  }
+  static constexpr size_t capacity() { return N; }
+
+ protected:
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  T items_[N]{};
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
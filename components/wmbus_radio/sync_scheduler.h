@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace wmbus_radio {
+
+// Per sync variant, [0] 0x3D and [1] 0xCD. 32-bit fields only: Radio adds
+// them to its rx-path counters.
+struct SyncScheduleStats {
+  uint32_t dwells[2]{};
+  uint32_t listen_ms[2]{};
+  // Radio interrupts (frame starts) while the variant was armed.
+  uint32_t captures[2]{};
+};
+
+// Which second sync byte restart_rx() arms for T1/C1 reception ("both" and
+// "c1" listen modes). The radio listens on one variant per dwell, until the
+// next frame or hop.
+//
+// Fixed: the 3:1 ping-pong the drivers always used, 0xCD on every 4th dwell.
+//
+// Adaptive (default): each variant gets a share of listening time in
+// proportion to its rate of valid frames per second of listening, kept
+// within [MIN_SHARE_PERMILLE, 1000 - MIN_SHARE_PERMILLE] so a rare variant
+// is still heard and its rate still measured. The rates start from a prior
+// equal to the 3:1 ratio, and the tallies are halved once they cover DECAY_MS
+// of listening, so the schedule follows a building whose meters change. The
+// variant furthest below its share of the listening time is armed next.
+//
+// next() runs on the receiver task (restart_rx()); note_hit() runs on the
+// loop task for every valid frame, so the hit counts are the only state the
+// two share, and the share is published for the summary.
+class SyncScheduler {
+ public:
+  static constexpr uint8_t SYNC2[2] = {0x3D, 0xCD};
+  static constexpr uint32_t MIN_SHARE_PERMILLE = 62;
+  static constexpr uint32_t DECAY_MS = 3600000UL;
+  // Prior: 3 and 1 hits per PRIOR_MS of listening.
+  static constexpr uint32_t PRIOR_MS = 60000UL;
+  static constexpr uint32_t PRIOR_HITS[2] = {3, 1};
+
+  void set_adaptive(bool adaptive) { this->adaptive_ = adaptive; }
+  bool adaptive() const { return this->adaptive_; }
+
+  // 1 for 0xCD, 0 for anything else.
+  static uint8_t variant_of(uint8_t sync2) { return sync2 == SYNC2[1] ? 1 : 0; }
+
+  // The second sync byte armed now (0x3D until next() first runs).
+  uint8_t current_sync2() const { return SYNC2[this->current_]; }
+
+  // Loop task: a valid frame came in while sync2 was armed.
+  void note_hit(uint8_t sync2) {
+    auto &h = this->hits_[variant_of(sync2)];
+    h.store(h.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  // Share of listening time given to 0xCD, in permille (250 when fixed).
+  uint32_t cd_share_permille() const { return this->cd_share_.load(std::memory_order_relaxed); }
+
+  // Receiver task: ends the current dwell and returns the byte to arm next.
+  uint8_t next(uint32_t now_ms) {
+    if (this->armed_) {
+      const uint32_t dwell_ms = now_ms - this->armed_at_ms_;
+      this->listen_ms_[this->current_] += dwell_ms;
+      this->stats_.listen_ms[this->current_] += dwell_ms;
+    }
+    if (this->adaptive_) {
+      this->update_share_();
+      const uint64_t total = (uint64_t) this->listen_ms_[0] + this->listen_ms_[1];
+      const uint64_t cd_due = total * this->cd_share_.load(std::memory_order_relaxed) / 1000U;
+      this->current_ = cd_due > this->listen_ms_[1] ? 1 : 0;
+    } else {
+      this->current_ = this->cycle_ == 3 ? 1 : 0;
+      this->cycle_ = (uint8_t) ((this->cycle_ + 1) & 0x03);
+    }
+    this->armed_ = true;
+    this->armed_at_ms_ = now_ms;
+    this->stats_.dwells[this->current_]++;
+    return SYNC2[this->current_];
+  }
+
+  // Receiver task: adds the dwell counts since the last call to acc.
+  void take_stats(SyncScheduleStats &acc) {
+    for (size_t v = 0; v < 2; v++) {
+      acc.dwells[v] += this->stats_.dwells[v];
+      acc.listen_ms[v] += this->stats_.listen_ms[v];
+    }
+    this->stats_ = {};
+  }
+
+ protected:
+  void update_share_() {
+    for (size_t v = 0; v < 2; v++) {
+      const uint32_t seen = this->hits_[v].load(std::memory_order_relaxed);
+      this->hit_tally_[v] += seen - this->hits_seen_[v];
+      this->hits_seen_[v] = seen;
+    }
+    if ((uint64_t) this->listen_ms_[0] + this->listen_ms_[1] > DECAY_MS) {
+      for (size_t v = 0; v < 2; v++) {
+        this->listen_ms_[v] /= 2;
+        this->hit_tally_[v] /= 2;
+      }
+    }
+    // Hits per ms of listening; the prior keeps a variant that has not been
+    // heard yet from dropping to zero.
+    float rate[2];
+    for (size_t v = 0; v < 2; v++) {
+      rate[v] = (float) (this->hit_tally_[v] + PRIOR_HITS[v]) / (float) (this->listen_ms_[v] + PRIOR_MS);
+    }
+    uint32_t share = (uint32_t) (1000.0f * rate[1] / (rate[0] + rate[1]));
+    if (share < MIN_SHARE_PERMILLE) share = MIN_SHARE_PERMILLE;
+    if (share > 1000U - MIN_SHARE_PERMILLE) share = 1000U - MIN_SHARE_PERMILLE;
+    this->cd_share_.store(share, std::memory_order_relaxed);
+  }
+
+  bool adaptive_{true};
+  uint8_t current_{0};
+  uint8_t cycle_{0};
+  bool armed_{false};
+  uint32_t armed_at_ms_{0};
+  // Decayed tallies behind the rates.
+  uint32_t listen_ms_[2]{};
+  uint32_t hit_tally_[2]{};
+  uint32_t hits_seen_[2]{};
+  SyncScheduleStats stats_{};
+  std::atomic<uint32_t> hits_[2]{};
+  std::atomic<uint32_t> cd_share_{250};
+};
+
+}  // namespace wmbus_radio
+}  // namespace esphome
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "link_mode.h"
+
+// Binary telegram record (telegram_format: binary).
+//
+// The hex text on telegram_topic doubles every frame and the raw tap wraps it
+// in JSON on top. A binary record is the frame bytes behind a fixed 12-byte
+// header, built into a buffer reserved once, so publishing a frame no longer
+// allocates a hex string:
+//
+//   off len
+//    0   1  version (TELEGRAM_WIRE_VERSION)
+//    1   1  link mode (LinkMode: 0 unknown, 1 T1, 2 C1, 3 S1)
+//    2   1  frame format (TelegramWireFormat)
+//    3   1  RSSI in dBm, int8
+//    4   4  receive time, ms since boot, little-endian
+//    8   1  flags (TELEGRAM_WIRE_FLAG_*); undefined bits are 0
+//    9   1  header length (TELEGRAM_WIRE_HEADER_LEN)
+//   10   2  payload length, little-endian
+//   12   n  payload: the telegram as it would be hex-encoded on the text topic
+//
+// A decoder must skip header_len bytes rather than assume 12: new header
+// fields are appended and only grow header_len, the version byte changes only
+// if the layout above does. Batches (telegram_batch_size) are
+// records back to back; every record carries its own length.
+//
+// telegram_wire_decode() is the reference decoder; tools/telegram_wire.py
+// does the same for MQTT consumers.
+
+namespace esphome {
+namespace wmbus_radio {
+
+static constexpr uint8_t TELEGRAM_WIRE_VERSION = 1;
+static constexpr size_t TELEGRAM_WIRE_HEADER_LEN = 12;
+
+enum class TelegramWireFormat : uint8_t {
+  UNKNOWN = 0,
+  A = 1,
+  B = 2,
+};
+
+// Payload is the radio packet as received (raw tap), not a validated telegram.
+static constexpr uint8_t TELEGRAM_WIRE_FLAG_RAW = 1 << 0;
+
+struct TelegramWireHeader {
+  uint8_t version{TELEGRAM_WIRE_VERSION};
+  LinkMode link_mode{LinkMode::UNKNOWN};
+  TelegramWireFormat format{TelegramWireFormat::UNKNOWN};
+  int8_t rssi{0};
+  uint32_t rx_ms{0};
+  uint8_t flags{0};
+  uint16_t payload_len{0};
+};
+
+inline TelegramWireFormat telegram_wire_format(const char *frame_format) {
+  if (frame_format == nullptr) return TelegramWireFormat::UNKNOWN;
+  if (std::strcmp(frame_format, "A") == 0) return TelegramWireFormat::A;
+  if (std::strcmp(frame_format, "B") == 0) return TelegramWireFormat::B;
+  return TelegramWireFormat::UNKNOWN;
+}
+
+// Writes the TELEGRAM_WIRE_HEADER_LEN header bytes for a payload of len
+// (<= 0xFFFF) bytes; for callers that place the payload themselves.
+inline void telegram_wire_encode_header(uint8_t *out, const TelegramWireHeader &h, size_t len) {
+  out[0] = TELEGRAM_WIRE_VERSION;
+  out[1] = (uint8_t) h.link_mode;
+  out[2] = (uint8_t) h.format;
+  out[3] = (uint8_t) h.rssi;
+  out[4] = (uint8_t) (h.rx_ms);
+  out[5] = (uint8_t) (h.rx_ms >> 8);
+  out[6] = (uint8_t) (h.rx_ms >> 16);
+  out[7] = (uint8_t) (h.rx_ms >> 24);
+  out[8] = h.flags;
+  out[9] = (uint8_t) TELEGRAM_WIRE_HEADER_LEN;
+  out[10] = (uint8_t) len;
+  out[11] = (uint8_t) (len >> 8);
+}
+
+// Writes header + payload to out. Returns the record length, or 0 if it does
+// not fit in cap or the payload is longer than the length field.
+inline size_t telegram_wire_encode(uint8_t *out, size_t cap, const TelegramWireHeader &h, const uint8_t *payload,
+                                   size_t len) {
+  if (len > 0xFFFF || cap < TELEGRAM_WIRE_HEADER_LEN + len) return 0;
+  telegram_wire_encode_header(out, h, len);
+  if (len != 0) std::memcpy(out + TELEGRAM_WIRE_HEADER_LEN, payload, len);
+  return TELEGRAM_WIRE_HEADER_LEN + len;
+}
+
+// Parses the record at the start of in. On success fills h, points payload at
+// the frame bytes inside in and returns the record length, so a batch is
+// decoded by advancing past it. Returns 0 for a truncated record, an unknown
+// version or a header shorter than version 1's.
+inline size_t telegram_wire_decode(const uint8_t *in, size_t len, TelegramWireHeader &h, const uint8_t *&payload) {
+  if (len < TELEGRAM_WIRE_HEADER_LEN || in[0] != TELEGRAM_WIRE_VERSION) return 0;
+  const size_t header_len = in[9];
+  if (header_len < TELEGRAM_WIRE_HEADER_LEN) return 0;
+  h.version = in[0];
+  h.link_mode = (LinkMode) in[1];
+  h.format = (TelegramWireFormat) in[2];
+  h.rssi = (int8_t) in[3];
+  h.rx_ms = (uint32_t) in[4] | ((uint32_t) in[5] << 8) | ((uint32_t) in[6] << 16) | ((uint32_t) in[7] << 24);
+  h.flags = in[8];
+  h.payload_len = (uint16_t) (in[10] | (in[11] << 8));
+  if (len < header_len + h.payload_len) return 0;
+  payload = in + header_len;
+  return header_len + h.payload_len;
+}
+
+}  // namespace wmbus_radio
+}  // namespace esphome
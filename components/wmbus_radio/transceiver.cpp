@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "transceiver.h"
+#include "seqlock_counters.h"
 
+#include "esphome/core/hal.h"
 #include "esphome/core/log.h"
 
 #include "freertos/FreeRTOS.h"
@@ -10,19 +12,16 @@ namespace wmbus_radio {
 static const char *TAG = "wmbus.transceiver";
 
 bool RadioTransceiver::read_in_task(uint8_t *buffer, size_t length) {
-  const uint8_t *buffer_end = buffer + length;
-  int wait_count = 0;
+  size_t done = 0;
 
-  while (buffer != buffer_end) {
-    auto byte = this->read();
-    if (byte.has_value())
-      *buffer++ = *byte;
+  while (done < length) {
+    const size_t got = this->read_bulk(buffer + done, length - done);
+    if (got > 0)
+      done += got;
     else if (this->consume_rx_abort_request())
       return false;
     else if (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1)))
       return false;
-    else
-      wait_count++;
   }
 
   return true;
@@ -37,9 +36,9 @@ bool RadioTransceiver::read_in_task_partial(uint8_t *buffer, size_t max_length,
 
   uint8_t idle_seen = 0;
   while (out_read < max_length) {
-    auto byte = this->read();
-    if (byte.has_value()) {
-      buffer[out_read++] = *byte;
+    const size_t got = this->read_bulk(buffer + out_read, max_length - out_read);
+    if (got > 0) {
+      out_read += got;
       idle_seen = 0;
       continue;
     }
@@ -89,6 +88,7 @@ void RadioTransceiver::common_setup() {
 
 uint8_t RadioTransceiver::spi_transaction(uint8_t operation, uint8_t address,
                                           std::initializer_list<uint8_t> data) {
+  this->spi_txns_++;
   this->delegate_->begin_transaction();
   auto rval = this->delegate_->transfer(operation | address);
   for (auto byte : data)
@@ -110,6 +110,57 @@ void RadioTransceiver::spi_write(uint8_t address, uint8_t data) {
   this->spi_write(address, {data});
 }
 
+bool RadioTransceiver::begin_rearm_() {
+  const bool fast = this->rearms_since_full_ != 0;
+  this->rearms_since_full_ = (uint8_t) ((this->rearms_since_full_ + 1) % FULL_REARM_INTERVAL);
+  return fast;
+}
+
+void RadioTransceiver::note_rearm_(uint32_t blind_us, bool fast) {
+  auto &st = this->rearm_stats_;
+  st.rearms++;
+  if (fast) {
+    st.fast++;
+    st.blind_us_sum_fast += blind_us;
+  } else {
+    st.blind_us_sum_full += blind_us;
+  }
+  st.blind_hist[blind_us < 50 ? 0 : blind_us < 200 ? 1 : blind_us < 500 ? 2 : blind_us < 2000 ? 3 : 4]++;
+}
+
+void RadioTransceiver::take_rearm_stats(RearmStats &acc) {
+  counters_fold(acc, this->rearm_stats_, false);
+  this->rearm_stats_ = {};
+}
+
+void RadioTransceiver::take_fifo_drain_stats(FifoDrainStats &acc) {
+  counters_fold(acc, this->drain_stats_, false);
+  this->drain_stats_ = {};
+}
+
+void RadioTransceiver::begin_fifo_drain_(bool event) {
+  // The first read after restart_rx() opens a frame.
+  if (!this->drain_frame_open_) {
+    this->drain_frame_open_ = true;
+    this->drain_stats_.frames++;
+    if (event) this->drain_stats_.event_frames++;
+  }
+  this->drain_start_us_ = micros();
+  this->drain_start_txns_ = this->spi_txns_;
+}
+
+void RadioTransceiver::end_fifo_drain_(uint32_t slept_us) {
+  this->drain_stats_.spi_txns += this->spi_txns_ - this->drain_start_txns_;
+  this->drain_stats_.busy_us_sum += micros() - this->drain_start_us_ - slept_us;
+}
+
+void RadioTransceiver::close_fifo_drain_(bool event) {
+  // The FIFO line may have risen after the last read of the previous frame;
+  // that notification must not pass for the next frame's IRQ.
+  if (this->drain_frame_open_ && event) ulTaskNotifyTake(pdTRUE, 0);
+  this->drain_frame_open_ = false;
+}
+
 void RadioTransceiver::dump_config() {
   ESP_LOGCONFIG(TAG, "Transceiver: %s", this->get_name());
   if (this->reset_pin_ != nullptr)
@@ -121,8 +172,10 @@ void RadioTransceiver::dump_config() {
   const char *mode_str = (this->listen_mode_ == LISTEN_MODE_T1) ? "T1 only"
                        : (this->listen_mode_ == LISTEN_MODE_C1) ? "C1 only"
                        : (this->listen_mode_ == LISTEN_MODE_S1) ? "S1 only"
-                       : "T1+C1 (both, 3:1 bias)";
+                       : "T1+C1 (both)";
   ESP_LOGCONFIG(TAG, "  Listen mode: %s", mode_str);
+  if (this->uses_sync_schedule())
+    ESP_LOGCONFIG(TAG, "  Sync schedule: %s", this->sync_sched_.adaptive() ? "adaptive" : "fixed 3:1");
 }
 } // namespace wmbus_radio
 } // namespace esphome
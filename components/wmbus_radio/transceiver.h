@@ -1,17 +1,62 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
 #include "esphome/components/spi/spi.h"
-#include "esphome/core/optional.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
+#include "sync_scheduler.h"
+
 #define BYTE(x, n) ((uint8_t)(x >> (n * 8)))
 
 namespace esphome {
 namespace wmbus_radio {
 enum ListenMode : uint8_t { LISTEN_MODE_BOTH = 0, LISTEN_MODE_T1 = 1, LISTEN_MODE_C1 = 2, LISTEN_MODE_S1 = 3 };
+
+// RX re-arms (restart_rx()) and the blind window of each: the time from the
+// command that takes the radio out of sync search to the one that puts it
+// back (CC1101: until it reports RX again, calibration included). 32-bit
+// fields only; Radio adds them to its rx-path counters.
+struct RearmStats {
+  uint32_t rearms{0};
+  // Re-arms that took the driver's fast path; the full path is the one the
+  // drivers always took, so the two averages compare old and new.
+  uint32_t fast{0};
+  uint32_t blind_us_sum_full{0};
+  uint32_t blind_us_sum_fast{0};
+  // Buckets: [0]<50us [1]50-199us [2]200-499us [3]500-1999us [4]>=2ms
+  uint32_t blind_hist[5]{};
+};
+
+// Frames a driver read from its RX FIFO through read_bulk(), and what reading
+// them cost the receiver task: SPI transactions and CPU time spent in
+// read_bulk(), time asleep on the task notification excluded. 32-bit fields
+// only; Radio adds them to its rx-path counters.
+struct FifoDrainStats {
+  uint32_t frames{0};
+  // Frames read with the event-driven wakeup rather than by polling.
+  uint32_t event_frames{0};
+  uint32_t spi_txns{0};
+  uint32_t busy_us_sum{0};
+  // Times the driver slept on the task notification while reading.
+  uint32_t sleeps{0};
+};
+
+// Frames a driver captured by streaming from the radio buffer (SX1262 long
+// GFSK hold, S1), and how long the receiver was deaf after each: from the
+// last byte read to RX armed again. 32-bit fields only; Radio adds them to
+// its rx-path counters.
+struct StreamCaptureStats {
+  uint32_t frames{0};
+  // Stopped at the length from the L-field rather than by the IRQ/silence
+  // window.
+  uint32_t length_stops{0};
+  uint32_t deaf_us_sum{0};
+  // Buckets: [0]<1ms [1]1-4.9ms [2]5-19.9ms [3]>=20ms
+  uint32_t deaf_hist[4]{};
+};
 class RadioTransceiver
     : public Component,
       public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW,
@@ -23,6 +68,8 @@ public:
   template <typename T>
   void attach_data_interrupt(void (*callback)(T *), T *arg) {
     this->irq_pin_->attach_interrupt(callback, arg, this->irq_edge_);
+    if (this->fifo_irq_pin_ != nullptr)
+      this->fifo_irq_pin_->attach_interrupt(callback, arg, gpio::INTERRUPT_RISING_EDGE);
   }
   virtual void restart_rx() = 0;
   virtual int8_t get_rssi() = 0;
@@ -38,6 +85,12 @@ public:
   virtual bool supports_weak_partial_start_abort() const { return false; }
   virtual bool consume_rx_abort_request() { return false; }
   virtual uint32_t take_fifo_overrun_count() { return 0; }
+  // Adds the stream-capture counts since the last call to acc.
+  virtual void take_stream_capture_stats(StreamCaptureStats &acc) {}
+  // Adds the FIFO read counts since the last call to acc.
+  void take_fifo_drain_stats(FifoDrainStats &acc);
+  // Adds the re-arm counts since the last call to acc.
+  void take_rearm_stats(RearmStats &acc);
 
   // Optional radio-specific debug dump. Used when RX waits time out.
   virtual void dump_debug_status(const char *reason) {}
@@ -58,6 +111,14 @@ public:
   void set_irq_pin(InternalGPIOPin *irq_pin);
   void set_busy_pin(InternalGPIOPin *busy_pin);
   void set_listen_mode(ListenMode mode) { this->listen_mode_ = mode; }
+  void set_adaptive_sync_schedule(bool adaptive) { this->sync_sched_.set_adaptive(adaptive); }
+  // Second sync byte schedule for T1/C1 (sync_scheduler.h): restart_rx()
+  // takes each dwell's byte from it, Radio reports valid frames to it.
+  SyncScheduler &sync_scheduler() { return this->sync_sched_; }
+  // True when restart_rx() alternates sync bytes (listen modes "both", "c1").
+  bool uses_sync_schedule() const {
+    return this->listen_mode_ == LISTEN_MODE_BOTH || this->listen_mode_ == LISTEN_MODE_C1;
+  }
   ListenMode get_listen_mode() const { return this->listen_mode_; }
   const std::string &get_rf_params_str() const { return this->rf_params_str_; }
 
@@ -65,15 +126,52 @@ protected:
   InternalGPIOPin *reset_pin_{nullptr};
   InternalGPIOPin *irq_pin_{nullptr};
   InternalGPIOPin *busy_pin_{nullptr};
+  // Optional second wake-up line for the receiver task while a frame is
+  // read (CC1101 GDO0 RX FIFO threshold), rising edge.
+  InternalGPIOPin *fifo_irq_pin_{nullptr};
 
   // SX127x DIO for FIFO level is typically active-low (falling edge).
   // SX126x DIO for IRQ is active-high (rising edge).
   gpio::InterruptType irq_edge_{gpio::INTERRUPT_FALLING_EDGE};
 
   ListenMode listen_mode_{LISTEN_MODE_BOTH};
+  SyncScheduler sync_sched_{};
+
+  // restart_rx() fast path: a driver may skip writes whose value it armed
+  // last time and use a cheaper restart, but every FULL_REARM_INTERVAL-th
+  // re-arm (and the first) takes the full path, as a safety net against
+  // state the fast path assumed unchanged. begin_rearm_() says which one
+  // this is; note_rearm_() records its blind window.
+  static constexpr uint8_t FULL_REARM_INTERVAL = 16;
+  bool begin_rearm_();
+  void note_rearm_(uint32_t blind_us, bool fast);
+  uint8_t rearms_since_full_{0};
+  RearmStats rearm_stats_{};
+  // SPI transactions, for the per-frame cost in FifoDrainStats: counted by
+  // spi_transaction() and by drivers that drive the delegate themselves.
+  uint32_t spi_txns_{0};
+
+  // FIFO read accounting for drivers that read through read_bulk(): wrap
+  // each staging read in begin_fifo_drain_() / end_fifo_drain_(), count
+  // each sleep on the task notification in drain_stats_.sleeps, and call
+  // close_fifo_drain_() from restart_rx(). event says whether the frame is
+  // read with the event-driven wakeup.
+  void begin_fifo_drain_(bool event);
+  void end_fifo_drain_(uint32_t slept_us);
+  void close_fifo_drain_(bool event);
+  // read_bulk() has counted the current frame in drain_stats_.
+  bool drain_frame_open_{false};
+  uint32_t drain_start_us_{0};
+  uint32_t drain_start_txns_{0};
+  FifoDrainStats drain_stats_{};
+
   std::string rf_params_str_{};
 
-  virtual optional<uint8_t> read() = 0;
+  // Copy up to max bytes the radio already has (FIFO burst, staged chunk or
+  // captured frame) into dst and return how many were copied; 0 means nothing
+  // is available right now. read_in_task*() call this once per chunk instead
+  // of making one virtual call per byte.
+  virtual size_t read_bulk(uint8_t *dst, size_t max) = 0;
 
   void reset();
   void common_setup();
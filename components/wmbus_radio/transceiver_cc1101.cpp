@@ -1,10 +1,13 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "transceiver_cc1101.h"
+#include "seqlock_counters.h"
 
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
 #include "esp_timer.h"
 #include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #include <algorithm>
 #include <cstring>
@@ -22,6 +25,15 @@ static constexpr uint8_t CC1101_SIDLE = 0x36;
 static constexpr uint8_t CC1101_SFRX  = 0x3A;
 static constexpr uint8_t CC1101_SNOP  = 0x3D;
 
+static constexpr uint8_t MARCSTATE_IDLE = 0x01;
+static constexpr uint8_t MARCSTATE_RX   = 0x0D;
+// MCSM0 with and without FS_AUTOCAL = IDLE->RX/TX (PO_TIMEOUT 64 cycles).
+static constexpr uint8_t MCSM0_AUTOCAL    = 0x18;
+static constexpr uint8_t MCSM0_NO_AUTOCAL = 0x08;
+// restart_rx() waits at most this long for IDLE, and for RX after SRX.
+static constexpr uint32_t REARM_IDLE_WAIT_US = 120;
+static constexpr uint32_t REARM_RX_WAIT_US   = 2000;
+
 // CC1101 configuration registers
 static constexpr uint8_t REG_IOCFG2   = 0x00;
 static constexpr uint8_t REG_IOCFG1   = 0x01;
@@ -118,6 +130,8 @@ static constexpr uint32_t CC1101_FOSC_HZ = 26000000UL;
 static constexpr uint32_t CC1101_DEFAULT_FREQ_HZ = 868950000UL;
 static constexpr uint32_t CC1101_READ_POLL_US = 1800;
 static constexpr uint32_t CC1101_POLL_STEP_US = 80;
+// Legacy polling reads at most this much per burst.
+static constexpr size_t CC1101_POLL_CHUNK = 16;
 
 static const char *marc_state_name_(uint8_t state) {
   switch (state & 0x1F) {
@@ -193,6 +207,7 @@ static void log_expected_reg_(const char *name, uint8_t got, uint8_t expected,
 
 
 uint8_t CC1101::strobe_(uint8_t cmd) {
+  this->spi_txns_++;
   this->delegate_->begin_transaction();
   const uint8_t status = this->delegate_->transfer(cmd);
   this->delegate_->end_transaction();
@@ -200,6 +215,7 @@ uint8_t CC1101::strobe_(uint8_t cmd) {
 }
 
 uint8_t CC1101::read_reg_(uint8_t address) {
+  this->spi_txns_++;
   this->delegate_->begin_transaction();
   this->delegate_->transfer(address | CC1101_READ);
   const uint8_t value = this->delegate_->transfer(0x00);
@@ -208,6 +224,7 @@ uint8_t CC1101::read_reg_(uint8_t address) {
 }
 
 uint8_t CC1101::read_status_(uint8_t address) {
+  this->spi_txns_++;
   this->delegate_->begin_transaction();
   this->delegate_->transfer(address | CC1101_READ | CC1101_BURST);
   const uint8_t value = this->delegate_->transfer(0x00);
@@ -216,6 +233,7 @@ uint8_t CC1101::read_status_(uint8_t address) {
 }
 
 void CC1101::write_reg_(uint8_t address, uint8_t value) {
+  this->spi_txns_++;
   this->delegate_->begin_transaction();
   this->delegate_->transfer(address);
   this->delegate_->transfer(value);
@@ -224,6 +242,7 @@ void CC1101::write_reg_(uint8_t address, uint8_t value) {
 
 void CC1101::write_burst_(uint8_t address, const uint8_t *data, size_t len) {
   if (len == 0) return;
+  this->spi_txns_++;
   this->delegate_->begin_transaction();
   this->delegate_->transfer(address | CC1101_BURST);
   for (size_t i = 0; i < len; i++) this->delegate_->transfer(data[i]);
@@ -232,6 +251,7 @@ void CC1101::write_burst_(uint8_t address, const uint8_t *data, size_t len) {
 
 void CC1101::read_burst_(uint8_t address, uint8_t *data, size_t len) {
   if (len == 0) return;
+  this->spi_txns_++;
   this->delegate_->begin_transaction();
   this->delegate_->transfer(address | CC1101_READ | CC1101_BURST);
   for (size_t i = 0; i < len; i++) data[i] = this->delegate_->transfer(0x00);
@@ -239,8 +259,6 @@ void CC1101::read_burst_(uint8_t address, uint8_t *data, size_t len) {
 }
 
 uint8_t CC1101::rxbytes_raw_() { return this->read_status_(REG_RXBYTES); }
-uint8_t CC1101::rxbytes_count_() { return this->rxbytes_raw_() & 0x7F; }
-bool CC1101::rx_overflow_() { return (this->rxbytes_raw_() & 0x80) != 0; }
 
 void CC1101::flush_rx_() {
   this->strobe_(CC1101_SIDLE);
@@ -249,6 +267,14 @@ void CC1101::flush_rx_() {
   esp_rom_delay_us(120);
 }
 
+bool CC1101::wait_marcstate_(uint8_t state, uint32_t max_us) {
+  const uint32_t start = micros();
+  while ((this->read_status_(REG_MARCSTATE) & 0x1F) != state) {
+    if (micros() - start >= max_us) return false;
+  }
+  return true;
+}
+
 void CC1101::reset_cc1101_() {
   // Standard command reset. Keep CS toggling under the SPI delegate.
   this->strobe_(CC1101_SRES);
@@ -271,11 +297,6 @@ void CC1101::set_frequency_(uint32_t frequency_hz) {
   this->write_reg_(REG_FREQ0, (uint8_t) (freq & 0xFF));
 }
 
-void CC1101::set_sync_word_(uint8_t sync2) {
-  this->write_reg_(REG_SYNC1, 0x54);
-  this->write_reg_(REG_SYNC0, sync2);
-}
-
 void CC1101::apply_radio_profile_() {
   // CC1101 RF profile adjusted to the known-working Szczepan/Kubasa-style
   // wM-Bus 868.950 MHz profile. Keep our hardware model intact:
@@ -316,7 +337,9 @@ void CC1101::apply_radio_profile_() {
 
   this->write_reg_(REG_MCSM2, 0x07);
   this->write_reg_(REG_MCSM1, 0x00);
-  this->write_reg_(REG_MCSM0, 0x18);  // auto-calibrate from IDLE to RX/TX
+  this->write_reg_(REG_MCSM0, MCSM0_AUTOCAL);  // auto-calibrate from IDLE to RX/TX
+  this->autocal_off_ = false;
+  this->armed_sync2_ = 0;
   this->write_reg_(REG_FOCCFG, 0x2E);
   this->write_reg_(REG_BSCFG, 0xBF);
   this->write_reg_(REG_AGCCTRL2, 0x43);
@@ -644,6 +667,7 @@ void CC1101::setup() {
   if (this->gdo2_pin_ != nullptr) this->gdo2_pin_->setup();
   if (this->gdo0_pin_ != nullptr) this->gdo0_pin_->setup();
   this->irq_pin_ = this->gdo2_pin_;
+  this->fifo_irq_pin_ = this->fifo_threshold_wakeup_ ? this->gdo0_pin_ : nullptr;
 
   ESP_LOGI(TAG, "Setup CC1101 experimental RX path: GDO2=sync IRQ, GDO0=FIFO threshold");
   this->reset_cc1101_();
@@ -680,45 +704,65 @@ void CC1101::dump_config() {
   const char *mode_str = (this->listen_mode_ == LISTEN_MODE_T1) ? "T1 only"
                        : (this->listen_mode_ == LISTEN_MODE_C1) ? "C1 only"
                        : (this->listen_mode_ == LISTEN_MODE_S1) ? "S1 only (experimental sync only)"
-                       : "T1+C1 (both, 3:1 sync-cycle bias)";
+                       : "T1+C1 (both)";
   ESP_LOGCONFIG(TAG, "  Listen mode: %s", mode_str);
+  if (this->uses_sync_schedule())
+    ESP_LOGCONFIG(TAG, "  Sync schedule: %s", this->sync_sched_.adaptive() ? "adaptive" : "fixed 3:1");
+  ESP_LOGCONFIG(TAG, "  FIFO wakeup: %s", this->fifo_threshold_wakeup_ ? "GDO0 threshold" : "polling");
 }
 
 void CC1101::restart_rx() {
+  // Full path: IDLE and RX FIFO flush with fixed settle delays, both sync
+  // bytes, and SRX with the synthesizer calibrated on the way (about 800 us).
+  // Fast path: waits on MARCSTATE instead of the delays, writes SYNC0 only when
+  // it changes and skips the calibration; the full path every
+  // FULL_REARM_INTERVAL re-arms calibrates again. The blind window runs from
+  // SIDLE until MARCSTATE reads RX.
+  const bool fast = this->begin_rearm_();
   uint8_t sync2;
+  uint8_t sync1;
   if (this->listen_mode_ == LISTEN_MODE_S1) {
     // CC1101 has only the existing 2-byte sync path here; use the last 16 bits
     // of S-mode sync as an experimental raw sniffer. SX1262/SX1276 are preferred for S1.
+    sync1 = 0x76;
     sync2 = 0x96;
-    this->flush_rx_();
-    this->write_reg_(REG_SYNC1, 0x76);
-    this->write_reg_(REG_SYNC0, sync2);
-    this->chunk_len_ = 0;
-    this->chunk_idx_ = 0;
-    this->rssi_captured_ = false;
-    this->last_rssi_dbm_ = -127;
-    this->abort_requested_ = false;
-    this->strobe_(CC1101_SRX);
-    return;
+  } else {
+    sync1 = 0x54;
+    sync2 = this->uses_sync_schedule() ? this->sync_sched_.next(millis()) : 0x3D;
   }
-  if (this->listen_mode_ == LISTEN_MODE_T1) {
-    sync2 = 0x3D;
-  } else if (this->listen_mode_ == LISTEN_MODE_C1) {
-    sync2 = (this->sync_cycle_ == 3) ? 0xCD : 0x3D;
-    this->sync_cycle_ = (uint8_t) ((this->sync_cycle_ + 1) & 0x03);
+
+  const uint32_t blind_start_us = micros();
+  if (fast) {
+    this->strobe_(CC1101_SIDLE);
+    this->wait_marcstate_(MARCSTATE_IDLE, REARM_IDLE_WAIT_US);
+    this->strobe_(CC1101_SFRX);
+    if (sync2 != this->armed_sync2_) this->write_reg_(REG_SYNC0, sync2);
+    if (!this->autocal_off_) {
+      this->write_reg_(REG_MCSM0, MCSM0_NO_AUTOCAL);
+      this->autocal_off_ = true;
+    }
   } else {
-    sync2 = (this->sync_cycle_ == 3) ? 0xCD : 0x3D;
-    this->sync_cycle_ = (uint8_t) ((this->sync_cycle_ + 1) & 0x03);
+    this->flush_rx_();
+    this->write_reg_(REG_SYNC1, sync1);
+    this->write_reg_(REG_SYNC0, sync2);
+    if (this->autocal_off_) {
+      this->write_reg_(REG_MCSM0, MCSM0_AUTOCAL);
+      this->autocal_off_ = false;
+    }
   }
+  this->armed_sync2_ = sync2;
 
-  this->flush_rx_();
-  this->set_sync_word_(sync2);
   this->chunk_len_ = 0;
   this->chunk_idx_ = 0;
   this->rssi_captured_ = false;
   this->last_rssi_dbm_ = -127;
   this->abort_requested_ = false;
+  // Drops a stale GDO0 notification; still IDLE here, so no sync IRQ can be
+  // lost.
+  this->close_fifo_drain_(this->fifo_irq_pin_ != nullptr);
   this->strobe_(CC1101_SRX);
+  this->wait_marcstate_(MARCSTATE_RX, REARM_RX_WAIT_US);
+  this->note_rearm_(micros() - blind_start_us, fast);
 }
 
 void CC1101::capture_rssi_() {
@@ -733,17 +777,20 @@ void CC1101::capture_rssi_() {
   this->rssi_captured_ = true;
 }
 
-optional<uint8_t> CC1101::drain_fifo_once_() {
-  if (this->rx_overflow_()) {
+bool CC1101::drain_fifo_once_(size_t min_bytes, size_t max_bytes) {
+  const uint8_t rxbytes = this->rxbytes_raw_();
+  if ((rxbytes & 0x80) != 0) {
+    this->fifo_level_ = 0;
     this->fifo_overrun_count_++;
     this->abort_requested_ = true;
     ESP_LOGW(TAG, "RX FIFO overflow / przepelnienie RX FIFO");
     this->flush_rx_();
-    return {};
+    return false;
   }
 
-  const uint8_t rx_bytes = this->rxbytes_count_();
-  if (rx_bytes == 0) return {};
+  const uint8_t rx_bytes = rxbytes & 0x7F;
+  this->fifo_level_ = rx_bytes;
+  if (rx_bytes == 0) return false;
 
   if (!this->rssi_captured_) this->capture_rssi_();
 
@@ -752,30 +799,66 @@ optional<uint8_t> CC1101::drain_fifo_once_() {
   const bool sync_asserted = this->gdo2_pin_ != nullptr && this->gdo2_pin_->digital_read();
   size_t safe = rx_bytes;
   if (sync_asserted && safe > 1) safe -= 1;
-  if (safe == 0) return {};
+  if (safe == 0) return false;
+  if (sync_asserted && safe < min_bytes) return false;
 
-  const size_t n = std::min<size_t>(safe, this->chunk_buffer_.size());
+  const size_t n = std::min<size_t>(safe, max_bytes);
   this->read_burst_(REG_FIFO, this->chunk_buffer_.data(), n);
   this->chunk_len_ = n;
   this->chunk_idx_ = 0;
-  return this->chunk_buffer_[this->chunk_idx_++];
+  return true;
 }
 
-optional<uint8_t> CC1101::read() {
-  if (this->chunk_idx_ < this->chunk_len_) {
-    return this->chunk_buffer_[this->chunk_idx_++];
-  }
-
+bool CC1101::stage_polling_() {
   const int64_t deadline = esp_timer_get_time() + CC1101_READ_POLL_US;
   while (esp_timer_get_time() < deadline) {
-    if (auto byte = this->drain_fifo_once_(); byte.has_value()) {
-      return byte;
-    }
-    if (this->abort_requested_) return {};
+    if (this->drain_fifo_once_(1, CC1101_POLL_CHUNK)) return true;
+    if (this->abort_requested_) return false;
     esp_rom_delay_us(CC1101_POLL_STEP_US);
   }
+  return false;
+}
+
+bool CC1101::stage_on_threshold_(size_t max, uint32_t &slept_us) {
+  // GDO0 rises when the FIFO reaches CC1101_FIFO_THRESHOLD; one byte stays
+  // behind while sync is asserted, so a full burst is one byte short of it.
+  const size_t want = std::min<size_t>(max, CC1101_FIFO_THRESHOLD - 1);
+  const uint32_t byte_us = this->listen_mode_ == LISTEN_MODE_S1 ? 244 : 80;
+  const uint32_t budget_us = (uint32_t) want * byte_us + CC1101_READ_POLL_US;
+  const uint32_t start = micros();
+  for (;;) {
+    if (this->drain_fifo_once_(want, this->chunk_buffer_.size())) return true;
+    if (this->abort_requested_) return false;
+    const uint32_t elapsed = micros() - start;
+    // Past the time the bytes were due: the frame ended short of want.
+    if (elapsed >= budget_us) return this->drain_fifo_once_(1, this->chunk_buffer_.size());
+
+    const size_t missing = want > this->fifo_level_ ? want - this->fifo_level_ : 1;
+    const uint32_t due_us = std::min<uint32_t>((uint32_t) missing * byte_us, budget_us - elapsed);
+    const TickType_t ticks = std::max<TickType_t>(1, pdMS_TO_TICKS((due_us + 999) / 1000));
+    const uint32_t sleep_start = micros();
+    ulTaskNotifyTake(pdTRUE, ticks);
+    slept_us += micros() - sleep_start;
+    this->drain_stats_.sleeps++;
+  }
+}
+
+size_t CC1101::read_bulk(uint8_t *dst, size_t max) {
+  if (max == 0) return 0;
+
+  if (this->chunk_idx_ >= this->chunk_len_) {
+    this->begin_fifo_drain_(this->fifo_irq_pin_ != nullptr);
+    uint32_t slept_us = 0;
+    const bool staged = this->fifo_irq_pin_ != nullptr ? this->stage_on_threshold_(max, slept_us)
+                                                       : this->stage_polling_();
+    this->end_fifo_drain_(slept_us);
+    if (!staged) return 0;
+  }
 
-  return {};
+  const size_t n = std::min(max, this->chunk_len_ - this->chunk_idx_);
+  std::memcpy(dst, this->chunk_buffer_.data() + this->chunk_idx_, n);
+  this->chunk_idx_ += n;
+  return n;
 }
 
 int8_t CC1101::get_rssi() { return this->last_rssi_dbm_; }
@@ -12,7 +12,9 @@ namespace wmbus_radio {
 // - GDO2 is used as sync-detect interrupt (start of candidate)
 // - GDO0 is used as FIFO-threshold/data hint
 // This avoids the single-IRQ ambiguity that produces 8-byte false candidates.
-static constexpr size_t CC1101_CHUNK_SIZE = 16;
+static constexpr size_t CC1101_CHUNK_SIZE = 32;
+// RX FIFO threshold GDO0 reports (FIFOTHR 0x07).
+static constexpr size_t CC1101_FIFO_THRESHOLD = 32;
 
 class CC1101 : public RadioTransceiver {
  public:
@@ -21,11 +23,14 @@ class CC1101 : public RadioTransceiver {
   void set_gdo0_pin(InternalGPIOPin *pin) { this->gdo0_pin_ = pin; }
   void set_gdo2_pin(InternalGPIOPin *pin) { this->gdo2_pin_ = pin; }
   void set_frequency_mhz(float frequency_mhz);
+  // True: sleep on the receiver task notification between FIFO bursts, woken
+  // by GDO0 at the RX FIFO threshold. False: poll RXBYTES (legacy).
+  void set_fifo_threshold_wakeup(bool enabled) { this->fifo_threshold_wakeup_ = enabled; }
 
   void setup() override;
   void dump_config() override;
   void restart_rx() override;
-  optional<uint8_t> read() override;
+  size_t read_bulk(uint8_t *dst, size_t max) override;
   int8_t get_rssi() override;
   const char *get_name() override;
 
@@ -43,18 +48,24 @@ class CC1101 : public RadioTransceiver {
   size_t chunk_len_{0};
   size_t chunk_idx_{0};
 
-  uint8_t sync_cycle_{0};
   uint32_t configured_frequency_hz_{868950000UL};
   int8_t last_rssi_dbm_{-127};
   bool rssi_captured_{false};
   bool abort_requested_{false};
   uint32_t fifo_overrun_count_{0};
-
+  bool fifo_threshold_wakeup_{true};
+  // RXBYTES at the last drain_fifo_once_().
+  uint8_t fifo_level_{0};
+  // What restart_rx() armed last: SYNC0, and MCSM0 without FS_AUTOCAL.
+  uint8_t armed_sync2_{0};
+  bool autocal_off_{false};
+
+  // Polls MARCSTATE for state; false after max_us.
+  bool wait_marcstate_(uint8_t state, uint32_t max_us);
   void reset_cc1101_();
   void apply_radio_profile_();
   bool validate_startup_config_();
   void set_frequency_(uint32_t frequency_hz);
-  void set_sync_word_(uint8_t sync2);
 
   uint8_t strobe_(uint8_t cmd);
   uint8_t read_reg_(uint8_t address);
@@ -64,12 +75,16 @@ class CC1101 : public RadioTransceiver {
   void read_burst_(uint8_t address, uint8_t *data, size_t len);
 
   uint8_t rxbytes_raw_();
-  uint8_t rxbytes_count_();
-  bool rx_overflow_();
   void flush_rx_();
   void capture_rssi_();
 
-  optional<uint8_t> drain_fifo_once_();
+  // Stage the bytes that are safe to read now in chunk_buffer_, at most
+  // max_bytes; false while fewer than min_bytes are safe and sync is asserted.
+  bool drain_fifo_once_(size_t min_bytes, size_t max_bytes);
+  // Fill chunk_buffer_ for read_bulk(): by polling RXBYTES for up to
+  // CC1101_READ_POLL_US, or asleep until GDO0 or the bytes wanted are due.
+  bool stage_polling_();
+  bool stage_on_threshold_(size_t max, uint32_t &slept_us);
 };
 
 }  // namespace wmbus_radio
@@ -1,9 +1,17 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "transceiver_sx1262.h"
+#include "packet.h"
+#include "seqlock_counters.h"
 
 #include "esphome/core/log.h"
 #include "esphome/core/hal.h"
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <algorithm>
+#include <cstring>
+
 namespace esphome {
 namespace wmbus_radio {
 
@@ -267,6 +275,8 @@ void SX1262::configure_irq_params_() {
   const bool stream_on_sync = this->long_stream_active_() || (this->listen_mode_ == LISTEN_MODE_S1);
   const uint16_t mask = stream_on_sync ? (IRQ_SYNC_WORD_VALID | IRQ_RX_DONE | IRQ_CRC_ERROR | IRQ_TIMEOUT)
                                        : (IRQ_RX_DONE | IRQ_CRC_ERROR | IRQ_TIMEOUT);
+  if (mask == this->armed_irq_mask_) return;
+  this->armed_irq_mask_ = mask;
   const uint8_t mask_msb = (uint8_t) ((mask >> 8) & 0xFF);
   const uint8_t mask_lsb = (uint8_t) (mask & 0xFF);
 
@@ -342,31 +352,58 @@ bool SX1262::load_rx_buffer_() {
 //   2. Poll REG_RX_ADDR_PTR to see how many new bytes arrived.
 //   3. Drain those bytes into rx_buffer_.
 //   4. Write (current_ptr - 1) back to REG_RXTX_PAYLOAD_LEN to keep the radio alive.
-//   5. Repeat until IRQ_RX_DONE / IRQ_TIMEOUT fires and data flow stops.
+//   5. Repeat until the frame is in: as many bytes as its L-field says
+//      (Packet::raw_frame_size()), or, when the L-field cannot be read,
+//      IRQ_RX_DONE / IRQ_TIMEOUT followed by a short silence.
+//
+// Between polls the loop sleeps for the air time of the bytes still missing
+// (80 us per byte at 100 kbps, 244 us at 32.768 kcps), at most half the
+// buffer so rxAddrPtr never laps the read index; with an unknown length it
+// polls every STREAM_POLL_BYTES.
 //
 // avail = (uint8_t)(cur - state_index): intentional uint8_t wrap handles
 // the 0xFF->0x00 circular pointer rollover (e.g. cur=0x0A, state=0xFA -> avail=16).
 //
 // The manual first/second read split below is a conservative defensive measure;
 // ReadBuffer wraps automatically in HW so both produce identical results.
+//
+// RX is re-armed here as soon as the frame is in, not on the receiver task's
+// next restart_rx(): the task still has to read and queue the frame, and a
+// telegram arriving meanwhile would be missed. The time from the last byte
+// read to RX armed is the deaf time reported in stream_capture.
 // ---------------------------------------------------------------------------
+static constexpr size_t STREAM_MAX_BYTES = 512;
+static constexpr size_t STREAM_POLL_BYTES = 8;
+static constexpr size_t STREAM_MAX_WAIT_BYTES = 128;
+
 bool SX1262::capture_rx_stream_() {
   // Semtech AN1200.53: stream from the 256-byte internal buffer while RX is still running.
-  // We rely on IRQ_RX_DONE / IRQ_TIMEOUT to decide when the burst is complete (not a tiny "silence" window),
-  // otherwise we may cut valid frames (WMBus T1 airtime is several ms).
   this->rx_buffer_.clear();
-  this->rx_buffer_.reserve(512);
+  this->rx_buffer_.reserve(STREAM_MAX_BYTES);
 
   // Ensure payload length starts at 255 (0xFF) so the packet engine doesn't stop early.
   this->write_register_(REG_RXTX_PAYLOAD_LEN, {0xFF});
 
+  const bool s1 = this->listen_mode_ == LISTEN_MODE_S1;
+  // Air time of one raw byte: 8 bits at 100 kbps, 8 chips at 32.768 kcps.
+  const uint32_t byte_us = s1 ? 244 : 80;
+  const size_t prefix = s1 ? Packet::RAW_FRAME_SIZE_PREFIX_S1 : Packet::RAW_FRAME_SIZE_PREFIX;
+
   const uint32_t start_ms = millis();
   uint32_t last_change_ms = start_ms;
+  uint32_t last_change_us = micros();
 
   size_t copied = 0;
   uint8_t state_index = 0;  // last read index (wraps 0..255)
 
-  // Capture until RX_DONE/TIMEOUT (latched IRQ), then allow a short drain window.
+  // On-air length once the L-field is in; 0 while unknown. length_tried:
+  // the L-field was looked at (an invalid one leaves want at 0).
+  size_t want = 0;
+  bool length_tried = false;
+  bool length_stop = false;
+
+  // Fallback without a length: capture until RX_DONE/TIMEOUT (latched IRQ),
+  // then allow a short drain window.
   bool seen_end_irq = false;
 
   while (true) {
@@ -378,8 +415,8 @@ bool SX1262::capture_rx_stream_() {
       break;
     }
     // Hard cap (covers max WMBus T1 raw size comfortably)
-    if (copied >= 512) {
-      ESP_LOGD(TAG, "Long RX capture capped at 512 bytes");
+    if (copied >= STREAM_MAX_BYTES) {
+      ESP_LOGD(TAG, "Long RX capture capped at %u bytes", (unsigned) STREAM_MAX_BYTES);
       break;
     }
 
@@ -387,7 +424,7 @@ bool SX1262::capture_rx_stream_() {
     uint8_t avail = (uint8_t) (cur - state_index);  // uint8 wrap by design
 
     // Cap to remaining space
-    const size_t room = 512 - copied;
+    const size_t room = STREAM_MAX_BYTES - copied;
     if (avail > room) {
       avail = (uint8_t) room;
     }
@@ -410,8 +447,18 @@ bool SX1262::capture_rx_stream_() {
       copied += avail;
       state_index = current_index;
       last_change_ms = now;
-    } else {
-      // No new bytes right now.
+      last_change_us = micros();
+
+      if (!length_tried && copied >= prefix) {
+        length_tried = true;
+        want = std::min(Packet::raw_frame_size(this->rx_buffer_.data(), copied, s1), STREAM_MAX_BYTES);
+      }
+      if (want != 0 && copied >= want) {
+        length_stop = true;
+        break;
+      }
+    } else if (want == 0) {
+      // No new bytes right now and no length to go by.
       const uint16_t irq = this->get_irq_status_();
       if (irq & (IRQ_RX_DONE | IRQ_TIMEOUT)) {
         seen_end_irq = true;
@@ -431,8 +478,15 @@ bool SX1262::capture_rx_stream_() {
       if (copied > 0 && (now - last_change_ms) > 30) {
         break;
       }
+    }
 
-      delay(1);
+    // Sleep until the rest of the frame (or the next few bytes) is on air.
+    const size_t wait_bytes = std::min(want != 0 ? want - copied : STREAM_POLL_BYTES, STREAM_MAX_WAIT_BYTES);
+    const uint32_t wait_us = (uint32_t) wait_bytes * byte_us;
+    if (wait_us < 1000) {
+      delayMicroseconds(wait_us);
+    } else {
+      delay(wait_us / 1000);
     }
   }
 
@@ -486,19 +540,34 @@ bool SX1262::capture_rx_stream_() {
   if (this->rx_buffer_.empty())
     return false;
 
-  this->rx_idx_ = 0;
-  this->rx_len_ = this->rx_buffer_.size();
-  this->rx_loaded_ = true;
-
   // Renew the adaptive hold if the captured frame is still long (>= 250 bytes).
   // Without this the hold expires between consecutive transmissions of the same
   // long-packet meter, causing the next frame to fall back to the FIFO path
-  // (truncated) and re-trigger from scratch.
-  if (this->long_gfsk_packets_ && this->rx_len_ >= 250) {
+  // (truncated) and re-trigger from scratch. Before the re-arm, which sets the
+  // IRQ routing from the hold.
+  const bool hold_renewed = this->long_gfsk_packets_ && this->rx_buffer_.size() >= 250;
+  if (hold_renewed) {
     this->long_stream_hold_until_ms_ = millis() + 45000UL;
-    ESP_LOGD(TAG, "Long RX captured %u bytes (hold renewed for 45 s)", (unsigned) this->rx_len_);
+  }
+  this->restart_rx();
+  this->rx_rearmed_ = true;
+  const uint32_t deaf_us = micros() - last_change_us;
+  auto &st = this->stream_stats_;
+  st.frames++;
+  if (length_stop) st.length_stops++;
+  st.deaf_us_sum += deaf_us;
+  st.deaf_hist[deaf_us < 1000 ? 0 : deaf_us < 5000 ? 1 : deaf_us < 20000 ? 2 : 3]++;
+
+  this->rx_idx_ = 0;
+  this->rx_len_ = this->rx_buffer_.size();
+  this->rx_loaded_ = true;
+
+  if (hold_renewed) {
+    ESP_LOGD(TAG, "Long RX captured %u bytes (%s, deaf %u us, hold renewed for 45 s)", (unsigned) this->rx_len_,
+             length_stop ? "L-field" : "silence", (unsigned) deaf_us);
   } else {
-    ESP_LOGD(TAG, "Long RX captured %u bytes", (unsigned) this->rx_len_);
+    ESP_LOGD(TAG, "Long RX captured %u bytes (%s, deaf %u us)", (unsigned) this->rx_len_,
+             length_stop ? "L-field" : "silence", (unsigned) deaf_us);
   }
   return true;
 }
@@ -518,7 +587,7 @@ void SX1262::setup() {
     const char *lm = (this->listen_mode_ == LISTEN_MODE_T1) ? "T1 only"
                    : (this->listen_mode_ == LISTEN_MODE_C1) ? "C1 only"
                    : (this->listen_mode_ == LISTEN_MODE_S1) ? "S1 only"
-                   : "T1+C1 (both, 3:1 bias)";
+                   : "T1+C1 (both)";
     ESP_LOGI(TAG, "Listen mode / tryb nasluchu: %s", lm);
   }
 
@@ -645,54 +714,69 @@ void SX1262::log_reg_status() {
 // restart_rx: re-arm the receiver for the next WMBus frame.
 //
 // WMBus C-mode has two formats differing only in the second sync byte.
-// We cycle 3:1 towards Format B (0x3D) as it is more common in practice,
+// The byte for each dwell comes from the sync schedule (sync_scheduler.h),
 // so both formats are caught without any user configuration.
 // ---------------------------------------------------------------------------
 void SX1262::restart_rx() {
-  // Ping-pong between C-mode Block B (0x3D) and Block A (0xCD)
-  // WMBus C-mode exists in two Format variants that differ only in the second
-  // sync byte: Format A uses 0x3D, Format B uses 0xCD. Both are valid C1
-  // transmissions and real devices may transmit Format A.
-  // C1-only MUST cycle through both sync bytes exactly like `both` mode —
-  // otherwise Format A packets are silently missed.
-  // Bug: previous code hardcoded 0xCD (Format B only) in C1-only mode.
-  // Fix: apply the same 3:1 (A:B) cycling used in `both` mode.
-  // NOTE: do NOT revert C1-only to a fixed 0xCD; that breaks Format A.
-  if (this->listen_mode_ == LISTEN_MODE_S1) {
-    this->set_s1_sync_word_();
-    this->cmd_write_(CMD_CLEAR_IRQ_STATUS, {0xFF, 0xFF});
-    this->cmd_write_(CMD_SET_STANDBY, {STANDBY_XOSC});
-    this->configure_irq_params_();
-    this->cmd_write_(CMD_SET_RX, {0xFF, 0xFF, 0xFF});
+  // capture_rx_stream_() re-armed RX right after its frame; re-arming again
+  // would throw away a telegram that started since.
+  if (this->rx_rearmed_) {
+    this->rx_rearmed_ = false;
+    this->rx_stream_done_ = false;
     this->rx_loaded_ = false;
     this->rx_idx_ = 0;
     this->rx_len_ = 0;
+    // A telegram that started since the re-arm may have had its notification
+    // taken by a wait while the task was still reading the last frame; give
+    // it back, so the caller's wait returns at once instead of at the hop.
+    if (this->get_irq_status_() & (IRQ_SYNC_WORD_VALID | IRQ_RX_DONE))
+      xTaskNotifyGive(xTaskGetCurrentTaskHandle());
     return;
   }
+  // Full path: the sequence this driver always used, every register written
+  // again. Fast path: the sync word and IRQ routing are written only when they
+  // differ from what was armed last time (just the second sync byte), and
+  // before leaving RX: they only affect the next sync search. What is left
+  // between standby and SetRx is the blind window.
+  const bool fast = this->begin_rearm_();
+  if (!fast) {
+    this->armed_sync2_ = 0;
+    this->armed_irq_mask_ = 0;
+  }
 
-  uint8_t sync2;
-  if (this->listen_mode_ == LISTEN_MODE_T1) {
-    sync2 = 0x3D;
-  } else if (this->listen_mode_ == LISTEN_MODE_C1) {
-    // Cycle 3:1 (A:B) — same ratio as `both` mode.
-    sync2 = (this->sync_cycle_ == 3) ? 0xCD : 0x3D;
-    this->sync_cycle_ = (uint8_t) ((this->sync_cycle_ + 1) & 0x03);
+  if (this->listen_mode_ == LISTEN_MODE_S1) {
+    if (this->armed_sync2_ == 0) {
+      this->set_s1_sync_word_();
+      this->armed_sync2_ = 0x96;
+    }
   } else {
-    sync2 = (this->sync_cycle_ == 3) ? 0xCD : 0x3D;
-    this->sync_cycle_ = (uint8_t) ((this->sync_cycle_ + 1) & 0x03);
+    // WMBus C-mode exists in two Format variants that differ only in the second
+    // sync byte (0x3D / 0xCD). Both are valid C1 transmissions and real devices
+    // may transmit either.
+    // C1-only MUST follow the schedule exactly like `both` mode — otherwise
+    // one format is silently missed.
+    // NOTE: do NOT pin C1-only to a fixed byte; that breaks the other format.
+    const uint8_t sync2 = this->uses_sync_schedule() ? this->sync_sched_.next(millis()) : 0x3D;
+    if (this->armed_sync2_ == 0) {
+      this->set_sync_word_(sync2);
+    } else if (sync2 != this->armed_sync2_) {
+      this->write_register_(REG_SYNC_WORD_0 + 1, {sync2});
+    }
+    this->armed_sync2_ = sync2;
   }
 
-  this->set_sync_word_(sync2);
-
   this->cmd_write_(CMD_CLEAR_IRQ_STATUS, {0xFF, 0xFF});
-  this->cmd_write_(CMD_SET_STANDBY, {STANDBY_XOSC});
-
   // Adaptive long-packet mode may switch IRQ routing between fast RX_DONE-only
   // and long-stream SYNC_WORD_VALID+RX_DONE. Re-apply it each time RX is armed.
-  this->configure_irq_params_();
+  if (fast) this->configure_irq_params_();
+
+  const uint32_t blind_start_us = micros();
+  this->cmd_write_(CMD_SET_STANDBY, {STANDBY_XOSC});
+  if (!fast) this->configure_irq_params_();
 
   // RX continuous
   this->cmd_write_(CMD_SET_RX, {0xFF, 0xFF, 0xFF});
+  this->note_rearm_(micros() - blind_start_us, fast);
 
   this->rx_loaded_ = false;
   this->rx_idx_ = 0;
@@ -700,12 +784,17 @@ void SX1262::restart_rx() {
 }
 
 
+void SX1262::take_stream_capture_stats(StreamCaptureStats &acc) {
+  counters_fold(acc, this->stream_stats_, false);
+  this->stream_stats_ = {};
+}
+
 // ---------------------------------------------------------------------------
-// read: called byte-by-byte by the receiver task.
+// read_bulk: called by the receiver task via read_in_task*().
 // On first call after an IRQ: loads buffer (normal) or streams (long-packet).
-// Subsequent calls return successive bytes from rx_buffer_ until exhausted.
+// Every call copies as much of the rest of rx_buffer_ as the caller asked for.
 // ---------------------------------------------------------------------------
-optional<uint8_t> SX1262::read() {
+size_t SX1262::read_bulk(uint8_t *dst, size_t max) {
   if (!this->rx_loaded_) {
     const bool use_long_stream = this->long_stream_active_() || this->listen_mode_ == LISTEN_MODE_S1;
 
@@ -714,20 +803,20 @@ optional<uint8_t> SX1262::read() {
       // always handled as a stream). Do not use it for normal short T1 packets.
       const uint16_t irq = this->get_irq_status_();
       if ((irq & (IRQ_SYNC_WORD_VALID | IRQ_RX_DONE | IRQ_TIMEOUT | IRQ_CRC_ERROR)) == 0) {
-        return {};
+        return 0;
       }
       ESP_LOGD(TAG, "IRQ=%04X, capturing RX stream (adaptive long GFSK)", irq);
       if (!this->capture_rx_stream_())
-        return {};
+        return 0;
     } else {
       // Fast normal FIFO path. This is intentionally the default even when
       // long_gfsk_packets_ is true; long_gfsk_packets_ only enables the
       // adaptive fallback below when packets hit the FIFO edge.
       if (!this->irq_pin_->digital_read())
-        return {};
+        return 0;
       ESP_LOGD(TAG, "IRQ detected, loading buffer");
       if (!this->load_rx_buffer_())
-        return {};
+        return 0;
 
       if (this->long_gfsk_packets_ && this->rx_len_ >= 250) {
        // Hold must exceed the meter TX interval so the next transmission lands inside
@@ -740,9 +829,21 @@ optional<uint8_t> SX1262::read() {
     }
   }
 
-  if (this->rx_idx_ < this->rx_len_)
-    return this->rx_buffer_[this->rx_idx_++];
-  return {};
+  const size_t n = std::min(max, this->rx_len_ - this->rx_idx_);
+  if (n == 0) {
+    // RX was re-armed after the capture: the frame is complete.
+    if (this->rx_rearmed_) this->rx_stream_done_ = true;
+    return 0;
+  }
+  std::memcpy(dst, this->rx_buffer_.data() + this->rx_idx_, n);
+  this->rx_idx_ += n;
+  return n;
+}
+
+bool SX1262::consume_rx_abort_request() {
+  const bool done = this->rx_stream_done_;
+  this->rx_stream_done_ = false;
+  return done;
 }
 
 // ---------------------------------------------------------------------------
@@ -52,8 +52,10 @@ class SX1262 : public RadioTransceiver {
 
   void setup() override;
   void restart_rx() override;
-  optional<uint8_t> read() override;
+  size_t read_bulk(uint8_t *dst, size_t max) override;
+  bool consume_rx_abort_request() override;
   int8_t get_rssi() override;
+  void take_stream_capture_stats(StreamCaptureStats &acc) override;
   const char *get_name() override;
   void log_reg_status() override;
 
@@ -80,6 +82,14 @@ class SX1262 : public RadioTransceiver {
 
   // Long GFSK reception (Semtech AN1200.53)
   bool capture_rx_stream_();
+  // Set when capture_rx_stream_() has re-armed RX itself; the next
+  // restart_rx() then only resets the buffer state.
+  bool rx_rearmed_{false};
+  // Set by read_bulk() once such a frame is read out: nothing more will come
+  // for it, so read_in_task*() must stop instead of waiting on the task
+  // notification, which by then belongs to the next telegram.
+  bool rx_stream_done_{false};
+  StreamCaptureStats stream_stats_{};
 
   // Adaptive long-packet mode:
   // long_gfsk_packets=false -> always use fast normal FIFO/RX_DONE path.
@@ -87,10 +97,13 @@ class SX1262 : public RadioTransceiver {
   // reaches the SX126x FIFO edge (>=250 B), enable long-stream reception for a
   // short hold window so subsequent long frames can exceed the 255-byte FIFO limit.
   bool long_stream_active_() const;
+  // Writes the IRQ routing unless armed_irq_mask_ says it is set already.
   void configure_irq_params_();
+  // What restart_rx() armed last; 0 = unknown, write in full. S1 marks its
+  // sync word with 0x96, its last byte.
+  uint8_t armed_sync2_{0};
+  uint16_t armed_irq_mask_{0};
 
-  // Bias towards Block B (0x3D). Every 4th hop switches to Block A (0xCD).
-  uint8_t sync_cycle_{0};
 
   // Config
   uint32_t configured_frequency_hz_{868950000UL};
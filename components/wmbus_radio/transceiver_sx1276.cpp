@@ -1,9 +1,14 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 #include "transceiver_sx1276.h"
 
+#include "seqlock_counters.h"
+
 #include "esphome/core/log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <esp_timer.h>
 #include <algorithm>
+#include <cstring>
 
 #define F_OSC (32000000)
 
@@ -14,6 +19,7 @@ static const char *TAG = "SX1276";
 static constexpr uint8_t REG_FIFO         = 0x00;
 static constexpr uint8_t REG_OP_MODE      = 0x01;
 static constexpr uint8_t REG_IRQ_FLAGS2   = 0x3F;
+static constexpr uint8_t REG_RX_CONFIG    = 0x0D;
 static constexpr uint8_t REG_RSSI_VALUE   = 0x11;
 static constexpr uint8_t REG_FIFO_THRESH  = 0x35;
 static constexpr uint8_t REG_DIO_MAPPING1 = 0x40;
@@ -23,7 +29,13 @@ static constexpr uint8_t FLAG2_FIFO_EMPTY   = (1 << 6);
 static constexpr uint8_t FLAG2_FIFO_LEVEL   = (1 << 5);
 static constexpr uint8_t FLAG2_FIFO_OVERRUN = (1 << 4);
 
+// AfcAutoOn, AgcAutoOn, RxTrigger = PreambleDetect.
+static constexpr uint8_t RX_CONFIG = (1 << 4) | (1 << 3) | 0b110;
+// Restarts the receiver in place; the PLL stays locked (same frequency).
+static constexpr uint8_t RX_CONFIG_RESTART = RX_CONFIG | (1 << 6);
+
 void SX1276::spi_read_burst_(uint8_t address, uint8_t *dst, size_t len) {
+  this->spi_txns_++;
   this->delegate_->begin_transaction();
   this->delegate_->transfer(address & 0x7F);
   for (size_t i = 0; i < len; i++) {
@@ -32,20 +44,30 @@ void SX1276::spi_read_burst_(uint8_t address, uint8_t *dst, size_t len) {
   this->delegate_->end_transaction();
 }
 
-optional<uint8_t> SX1276::drain_fifo_once_() {
+void SX1276::handle_fifo_overrun_() {
+  this->spi_write(REG_IRQ_FLAGS2, (uint8_t) FLAG2_FIFO_OVERRUN);
+  this->chunk_len_ = 0;
+  this->chunk_idx_ = 0;
+  this->frame_active_ = false;
+  this->rssi_captured_ = false;
+  this->last_rssi_dbm_ = -127;
+  this->abort_requested_ = true;
+  this->fifo_overrun_count_++;
+  ESP_LOGW(TAG, "FIFO overrun / przepelnienie FIFO");
+}
+
+void SX1276::set_fifo_threshold_(uint8_t thresh) {
+  if (thresh == this->fifo_thresh_) return;
+  this->spi_write(REG_FIFO_THRESH, thresh);
+  this->fifo_thresh_ = thresh;
+}
+
+bool SX1276::drain_fifo_once_() {
   const uint8_t irq2 = this->spi_read(REG_IRQ_FLAGS2);
 
   if (irq2 & FLAG2_FIFO_OVERRUN) {
-    this->spi_write(REG_IRQ_FLAGS2, (uint8_t) FLAG2_FIFO_OVERRUN);
-    this->chunk_len_ = 0;
-    this->chunk_idx_ = 0;
-    this->frame_active_ = false;
-    this->rssi_captured_ = false;
-    this->last_rssi_dbm_ = -127;
-    this->abort_requested_ = true;
-    this->fifo_overrun_count_++;
-    ESP_LOGW(TAG, "FIFO overrun / przepelnienie FIFO");
-    return {};
+    this->handle_fifo_overrun_();
+    return false;
   }
 
   // Safe burst path: FifoLevel guarantees >= SX1276_CHUNK_SIZE bytes in FIFO.
@@ -59,7 +81,7 @@ optional<uint8_t> SX1276::drain_fifo_once_() {
     this->chunk_len_ = SX1276_CHUNK_SIZE;
     this->chunk_idx_ = 0;
     this->frame_active_ = true;
-    return this->chunk_buffer_[this->chunk_idx_++];
+    return true;
   }
 
   // Tail path: less than threshold left, so only a single-byte read is safe.
@@ -69,11 +91,14 @@ optional<uint8_t> SX1276::drain_fifo_once_() {
       this->rssi_captured_ = true;
     }
 
+    this->chunk_buffer_[0] = this->spi_read(REG_FIFO);
+    this->chunk_len_ = 1;
+    this->chunk_idx_ = 0;
     this->frame_active_ = true;
-    return this->spi_read(REG_FIFO);
+    return true;
   }
 
-  return {};
+  return false;
 }
 
 void SX1276::setup() {
@@ -94,7 +119,7 @@ void SX1276::setup() {
     const char *lm = (this->listen_mode_ == LISTEN_MODE_T1) ? "T1 only"
                    : (this->listen_mode_ == LISTEN_MODE_C1) ? "C1 only"
                    : (this->listen_mode_ == LISTEN_MODE_S1) ? "S1 only"
-                   : "T1+C1 (both, 3:1 bias)";
+                   : "T1+C1 (both)";
     ESP_LOGI(TAG, "Listen mode / tryb nasluchu: %s", lm);
   }
   this->reset();
@@ -137,7 +162,7 @@ void SX1276::setup() {
   this->spi_write(0x25, {BYTE(preamble_length, 1), BYTE(preamble_length, 0)});
 
   this->spi_write(0x1F, (uint8_t) ((1 << 7) | (1 << 5) | 0x0A));
-  this->spi_write(0x0D, (uint8_t) ((1 << 4) | (1 << 3) | 0b110));
+  this->spi_write(REG_RX_CONFIG, RX_CONFIG);
   this->spi_write(0x24, (uint8_t) 0b111);
 
   const uint8_t sync_len = (this->listen_mode_ == LISTEN_MODE_S1) ? 3 : 2;
@@ -152,6 +177,7 @@ void SX1276::setup() {
 
   // Threshold = CHUNK_SIZE - 1, so FifoLevel means FIFO has at least CHUNK_SIZE bytes.
   this->spi_write(REG_FIFO_THRESH, (uint8_t) (SX1276_CHUNK_SIZE - 1));
+  this->fifo_thresh_ = SX1276_CHUNK_SIZE - 1;
 
   // DIO1 = FifoLevel in FSK mode.
   // bits[5:4] = 00 -> FifoLevel
@@ -163,7 +189,7 @@ void SX1276::setup() {
   this->chunk_idx_ = 0;
   this->frame_active_ = false;
 
-  ESP_LOGV(TAG, "SX1276 setup done (burst + tail-gap bridge)");
+  ESP_LOGV(TAG, "SX1276 setup done (burst + %s)", this->fifo_event_wakeup_ ? "FifoLevel wakeup" : "tail-gap bridge");
 }
 
 void SX1276::log_reg_status() {
@@ -184,70 +210,135 @@ void SX1276::log_reg_status() {
   }
 }
 
-optional<uint8_t> SX1276::read() {
-  // First serve already buffered burst bytes from RAM.
-  if (this->chunk_idx_ < this->chunk_len_) {
-    return this->chunk_buffer_[this->chunk_idx_++];
-  }
-
-  // Normal fast path.
-  if (auto byte = this->drain_fifo_once_(); byte.has_value()) {
-    return byte;
-  }
-
+bool SX1276::stage_polling_() {
+  // Nothing left from the last burst: fetch the next chunk (fast path).
+  if (this->drain_fifo_once_()) return true;
   // Critical fix versus naive FifoLevel-only design:
   // when draining the tail of a frame, FIFO can become temporarily empty before
   // the next tail byte arrives. That does NOT necessarily mean EOF, and because
   // DIO1 now signals FifoLevel, there may be no new IRQ for the remaining <16 B.
-  // So after a frame has started, briefly poll for more bytes before returning {}.
-  if (this->frame_active_) {
-    const int64_t deadline = esp_timer_get_time() + SX1276_TAIL_GAP_US;
-    while (esp_timer_get_time() < deadline) {
-      if (auto byte = this->drain_fifo_once_(); byte.has_value()) {
-        return byte;
+  // So after a frame has started, briefly poll for more bytes before returning 0.
+  if (!this->frame_active_) return false;
+  const int64_t deadline = esp_timer_get_time() + SX1276_TAIL_GAP_US;
+  while (esp_timer_get_time() < deadline) {
+    if (this->drain_fifo_once_()) return true;
+  }
+  // No more bytes within the short intra-frame grace period -> frame ended.
+  this->frame_active_ = false;
+  return false;
+}
+
+bool SX1276::stage_on_fifo_level_(size_t max, uint32_t &slept_us) {
+  // Wait for a full chunk, or for the rest of the frame when the caller asks
+  // for less: with the threshold at want - 1, DIO1 (FifoLevel) rises exactly
+  // when want bytes are in the FIFO, and they are read in one burst. The
+  // sleep ends at that IRQ or once the bytes are overdue.
+  const size_t want = std::min(max, SX1276_CHUNK_SIZE);
+  this->set_fifo_threshold_((uint8_t) (want - 1));
+  const uint32_t byte_us = this->listen_mode_ == LISTEN_MODE_S1 ? 244 : 80;
+  const uint32_t budget_us = (uint32_t) want * byte_us + SX1276_TAIL_GAP_US;
+  const uint32_t start = micros();
+  for (;;) {
+    const uint8_t irq2 = this->spi_read(REG_IRQ_FLAGS2);
+    if (irq2 & FLAG2_FIFO_OVERRUN) {
+      this->handle_fifo_overrun_();
+      return false;
+    }
+    const bool level = (irq2 & FLAG2_FIFO_LEVEL) != 0;
+    const uint32_t elapsed = micros() - start;
+    // Overdue: the frame ended short of want (or the caller does not know
+    // its length); hand over what is there a byte at a time, without waiting
+    // again for each of them.
+    const bool tail = !level && (this->tail_draining_ || elapsed >= budget_us) && !(irq2 & FLAG2_FIFO_EMPTY);
+    if (level || tail) {
+      if (!this->rssi_captured_) {
+        this->last_rssi_dbm_ = (int8_t) (-(int) this->spi_read(REG_RSSI_VALUE) / 2);
+        this->rssi_captured_ = true;
       }
+      const size_t n = level ? want : 1;
+      this->tail_draining_ = !level;
+      this->spi_read_burst_(REG_FIFO, this->chunk_buffer_.data(), n);
+      this->chunk_len_ = n;
+      this->chunk_idx_ = 0;
+      this->frame_active_ = true;
+      return true;
+    }
+    if (elapsed >= budget_us) {
+      this->frame_active_ = false;
+      this->tail_draining_ = false;
+      return false;
     }
 
-    // No more bytes within the short intra-frame grace period -> frame ended.
-    this->frame_active_ = false;
+    const uint32_t due_us = std::min<uint32_t>((uint32_t) want * byte_us, budget_us - elapsed);
+    const TickType_t ticks = std::max<TickType_t>(1, pdMS_TO_TICKS((due_us + 999) / 1000));
+    const uint32_t sleep_start = micros();
+    ulTaskNotifyTake(pdTRUE, ticks);
+    slept_us += micros() - sleep_start;
+    this->drain_stats_.sleeps++;
   }
-
-  return {};
 }
 
-void SX1276::restart_rx() {
-  if (this->listen_mode_ == LISTEN_MODE_S1) {
-    this->spi_write(REG_OP_MODE, (uint8_t) 0b001);  // standby
-    this->spi_write(0x28, {0x54, 0x76, 0x96});
-    this->spi_write(REG_IRQ_FLAGS2, (uint8_t) FLAG2_FIFO_OVERRUN);
-    this->chunk_len_ = 0;
-    this->chunk_idx_ = 0;
-    this->frame_active_ = false;
-    this->rssi_captured_ = false;
-    this->last_rssi_dbm_ = -127;
-    this->abort_requested_ = false;
-    this->spi_write(REG_OP_MODE, (uint8_t) 0b101);  // RX
-    return;
-  }
+size_t SX1276::read_bulk(uint8_t *dst, size_t max) {
+  if (max == 0) return 0;
 
-  uint8_t sync2;
-  if (this->listen_mode_ == LISTEN_MODE_T1) {
-    sync2 = 0x3D;
-  } else if (this->listen_mode_ == LISTEN_MODE_C1) {
-    // C1 exists with both second sync-byte variants (0x3D / 0xCD).
-    // Bias 3:1 towards 0x3D, same as LISTEN_MODE_BOTH, so C1-only
-    // does not accidentally exclude the more common variant.
-    sync2 = (this->sync_cycle_ == 3) ? 0xCD : 0x3D;
-    this->sync_cycle_ = (uint8_t) ((this->sync_cycle_ + 1) & 0x03);
-  } else {
-    sync2 = (this->sync_cycle_ == 3) ? 0xCD : 0x3D;
-    this->sync_cycle_ = (uint8_t) ((this->sync_cycle_ + 1) & 0x03);
+  if (this->chunk_idx_ >= this->chunk_len_) {
+    this->begin_fifo_drain_(this->fifo_event_wakeup_);
+    uint32_t slept_us = 0;
+    const bool staged = this->fifo_event_wakeup_ ? this->stage_on_fifo_level_(max, slept_us)
+                                                 : this->stage_polling_();
+    this->end_fifo_drain_(slept_us);
+    if (!staged) return 0;
   }
 
-  this->spi_write(REG_OP_MODE, (uint8_t) 0b001);  // standby
-  this->spi_write(0x28, {0x54, sync2});
+  // Serve buffered burst bytes from RAM.
+  const size_t n = std::min(max, this->chunk_len_ - this->chunk_idx_);
+  std::memcpy(dst, this->chunk_buffer_.data() + this->chunk_idx_, n);
+  this->chunk_idx_ += n;
+  return n;
+}
 
-  // Clear FIFO overrun flag.
+void SX1276::restart_rx() {
+  // Full path: standby, sync word, RX; the way this driver always re-armed.
+  // Fast path: RX stays on, the second sync byte is written only when it
+  // changes, and RestartRxWithoutPllLock restarts the receiver without the
+  // frequency synthesizer going through standby. The blind window is timed
+  // from the first command that stops reception until the FIFO is clear and
+  // the receiver listens again.
+  const bool fast = this->begin_rearm_();
+  const bool s1 = this->listen_mode_ == LISTEN_MODE_S1;
+
+  // C1 exists with both second sync-byte variants (0x3D / 0xCD), so C1-only
+  // follows the same schedule as LISTEN_MODE_BOTH.
+  const uint8_t sync2 = s1 ? 0x76 : (this->uses_sync_schedule() ? this->sync_sched_.next(millis()) : 0x3D);
+
+  // The next frame's first IRQ is FifoLevel at a full chunk.
+  this->set_fifo_threshold_(SX1276_CHUNK_SIZE - 1);
+
+  uint32_t blind_start_us;
+  if (fast) {
+    if (sync2 != this->armed_sync2_) this->spi_write(0x29, sync2);
+    blind_start_us = micros();
+  } else {
+    blind_start_us = micros();
+    this->spi_write(REG_OP_MODE, (uint8_t) 0b001);  // standby
+    if (s1)
+      this->spi_write(0x28, {0x54, 0x76, 0x96});
+    else
+      this->spi_write(0x28, {0x54, sync2});
+  }
+  this->armed_sync2_ = sync2;
+
+  // Fast path: restart first, then clear. In unlimited packet mode the packet
+  // handler keeps filling the FIFO until it is restarted, so a byte landing
+  // between a clear and the restart would stay at the FIFO head. After
+  // RestartRxWithoutPllLock the handler waits for a new sync word before it
+  // writes to the FIFO again (SX1276 datasheet, FSK/OOK "Sync Word
+  // Recognition": with SyncOn, data reaches the FIFO only after
+  // SyncAddressMatch), and that takes at least the 16-24 sync bits, far
+  // longer than the one SPI write below.
+  if (fast) this->spi_write(REG_RX_CONFIG, RX_CONFIG_RESTART);
+
+  // Clear FIFO overrun flag (and the FIFO with it).
   this->spi_write(REG_IRQ_FLAGS2, (uint8_t) FLAG2_FIFO_OVERRUN);
 
   this->chunk_len_ = 0;
@@ -256,8 +347,12 @@ void SX1276::restart_rx() {
   this->rssi_captured_ = false;
   this->last_rssi_dbm_ = -127;
   this->abort_requested_ = false;
+  // The FIFO was just cleared; drops a stale FifoLevel notification.
+  this->close_fifo_drain_(this->fifo_event_wakeup_);
+  this->tail_draining_ = false;
 
-  this->spi_write(REG_OP_MODE, (uint8_t) 0b101);  // RX
+  if (!fast) this->spi_write(REG_OP_MODE, (uint8_t) 0b101);  // RX
+  this->note_rearm_(micros() - blind_start_us, fast);
 }
 
 int8_t SX1276::get_rssi() {
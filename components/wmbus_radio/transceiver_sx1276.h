@@ -22,8 +22,12 @@ class SX1276 : public RadioTransceiver {
     this->configured_frequency_hz_ = (uint32_t) (frequency_mhz * 1000000.0f + 0.5f);
   }
   void set_tcxo_pin(InternalGPIOPin *pin) { this->tcxo_pin_ = pin; }
+  // True: sleep on the receiver task notification until DIO1 (FifoLevel)
+  // reports the next chunk, or the rest of a frame of known length. False:
+  // poll RegIrqFlags2 through the tail gap (legacy).
+  void set_fifo_event_wakeup(bool enabled) { this->fifo_event_wakeup_ = enabled; }
   void setup() override;
-  optional<uint8_t> read() override;
+  size_t read_bulk(uint8_t *dst, size_t max) override;
   void restart_rx() override;
   int8_t get_rssi() override;
   const char *get_name() override;
@@ -37,9 +41,9 @@ class SX1276 : public RadioTransceiver {
  protected:
   uint32_t configured_frequency_hz_{868950000UL};
   InternalGPIOPin *tcxo_pin_{nullptr};
-  uint8_t sync_cycle_{0};
 
-  // Burst chunk buffered in ESP32 RAM and served byte-by-byte to upper layer.
+  // Burst chunk (or single tail byte) buffered in ESP32 RAM and handed to the
+  // upper layer by read_bulk().
   std::array<uint8_t, SX1276_CHUNK_SIZE> chunk_buffer_{};
   size_t chunk_len_{0};
   size_t chunk_idx_{0};
@@ -52,13 +56,28 @@ class SX1276 : public RadioTransceiver {
   bool rssi_captured_{false};
   bool abort_requested_{false};
   uint32_t fifo_overrun_count_{0};
+  // Second sync byte restart_rx() armed last.
+  uint8_t armed_sync2_{0};
+
+  bool fifo_event_wakeup_{true};
+  // RegFifoThresh as last written; FifoLevel = more than this many bytes.
+  uint8_t fifo_thresh_{SX1276_CHUNK_SIZE - 1};
+  // The FIFO ran short of a full read; take what is left byte by byte.
+  bool tail_draining_{false};
 
   // Burst SPI: CS held low for the entire transfer.
   // SAFE only when caller knows at least 'len' bytes are already in FIFO.
   void spi_read_burst_(uint8_t address, uint8_t *dst, size_t len);
 
-  // Drain one safe chunk or one safe tail byte if available.
-  optional<uint8_t> drain_fifo_once_();
+  // Stage one safe chunk or one safe tail byte in chunk_buffer_ if available.
+  bool drain_fifo_once_();
+  // Drop the staged bytes and flag the overrun for the upper layer.
+  void handle_fifo_overrun_();
+  void set_fifo_threshold_(uint8_t thresh);
+  // Fill chunk_buffer_ for read_bulk(): by polling through the tail gap, or
+  // asleep until FifoLevel says want bytes are in the FIFO.
+  bool stage_polling_();
+  bool stage_on_fifo_level_(size_t max, uint32_t &slept_us);
 };
 
 }  // namespace wmbus_radio
@@ -10,7 +10,13 @@
 // Protocol constants (were defined at the top of component.cpp).
 #define WMBUS_PREAMBLE_SIZE (3)
 #define WMBUS_MODE_C_PREAMBLE (0x54)
+// T1 bytes that used to be read before the length was computed. The L-field
+// now comes from the preamble bytes (streaming 3-of-6 decode); this is still
+// the first body chunk and the base of the weak-start thresholds.
 #define WMBUS_T1_LEN_PROBE_BYTES (18)
+// Later T1 body chunks (32 symbols each). Between chunks the streaming
+// decoder checks the new symbols, so a lost frame stops being read early.
+#define WMBUS_T1_STREAM_CHUNK_BYTES (24)
 // SX1276-specific recovery path: if length cannot be derived from the initial
 // probe, keep draining the raw stream until idle and let the packet parser make
 // the final decision. Sized to cover long T1 telegrams (>255 B after decode).
@@ -32,7 +38,7 @@ static inline const char *listen_mode_to_string_(ListenMode mode) {
       return "S1 only";
     case LISTEN_MODE_BOTH:
     default:
-      return "T1+C1 (both, 3:1 bias)";
+      return "T1+C1 (both)";
   }
 }
 
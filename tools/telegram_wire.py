@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-3.0-or-later
+"""Reference decoder for binary telegram records (telegram_format: binary).
+
+Layout (components/wmbus_radio/telegram_wire.h), little-endian:
+
+    off len
+     0   1  version (1)
+     1   1  link mode: 0 unknown, 1 T1, 2 C1, 3 S1
+     2   1  frame format: 0 unknown, 1 A, 2 B
+     3   1  RSSI in dBm, signed
+     4   4  receive time, ms since boot
+     8   1  flags: bit 0 = raw radio packet (wmbus_bridge/raw), not a validated telegram
+     9   1  header length; skip this many bytes, newer firmware may append fields
+    10   2  payload length
+    12   n  payload
+
+A batch (<telegram topic>/batch) is records back to back.
+
+Use it as a module (decode_records()) or on a capture, one JSON object per
+record on stdout, with "hex" in the form the text topics carry:
+
+    mosquitto_sub -h <broker> -t 'wmbus/+/telegram' -F '%x' | tools/telegram_wire.py
+    tools/telegram_wire.py --binary < payload.bin
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+VERSION = 1
+HEADER_LEN = 12
+FLAG_RAW = 0x01
+
+LINK_MODES = {0: "??", 1: "T1", 2: "C1", 3: "S1"}
+FORMATS = {0: None, 1: "A", 2: "B"}
+
+
+class WireError(ValueError):
+    pass
+
+
+def decode_records(buf):
+    """Yield one dict per record in buf (one message: a frame or a batch)."""
+    off = 0
+    while off < len(buf):
+        if len(buf) - off < HEADER_LEN:
+            raise WireError("truncated header at offset %d" % off)
+        version, mode, fmt, rssi, rx_ms, flags, header_len, payload_len = struct.unpack_from(
+            "<BBBbIBBH", buf, off
+        )
+        if version != VERSION:
+            raise WireError("unsupported version %d at offset %d" % (version, off))
+        if header_len < HEADER_LEN:
+            raise WireError("header length %d at offset %d" % (header_len, off))
+        end = off + header_len + payload_len
+        if end > len(buf):
+            raise WireError("truncated payload at offset %d" % off)
+        yield {
+            "rx_ms": rx_ms,
+            "mode": LINK_MODES.get(mode, "??"),
+            "format": FORMATS.get(fmt),
+            "rssi": rssi,
+            "raw": bool(flags & FLAG_RAW),
+            "hex": buf[off + header_len : end].hex(),
+        }
+        off = end
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("file", nargs="?", help="input (default: stdin)")
+    ap.add_argument(
+        "--binary",
+        action="store_true",
+        help="input is one raw message, not hex lines (mosquitto_sub -F %%x)",
+    )
+    args = ap.parse_args()
+
+    src = open(args.file, "rb") if args.file else sys.stdin.buffer
+    with src:
+        if args.binary:
+            messages = [src.read()]
+        else:
+            messages = [bytes.fromhex(line.decode().strip()) for line in src if line.strip()]
+
+    status = 0
+    for msg in messages:
+        try:
+            for rec in decode_records(msg):
+                print(json.dumps(rec))
+        except WireError as e:
+            print("error: %s" % e, file=sys.stderr)
+            status = 1
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())